@@ -24,8 +24,14 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 // TODO: From coreapi. Remove me later.
 #include "private.h"
 
+static void linphone_buffer_free_content(LinphoneBuffer *buffer) {
+	if (buffer->content && !buffer->borrowed) belle_sip_free(buffer->content);
+	buffer->content = NULL;
+	buffer->borrowed = FALSE;
+}
+
 static void linphone_buffer_destroy(LinphoneBuffer *buffer) {
-	if (buffer->content) belle_sip_free(buffer->content);
+	linphone_buffer_free_content(buffer);
 }
 
 BELLE_SIP_DECLARE_NO_IMPLEMENTED_INTERFACES(LinphoneBuffer);
@@ -56,6 +62,29 @@ LinphoneBuffer * linphone_buffer_new_from_string(const char *data) {
 	return buffer;
 }
 
+/*
+ * Creates a buffer that points to data owned by the caller, without copying it. data[size] must be '\0', so that
+ * linphone_buffer_get_string_content() keeps working. The caller must give it back with
+ * _linphone_buffer_release_borrowed_data() before the data goes away.
+ */
+LinphoneBuffer *_linphone_buffer_new_borrowing_data(uint8_t *data, size_t size) {
+	LinphoneBuffer *buffer = linphone_buffer_new();
+	buffer->content = data;
+	buffer->size = size;
+	buffer->borrowed = TRUE;
+	return buffer;
+}
+
+/*
+ * Drops the reference of the creator of a buffer made by _linphone_buffer_new_borrowing_data().
+ * If the buffer is still referenced elsewhere, it gets its own copy of the borrowed data.
+ */
+void _linphone_buffer_release_borrowed_data(LinphoneBuffer *buffer) {
+	if (buffer->borrowed && buffer->base.ref > 1)
+		linphone_buffer_set_content(buffer, buffer->content, buffer->size);
+	linphone_buffer_unref(buffer);
+}
+
 LinphoneBuffer * linphone_buffer_ref(LinphoneBuffer *buffer) {
 	belle_sip_object_ref(buffer);
 	return buffer;
@@ -78,11 +107,12 @@ const uint8_t * linphone_buffer_get_content(const LinphoneBuffer *buffer) {
 }
 
 void linphone_buffer_set_content(LinphoneBuffer *buffer, const uint8_t *content, size_t size) {
+	uint8_t *newContent = reinterpret_cast<uint8_t *>(belle_sip_malloc(size + 1));
+	memcpy(newContent, content, size);
+	newContent[size] = '\0';
+	linphone_buffer_free_content(buffer);
 	buffer->size = size;
-	if (buffer->content) belle_sip_free(buffer->content);
-	buffer->content = reinterpret_cast<uint8_t *>(belle_sip_malloc(size + 1));
-	memcpy(buffer->content, content, size);
-    ((char *)buffer->content)[size] = '\0';
+	buffer->content = newContent;
 }
 
 const char * linphone_buffer_get_string_content(const LinphoneBuffer *buffer) {
@@ -90,9 +120,10 @@ const char * linphone_buffer_get_string_content(const LinphoneBuffer *buffer) {
 }
 
 void linphone_buffer_set_string_content(LinphoneBuffer *buffer, const char *content) {
+	uint8_t *newContent = (uint8_t *)belle_sip_strdup(content);
+	linphone_buffer_free_content(buffer);
 	buffer->size = strlen(content);
-	if (buffer->content) belle_sip_free(buffer->content);
-	buffer->content = (uint8_t *)belle_sip_strdup(content);
+	buffer->content = newContent;
 }
 
 size_t linphone_buffer_get_size(const LinphoneBuffer *buffer) {
@@ -43,6 +43,7 @@
 #include "c-wrapper/c-wrapper.h"
 #include "core/core-p.h"
 #include "db/main-db.h"
+#include "utils/metrics.h"
 
 // TODO: From coreapi. Remove me later.
 #include "private.h"
@@ -462,6 +463,13 @@ LinphoneStatus linphone_friend_enable_subscribes(LinphoneFriend *fr, bool_t val)
 }
 
 LinphoneStatus linphone_friend_set_inc_subscribe_policy(LinphoneFriend *fr, LinphoneSubscribePolicy pol) {
+	/* A denied subscriber is kept in the subscribers list to reject its next requests, but it is no longer pending. */
+	if (fr->lc && ((fr->pol == LinphoneSPDeny) != (pol == LinphoneSPDeny)) && bctbx_list_find(fr->lc->subscribers, fr)) {
+		if (pol == LinphoneSPDeny)
+			LinphonePrivate::Metrics::get().presencePendingSubscriptions.decrement();
+		else
+			LinphonePrivate::Metrics::get().presencePendingSubscriptions.increment();
+	}
 	fr->pol=pol;
 	return 0;
 }
@@ -885,6 +893,8 @@ void linphone_core_add_friend(LinphoneCore *lc, LinphoneFriend *lf) {
 	if (bctbx_list_find(lc->subscribers, lf)) {
 		/*if this friend was in the pending subscriber list, now remove it from this list*/
 		lc->subscribers = bctbx_list_remove(lc->subscribers, lf);
+		if (lf->pol != LinphoneSPDeny)
+			LinphonePrivate::Metrics::get().presencePendingSubscriptions.decrement();
 		linphone_friend_unref(lf);
 	}
 }
@@ -921,7 +921,8 @@ static void _linphone_friend_list_send_list_subscription_with_body(LinphoneFrien
 		linphone_content_set_subtype(content, "resource-lists+xml");
 		linphone_content_set_string_buffer(content, xml_content);
 		if (linphone_core_content_encoding_supported(list->lc, "deflate")) {
-			linphone_content_set_encoding(content, "deflate");
+			if (linphone_core_should_apply_content_encoding(list->lc, "deflate", strlen(xml_content)))
+				linphone_content_set_encoding(content, "deflate");
 			linphone_event_add_custom_header(list->event, "Accept-Encoding", "deflate");
 		}
 		for (elem = list->friends; elem != NULL; elem = bctbx_list_next(elem)) {
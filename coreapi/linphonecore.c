@@ -67,6 +67,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "content/content-manager.h"
 #include "content/content-type.h"
 #include "core/core-p.h"
+#include "utils/metrics.h"
 
 // For migration purpose.
 #include "address/address-p.h"
@@ -466,6 +467,22 @@ void linphone_core_cbs_set_chat_room_state_changed (LinphoneCoreCbs *cbs, Linpho
 	cbs->vtable->chat_room_state_changed = cb;
 }
 
+LinphoneCoreCbsOutgoingMessageQueueCongestionChangedCb linphone_core_cbs_get_outgoing_message_queue_congestion_changed (LinphoneCoreCbs *cbs) {
+	return cbs->vtable->outgoing_message_queue_congestion_changed;
+}
+
+void linphone_core_cbs_set_outgoing_message_queue_congestion_changed (LinphoneCoreCbs *cbs, LinphoneCoreCbsOutgoingMessageQueueCongestionChangedCb cb) {
+	cbs->vtable->outgoing_message_queue_congestion_changed = cb;
+}
+
+LinphoneCoreCbsFileTransferQueueChangedCb linphone_core_cbs_get_file_transfer_queue_changed (LinphoneCoreCbs *cbs) {
+	return cbs->vtable->file_transfer_queue_changed;
+}
+
+void linphone_core_cbs_set_file_transfer_queue_changed (LinphoneCoreCbs *cbs, LinphoneCoreCbsFileTransferQueueChangedCb cb) {
+	cbs->vtable->file_transfer_queue_changed = cb;
+}
+
 LinphoneCoreCbsQrcodeFoundCb linphone_core_cbs_get_qrcode_found(LinphoneCoreCbs *cbs) {
 	return cbs->vtable->qrcode_found;
 }
@@ -1496,6 +1513,7 @@ static void sip_config_read(LinphoneCore *lc) {
 	lc->sip_conf.auto_net_state_mon = !!lp_config_get_int(lc->config,"sip","auto_net_state_mon",1);
 	lc->sip_conf.keepalive_period = (unsigned int)lp_config_get_int(lc->config,"sip","keepalive_period",10000);
 	lc->sip_conf.tcp_tls_keepalive = !!lp_config_get_int(lc->config,"sip","tcp_tls_keepalive",0);
+	lc->sip_conf.content_encoding_min_size = (size_t)MAX(0, lp_config_get_int(lc->config,"sip","content_encoding_min_size",256));
 	linphone_core_enable_keep_alive(lc, (lc->sip_conf.keepalive_period > 0));
 	lc->sal->useOneMatchingCodecPolicy(!!lp_config_get_int(lc->config,"sip","only_one_codec",0));
 	lc->sal->useDates(!!lp_config_get_int(lc->config,"sip","put_date",0));
@@ -1936,12 +1954,14 @@ bool_t linphone_core_rtcp_enabled(const LinphoneCore *lc){
 void linphone_core_set_download_bandwidth(LinphoneCore *lc, int bw){
 	lc->net_conf.download_bw=bw;
 	linphone_core_update_allocated_audio_bandwidth(lc);
+	linphone_core_codecs_changed(lc);
 	if (linphone_core_ready(lc)) lp_config_set_int(lc->config,"net","download_bw",bw);
 }
 
 void linphone_core_set_upload_bandwidth(LinphoneCore *lc, int bw){
 	lc->net_conf.upload_bw=bw;
 	linphone_core_update_allocated_audio_bandwidth(lc);
+	linphone_core_codecs_changed(lc);
 	if (linphone_core_ready(lc)) lp_config_set_int(lc->config,"net","upload_bw",bw);
 }
 
@@ -2698,6 +2718,7 @@ LinphoneAddress *linphone_core_get_primary_contact_parsed(LinphoneCore *lc){
 LinphoneStatus linphone_core_set_audio_codecs(LinphoneCore *lc, bctbx_list_t *codecs){
 	if (lc->codecs_conf.audio_codecs!=NULL) bctbx_list_free(lc->codecs_conf.audio_codecs);
 	lc->codecs_conf.audio_codecs=codecs;
+	linphone_core_codecs_changed(lc);
 	_linphone_core_codec_config_write(lc);
 	linphone_core_update_allocated_audio_bandwidth(lc);
 	return 0;
@@ -2706,6 +2727,7 @@ LinphoneStatus linphone_core_set_audio_codecs(LinphoneCore *lc, bctbx_list_t *co
 LinphoneStatus linphone_core_set_video_codecs(LinphoneCore *lc, bctbx_list_t *codecs){
 	if (lc->codecs_conf.video_codecs!=NULL) bctbx_list_free(lc->codecs_conf.video_codecs);
 	lc->codecs_conf.video_codecs=codecs;
+	linphone_core_codecs_changed(lc);
 	_linphone_core_codec_config_write(lc);
 	return 0;
 }
@@ -2715,12 +2737,14 @@ LinphoneStatus linphone_core_set_text_codecs(LinphoneCore *lc, bctbx_list_t *cod
 		bctbx_list_free(lc->codecs_conf.text_codecs);
 
 	lc->codecs_conf.text_codecs = codecs;
+	linphone_core_codecs_changed(lc);
 	_linphone_core_codec_config_write(lc);
 	return 0;
 }
 
 void linphone_core_enable_generic_comfort_noise(LinphoneCore *lc, bool_t enabled){
 	lp_config_set_int(lc->config, "misc", "use_cn", enabled);
+	linphone_core_codecs_changed(lc);
 }
 
 bool_t linphone_core_generic_comfort_noise_enabled(const LinphoneCore *lc){
@@ -3257,6 +3281,22 @@ bool_t linphone_core_content_encoding_supported(const LinphoneCore *lc, const ch
 	return (strcmp(handle_content_encoding, content_encoding) == 0) && lc->sal->isContentEncodingAvailable(content_encoding);
 }
 
+/*
+ * Compressing a body costs a zlib stream setup in belle-sip and adds a header and a checksum to the payload,
+ * which makes it a net loss for small bodies. Those are sent as is, below the sip/content_encoding_min_size threshold.
+ */
+bool_t linphone_core_should_apply_content_encoding(LinphoneCore *lc, const char *content_encoding, size_t body_size) {
+	if (!linphone_core_content_encoding_supported(lc, content_encoding))
+		return FALSE;
+	if (body_size < lc->sip_conf.content_encoding_min_size) {
+		LinphonePrivate::Metrics::get().sipBodiesUnencoded.increment();
+		return FALSE;
+	}
+	LinphonePrivate::Metrics::get().sipBodiesEncoded.increment();
+	LinphonePrivate::Metrics::get().sipBodiesEncodedBytes.increment(body_size);
+	return TRUE;
+}
+
 static void notify_network_reachable_change (LinphoneCore *lc) {
 	if (!lc->network_reachable_to_be_notified)
 		return;
@@ -6167,6 +6207,10 @@ void _linphone_core_codec_config_write(LinphoneCore *lc){
 	}
 }
 
+void linphone_core_codecs_changed(LinphoneCore *lc){
+	lc->codecs_conf.revision++;
+}
+
 static void codecs_config_uninit(LinphoneCore *lc)
 {
 	_linphone_core_codec_config_write(lc);
@@ -6180,6 +6224,10 @@ void friends_config_uninit(LinphoneCore* lc)
 	ms_message("Destroying friends.");
 	lc->friends_lists = bctbx_list_free_with_data(lc->friends_lists, (void (*)(void*))_linphone_friend_list_release);
 	if (lc->subscribers) {
+		for (const bctbx_list_t *elem = lc->subscribers; elem != NULL; elem = bctbx_list_next(elem)) {
+			if (((LinphoneFriend *)bctbx_list_get_data(elem))->pol != LinphoneSPDeny)
+				LinphonePrivate::Metrics::get().presencePendingSubscriptions.decrement();
+		}
 		lc->subscribers = bctbx_list_free_with_data(lc->subscribers, (void (*)(void *))_linphone_friend_release);
 	}
 	if (lc->presence_model) {
@@ -17,6 +17,8 @@ along with this program; if not, write to the Free Software
 Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 
+#include <ctype.h>
+
 #include "c-wrapper/internal/c-sal.h"
 #include "sal/sal.h"
 #include "offeranswer.h"
@@ -24,6 +26,8 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 
 #include "utils/payload-type-handler.h"
 
+#define MAX_PAYLOAD_TYPE_NUMBER 128
+
 static bool_t only_telephone_event(const bctbx_list_t *l){
 	for(;l!=NULL;l=l->next){
 		PayloadType *p=(PayloadType*)l->data;
@@ -134,18 +138,67 @@ MSOfferAnswerProvider red_offer_answer_provider={
 	red_offer_answer_create_context
 };
 
-static PayloadType * generic_match(const bctbx_list_t *local_payloads, const PayloadType *refpt, const bctbx_list_t *remote_payloads){
-	PayloadType *pt;
+/*
+ * Index of the local payload types keyed by mime type (case insensitive), clock rate and channels, so that matching
+ * the remote payload types does not walk the local list for each of them.
+ * Only the first local payload type of a key is kept: generic matching picks the first one of the list.
+ */
+typedef struct _PayloadTypeIndex{
+	PayloadType **slots;
+	size_t mask;
+}PayloadTypeIndex;
+
+static size_t payload_type_hash(const PayloadType *pt){
+	/*FNV-1a*/
+	unsigned int hash=2166136261u;
+	const char *c;
+	for (c=pt->mime_type;*c!='\0';c++){
+		hash^=(unsigned int)tolower((unsigned char)*c);
+		hash*=16777619u;
+	}
+	hash^=(unsigned int)pt->clock_rate;
+	hash*=16777619u;
+	hash^=(unsigned int)pt->channels;
+	hash*=16777619u;
+	return hash;
+}
+
+static bool_t payload_type_key_equals(const PayloadType *pt, const PayloadType *refpt){
+	return strcasecmp(pt->mime_type, refpt->mime_type)==0
+		&& pt->clock_rate==refpt->clock_rate
+		&& pt->channels==refpt->channels;
+}
+
+static void payload_type_index_init(PayloadTypeIndex *index, const bctbx_list_t *payloads){
 	const bctbx_list_t *elem;
+	size_t size=8;
+	size_t i;
+
+	while (size < bctbx_list_size(payloads)*2) size*=2;
+	index->slots=ms_new0(PayloadType*,size);
+	index->mask=size-1;
+	for (elem=payloads;elem!=NULL;elem=elem->next){
+		PayloadType *pt=(PayloadType*)elem->data;
+		if (!pt->mime_type) continue;
+		for (i=payload_type_hash(pt) & index->mask;index->slots[i]!=NULL;i=(i+1) & index->mask){
+			if (payload_type_key_equals(index->slots[i], pt)) break;
+		}
+		if (index->slots[i]==NULL) index->slots[i]=pt;
+	}
+}
 
-	for (elem=local_payloads;elem!=NULL;elem=elem->next){
-		pt=(PayloadType*)elem->data;
-		
-		if ( pt->mime_type && refpt->mime_type 
-			&& strcasecmp(pt->mime_type, refpt->mime_type)==0
-			&& pt->clock_rate==refpt->clock_rate
-			&& pt->channels==refpt->channels)
-			return payload_type_clone(pt);
+static void payload_type_index_uninit(PayloadTypeIndex *index){
+	ms_free(index->slots);
+	index->slots=NULL;
+}
+
+static PayloadType * generic_match(const PayloadTypeIndex *local_index, const PayloadType *refpt){
+	size_t i;
+
+	if (!refpt->mime_type) return NULL;
+	for (i=payload_type_hash(refpt) & local_index->mask;local_index->slots[i]!=NULL;i=(i+1) & local_index->mask){
+		if (payload_type_key_equals(local_index->slots[i], refpt))
+			return payload_type_clone(local_index->slots[i]);
 	}
 	return NULL;
 }
@@ -161,8 +214,8 @@ void linphone_core_register_offer_answer_providers(LinphoneCore *lc){
 /*
  * Returns a PayloadType from the local list that matches a PayloadType offered or answered in the remote list
 */
-static PayloadType * find_payload_type_best_match(MSFactory *factory, const bctbx_list_t *local_payloads, const PayloadType *refpt,
-						  const bctbx_list_t *remote_payloads, bool_t reading_response){
+static PayloadType * find_payload_type_best_match(MSFactory *factory, const bctbx_list_t *local_payloads, const PayloadTypeIndex *local_index,
+						  const PayloadType *refpt, const bctbx_list_t *remote_payloads, bool_t reading_response){
 	PayloadType *ret = NULL;
 	MSOfferAnswerContext *ctx = NULL;
 
@@ -173,7 +226,7 @@ static PayloadType * find_payload_type_best_match(MSFactory *factory, const bctb
 		ms_offer_answer_context_destroy(ctx);
 		return ret;
 	}
-	return generic_match(local_payloads, refpt, remote_payloads);
+	return generic_match(local_index, refpt);
 }
 
 
@@ -182,10 +235,13 @@ static bctbx_list_t *match_payloads(MSFactory *factory, const bctbx_list_t *loca
 	bctbx_list_t *res=NULL;
 	PayloadType *matched;
 	bool_t found_codec=FALSE;
+	PayloadTypeIndex local_index;
+	bool_t used_numbers[MAX_PAYLOAD_TYPE_NUMBER]={0};
 
+	payload_type_index_init(&local_index, local);
 	for(e2=remote;e2!=NULL;e2=e2->next){
 		PayloadType *p2=(PayloadType*)e2->data;
-		matched=find_payload_type_best_match(factory, local, p2, remote, reading_response);
+		matched=find_payload_type_best_match(factory, local, &local_index, p2, remote, reading_response);
 		if (matched){
 			int local_number=payload_type_get_number(matched);
 			int remote_number=payload_type_get_number(p2);
@@ -238,16 +294,25 @@ static bctbx_list_t *match_payloads(MSFactory *factory, const bctbx_list_t *loca
 			else ms_message("No match for %s/%i",p2->mime_type,p2->clock_rate);
 		}
 	}
+	payload_type_index_uninit(&local_index);
 	if (reading_response){
 		/* add remaning local payload as CAN_RECV only so that if we are in front of a non-compliant equipment we are still able to decode the RTP stream*/
+		for(e2=res;e2!=NULL;e2=e2->next){
+			int number=payload_type_get_number((PayloadType*)e2->data);
+			if (number>=0 && number<MAX_PAYLOAD_TYPE_NUMBER) used_numbers[number]=TRUE;
+		}
 		for(e1=local;e1!=NULL;e1=e1->next){
 			PayloadType *p1=(PayloadType*)e1->data;
+			int number=payload_type_get_number(p1);
 			bool_t found=FALSE;
-			for(e2=res;e2!=NULL;e2=e2->next){
-				PayloadType *p2=(PayloadType*)e2->data;
-				if (payload_type_get_number(p2)==payload_type_get_number(p1)){
-					found=TRUE;
-					break;
+			if (number>=0 && number<MAX_PAYLOAD_TYPE_NUMBER){
+				found=used_numbers[number];
+			}else{
+				for(e2=res;e2!=NULL;e2=e2->next){
+					if (payload_type_get_number((PayloadType*)e2->data)==number){
+						found=TRUE;
+						break;
+					}
 				}
 			}
 			if (!found){
@@ -256,6 +321,7 @@ static bctbx_list_t *match_payloads(MSFactory *factory, const bctbx_list_t *loca
 				payload_type_set_flag(p1, PAYLOAD_TYPE_FLAG_CAN_RECV);
 				payload_type_set_flag(p1, PAYLOAD_TYPE_FROZEN_NUMBER);
 				res=bctbx_list_append(res,p1);
+				if (number>=0 && number<MAX_PAYLOAD_TYPE_NUMBER) used_numbers[number]=TRUE;
 			}
 		}
 	}
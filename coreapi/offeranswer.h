@@ -33,7 +33,7 @@ extern "C" {
  * Returns a media description to run the streams with, based on a local offer
  * and the returned response (remote).
 **/
-int offer_answer_initiate_outgoing(MSFactory *factory, const SalMediaDescription *local_offer,
+LINPHONE_PUBLIC int offer_answer_initiate_outgoing(MSFactory *factory, const SalMediaDescription *local_offer,
 									const SalMediaDescription *remote_answer,
 									SalMediaDescription *result);
 
@@ -42,7 +42,7 @@ int offer_answer_initiate_outgoing(MSFactory *factory, const SalMediaDescription
  * and the received offer.
  * The returned media description is an answer and should be sent to the offerer.
 **/
-int offer_answer_initiate_incoming(MSFactory* factory, const SalMediaDescription *local_capabilities,
+LINPHONE_PUBLIC int offer_answer_initiate_incoming(MSFactory* factory, const SalMediaDescription *local_capabilities,
 						const SalMediaDescription *remote_offer,
 						SalMediaDescription *result, bool_t one_matching_codec);
 
@@ -70,6 +70,7 @@ static char *_payload_type_get_description(const OrtpPayloadType *pt) {
 
 static int _linphone_core_enable_payload_type(LinphoneCore *lc, OrtpPayloadType *pt, bool_t enabled) {
 	payload_type_set_enable(pt,enabled);
+	linphone_core_codecs_changed(lc);
 	_linphone_core_codec_config_write(lc);
 	linphone_core_update_allocated_audio_bandwidth(lc);
 	return 0;
@@ -178,6 +179,7 @@ static void _linphone_core_set_payload_type_normal_bitrate(LinphoneCore *lc, Ort
 		pt->normal_bitrate=bitrate*1000;
 		pt->flags|=PAYLOAD_TYPE_BITRATE_OVERRIDE;
 		linphone_core_update_allocated_audio_bandwidth(lc);
+		linphone_core_codecs_changed(lc);
 	}else{
 		char *desc = _payload_type_get_description(pt);
 		ms_error("Cannot set an explicit bitrate for codec '%s', because it is not VBR.",desc);
@@ -221,10 +223,12 @@ int linphone_payload_type_get_number(const LinphonePayloadType *pt) {
 
 void linphone_core_set_payload_type_number(LinphoneCore *lc, OrtpPayloadType *pt, int number) {
 	payload_type_set_number(pt, number);
+	linphone_core_codecs_changed(lc);
 }
 
 void linphone_payload_type_set_number(LinphonePayloadType *pt, int number) {
 	payload_type_set_number(pt->pt, number);
+	if (pt->lc) linphone_core_codecs_changed(pt->lc);
 }
 
 const char *linphone_payload_type_get_recv_fmtp(const LinphonePayloadType *pt) {
@@ -235,6 +239,7 @@ void linphone_payload_type_set_recv_fmtp(LinphonePayloadType *pt, const char *re
 	if (pt->pt->recv_fmtp != NULL) bctbx_free(pt->pt->recv_fmtp);
 	if (recv_fmtp != NULL) pt->pt->recv_fmtp = bctbx_strdup(recv_fmtp);
 	else recv_fmtp = NULL;
+	if (pt->lc) linphone_core_codecs_changed(pt->lc);
 }
 
 const char *linphone_payload_type_get_send_fmtp(const LinphonePayloadType *pt) {
@@ -245,6 +250,7 @@ void linphone_payload_type_set_send_fmtp(LinphonePayloadType *pt, const char *se
 	if (pt->pt->send_fmtp != NULL) bctbx_free(pt->pt->send_fmtp);
 	if (send_fmtp != NULL) pt->pt->recv_fmtp = bctbx_strdup(send_fmtp);
 	else send_fmtp = NULL;
+	if (pt->lc) linphone_core_codecs_changed(pt->lc);
 }
 
 int linphone_payload_type_get_clock_rate(const LinphonePayloadType *pt) {
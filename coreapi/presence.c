@@ -22,6 +22,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "linphone/presence.h"
 
 #include "c-wrapper/c-wrapper.h"
+#include "utils/metrics.h"
 
 // TODO: From coreapi. Remove me later.
 #include "private.h"
@@ -1536,6 +1537,7 @@ void linphone_core_add_subscriber(LinphoneCore *lc, const char *subscriber, SalO
 	fl->inc_subscribe_pending=TRUE;
 	/* the newly created "not yet" friend ownership is transfered to the lc->subscribers list*/
 	lc->subscribers=bctbx_list_append(lc->subscribers,fl);
+	LinphonePrivate::Metrics::get().presencePendingSubscriptions.increment();
 
 	addr = linphone_friend_get_address(fl);
 	if (addr != NULL) {
@@ -174,6 +174,7 @@ LinphoneFriend *linphone_core_find_friend_by_out_subscribe(const LinphoneCore *l
 LinphoneFriend *linphone_core_find_friend_by_inc_subscribe(const LinphoneCore *lc, LinphonePrivate::SalOp *op);
 MSList *linphone_find_friend_by_address(MSList *fl, const LinphoneAddress *addr, LinphoneFriend **lf);
 bool_t linphone_core_should_subscribe_friends_only_when_registered(const LinphoneCore *lc);
+bool_t linphone_core_should_apply_content_encoding(LinphoneCore *lc, const char *content_encoding, size_t body_size);
 void linphone_core_update_friends_subscriptions(LinphoneCore *lc);
 void _linphone_friend_list_update_subscriptions(LinphoneFriendList *list, LinphoneProxyConfig *cfg, bool_t only_when_registered);
 void linphone_core_friends_storage_init(LinphoneCore *lc);
@@ -374,6 +375,7 @@ bool_t linphone_core_sound_resources_available(LinphoneCore *lc);
 LINPHONE_PUBLIC unsigned int linphone_core_get_audio_features(LinphoneCore *lc);
 
 void _linphone_core_codec_config_write(LinphoneCore *lc);
+void linphone_core_codecs_changed(LinphoneCore *lc);
 
 LINPHONE_PUBLIC bctbx_list_t * linphone_core_read_call_logs_from_config_file(LinphoneCore *lc);
 void call_logs_write_to_config_file(LinphoneCore *lc);
@@ -539,6 +541,8 @@ void linphone_core_notify_friend_list_removed(LinphoneCore *lc, LinphoneFriendLi
 void linphone_core_notify_call_created(LinphoneCore *lc, LinphoneCall *call);
 void linphone_core_notify_version_update_check_result_received(LinphoneCore *lc, LinphoneVersionUpdateCheckResult result, const char *version, const char *url);
 void linphone_core_notify_chat_room_state_changed (LinphoneCore *lc, LinphoneChatRoom *cr, LinphoneChatRoomState state);
+void linphone_core_notify_outgoing_message_queue_congestion_changed (LinphoneCore *lc, bool_t congested);
+void linphone_core_notify_file_transfer_queue_changed (LinphoneCore *lc, int running, int queued);
 void linphone_core_notify_qrcode_found(LinphoneCore *lc, const char *result);
 void linphone_core_notify_ec_calibration_result(LinphoneCore *lc, LinphoneEcCalibratorStatus status, int delay_ms);
 void linphone_core_notify_ec_calibration_audio_init(LinphoneCore *lc);
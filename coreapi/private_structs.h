@@ -237,6 +237,7 @@ struct sip_config
 	int in_call_timeout;	/*timeout after a call is hangup */
 	int delayed_timeout; 	/*timeout after a delayed call is resumed */
 	unsigned int keepalive_period; /* interval in ms between keep alive messages sent to the proxy server*/
+	size_t content_encoding_min_size; /* bodies smaller than this are sent without content encoding */
 	LinphoneSipTransports transports;
 	bool_t guess_hostname;
 	bool_t loopback_only;
@@ -319,6 +320,7 @@ struct codecs_config
 	MSList *text_codecs;
 	int dyn_pt;
 	int telephone_event_pt;
+	unsigned int revision; /* incremented by linphone_core_codecs_changed() each time the codecs to offer may have changed */
 };
 
 struct video_config{
@@ -462,6 +464,7 @@ struct _LinphoneBuffer {
 	void *user_data;
 	uint8_t *content;	/**< A pointer to the buffer content */
 	size_t size;	/**< The size of the buffer content */
+	bool_t borrowed;	/**< The content belongs to the creator of the buffer and is not freed with it */
 };
 
 BELLE_SIP_DECLARE_VPTR_NO_EXPORT(LinphoneBuffer);
@@ -56,6 +56,8 @@ LINPHONE_PUBLIC const char *linphone_core_get_tone_file(const LinphoneCore *lc,
 LINPHONE_PUBLIC IceSession * linphone_call_get_ice_session(const LinphoneCall *call);
 LINPHONE_PUBLIC const struct addrinfo *linphone_core_get_stun_server_addrinfo(LinphoneCore *lc);
 LINPHONE_PUBLIC void linphone_core_enable_send_call_stats_periodical_updates(LinphoneCore *lc, bool_t enabled);
+LINPHONE_PUBLIC LinphoneBuffer *_linphone_buffer_new_borrowing_data(uint8_t *data, size_t size);
+LINPHONE_PUBLIC void _linphone_buffer_release_borrowed_data(LinphoneBuffer *buffer);
 
 LINPHONE_PUBLIC int linphone_run_stun_tests(LinphoneCore *lc, int audioPort, int videoPort, int textPort,
 	char *audioCandidateAddr, int *audioCandidatePort, char *videoCandidateAddr, int *videoCandidatePort, char *textCandidateAddr, int *textCandidatePort);
@@ -304,6 +304,16 @@ void linphone_core_notify_chat_room_state_changed (LinphoneCore *lc, LinphoneCha
 	cleanup_dead_vtable_refs(lc);
 }
 
+void linphone_core_notify_outgoing_message_queue_congestion_changed (LinphoneCore *lc, bool_t congested) {
+	NOTIFY_IF_EXIST(outgoing_message_queue_congestion_changed, lc, congested);
+	cleanup_dead_vtable_refs(lc);
+}
+
+void linphone_core_notify_file_transfer_queue_changed (LinphoneCore *lc, int running, int queued) {
+	NOTIFY_IF_EXIST(file_transfer_queue_changed, lc, running, queued);
+	cleanup_dead_vtable_refs(lc);
+}
+
 void linphone_core_notify_qrcode_found(LinphoneCore *lc, const char *result) {
 	NOTIFY_IF_EXIST(qrcode_found, lc, result);
 	cleanup_dead_vtable_refs(lc);
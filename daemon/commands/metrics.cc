@@ -0,0 +1,50 @@
+/*
+metrics.cc
+Copyright (C) 2018 Belledonne Communications, Grenoble, France
+
+This library is free software; you can redistribute it and/or modify it
+under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation; either version 2.1 of the License, or (at
+your option) any later version.
+
+This library is distributed in the hope that it will be useful, but WITHOUT
+ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this library; if not, write to the Free Software Foundation,
+Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
+*/
+
+#include "metrics.h"
+
+using namespace std;
+
+class MetricsResponse : public Response {
+public:
+	MetricsResponse();
+};
+
+MetricsResponse::MetricsResponse() : Response() {
+	char *metrics = linphone_core_get_metrics();
+	setBody(metrics);
+	ms_free(metrics);
+}
+
+MetricsCommand::MetricsCommand() :
+		DaemonCommand("metrics", "metrics", "Get the metrics of the daemon in the Prometheus text exposition format.") {
+	addExample(new DaemonCommandExample("metrics",
+						"Status: Ok\n\n"
+						"# HELP linphone_calls_total Calls created.\n"
+						"# TYPE linphone_calls_total counter\n"
+						"linphone_calls_total 2\n"
+						"# HELP linphone_calls_active Calls currently handled by the cores.\n"
+						"# TYPE linphone_calls_active gauge\n"
+						"linphone_calls_active 1\n"
+						"..."));
+}
+
+void MetricsCommand::exec(Daemon *app, const string& args) {
+	app->sendResponse(MetricsResponse());
+}
@@ -82,6 +82,7 @@ Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301  USA
 #include "commands/netsim.h"
 #include "commands/cn.h"
 #include "commands/version.h"
+#include "commands/metrics.h"
 #include "commands/play.h"
 #include "commands/message.h"
 
@@ -491,6 +492,7 @@ void Daemon::initCommands() {
 	mCommands.push_back(new JitterBufferCommand());
 	mCommands.push_back(new JitterBufferResetCommand());
 	mCommands.push_back(new VersionCommand());
+	mCommands.push_back(new MetricsCommand());
 	mCommands.push_back(new QuitCommand());
 	mCommands.push_back(new HelpCommand());
 	mCommands.push_back(new ConfigGetCommand());
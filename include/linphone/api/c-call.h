@@ -749,6 +749,19 @@ LINPHONE_PUBLIC LinphoneStatus linphone_call_send_info_message(LinphoneCall *cal
 **/
 LINPHONE_PUBLIC LinphoneCallStats *linphone_call_get_stats(LinphoneCall *call, LinphoneStreamType type);
 
+/**
+ * Get the statistics of a stream sampled every second, from a given time. Only the last samples are kept,
+ * as many as the stats_history_size setting of the [rtp] section (60 by default, 0 disables the history).
+ * @param call the call
+ * @param type the stream type
+ * @param since the time of the first sample to return, 0 to get all of them
+ * @param samples an array of max_samples samples to fill, the oldest first, or NULL
+ * @param max_samples the size of the samples array
+ * @return the number of samples copied, or the number of samples available if samples is NULL
+ * @donotwrap
+**/
+LINPHONE_PUBLIC size_t linphone_call_get_stats_history(LinphoneCall *call, LinphoneStreamType type, time_t since, LinphoneCallStatsSample *samples, size_t max_samples);
+
 LINPHONE_PUBLIC LinphoneCallStats *linphone_call_get_audio_stats(LinphoneCall *call);
 
 LINPHONE_PUBLIC LinphoneCallStats *linphone_call_get_video_stats(LinphoneCall *call);
@@ -250,6 +250,28 @@ LINPHONE_PUBLIC const char *linphone_content_get_file_path (const LinphoneConten
  */
 LINPHONE_PUBLIC void linphone_content_set_file_path (LinphoneContent *content, const char *file_path);
 
+/**
+ * Get the path of the thumbnail uploaded along with the file of this content.
+ * @param[in] content #LinphoneContent object.
+ * @return The thumbnail file path set for this content if it has been set, NULL otherwise.
+ */
+LINPHONE_PUBLIC const char *linphone_content_get_thumbnail_file_path (const LinphoneContent *content);
+
+/**
+ * Set the path of a small version of the file, uploaded along with it so that receivers can display it
+ * before downloading the file. It is not sent when the file transfer is encrypted.
+ * @param[in] content #LinphoneContent object.
+ * @param[in] thumbnail_file_path the thumbnail filepath, a JPEG or PNG image.
+ */
+LINPHONE_PUBLIC void linphone_content_set_thumbnail_file_path (LinphoneContent *content, const char *thumbnail_file_path);
+
+/**
+ * Get the URL of the thumbnail advertised by the sender of a received file transfer.
+ * @param[in] content #LinphoneContent object.
+ * @return The thumbnail URL if the sender uploaded one, NULL otherwise.
+ */
+LINPHONE_PUBLIC const char *linphone_content_get_thumbnail_url (const LinphoneContent *content);
+
 /**
  * Tells whether or not this content contains text.
  * @param[in] content #LinphoneContent object.
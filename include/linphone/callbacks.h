@@ -405,6 +405,24 @@ typedef void (*LinphoneCoreCbsVersionUpdateCheckResultReceivedCb) (LinphoneCore
  */
 typedef void (*LinphoneCoreCbsChatRoomStateChangedCb) (LinphoneCore *lc, LinphoneChatRoom *cr, LinphoneChatRoomState state);
 
+/**
+ * Callback prototype telling that the queue of outgoing chat messages waiting to be sent became congested or not.
+ * Messages are queued when the outgoing_message_rate or outgoing_message_rate_per_destination limits of the [sip] section are reached.
+ * @param[in] lc #LinphoneCore object
+ * @param[in] congested TRUE if the queue has reached outgoing_message_congestion_threshold, FALSE once it has drained to half of it
+ */
+typedef void (*LinphoneCoreCbsOutgoingMessageQueueCongestionChangedCb) (LinphoneCore *lc, bool_t congested);
+
+/**
+ * Callback prototype telling that file transfers have been started, queued or have ended.
+ * The number of concurrent transfers is limited by the max_concurrent_file_transfers and
+ * max_concurrent_file_transfers_during_call entries of the [misc] section.
+ * @param[in] lc #LinphoneCore object
+ * @param[in] running The number of file transfers in progress
+ * @param[in] queued The number of file transfers waiting to be started
+ */
+typedef void (*LinphoneCoreCbsFileTransferQueueChangedCb) (LinphoneCore *lc, int running, int queued);
+
 /**
  * Callback prototype telling the result of decoded qrcode
  * @param[in] lc LinphoneCore object
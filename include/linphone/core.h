@@ -230,6 +230,9 @@ typedef struct _LinphoneCoreVTable{
 	LinphoneCoreCbsEcCalibrationAudioInitCb ec_calibration_audio_init;
 	LinphoneCoreCbsEcCalibrationAudioUninitCb ec_calibration_audio_uninit;
 	void *user_data; /**<User data associated with the above callbacks */
+	/* New callbacks go after user_data, so that the layout of the fields above is kept. */
+	LinphoneCoreCbsOutgoingMessageQueueCongestionChangedCb outgoing_message_queue_congestion_changed;
+	LinphoneCoreCbsFileTransferQueueChangedCb file_transfer_queue_changed;
 } LinphoneCoreVTable;
 
 /**
@@ -733,6 +736,34 @@ LINPHONE_PUBLIC LinphoneCoreCbsChatRoomStateChangedCb linphone_core_cbs_get_chat
  */
 LINPHONE_PUBLIC void linphone_core_cbs_set_chat_room_state_changed (LinphoneCoreCbs *cbs, LinphoneCoreCbsChatRoomStateChangedCb cb);
 
+/**
+ * Get the outgoing message queue congestion changed callback.
+ * @param[in] cbs #LinphoneCoreCbs object
+ * @return The current callback
+ */
+LINPHONE_PUBLIC LinphoneCoreCbsOutgoingMessageQueueCongestionChangedCb linphone_core_cbs_get_outgoing_message_queue_congestion_changed (LinphoneCoreCbs *cbs);
+
+/**
+ * Set the outgoing message queue congestion changed callback.
+ * @param[in] cbs #LinphoneCoreCbs object
+ * @param[in] cb The callback to use
+ */
+LINPHONE_PUBLIC void linphone_core_cbs_set_outgoing_message_queue_congestion_changed (LinphoneCoreCbs *cbs, LinphoneCoreCbsOutgoingMessageQueueCongestionChangedCb cb);
+
+/**
+ * Get the file transfer queue changed callback.
+ * @param[in] cbs #LinphoneCoreCbs object
+ * @return The current callback
+ */
+LINPHONE_PUBLIC LinphoneCoreCbsFileTransferQueueChangedCb linphone_core_cbs_get_file_transfer_queue_changed (LinphoneCoreCbs *cbs);
+
+/**
+ * Set the file transfer queue changed callback.
+ * @param[in] cbs #LinphoneCoreCbs object
+ * @param[in] cb The callback to use
+ */
+LINPHONE_PUBLIC void linphone_core_cbs_set_file_transfer_queue_changed (LinphoneCoreCbs *cbs, LinphoneCoreCbsFileTransferQueueChangedCb cb);
+
 /**
  * Get the qrcode found callback.
  * @param[in] cbs LinphoneCoreCbs object
@@ -857,6 +888,13 @@ LINPHONE_PUBLIC char * linphone_core_compress_log_collection(void);
  */
 LINPHONE_PUBLIC void linphone_core_reset_log_collection(void);
 
+/**
+ * Get the metrics gathered by the library: calls, registrations, SIP traffic, chat messages, database
+ * transactions and call quality, counted for all the cores of the process.
+ * @return The metrics in the Prometheus text exposition format (to be freed calling ms_free()).
+ */
+LINPHONE_PUBLIC char * linphone_core_get_metrics(void);
+
 /**
  * @brief Define a log handler.
  * @param logfunc The function pointer of the log handler.
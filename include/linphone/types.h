@@ -275,6 +275,21 @@ typedef struct _LinphoneCallParams LinphoneCallParams;
 **/
 typedef struct _LinphoneCallStats LinphoneCallStats;
 
+/**
+ * Statistics of a stream sampled every second while the call is running, see linphone_call_get_stats_history().
+ * @ingroup call_misc
+ * @donotwrap
+**/
+typedef struct _LinphoneCallStatsSample {
+	time_t time; /**< Time at which the sample was taken */
+	float download_bandwidth; /**< Bandwidth of the received stream in kbit/s, including IP/UDP/RTP headers */
+	float upload_bandwidth; /**< Bandwidth of the sent stream in kbit/s, including IP/UDP/RTP headers */
+	float local_loss_rate; /**< Percentage of packets lost over the last second */
+	float receiver_interarrival_jitter; /**< Interarrival jitter reported by the remote end, in seconds */
+	float round_trip_delay; /**< Round trip propagation time in seconds, -1 if unknown */
+	float quality; /**< Quality rating of the stream, between 0 and 5, -1 if unknown */
+} LinphoneCallStatsSample;
+
 /**
  * Enum representing the status of a call
  * @ingroup call_logs
@@ -102,6 +102,7 @@ namespace Utils {
 	LINPHONE_PUBLIC std::string stringToLower (const std::string &str);
 
 	LINPHONE_PUBLIC char *utf8ToChar (uint32_t ic);
+	LINPHONE_PUBLIC void appendUtf8 (std::string &str, uint32_t ic);
 
 	LINPHONE_PUBLIC inline std::string cStringToCppString (const char *str) {
 		return str ? str : "";
@@ -587,6 +587,16 @@ LinphoneCallStats *linphone_call_get_stats (LinphoneCall *call, LinphoneStreamTy
 	return L_GET_CPP_PTR_FROM_C_OBJECT(call)->getStats(type);
 }
 
+size_t linphone_call_get_stats_history (
+	LinphoneCall *call,
+	LinphoneStreamType type,
+	time_t since,
+	LinphoneCallStatsSample *samples,
+	size_t max_samples
+) {
+	return L_GET_CPP_PTR_FROM_C_OBJECT(call)->getStatsHistory(type, since, samples, max_samples);
+}
+
 LinphoneCallStats *linphone_call_get_audio_stats (LinphoneCall *call) {
 	return L_GET_CPP_PTR_FROM_C_OBJECT(call)->getAudioStats();
 }
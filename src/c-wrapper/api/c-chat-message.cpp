@@ -239,6 +239,7 @@ void linphone_chat_message_add_file_content (LinphoneChatMessage *msg, LinphoneC
 	fileContent->setFileSize(linphone_content_get_size(c_content));
 	fileContent->setFileName(linphone_content_get_name(c_content));
 	fileContent->setFilePath(linphone_content_get_file_path(c_content));
+	fileContent->setThumbnailFilePath(L_C_TO_STRING(linphone_content_get_thumbnail_file_path(c_content)));
 	if (linphone_content_get_size(c_content) > 0) {
 		fileContent->setBody(linphone_content_get_string_buffer(c_content));
 	}
@@ -17,6 +17,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <cstring>
+
 #include "linphone/api/c-content.h"
 #include "linphone/wrapper_utils.h"
 
@@ -49,6 +51,7 @@ L_DECLARE_C_CLONABLE_OBJECT_IMPL_WITH_XTORS(Content,
 		string subtype;
 		string buffer;
 		string file_path;
+		string thumbnail_file_path;
 	} mutable cache;
 )
 
@@ -263,6 +266,27 @@ void linphone_content_set_file_path (LinphoneContent *content, const char *file_
 	content->cache.file_path = L_C_TO_STRING(file_path);
 }
 
+const char *linphone_content_get_thumbnail_file_path (const LinphoneContent *content) {
+	const LinphonePrivate::Content *c = L_GET_CPP_PTR_FROM_C_OBJECT(content);
+	if (c->isFile())
+		return L_STRING_TO_C(static_cast<const LinphonePrivate::FileContent *>(c)->getThumbnailFilePath());
+	return L_STRING_TO_C(content->cache.thumbnail_file_path);
+}
+
+void linphone_content_set_thumbnail_file_path (LinphoneContent *content, const char *thumbnail_file_path) {
+	LinphonePrivate::Content *c = L_GET_CPP_PTR_FROM_C_OBJECT(content);
+	if (c->isFile())
+		static_cast<LinphonePrivate::FileContent *>(c)->setThumbnailFilePath(L_C_TO_STRING(thumbnail_file_path));
+	content->cache.thumbnail_file_path = L_C_TO_STRING(thumbnail_file_path);
+}
+
+const char *linphone_content_get_thumbnail_url (const LinphoneContent *content) {
+	const LinphonePrivate::Content *c = L_GET_CPP_PTR_FROM_C_OBJECT(content);
+	if (c->isFileTransfer())
+		return L_STRING_TO_C(static_cast<const LinphonePrivate::FileTransferContent *>(c)->getThumbnailUrl());
+	return nullptr;
+}
+
 bool_t linphone_content_is_text (const LinphoneContent *content) {
 	const LinphonePrivate::Content *c = L_GET_CPP_PTR_FROM_C_OBJECT(content);
 	return c->getContentType() == LinphonePrivate::ContentType::PlainText;
@@ -302,10 +326,13 @@ static LinphoneContent *linphone_content_new_with_body_handler (const SalBodyHan
 	if (linphone_content_is_multipart(content) && parseMultipart) {
 		belle_sip_multipart_body_handler_t *mpbh = BELLE_SIP_MULTIPART_BODY_HANDLER(bodyHandler);
 		char *body = belle_sip_object_to_string(mpbh);
-		linphone_content_set_string_buffer(content, body);
+		c->setBody(body, strlen(body));
 		belle_sip_free(body);
 	} else {
-		linphone_content_set_string_buffer(content, reinterpret_cast<char *>(sal_body_handler_get_data(bodyHandler)));
+		// Copy the data straight into the body, without going through an intermediate string.
+		const char *body = reinterpret_cast<const char *>(sal_body_handler_get_data(bodyHandler));
+		if (body)
+			c->setBody(body, strlen(body));
 	}
 
 	const belle_sip_list_t *headers = reinterpret_cast<const belle_sip_list_t *>(sal_body_handler_get_headers(bodyHandler));
@@ -345,6 +372,16 @@ LinphoneContent *linphone_content_from_sal_body_handler (const SalBodyHandler *b
 	return linphone_content_new_with_body_handler(bodyHandler, parseMultipart);
 }
 
+// Null-terminated copy of the body, made with a single allocation and owned by the caller.
+static char *dup_content_body (const LinphoneContent *content) {
+	const vector<char> &body = L_GET_CPP_PTR_FROM_C_OBJECT(content)->getBody();
+	char *buffer = reinterpret_cast<char *>(belle_sip_malloc(body.size() + 1));
+	if (!body.empty())
+		memcpy(buffer, body.data(), body.size());
+	buffer[body.size()] = '\0';
+	return buffer;
+}
+
 SalBodyHandler *sal_body_handler_from_content (const LinphoneContent *content, bool parseMultipart) {
 	if (!content)
 		return nullptr;
@@ -353,14 +390,14 @@ SalBodyHandler *sal_body_handler_from_content (const LinphoneContent *content, b
 	LinphonePrivate::ContentType contentType = L_GET_CPP_PTR_FROM_C_OBJECT(content)->getContentType();
 	if (contentType.isMultipart() && parseMultipart) {
 		size_t size = linphone_content_get_size(content);
-		char *buffer = bctbx_strdup(L_GET_CPP_PTR_FROM_C_OBJECT(content)->getBodyAsUtf8String().c_str());
+		char *buffer = dup_content_body(content);
 		const char *boundary = L_STRING_TO_C(contentType.getParameter("boundary").getValue());
 		belle_sip_multipart_body_handler_t *bh = belle_sip_multipart_body_handler_new_from_buffer(buffer, size, boundary);
 		bodyHandler = reinterpret_cast<SalBodyHandler *>(BELLE_SIP_BODY_HANDLER(bh));
-		bctbx_free(buffer);
+		belle_sip_free(buffer);
 	} else {
 		bodyHandler = sal_body_handler_new();
-		sal_body_handler_set_data(bodyHandler, belle_sip_strdup(linphone_content_get_string_buffer(content)));
+		sal_body_handler_set_data(bodyHandler, dup_content_body(content));
 	}
 
 	for (const auto &header : L_GET_CPP_PTR_FROM_C_OBJECT(content)->getHeaders()) {
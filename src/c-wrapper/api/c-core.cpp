@@ -21,6 +21,7 @@
 
 #include "c-wrapper/c-wrapper.h"
 #include "core/core.h"
+#include "utils/metrics.h"
 
 #include "private_structs.h"
 
@@ -45,3 +46,9 @@ static void _linphone_core_destructor (LinphoneCore *lc) {
 		bctbx_list_free_with_data(lc->callsCache, (bctbx_list_free_func)linphone_call_unref);
 	_linphone_core_uninit(lc);
 }
+
+// =============================================================================
+
+char *linphone_core_get_metrics () {
+	return ms_strdup(LinphonePrivate::Metrics::get().toPrometheusText().c_str());
+}
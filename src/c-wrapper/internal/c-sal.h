@@ -332,9 +332,9 @@ typedef struct SalMessage{
 extern "C" {
 #endif
 
-SalMediaDescription *sal_media_description_new(void);
+LINPHONE_PUBLIC SalMediaDescription *sal_media_description_new(void);
 SalMediaDescription * sal_media_description_ref(SalMediaDescription *md);
-void sal_media_description_unref(SalMediaDescription *md);
+LINPHONE_PUBLIC void sal_media_description_unref(SalMediaDescription *md);
 bool_t sal_media_description_empty(const SalMediaDescription *md);
 int sal_media_description_equals(const SalMediaDescription *md1, const SalMediaDescription *md2);
 char * sal_media_description_print_differences(int result);
@@ -25,6 +25,7 @@
 #include "conference/session/media-session-p.h"
 #include "core/core-p.h"
 #include "logger/logger.h"
+#include "utils/metrics.h"
 
 #include "conference_private.h"
 
@@ -89,7 +90,15 @@ bool CallPrivate::initiateOutgoing () {
 }
 
 void CallPrivate::iterate (time_t currentRealTime, bool oneSecondElapsed) {
-	getActiveSession()->iterate(currentRealTime, oneSecondElapsed);
+	Metrics::get().callIterations.increment();
+	shared_ptr<CallSession> session = getActiveSession();
+	session->iterate(currentRealTime, oneSecondElapsed);
+	// The events of the streams processed meanwhile may have started or ended some work.
+	session->getPrivate()->updatePendingWork();
+}
+
+bool CallPrivate::hasPendingWork () const {
+	return getActiveSession()->getPrivate()->hasPendingWork();
 }
 
 void CallPrivate::startIncomingNotification () {
@@ -368,6 +377,11 @@ void CallPrivate::onNoMediaTimeoutCheck (const shared_ptr<CallSession> &session,
 		terminateBecauseOfLostMedia();
 }
 
+void CallPrivate::onPendingWorkChanged (const shared_ptr<CallSession> &session, bool pendingWork) {
+	L_Q();
+	q->getCore()->getPrivate()->setCallPendingWork(q->getSharedFromThis(), pendingWork);
+}
+
 void CallPrivate::onEncryptionChanged (const shared_ptr<CallSession> &session, bool activated, const string &authToken) {
 	L_Q();
 	linphone_call_notify_encryption_changed(L_GET_C_BACK_PTR(q), activated, authToken.empty() ? nullptr : authToken.c_str());
@@ -489,8 +503,7 @@ bool CallPrivate::isPlayingRingbackTone (const shared_ptr<CallSession> &session)
 }
 
 void CallPrivate::onRealTimeTextCharacterReceived (const shared_ptr<CallSession> &session, RealtimeTextReceivedCharacter *data) {
-	L_Q();
-	getChatRoom()->getPrivate()->realtimeTextReceived(data->character, q->getSharedFromThis());
+	getChatRoom()->getPrivate()->realtimeTextReceived(data->character);
 }
 
 void CallPrivate::onTmmbrReceived (const shared_ptr<CallSession> &session, int streamIndex, int tmmbr) {
@@ -847,6 +860,11 @@ LinphoneCallStats *Call::getStats (LinphoneStreamType type) const {
 	return static_pointer_cast<const MediaSession>(d->getActiveSession())->getStats(type);
 }
 
+size_t Call::getStatsHistory (LinphoneStreamType type, time_t since, LinphoneCallStatsSample *samples, size_t count) const {
+	L_D();
+	return static_pointer_cast<const MediaSession>(d->getActiveSession())->getStatsHistory(type, since, samples, count);
+}
+
 int Call::getStreamCount () const {
 	L_D();
 	return static_pointer_cast<MediaSession>(d->getActiveSession())->getStreamCount();
@@ -108,6 +108,7 @@ public:
 	float getSpeakerVolumeGain () const;
 	CallSession::State getState () const;
 	LinphoneCallStats *getStats (LinphoneStreamType type) const;
+	size_t getStatsHistory (LinphoneStreamType type, time_t since, LinphoneCallStatsSample *samples, size_t count) const;
 	int getStreamCount () const;
 	MSFormatType getStreamType (int streamIndex) const;
 	LinphoneCallStats *getTextStats () const;
@@ -23,6 +23,7 @@
 #include <belle-sip/types.h>
 
 #include "chat/chat-message/chat-message.h"
+#include "chat/chat-message/outgoing-message-scheduler.h"
 #include "chat/chat-room/chat-room-id.h"
 #include "chat/modifier/file-transfer-chat-message-modifier.h"
 #include "chat/notification/imdn.h"
@@ -45,6 +46,7 @@ class ChatMessagePrivate : public ObjectPrivate {
 	friend class EncryptionChatMessageModifier;
 	friend class MultipartChatMessageModifier;
 	friend class NotificationMessagePrivate;
+	friend class OutgoingMessageScheduler;
 
 public:
 	enum Step {
@@ -64,6 +66,9 @@ public:
 	void setParticipantState (const IdentityAddress &participantAddress, ChatMessage::State newState, time_t stateChangeTime);
 
 	virtual void setState (ChatMessage::State newState);
+	// Same as setState(Displayed) for an incoming message whose state has already been stored in database by
+	// MainDb::markChatMessagesAsRead.
+	void markAsRead ();
 	void forceState (ChatMessage::State newState) {
 		state = newState;
 	}
@@ -169,6 +174,8 @@ public:
 	static bool isValidStateTransition (ChatMessage::State currentState, ChatMessage::State newState);
 
 private:
+	void notifyStateChanged ();
+
 	ChatMessagePrivate(const std::shared_ptr<AbstractChatRoom> &cr, ChatMessage::Direction dir);
 
 public:
@@ -180,6 +187,7 @@ protected:
 	bool positiveDeliveryNotificationRequired = true;
 	bool toBeStored = true;
 	std::string contentEncoding;
+	OutgoingMessageScheduler::Priority sendPriority = OutgoingMessageScheduler::Priority::Message;
 
 private:
 	// TODO: Clean attributes.
@@ -200,6 +208,7 @@ private:
 	unsigned char currentSendStep = Step::None;
 	unsigned char currentRecvStep = Step::None;
 	bool applyModifiers = true;
+	bool sendScheduled = false;
 	FileTransferChatMessageModifier fileTransferChatMessageModifier;
 
 	// Cache for returned values, used for compatibility with previous C API
@@ -43,6 +43,7 @@
 #include "core/core-p.h"
 #include "logger/logger.h"
 #include "sip-tools/sip-headers.h"
+#include "utils/metrics.h"
 
 #include "ortp/b64.h"
 
@@ -144,18 +145,16 @@ void ChatMessagePrivate::setState (ChatMessage::State newState) {
 	lInfo() << "Chat message " << this << ": moving from " << Utils::toString(state) <<
 		" to " << Utils::toString(newState);
 	state = newState;
-
-	LinphoneChatMessage *msg = L_GET_C_BACK_PTR(q);
-	if (linphone_chat_message_get_message_state_changed_cb(msg))
-		linphone_chat_message_get_message_state_changed_cb(msg)(
-			msg,
-			LinphoneChatMessageState(state),
-			linphone_chat_message_get_message_state_changed_cb_user_data(msg)
-		);
-
-	LinphoneChatMessageCbs *cbs = linphone_chat_message_get_callbacks(msg);
-	if (cbs && linphone_chat_message_cbs_get_msg_state_changed(cbs))
-		linphone_chat_message_cbs_get_msg_state_changed(cbs)(msg, (LinphoneChatMessageState)state);
+	if (
+		direction == ChatMessage::Direction::Outgoing &&
+		getContentType() != ContentType::ImIsComposing && getContentType() != ContentType::Imdn
+	) {
+		if (state == ChatMessage::State::Delivered)
+			Metrics::get().chatMessagesSent.increment();
+		else if (state == ChatMessage::State::NotDelivered)
+			Metrics::get().chatMessagesFailed.increment();
+	}
+	notifyStateChanged();
 
 	// 3. Specific case, change to displayed after transfer.
 	if (state == ChatMessage::State::FileTransferDone) {
@@ -171,6 +170,36 @@ void ChatMessagePrivate::setState (ChatMessage::State newState) {
 	}
 }
 
+void ChatMessagePrivate::markAsRead () {
+	L_Q();
+
+	if (!isValidStateTransition(state, ChatMessage::State::Displayed))
+		return;
+
+	lInfo() << "Chat message " << this << ": moving from " << Utils::toString(state) <<
+		" to " << Utils::toString(ChatMessage::State::Displayed);
+	state = ChatMessage::State::Displayed;
+	notifyStateChanged();
+
+	static_cast<ChatRoomPrivate *>(q->getChatRoom()->getPrivate())->sendDisplayNotification(q->getSharedFromThis());
+}
+
+void ChatMessagePrivate::notifyStateChanged () {
+	L_Q();
+
+	LinphoneChatMessage *msg = L_GET_C_BACK_PTR(q);
+	if (linphone_chat_message_get_message_state_changed_cb(msg))
+		linphone_chat_message_get_message_state_changed_cb(msg)(
+			msg,
+			LinphoneChatMessageState(state),
+			linphone_chat_message_get_message_state_changed_cb_user_data(msg)
+		);
+
+	LinphoneChatMessageCbs *cbs = linphone_chat_message_get_callbacks(msg);
+	if (cbs && linphone_chat_message_cbs_get_msg_state_changed(cbs))
+		linphone_chat_message_cbs_get_msg_state_changed(cbs)(msg, (LinphoneChatMessageState)state);
+}
+
 // -----------------------------------------------------------------------------
 
 belle_http_request_t *ChatMessagePrivate::getHttpRequest () const {
@@ -336,7 +365,7 @@ const ContentType &ChatMessagePrivate::getContentType () const {
 void ChatMessagePrivate::setContentType (const ContentType &contentType) {
 	loadContentsFromDatabase();
 	if (contents.size() > 0 && internalContent.getContentType().isEmpty() && internalContent.isEmpty()) {
-		internalContent.setBody(contents.front()->getBody());
+		internalContent.shareBody(*contents.front());
 	}
 	internalContent.setContentType(contentType);
 
@@ -617,8 +646,11 @@ LinphoneReason ChatMessagePrivate::receive () {
 		return reason;
 	}
 
+	// Notifications are not counted as messages.
 	if ((getContentType() == ContentType::ImIsComposing) || (getContentType() == ContentType::Imdn))
 		toBeStored = false;
+	else
+		Metrics::get().chatMessagesReceived.increment();
 
 	chatRoom->getPrivate()->onChatMessageReceived(q->getSharedFromThis());
 
@@ -753,6 +785,17 @@ void ChatMessagePrivate::send () {
 		}
 	}
 
+	// Everything is ready, wait for our turn if the outgoing messages are being paced.
+	if (!sendScheduled) {
+		const unique_ptr<OutgoingMessageScheduler> &scheduler = core->getPrivate()->outgoingMessageScheduler;
+		if (scheduler && !scheduler->requestSend(q->getSharedFromThis(), sendPriority, toAddress.asString())) {
+			if (direction == ChatMessage::Direction::Outgoing)
+				setState(ChatMessage::State::InProgress);
+			return;
+		}
+	}
+	sendScheduled = false;
+
 	auto msgOp = dynamic_cast<SalMessageOpInterface *>(op);
 	if (!externalBodyUrl.empty()) {
 		Content content;
@@ -764,8 +807,22 @@ void ChatMessagePrivate::send () {
 	} else {
 		if (!internalContent.getContentType().isValid())
 			internalContent.setContentType(ContentType::PlainText);
-		if (!contentEncoding.empty())
-			internalContent.setContentEncoding(contentEncoding);
+		string encoding = contentEncoding;
+		// Conference servers handle deflate, plain peers may not: only offer it to group chat rooms.
+		if (
+			encoding.empty() &&
+			(q->getChatRoom()->getCapabilities() & ChatRoom::Capabilities::Conference) &&
+			lp_config_get_int(core->getCCore()->config, "sip", "deflate_chat_messages", 0)
+		)
+			encoding = "deflate";
+		if (!encoding.empty()) {
+			if (!linphone_core_content_encoding_supported(core->getCCore(), encoding.c_str()))
+				lWarning() << "Content encoding " << encoding << " is not supported, message [" << q << "] sent as is";
+			else if (linphone_core_should_apply_content_encoding(core->getCCore(), encoding.c_str(), internalContent.getSize()))
+				internalContent.setContentEncoding(encoding);
+			else
+				lInfo() << "Message [" << q << "] too small for content encoding " << encoding << ", sent as is";
+		}
 		msgOp->sendMessage(internalContent);
 	}
 
@@ -1108,12 +1165,16 @@ bool ChatMessage::downloadFile(FileTransferContent *fileTransferContent) {
 
 bool ChatMessage::isFileTransferInProgress () const {
 	L_D();
-	return d->fileTransferChatMessageModifier.isFileTransferInProgressAndValid();
+	return d->fileTransferChatMessageModifier.isFileTransferInProgressAndValid()
+		|| d->fileTransferChatMessageModifier.isFileTransferQueued();
 }
 
 void ChatMessage::cancelFileTransfer () {
 	L_D();
-	if (d->fileTransferChatMessageModifier.isFileTransferInProgressAndValid()) {
+	if (
+		d->fileTransferChatMessageModifier.isFileTransferInProgressAndValid()
+		|| d->fileTransferChatMessageModifier.isFileTransferQueued()
+	) {
 		if (d->state == State::InProgress) {
 			d->setState(State::NotDelivered);
 		}
@@ -1153,10 +1214,8 @@ int ChatMessage::putCharacter (uint32_t character) {
 			d->rttMessage = "";
 		}
 	} else {
-		char *value = LinphonePrivate::Utils::utf8ToChar(character);
-		d->rttMessage += string(value);
-		lDebug() << "Sent RTT character: " << value << "(" << (unsigned long)character << "), pending text is " << d->rttMessage;
-		delete[] value;
+		LinphonePrivate::Utils::appendUtf8(d->rttMessage, character);
+		lDebug() << "Sent RTT character: " << (unsigned long)character << ", pending text is " << d->rttMessage.size() << " bytes long";
 	}
 
 	text_stream_putchar32(
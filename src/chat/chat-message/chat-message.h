@@ -54,6 +54,7 @@ class LINPHONE_PUBLIC ChatMessage : public Object, public CoreAccessor {
 	friend class ImdnMessagePrivate;
 	friend class MainDb;
 	friend class MainDbPrivate;
+	friend class OutgoingMessageScheduler;
 	friend class RealTimeTextChatRoomPrivate;
 	friend class ServerGroupChatRoomPrivate;
 
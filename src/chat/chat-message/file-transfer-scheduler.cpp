@@ -0,0 +1,245 @@
+/*
+ * file-transfer-scheduler.cpp
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "linphone/utils/utils.h"
+
+#include "chat/modifier/file-transfer-chat-message-modifier.h"
+#include "core/core.h"
+#include "logger/logger.h"
+#include "utils/metrics.h"
+
+#include "file-transfer-scheduler.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+FileTransferScheduler::FileTransferScheduler (const shared_ptr<Core> &core) : CoreAccessor(core) {}
+
+// -----------------------------------------------------------------------------
+
+bool FileTransferScheduler::requestStart (FileTransferChatMessageModifier *modifier, Direction direction, const string &url) {
+	Entry entry{ modifier, getHost(url) };
+	// Queued transfers are only waiting for a limit: a transfer to another host starts if the limits allow it.
+	if (
+		!isHostQueued(entry.host) &&
+		canStart(entry.host, getMaxConcurrentTransfers(), getMaxConcurrentTransfersPerHost())
+	) {
+		start(entry);
+		notifyQueueChanged();
+		return true;
+	}
+
+	queues[static_cast<size_t>(direction)].push_back(entry);
+	lInfo() << "File transfer [" << modifier << "] to " << entry.host << " queued, " << running.size() <<
+		" running and " << getQueuedCount() << " waiting";
+	notifyQueueChanged();
+	return false;
+}
+
+void FileTransferScheduler::transferEnded (FileTransferChatMessageModifier *modifier) {
+	bool changed = false;
+	auto it = running.find(modifier);
+	if (it != running.end()) {
+		stop(it->second);
+		running.erase(it);
+		changed = true;
+	}
+	for (auto &queue : queues) {
+		auto queueIt = find_if(queue.begin(), queue.end(), [modifier](const Entry &entry) {
+			return entry.modifier == modifier;
+		});
+		if (queueIt != queue.end()) {
+			string host = queueIt->host;
+			queue.erase(queueIt);
+			changed = true;
+			auto hostIt = hosts.find(host);
+			if (hostIt != hosts.end() && hostIt->second.running == 0 && !isHostQueued(host))
+				hosts.erase(hostIt);
+		}
+	}
+
+	if (!changed)
+		return;
+
+	notifyQueueChanged();
+	processQueues();
+}
+
+void FileTransferScheduler::callRemoved () {
+	if (getQueuedCount() > 0)
+		processQueues();
+}
+
+void FileTransferScheduler::clear () {
+	for (auto &queue : queues)
+		queue.clear();
+	running.clear();
+	hosts.clear();
+}
+
+bool FileTransferScheduler::isQueued (const FileTransferChatMessageModifier *modifier) const {
+	for (const auto &queue : queues)
+		for (const auto &entry : queue)
+			if (entry.modifier == modifier)
+				return true;
+	return false;
+}
+
+size_t FileTransferScheduler::getQueuedCount () const {
+	size_t count = 0;
+	for (const auto &queue : queues)
+		count += queue.size();
+	return count;
+}
+
+// -----------------------------------------------------------------------------
+
+string FileTransferScheduler::getHost (const string &url) {
+	// Scheme, host and port: the key of the connections of the HTTP provider, with the default port of the scheme
+	// when the URL has none so that "https://host/" and "https://host:443/" are the same server.
+	size_t begin = url.find("://");
+	if (begin == string::npos)
+		return url;
+	string scheme = Utils::stringToLower(url.substr(0, begin));
+	begin += 3;
+	size_t end = url.find_first_of("/?#", begin);
+	string authority = url.substr(begin, end == string::npos ? string::npos : end - begin);
+	size_t userInfoEnd = authority.rfind('@');
+	if (userInfoEnd != string::npos)
+		authority.erase(0, userInfoEnd + 1);
+
+	// The port follows the last colon, unless it is part of an IPv6 address.
+	size_t portBegin = authority.rfind(':');
+	if (portBegin != string::npos && authority.find(']', portBegin) == string::npos)
+		return scheme + "://" + Utils::stringToLower(authority);
+
+	const char *defaultPort = scheme == "https" ? "443" : scheme == "http" ? "80" : nullptr;
+	if (!defaultPort)
+		return scheme + "://" + Utils::stringToLower(authority);
+	return scheme + "://" + Utils::stringToLower(authority) + ":" + defaultPort;
+}
+
+size_t FileTransferScheduler::getMaxConcurrentTransfers () const {
+	shared_ptr<Core> core = getCore();
+	LinphoneConfig *config = linphone_core_get_config(core->getCCore());
+	int maxTransfers = lp_config_get_int(config, "misc", "max_concurrent_file_transfers", 0);
+	if (core->getCallCount() > 0) {
+		int maxTransfersDuringCall = lp_config_get_int(
+			config, "misc", "max_concurrent_file_transfers_during_call", defaultMaxConcurrentTransfersDuringCall
+		);
+		if (maxTransfersDuringCall > 0 && (maxTransfers <= 0 || maxTransfersDuringCall < maxTransfers))
+			maxTransfers = maxTransfersDuringCall;
+	}
+	return maxTransfers > 0 ? static_cast<size_t>(maxTransfers) : 0;
+}
+
+size_t FileTransferScheduler::getMaxConcurrentTransfersPerHost () const {
+	int maxTransfers = lp_config_get_int(
+		linphone_core_get_config(getCore()->getCCore()), "misc", "max_concurrent_file_transfers_per_host",
+		defaultMaxConcurrentTransfersPerHost
+	);
+	return maxTransfers > 0 ? static_cast<size_t>(maxTransfers) : 0;
+}
+
+bool FileTransferScheduler::canStart (const string &host, size_t maxTransfers, size_t maxTransfersPerHost) const {
+	if (maxTransfers > 0 && running.size() >= maxTransfers)
+		return false;
+	if (maxTransfersPerHost == 0)
+		return true;
+	auto it = hosts.find(host);
+	return it == hosts.end() || it->second.running < maxTransfersPerHost;
+}
+
+bool FileTransferScheduler::isHostQueued (const string &host) const {
+	for (const auto &queue : queues)
+		for (const auto &entry : queue)
+			if (entry.host == host)
+				return true;
+	return false;
+}
+
+void FileTransferScheduler::start (const Entry &entry) {
+	running[entry.modifier] = entry.host;
+	HostStats &stats = hosts[entry.host];
+	stats.running++;
+	stats.transfers++;
+	Metrics::get().fileTransfersStarted.increment();
+	if (stats.running > stats.maxRunning) {
+		stats.maxRunning = stats.running;
+		Metrics::get().fileTransferConnections.increment();
+	}
+}
+
+void FileTransferScheduler::stop (const string &host) {
+	auto it = hosts.find(host);
+	if (it == hosts.end())
+		return;
+
+	// Kept while transfers to the host are waiting: they may reuse the connection left idle.
+	HostStats &stats = it->second;
+	if (--stats.running > 0 || isHostQueued(host))
+		return;
+
+	lInfo() << "File transfer server " << host << ": " << stats.transfers << " transfer(s), at most " <<
+		stats.maxRunning << " at once";
+	hosts.erase(it);
+}
+
+void FileTransferScheduler::processQueues () {
+	size_t maxTransfers = getMaxConcurrentTransfers();
+	size_t maxTransfersPerHost = getMaxConcurrentTransfersPerHost();
+
+	// Pick the transfers first: starting them may end them right away.
+	// A transfer waiting for its host does not hold back the ones to other hosts.
+	vector<FileTransferChatMessageModifier *> ready;
+	for (auto &queue : queues) {
+		for (auto it = queue.begin(); it != queue.end() && (maxTransfers == 0 || running.size() < maxTransfers);) {
+			if (!canStart(it->host, maxTransfers, maxTransfersPerHost)) {
+				it++;
+				continue;
+			}
+			start(*it);
+			ready.push_back(it->modifier);
+			it = queue.erase(it);
+		}
+	}
+
+	if (ready.empty())
+		return;
+
+	notifyQueueChanged();
+	for (FileTransferChatMessageModifier *modifier : ready) {
+		lInfo() << "Starting queued file transfer [" << modifier << "]";
+		modifier->startScheduledTransfer();
+	}
+}
+
+void FileTransferScheduler::notifyQueueChanged () {
+	linphone_core_notify_file_transfer_queue_changed(
+		getCore()->getCCore(), static_cast<int>(running.size()), static_cast<int>(getQueuedCount())
+	);
+}
+
+LINPHONE_END_NAMESPACE
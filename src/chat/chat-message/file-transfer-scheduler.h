@@ -0,0 +1,105 @@
+/*
+ * file-transfer-scheduler.h
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _L_FILE_TRANSFER_SCHEDULER_H_
+#define _L_FILE_TRANSFER_SCHEDULER_H_
+
+#include <array>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "core/core-accessor.h"
+
+// TODO: Remove me later.
+#include "private.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+class FileTransferChatMessageModifier;
+
+// Limits the number of HTTP file transfers running at the same time. Limits are read from the [misc] section:
+// max_concurrent_file_transfers (0 means unlimited) and max_concurrent_file_transfers_during_call, used while
+// there is a call so that transfers do not starve its media streams (1 by default, 0 to apply the former limit).
+// Downloads are started before uploads.
+// max_concurrent_file_transfers_per_host (0 by default, unlimited) bounds the transfers running against a single file
+// server: the HTTP provider reuses an idle connection to the same host, so a transfer waiting for one of these slots may
+// avoid a new handshake.
+class FileTransferScheduler : public CoreAccessor {
+public:
+	enum class Direction {
+		Download,
+		Upload
+	};
+
+	FileTransferScheduler (const std::shared_ptr<Core> &core);
+
+	// Returns true if the transfer can start right away, otherwise it is queued and
+	// FileTransferChatMessageModifier::startScheduledTransfer is called later on.
+	bool requestStart (FileTransferChatMessageModifier *modifier, Direction direction, const std::string &url);
+	// Must be called when a transfer is over, cancelled, or its modifier destroyed.
+	void transferEnded (FileTransferChatMessageModifier *modifier);
+	// Must be called when a call is removed from the core, as it may lift the limit applied during calls.
+	void callRemoved ();
+
+	void clear ();
+	bool isQueued (const FileTransferChatMessageModifier *modifier) const;
+	size_t getRunningCount () const { return running.size(); }
+	size_t getQueuedCount () const;
+
+private:
+	struct Entry {
+		FileTransferChatMessageModifier *modifier;
+		std::string host;
+	};
+
+	// Kept while transfers run against the host, and logged once the last one ends.
+	struct HostStats {
+		size_t running = 0;
+		// Transfers started, and the highest number of them running at once: each new peak may need a new connection.
+		unsigned int transfers = 0;
+		size_t maxRunning = 0;
+	};
+
+	static const int defaultMaxConcurrentTransfersDuringCall = 1;
+	static const int defaultMaxConcurrentTransfersPerHost = 0;
+
+	static std::string getHost (const std::string &url);
+
+	size_t getMaxConcurrentTransfers () const;
+	size_t getMaxConcurrentTransfersPerHost () const;
+	bool canStart (const std::string &host, size_t maxTransfers, size_t maxTransfersPerHost) const;
+	bool isHostQueued (const std::string &host) const;
+	void start (const Entry &entry);
+	void stop (const std::string &host);
+	void processQueues ();
+	void notifyQueueChanged ();
+
+	std::array<std::deque<Entry>, 2> queues;
+	std::unordered_map<FileTransferChatMessageModifier *, std::string> running;
+	std::unordered_map<std::string, HostStats> hosts;
+
+	L_DISABLE_COPY(FileTransferScheduler);
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_FILE_TRANSFER_SCHEDULER_H_
@@ -40,9 +40,8 @@ void ImdnMessagePrivate::setState (ChatMessage::State newState) {
 		for (const auto &message : context.displayedMessages)
 			message->getPrivate()->updateInDb();
 		static_pointer_cast<ChatRoom>(context.chatRoom)->getPrivate()->getImdnHandler()->onImdnMessageDelivered(q->getSharedFromThis());
-	} else if (newState == ChatMessage::State::NotDelivered) {
-		// TODO: Maybe we should retry sending the IMDN message if we get an error here
-	}
+	} else if (newState == ChatMessage::State::NotDelivered)
+		static_pointer_cast<ChatRoom>(context.chatRoom)->getPrivate()->getImdnHandler()->onImdnMessageNotDelivered(q->getSharedFromThis());
 }
 
 // -----------------------------------------------------------------------------
@@ -63,6 +62,8 @@ ImdnMessage::ImdnMessage (const std::shared_ptr<ImdnMessage> &message) : ImdnMes
 ImdnMessage::ImdnMessage (const Context &context) : NotificationMessage(*new ImdnMessagePrivate(context)) {
 	L_D();
 
+	d->sendPriority = OutgoingMessageScheduler::Priority::Notification;
+
 	for (const auto &message : d->context.deliveredMessages) {
 		Content *content = new Content();
 		content->setContentDisposition(ContentDisposition::Notification);
@@ -41,6 +41,7 @@ IsComposingMessage::IsComposingMessage (
 	addContent(content);
 	d->addSalCustomHeader(PriorityHeader::HeaderName, PriorityHeader::NonUrgent);
 	d->addSalCustomHeader("Expires", "0");
+	d->sendPriority = OutgoingMessageScheduler::Priority::IsComposing;
 }
 
 LINPHONE_END_NAMESPACE
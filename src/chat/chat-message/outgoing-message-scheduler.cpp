@@ -0,0 +1,261 @@
+/*
+ * outgoing-message-scheduler.cpp
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "chat/chat-message/chat-message-p.h"
+#include "core/core.h"
+#include "logger/logger.h"
+
+#include "outgoing-message-scheduler.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+namespace {
+	// Tokens are counted in thousandths so that a rate in messages per second is also the refill per millisecond.
+	constexpr uint64_t TokenUnit = 1000;
+
+	unsigned int getRate (LinphoneCore *lc, const char *key) {
+		int rate = lp_config_get_int(linphone_core_get_config(lc), "sip", key, 0);
+		return rate < 0 ? 0 : static_cast<unsigned int>(rate);
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+OutgoingMessageScheduler::OutgoingMessageScheduler (const shared_ptr<Core> &core) : CoreAccessor(core) {
+	LinphoneCore *lc = core->getCCore();
+	globalRate = getRate(lc, "outgoing_message_rate");
+	destinationRate = getRate(lc, "outgoing_message_rate_per_destination");
+	congestionThreshold = lp_config_get_int(
+		linphone_core_get_config(lc), "sip", "outgoing_message_congestion_threshold", defaultCongestionThreshold
+	);
+}
+
+OutgoingMessageScheduler::~OutgoingMessageScheduler () {
+	stopTimer();
+}
+
+// -----------------------------------------------------------------------------
+
+bool OutgoingMessageScheduler::requestSend (const shared_ptr<ChatMessage> &message, Priority priority, const string &destination) {
+	// A message sent again while it is still waiting keeps its place.
+	if (queuedMessages.count(message.get()) > 0)
+		return false;
+
+	// Do not overtake messages of the same or a higher priority that are already waiting.
+	size_t index = static_cast<size_t>(priority);
+	bool waiting = false;
+	for (size_t i = 0; i <= index; i++)
+		waiting |= !queues[i].empty();
+
+	if (!waiting && ((globalRate == 0 && destinationRate == 0) || consumeTokens(destination, ms_get_cur_time_ms())))
+		return true;
+
+	queues[index].push_back({ message, destination });
+	queuedMessages.insert(message.get());
+	lInfo() << "Outgoing message [" << message << "] to " << destination << " delayed, " << getQueueSize() << " message(s) waiting";
+	updateCongestion();
+	startTimer();
+	return false;
+}
+
+void OutgoingMessageScheduler::clear () {
+	size_t size = getQueueSize();
+	if (size > 0)
+		lWarning() << "Dropping " << size << " outgoing message(s) that were waiting to be sent";
+
+	vector<shared_ptr<ChatMessage>> dropped;
+	for (auto &queue : queues) {
+		for (auto &entry : queue)
+			dropped.push_back(move(entry.message));
+		queue.clear();
+	}
+	queuedMessages.clear();
+	destinationBuckets.clear();
+	stopTimer();
+	updateCongestion();
+	dropMessages(dropped);
+}
+
+size_t OutgoingMessageScheduler::getQueueSize () const {
+	size_t size = 0;
+	for (const auto &queue : queues)
+		size += queue.size();
+	return size;
+}
+
+// -----------------------------------------------------------------------------
+
+bool OutgoingMessageScheduler::consumeTokens (const string &destination, uint64_t now) {
+	if (globalRate > 0) {
+		refill(globalBucket, globalRate, now);
+		if (globalBucket.tokens < TokenUnit)
+			return false;
+	}
+
+	Bucket *destinationBucket = nullptr;
+	if (destinationRate > 0) {
+		auto it = destinationBuckets.find(destination);
+		if (it == destinationBuckets.end()) {
+			// No bucket means a full one.
+			it = destinationBuckets.emplace(destination, Bucket()).first;
+		}
+		destinationBucket = &it->second;
+		refill(*destinationBucket, destinationRate, now);
+		if (destinationBucket->tokens < TokenUnit)
+			return false;
+	}
+
+	if (globalRate > 0)
+		globalBucket.tokens -= TokenUnit;
+	if (destinationBucket)
+		destinationBucket->tokens -= TokenUnit;
+	return true;
+}
+
+void OutgoingMessageScheduler::dropMessages (const vector<shared_ptr<ChatMessage>> &messages) {
+	for (const auto &message : messages) {
+		ChatMessagePrivate *dMessage = message->getPrivate();
+		if (message->getChatRoom()) {
+			dMessage->setState(ChatMessage::State::NotDelivered);
+			continue;
+		}
+
+		// Its chat room is gone along with its events: only tell the application.
+		if (!ChatMessagePrivate::isValidStateTransition(dMessage->state, ChatMessage::State::NotDelivered))
+			continue;
+		dMessage->state = ChatMessage::State::NotDelivered;
+		dMessage->notifyStateChanged();
+	}
+}
+
+void OutgoingMessageScheduler::processQueues () {
+	uint64_t now = ms_get_cur_time_ms();
+
+	// Buckets that are full again carry no information.
+	for (auto it = destinationBuckets.begin(); it != destinationBuckets.end();) {
+		refill(it->second, destinationRate, now);
+		if ((destinationRate == 0) || (it->second.tokens >= destinationRate * TokenUnit))
+			it = destinationBuckets.erase(it);
+		else
+			it++;
+	}
+
+	// Pick the messages first: sending them may lead to new requests.
+	vector<Entry> ready;
+	vector<shared_ptr<ChatMessage>> dropped;
+	bool globalLimitReached = false;
+	for (auto &queue : queues) {
+		for (auto it = queue.begin(); !globalLimitReached && (it != queue.end());) {
+			if (!it->message->getChatRoom()) {
+				queuedMessages.erase(it->message.get());
+				dropped.push_back(move(it->message));
+				it = queue.erase(it);
+				continue;
+			}
+			if (consumeTokens(it->destination, now)) {
+				queuedMessages.erase(it->message.get());
+				ready.push_back(move(*it));
+				it = queue.erase(it);
+				continue;
+			}
+			globalLimitReached = (globalRate > 0) && (globalBucket.tokens < TokenUnit);
+			it++;
+		}
+	}
+
+	updateCongestion();
+	if (getQueueSize() > 0)
+		startTimer();
+
+	dropMessages(dropped);
+	for (const auto &entry : ready) {
+		ChatMessagePrivate *dMessage = entry.message->getPrivate();
+		dMessage->sendScheduled = true;
+		dMessage->send();
+	}
+}
+
+void OutgoingMessageScheduler::refill (Bucket &bucket, unsigned int rate, uint64_t now) const {
+	uint64_t capacity = max(rate, 1u) * TokenUnit;
+	if (bucket.lastRefillTime == 0)
+		bucket.tokens = capacity;
+	else if (now > bucket.lastRefillTime)
+		bucket.tokens = min(capacity, bucket.tokens + (now - bucket.lastRefillTime) * rate);
+	bucket.lastRefillTime = now;
+}
+
+void OutgoingMessageScheduler::startTimer () {
+	if (timer)
+		return;
+
+	// Wait for one token of the fastest configured rate.
+	unsigned int rate = max(globalRate, destinationRate);
+	unsigned int delay = rate > 0 ? max(1000u / rate, 10u) : 10u;
+	timer = getCore()->getCCore()->sal->createTimer(timerExpired, this, delay, "outgoing message scheduler");
+}
+
+void OutgoingMessageScheduler::stopTimer () {
+	if (!timer)
+		return;
+
+	try {
+		LinphoneCore *lc = getCore()->getCCore();
+		if (lc->sal)
+			lc->sal->cancelTimer(timer);
+	} catch (const bad_weak_ptr &) {
+		// Core is destroyed along with its main loop.
+	}
+	belle_sip_object_unref(timer);
+	timer = nullptr;
+}
+
+void OutgoingMessageScheduler::updateCongestion () {
+	int threshold = congestionThreshold;
+	size_t size = getQueueSize();
+	bool newCongested = congested;
+	if (threshold <= 0)
+		newCongested = false;
+	else if (size >= static_cast<size_t>(threshold))
+		newCongested = true;
+	else if (size <= static_cast<size_t>(threshold) / 2)
+		newCongested = false;
+
+	if (newCongested == congested)
+		return;
+
+	congested = newCongested;
+	lInfo() << "Outgoing message queue " << (congested ? "congested" : "no longer congested") << " with " << size << " message(s) waiting";
+	linphone_core_notify_outgoing_message_queue_congestion_changed(getCore()->getCCore(), congested);
+}
+
+int OutgoingMessageScheduler::timerExpired (void *data, unsigned int revents) {
+	OutgoingMessageScheduler *scheduler = static_cast<OutgoingMessageScheduler *>(data);
+	scheduler->stopTimer();
+	scheduler->processQueues();
+	return BELLE_SIP_STOP;
+}
+
+LINPHONE_END_NAMESPACE
@@ -0,0 +1,101 @@
+/*
+ * outgoing-message-scheduler.h
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _L_OUTGOING_MESSAGE_SCHEDULER_H_
+#define _L_OUTGOING_MESSAGE_SCHEDULER_H_
+
+#include <array>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "core/core-accessor.h"
+
+// TODO: Remove me later.
+#include "private.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+class ChatMessage;
+
+// Paces the SIP MESSAGE requests sent by a core. Rates are read from the [sip] section when the core starts:
+// outgoing_message_rate and outgoing_message_rate_per_destination (messages per second, 0 means unlimited).
+// When a rate is exceeded, messages are queued and sent by priority, in order for a given priority.
+// Queued messages that cannot be sent anymore (chat room gone, core stopped) are set NotDelivered.
+class OutgoingMessageScheduler : public CoreAccessor {
+public:
+	enum class Priority {
+		Message,
+		Notification,
+		IsComposing
+	};
+
+	OutgoingMessageScheduler (const std::shared_ptr<Core> &core);
+	~OutgoingMessageScheduler ();
+
+	// Returns true if the message can be sent right away, otherwise it is queued and sent later on.
+	bool requestSend (const std::shared_ptr<ChatMessage> &message, Priority priority, const std::string &destination);
+
+	void clear ();
+	size_t getQueueSize () const;
+	bool isCongested () const { return congested; }
+
+private:
+	struct Bucket {
+		uint64_t tokens = 0;
+		uint64_t lastRefillTime = 0;
+	};
+
+	struct Entry {
+		std::shared_ptr<ChatMessage> message;
+		std::string destination;
+	};
+
+	static const int defaultCongestionThreshold = 100;
+
+	bool consumeTokens (const std::string &destination, uint64_t now);
+	void dropMessages (const std::vector<std::shared_ptr<ChatMessage>> &messages);
+	void processQueues ();
+	void refill (Bucket &bucket, unsigned int rate, uint64_t now) const;
+	void startTimer ();
+	void stopTimer ();
+	void updateCongestion ();
+
+	static int timerExpired (void *data, unsigned int revents);
+
+	std::array<std::deque<Entry>, 3> queues;
+	Bucket globalBucket;
+	std::unordered_map<std::string, Bucket> destinationBuckets;
+	std::unordered_set<const ChatMessage *> queuedMessages;
+	unsigned int globalRate = 0;
+	unsigned int destinationRate = 0;
+	int congestionThreshold = defaultCongestionThreshold;
+	belle_sip_source_t *timer = nullptr;
+	bool congested = false;
+
+	L_DISABLE_COPY(OutgoingMessageScheduler);
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_OUTGOING_MESSAGE_SCHEDULER_H_
@@ -31,6 +31,9 @@ class ChatRoomIdPrivate : public ClonableObjectPrivate {
 public:
 	IdentityAddress peerAddress;
 	IdentityAddress localAddress;
+
+	mutable size_t hash = 0;
+	mutable bool hashComputed = false;
 };
 
 // -----------------------------------------------------------------------------
@@ -51,6 +54,10 @@ L_USE_DEFAULT_CLONABLE_OBJECT_SHARED_IMPL(ChatRoomId);
 bool ChatRoomId::operator== (const ChatRoomId &other) const {
 	L_D();
 	const ChatRoomIdPrivate *dChatRoomId = other.getPrivate();
+	if (d == dChatRoomId)
+		return true;
+	if (d->hashComputed && dChatRoomId->hashComputed && d->hash != dChatRoomId->hash)
+		return false;
 	return d->peerAddress == dChatRoomId->peerAddress && d->localAddress == dChatRoomId->localAddress;
 }
 
@@ -80,4 +87,15 @@ bool ChatRoomId::isValid () const {
 	return d->peerAddress.isValid() && d->localAddress.isValid();
 }
 
+size_t ChatRoomId::getHash () const {
+	L_D();
+	if (!d->hashComputed) {
+		d->hash = isValid()
+			? std::hash<string>()(d->peerAddress.asString()) ^ (std::hash<string>()(d->localAddress.asString()) << 1)
+			: size_t(-1);
+		d->hashComputed = true;
+	}
+	return d->hash;
+}
+
 LINPHONE_END_NAMESPACE
@@ -50,6 +50,9 @@ public:
 
 	bool isValid () const;
 
+	// Computed once and shared by all copies, ChatRoomId is immutable: the addresses must never be modified in place.
+	std::size_t getHash () const;
+
 private:
 	L_DECLARE_PRIVATE(ChatRoomId);
 };
@@ -66,9 +69,7 @@ namespace std {
 	template<>
 	struct hash<LinphonePrivate::ChatRoomId> {
 		std::size_t operator() (const LinphonePrivate::ChatRoomId &chatRoomId) const {
-			if (!chatRoomId.isValid()) return std::size_t(-1);
-			return hash<string>()(chatRoomId.getPeerAddress().asString()) ^
-				(hash<string>()(chatRoomId.getLocalAddress().asString()) << 1);
+			return chatRoomId.getHash();
 		}
 	};
 }
@@ -50,7 +50,7 @@ public:
 	void setState (ChatRoom::State newState) override;
 
 	void sendChatMessage (const std::shared_ptr<ChatMessage> &chatMessage) override;
-	void sendIsComposingNotification ();
+	void sendIsComposingNotification (bool isRefresh = false);
 
 	void addEvent (const std::shared_ptr<EventLog> &eventLog) override;
 
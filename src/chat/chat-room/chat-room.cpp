@@ -28,6 +28,7 @@
 #include "chat/chat-message/notification-message-p.h"
 #include "chat/chat-room/chat-room-p.h"
 #include "core/core-p.h"
+#include "event-log/events.h"
 #include "logger/logger.h"
 
 // =============================================================================
@@ -70,16 +71,21 @@ void ChatRoomPrivate::sendChatMessage (const shared_ptr<ChatMessage> &chatMessag
 		isComposing = false;
 	isComposingHandler->stopIdleTimer();
 	isComposingHandler->stopRefreshTimer();
+	isComposingHandler->resetSentState();
 }
 
-void ChatRoomPrivate::sendIsComposingNotification () {
+void ChatRoomPrivate::sendIsComposingNotification (bool isRefresh) {
 	L_Q();
 	LinphoneImNotifPolicy *policy = linphone_core_get_im_notif_policy(q->getCore()->getCCore());
 	if (!linphone_im_notif_policy_get_send_is_composing(policy))
 		return;
 
+	if (!isComposingHandler->canSendNotification(isComposing, isRefresh))
+		return;
+
 	auto isComposingMsg = createIsComposingMessage();
 	isComposingMsg->getPrivate()->send();
+	isComposingHandler->notificationSent(isComposing);
 }
 
 // -----------------------------------------------------------------------------
@@ -322,7 +328,7 @@ void ChatRoomPrivate::onIsComposingReceived (const Address &remoteAddress, const
 }
 
 void ChatRoomPrivate::onIsComposingRefreshNeeded () {
-	sendIsComposingNotification();
+	sendIsComposingNotification(true);
 }
 
 void ChatRoomPrivate::onIsComposingStateChanged (bool isComposing) {
@@ -516,10 +522,30 @@ void ChatRoom::markAsRead () {
 	L_D();
 
 	CorePrivate *dCore = getCore()->getPrivate();
-	for (auto &chatMessage : dCore->mainDb->getUnreadChatMessages(d->chatRoomId))
-		chatMessage->getPrivate()->setState(ChatMessage::State::Displayed);
+	if (dCore->mainDb->getUnreadChatMessageCount(d->chatRoomId) == 0)
+		return;
 
+	// The database is updated for the whole chat room in one statement, only the messages living in memory
+	// or waiting for a display notification are handled one by one.
+	LinphoneImNotifPolicy *policy = linphone_core_get_im_notif_policy(getCore()->getCCore());
+	list<shared_ptr<ChatMessage>> chatMessages = dCore->mainDb->getChatMessagesToMarkAsRead(
+		d->chatRoomId,
+		!!linphone_im_notif_policy_get_send_imdn_displayed(policy)
+	);
 	dCore->mainDb->markChatMessagesAsRead(d->chatRoomId);
+
+	for (auto &chatMessage : chatMessages)
+		chatMessage->getPrivate()->markAsRead();
+
+	// Read incoming messages without pending download do not need to be kept, as in ChatMessagePrivate::updateInDb.
+	d->transientEvents.remove_if([](const shared_ptr<EventLog> &eventLog) {
+		if (eventLog->getType() != EventLog::Type::ConferenceChatMessage)
+			return false;
+		shared_ptr<ChatMessage> chatMessage = static_pointer_cast<ConferenceChatMessageEvent>(eventLog)->getChatMessage();
+		return chatMessage->getDirection() == ChatMessage::Direction::Incoming &&
+			chatMessage->getState() == ChatMessage::State::Displayed &&
+			!chatMessage->getPrivate()->hasFileTransferContent();
+	});
 }
 
 LINPHONE_END_NAMESPACE
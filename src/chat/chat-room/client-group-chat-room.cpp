@@ -412,7 +412,7 @@ void ClientGroupChatRoom::addParticipants (
 		content.setBody(getResourceLists(addressesList));
 		content.setContentType(ContentType::ResourceLists);
 		content.setContentDisposition(ContentDisposition::RecipientList);
-		if (linphone_core_content_encoding_supported(getCore()->getCCore(), "deflate"))
+		if (linphone_core_should_apply_content_encoding(getCore()->getCCore(), "deflate", content.getSize()))
 			content.setContentEncoding("deflate");
 
 		auto session = d->createSession();
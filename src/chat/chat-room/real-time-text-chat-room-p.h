@@ -29,17 +29,17 @@ LINPHONE_BEGIN_NAMESPACE
 
 class RealTimeTextChatRoomPrivate : public BasicChatRoomPrivate {
 public:
-	struct Character {
-		uint32_t value;
-		bool hasBeenRead;
-	};
-
-	void realtimeTextReceived (uint32_t character, const std::shared_ptr<Call> &call);
+	// Called for each character received by the text stream of the call, so real time text is enabled.
+	void realtimeTextReceived (uint32_t character);
 	void sendChatMessage (const std::shared_ptr<ChatMessage> &chatMessage) override;
 	void setCall (const std::shared_ptr<Call> &value) { call = value; }
 
 	std::weak_ptr<Call> call;
-	std::list<Character> receivedRttCharacters;
+	// Characters of the current line, contiguous, and how many of them getChar has returned. The storage is
+	// reused once they have all been read. The line itself is kept encoded in UTF-8 until it is complete.
+	mutable std::vector<uint32_t> receivedRttCharacters;
+	mutable size_t readRttCharactersCount = 0;
+	std::string pendingText;
 	std::shared_ptr<ChatMessage> pendingMessage = nullptr;
 
 private:
@@ -33,7 +33,7 @@ LINPHONE_BEGIN_NAMESPACE
 
 // -----------------------------------------------------------------------------
 
-void RealTimeTextChatRoomPrivate::realtimeTextReceived (uint32_t character, const shared_ptr<Call> &call) {
+void RealTimeTextChatRoomPrivate::realtimeTextReceived (uint32_t character) {
 	L_Q();
 	const uint32_t new_line = 0x2028;
 	const uint32_t crlf = 0x0D0A;
@@ -42,45 +42,40 @@ void RealTimeTextChatRoomPrivate::realtimeTextReceived (uint32_t character, cons
 	shared_ptr<Core> core = q->getCore();
 	LinphoneCore *cCore = core->getCCore();
 
-	if (call && call->getCurrentParams()->realtimeTextEnabled()) {
-		if (!pendingMessage) {
-			pendingMessage = q->createChatMessage();
-			pendingMessage->getPrivate()->setDirection(ChatMessage::Direction::Incoming);
-			Content *content = new Content();
-			content->setContentType(ContentType::PlainText);
-			pendingMessage->addContent(content);
-		}
-
-		Character cmc;
-		cmc.value = character;
-		cmc.hasBeenRead = false;
-		receivedRttCharacters.push_back(cmc);
-
-		remoteIsComposing.push_back(q->getPeerAddress());
-		linphone_core_notify_is_composing_received(cCore, getCChatRoom());
-
-		if ((character == new_line) || (character == crlf) || (character == lf)) {
-			// End of message
-			auto content = pendingMessage->getContents().front();
-			lDebug() << "New line received, forge a message with content " << content->getBodyAsString();
-			pendingMessage->getPrivate()->setState(ChatMessage::State::Delivered);
-			pendingMessage->getPrivate()->setTime(::ms_time(0));
-
-			if (lp_config_get_int(linphone_core_get_config(cCore), "misc", "store_rtt_messages", 1) == 1)
-				pendingMessage->setToBeStored(true);
-			else
-				pendingMessage->setToBeStored(false);
-
-			onChatMessageReceived(pendingMessage);
-			pendingMessage = nullptr;
-			receivedRttCharacters.clear();
-		} else {
-			char *value = Utils::utf8ToChar(character);
-			auto content = pendingMessage->getContents().front();
-			content->setBody(content->getBodyAsString() + string(value));
-			lDebug() << "Received RTT character: " << value << " (" << character << "), pending text is " << content->getBodyAsString();
-			delete[] value;
-		}
+	if (!pendingMessage) {
+		pendingMessage = q->createChatMessage();
+		pendingMessage->getPrivate()->setDirection(ChatMessage::Direction::Incoming);
+		Content *content = new Content();
+		content->setContentType(ContentType::PlainText);
+		pendingMessage->addContent(content);
+	}
+
+	receivedRttCharacters.push_back(character);
+
+	remoteIsComposing.push_back(q->getPeerAddress());
+	linphone_core_notify_is_composing_received(cCore, getCChatRoom());
+
+	if ((character == new_line) || (character == crlf) || (character == lf)) {
+		// End of message
+		auto content = pendingMessage->getContents().front();
+		content->setBody(pendingText);
+		lDebug() << "New line received, forge a message with content " << content->getBodyAsString();
+		pendingMessage->getPrivate()->setState(ChatMessage::State::Delivered);
+		pendingMessage->getPrivate()->setTime(::ms_time(0));
+
+		if (lp_config_get_int(linphone_core_get_config(cCore), "misc", "store_rtt_messages", 1) == 1)
+			pendingMessage->setToBeStored(true);
+		else
+			pendingMessage->setToBeStored(false);
+
+		onChatMessageReceived(pendingMessage);
+		pendingMessage = nullptr;
+		pendingText.clear();
+		receivedRttCharacters.clear();
+		readRttCharactersCount = 0;
+	} else {
+		Utils::appendUtf8(pendingText, character);
+		lDebug() << "Received RTT character: " << character << ", pending text is " << pendingText.size() << " bytes long";
 	}
 }
 
@@ -114,13 +109,15 @@ RealTimeTextChatRoom::CapabilitiesMask RealTimeTextChatRoom::getCapabilities ()
 
 uint32_t RealTimeTextChatRoom::getChar () const {
 	L_D();
-	for (const auto &cmc : d->receivedRttCharacters) {
-		if (!cmc.hasBeenRead) {
-			const_cast<RealTimeTextChatRoomPrivate::Character *>(&cmc)->hasBeenRead = true;
-			return cmc.value;
-		}
+	if (d->readRttCharactersCount >= d->receivedRttCharacters.size())
+		return 0;
+
+	uint32_t character = d->receivedRttCharacters[d->readRttCharactersCount++];
+	if (d->readRttCharactersCount == d->receivedRttCharacters.size()) {
+		d->receivedRttCharacters.clear();
+		d->readRttCharactersCount = 0;
 	}
-	return 0;
+	return character;
 }
 
 // -----------------------------------------------------------------------------
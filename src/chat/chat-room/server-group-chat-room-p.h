@@ -88,18 +88,31 @@ private:
 		SalCustomHeader *customHeaders = nullptr;
 	};
 
+	// Last is-composing notification forwarded for a sender device, and the one waiting for the next flush.
+	struct IsComposingForward {
+		std::shared_ptr<Message> pendingMessage;
+		uint64_t lastForwardTime = 0;
+		bool lastForwardedActive = false;
+		bool pendingActive = false;
+	};
+
 	static void copyMessageHeaders (const std::shared_ptr<Message> &fromMessage, const std::shared_ptr<ChatMessage> &toMessage);
+	static int isComposingTimerExpired (void *data, unsigned int revents);
 
 	void addParticipantDevice (const std::shared_ptr<Participant> &participant, const IdentityAddress &deviceAddress);
 	void byeDevice (const std::shared_ptr<ParticipantDevice> &device);
 	void designateAdmin ();
 	void dispatchMessage (const std::shared_ptr<Message> &message, const std::string &uri);
 	void finalizeCreation ();
+	void flushIsComposingMessages ();
+	void loadIsComposingAggregationPeriod ();
+	bool handleIsComposingMessage (const std::shared_ptr<Message> &message);
 	void inviteDevice (const std::shared_ptr<ParticipantDevice> &device);
 	bool isAdminLeft () const;
 	void queueMessage (const std::shared_ptr<Message> &message);
 	void queueMessage (const std::shared_ptr<Message> &msg, const IdentityAddress &deviceAddress);
 	void removeParticipantDevice (const std::shared_ptr<Participant> &participant, const IdentityAddress &deviceAddress);
+	void stopIsComposingTimer ();
 
 	void onParticipantDeviceLeft (const std::shared_ptr<ParticipantDevice> &device);
 
@@ -122,6 +135,13 @@ private:
 	bool joiningPendingAfterCreation = false;
 	std::unordered_map<std::string, std::queue<std::shared_ptr<Message>>> queuedMessages;
 
+	std::unordered_map<std::string, IsComposingForward> isComposingForwards;
+	belle_sip_source_t *isComposingTimer = nullptr;
+	unsigned int isComposingAggregationPeriod = 0;
+	unsigned int isComposingReceivedCount = 0;
+	unsigned int isComposingForwardedCount = 0;
+	unsigned int isComposingSuppressedCount = 0;
+
 	L_DECLARE_PUBLIC(ServerGroupChatRoom);
 };
 
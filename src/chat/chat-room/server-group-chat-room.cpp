@@ -25,6 +25,7 @@
 #include "c-wrapper/c-wrapper.h"
 #include "c-wrapper/internal/c-tools.h"
 #include "chat/chat-message/chat-message-p.h"
+#include "chat/cpim/cpim.h"
 #include "chat/modifier/cpim-chat-message-modifier.h"
 #include "conference/handlers/local-conference-event-handler.h"
 #include "conference/handlers/local-conference-list-event-handler.h"
@@ -47,6 +48,46 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
+namespace {
+	enum class IsComposingState {
+		Unknown,
+		Idle,
+		Active
+	};
+
+	// Peek at the state of a cleartext is-composing notification without building the xsd tree.
+	// Ciphered messages cannot be inspected and are reported as Unknown.
+	IsComposingState getIsComposingState (const Content &content) {
+		string xml;
+		if (content.getContentType() == ContentType::ImIsComposing)
+			xml = content.getBodyAsUtf8String();
+		else if (content.getContentType() == ContentType::Cpim) {
+			shared_ptr<const Cpim::Message> cpimMessage = Cpim::Message::createFromString(content.getBodyAsUtf8String());
+			if (!cpimMessage)
+				return IsComposingState::Unknown;
+			auto contentTypeHeader = cpimMessage->getContentHeader("Content-Type");
+			if (!contentTypeHeader || (ContentType(contentTypeHeader->getValue()) != ContentType::ImIsComposing))
+				return IsComposingState::Unknown;
+			xml = cpimMessage->getContent();
+		} else
+			return IsComposingState::Unknown;
+
+		size_t pos = xml.find("state>");
+		if (pos == string::npos)
+			return IsComposingState::Unknown;
+		pos = xml.find_first_not_of(" \t\r\n", pos + 6);
+		if (pos == string::npos)
+			return IsComposingState::Unknown;
+		if (xml.compare(pos, 6, "active") == 0)
+			return IsComposingState::Active;
+		if (xml.compare(pos, 4, "idle") == 0)
+			return IsComposingState::Idle;
+		return IsComposingState::Unknown;
+	}
+}
+
+// -----------------------------------------------------------------------------
+
 #define CALL_CHAT_ROOM_CBS(cr, cbName, functionName, ...) \
 	bctbx_list_t *callbacksCopy = bctbx_list_copy(linphone_chat_room_get_callbacks_list(cr)); \
 	for (bctbx_list_t *it = callbacksCopy; it; it = bctbx_list_next(it)) { \
@@ -116,6 +157,7 @@ shared_ptr<Participant> ServerGroupChatRoomPrivate::addParticipant (const Identi
 	if (!participant) {
 		participant = make_shared<Participant>(qConference, addr);
 		qConference->getPrivate()->participants.push_back(participant);
+		qConference->getPrivate()->stateRevision++;
 		shared_ptr<ConferenceParticipantEvent> event = qConference->getPrivate()->eventHandler->notifyParticipantAdded(addr);
 		q->getCore()->getPrivate()->mainDb->addEvent(event);
 	}
@@ -294,6 +336,12 @@ void ServerGroupChatRoomPrivate::removeParticipant (const shared_ptr<const Parti
 	}
 
 	queuedMessages.erase(participant->getAddress().asString());
+	for (auto it = isComposingForwards.begin(); it != isComposingForwards.end();) {
+		if (IdentityAddress(it->first).getAddressWithoutGruu() == participant->getAddress())
+			it = isComposingForwards.erase(it);
+		else
+			it++;
+	}
 
 	// Do not notify participant removal for one-to-one chat rooms
 	if (!(capabilities & ServerGroupChatRoom::Capabilities::OneToOne)) {
@@ -387,6 +435,9 @@ LinphoneReason ServerGroupChatRoomPrivate::onSipMessageReceived (SalOp *op, cons
 		}
 	}
 
+	if (handleIsComposingMessage(msg))
+		return LinphoneReasonNone;
+
 	queueMessage(msg);
 	dispatchQueuedMessages();
 	return LinphoneReasonNone;
@@ -407,7 +458,7 @@ void ServerGroupChatRoomPrivate::setConferenceAddress (const IdentityAddress &co
 		lError() << "Cannot set the conference address of the ServerGroupChatRoom in state " << Utils::toString(q->getState());
 		return;
 	}
-	qConference->getPrivate()->conferenceAddress = conferenceAddress;
+	qConference->getPrivate()->setConferenceAddress(conferenceAddress);
 	lInfo() << "The ServerGroupChatRoom has been given the address " << conferenceAddress.asString() << ", now finalizing its creation";
 	finalizeCreation();
 }
@@ -521,6 +572,15 @@ void ServerGroupChatRoomPrivate::copyMessageHeaders (const shared_ptr<Message> &
 	}
 }
 
+int ServerGroupChatRoomPrivate::isComposingTimerExpired (void *data, unsigned int revents) {
+	ServerGroupChatRoomPrivate *d = reinterpret_cast<ServerGroupChatRoomPrivate *>(data);
+	d->stopIsComposingTimer();
+	d->flushIsComposingMessages();
+	return BELLE_SIP_STOP;
+}
+
+// -----------------------------------------------------------------------------
+
 void ServerGroupChatRoomPrivate::addParticipantDevice (const shared_ptr<Participant> &participant, const IdentityAddress &deviceAddress) {
 	L_Q();
 	L_Q_T(LocalConference, qConference);
@@ -621,6 +681,77 @@ void ServerGroupChatRoomPrivate::finalizeCreation () {
 	chatRoomListener->onChatRoomInsertInDatabaseRequested(q->getSharedFromThis());
 }
 
+void ServerGroupChatRoomPrivate::flushIsComposingMessages () {
+	L_Q();
+	uint64_t now = ms_get_cur_time_ms();
+	size_t nbMessages = 0;
+	for (auto &entry : isComposingForwards) {
+		IsComposingForward &forward = entry.second;
+		if (!forward.pendingMessage)
+			continue;
+		queueMessage(forward.pendingMessage);
+		forward.pendingMessage = nullptr;
+		forward.lastForwardTime = now;
+		forward.lastForwardedActive = forward.pendingActive;
+		isComposingForwardedCount++;
+		nbMessages++;
+	}
+	if (nbMessages == 0)
+		return;
+
+	lInfo() << q << ": Flushing " << nbMessages << " coalesced is-composing notification(s)";
+	dispatchQueuedMessages();
+}
+
+void ServerGroupChatRoomPrivate::loadIsComposingAggregationPeriod () {
+	L_Q();
+	int period = lp_config_get_int(linphone_core_get_config(q->getCore()->getCCore()), "sip", "composing_server_aggregation_period", 1000);
+	isComposingAggregationPeriod = period < 0 ? 0 : static_cast<unsigned int>(period);
+}
+
+// Returns true if the message is an is-composing notification that has been dropped or deferred, false if
+// it must be forwarded right away.
+bool ServerGroupChatRoomPrivate::handleIsComposingMessage (const shared_ptr<Message> &message) {
+	L_Q();
+	string sender(message->fromAddr.asString());
+	IsComposingState state = getIsComposingState(message->content);
+	if (state == IsComposingState::Unknown) {
+		// Participants consider the sender idle as soon as they receive any other message from it.
+		isComposingForwards.erase(sender);
+		return false;
+	}
+
+	isComposingReceivedCount++;
+	bool isActive = (state == IsComposingState::Active);
+	unsigned int period = isComposingAggregationPeriod;
+	uint64_t now = ms_get_cur_time_ms();
+	IsComposingForward &forward = isComposingForwards[sender];
+	if (forward.pendingMessage) {
+		// Superseded by the new notification.
+		forward.pendingMessage = nullptr;
+		isComposingSuppressedCount++;
+	}
+
+	if ((period == 0) || (forward.lastForwardTime == 0) || ((now - forward.lastForwardTime) >= period)) {
+		forward.lastForwardTime = now;
+		forward.lastForwardedActive = isActive;
+		isComposingForwardedCount++;
+		return false;
+	}
+
+	if (isActive == forward.lastForwardedActive) {
+		// Participants already have this state for the sender.
+		isComposingSuppressedCount++;
+		return true;
+	}
+
+	forward.pendingMessage = message;
+	forward.pendingActive = isActive;
+	if (!isComposingTimer)
+		isComposingTimer = q->getCore()->getCCore()->sal->createTimer(isComposingTimerExpired, this, period, "is-composing aggregation timeout");
+	return true;
+}
+
 void ServerGroupChatRoomPrivate::inviteDevice (const shared_ptr<ParticipantDevice> &device) {
 	L_Q();
 	L_Q_T(LocalConference, qConference);
@@ -659,7 +790,7 @@ void ServerGroupChatRoomPrivate::inviteDevice (const shared_ptr<ParticipantDevic
 	content.setBody(q->getResourceLists(addressesList));
 	content.setContentType(ContentType::ResourceLists);
 	content.setContentDisposition(ContentDisposition::RecipientListHistory);
-	if (linphone_core_content_encoding_supported(q->getCore()->getCCore(), "deflate"))
+	if (linphone_core_should_apply_content_encoding(q->getCore()->getCCore(), "deflate", content.getSize()))
 		content.setContentEncoding("deflate");
 	session->startInvite(nullptr, q->getSubject(), &content);
 }
@@ -706,6 +837,22 @@ void ServerGroupChatRoomPrivate::removeParticipantDevice (const shared_ptr<Parti
 	q->getCore()->getPrivate()->mainDb->addEvent(deviceEvent);
 }
 
+void ServerGroupChatRoomPrivate::stopIsComposingTimer () {
+	L_Q();
+	if (!isComposingTimer)
+		return;
+
+	try {
+		LinphoneCore *lc = q->getCore()->getCCore();
+		if (lc->sal)
+			lc->sal->cancelTimer(isComposingTimer);
+	} catch (const bad_weak_ptr &) {
+		// The core is destroyed along with its main loop.
+	}
+	belle_sip_object_unref(isComposingTimer);
+	isComposingTimer = nullptr;
+}
+
 // -----------------------------------------------------------------------------
 
 void ServerGroupChatRoomPrivate::onParticipantDeviceLeft (const std::shared_ptr<ParticipantDevice> &device) {
@@ -732,6 +879,7 @@ void ServerGroupChatRoomPrivate::onParticipantDeviceLeft (const std::shared_ptr<
 		linphone_address_unref(laddr);
 
 		qConference->getPrivate()->participants.remove(participant);
+		qConference->getPrivate()->stateRevision++;
 		filteredParticipants.remove(participant);
 	}
 
@@ -816,6 +964,7 @@ LocalConference(getCore(), IdentityAddress(linphone_proxy_config_get_conference_
 	const char *oneToOneChatRoomStr = sal_custom_header_find(op->getRecvCustomHeaders(), "One-To-One-Chat-Room");
 	if (oneToOneChatRoomStr && (strcmp(oneToOneChatRoomStr, "true") == 0))
 		d->capabilities |= ServerGroupChatRoom::Capabilities::OneToOne;
+	d->loadIsComposingAggregationPeriod();
 	shared_ptr<CallSession> session = getMe()->getPrivate()->createSession(*this, nullptr, false, d);
 	session->configure(LinphoneCallIncoming, nullptr, op, Address(op->getFrom()), Address(op->getTo()));
 	getCore()->getPrivate()->localListEventHandler->addHandler(dConference->eventHandler.get());
@@ -834,17 +983,24 @@ LocalConference(getCore(), peerAddress, nullptr) {
 	L_D_T(LocalConference, dConference);
 
 	d->capabilities |= capabilities & ServerGroupChatRoom::Capabilities::OneToOne;
+	d->loadIsComposingAggregationPeriod();
 	dConference->subject = subject;
 	dConference->participants = move(participants);
-	dConference->conferenceAddress = peerAddress;
+	dConference->setConferenceAddress(peerAddress);
 	dConference->eventHandler->setLastNotify(lastNotifyId);
 	dConference->eventHandler->setChatRoomId(d->chatRoomId);
 	getCore()->getPrivate()->localListEventHandler->addHandler(dConference->eventHandler.get());
 }
 
 ServerGroupChatRoom::~ServerGroupChatRoom () {
+	L_D();
 	L_D_T(LocalConference, dConference);
 
+	d->stopIsComposingTimer();
+	if (d->isComposingReceivedCount > 0)
+		lInfo() << this << ": Is-composing notifications received: " << d->isComposingReceivedCount
+			<< ", forwarded: " << d->isComposingForwardedCount << ", suppressed: " << d->isComposingSuppressedCount;
+
 	try {
 		if (getCore()->getPrivate()->localListEventHandler)
 			getCore()->getPrivate()->localListEventHandler->removeHandler(dConference->eventHandler.get());
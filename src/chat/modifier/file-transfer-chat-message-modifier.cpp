@@ -17,6 +17,9 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <algorithm>
+#include <cstdio>
+
 #include "linphone/api/c-content.h"
 
 #include "address/address.h"
@@ -26,7 +29,7 @@
 #include "chat/chat-room/chat-room-p.h"
 #include "content/content-type.h"
 #include "content/content.h"
-#include "core/core.h"
+#include "core/core-p.h"
 #include "logger/logger.h"
 
 #include "file-transfer-chat-message-modifier.h"
@@ -37,6 +40,10 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
+namespace {
+	constexpr char ResumeValidatorAppDataKey[] = "file-transfer-resume-validator";
+}
+
 FileTransferChatMessageModifier::FileTransferChatMessageModifier (belle_http_provider_t *prov) : provider(prov) {
 	bgTask.setName("File transfer upload");
 }
@@ -54,12 +61,19 @@ FileTransferChatMessageModifier::~FileTransferChatMessageModifier () {
 		cancelFileTransfer(); //to avoid body handler to still refference zombie FileTransferChatMessageModifier
 	else
 		releaseHttpRequest();
+	closeResumedFile();
+	// The file content may already be destroyed along with the message.
+	currentFileContentToTransfer = nullptr;
+	removeGeneratedThumbnail();
 }
 
 ChatMessageModifier::Result FileTransferChatMessageModifier::encode (const shared_ptr<ChatMessage> &message, int &errorCode) {
 	chatMessage = message;
 
 	currentFileContentToTransfer = nullptr;
+	uploadingThumbnail = false;
+	uploadedFileTransferContent = nullptr;
+	removeGeneratedThumbnail();
 	// For each FileContent, upload it and create a FileTransferContent
 	for (Content *content : message->getContents()) {
 		if (content->isFile()) {
@@ -72,10 +86,15 @@ ChatMessageModifier::Result FileTransferChatMessageModifier::encode (const share
 	if (!currentFileContentToTransfer)
 		return ChatMessageModifier::Result::Skipped;
 
+	// Wait for a free transfer slot, the upload is started by startScheduledTransfer.
+	if (!scheduleTransfer(message, FileTransferScheduler::Direction::Upload))
+		return ChatMessageModifier::Result::Suspended;
+
 	/* Open a transaction with the server and send an empty request(RCS5.1 section 3.5.4.8.3.1) */
 	if (uploadFile() == 0)
 		return ChatMessageModifier::Result::Suspended;
 
+	endScheduledTransfer();
 	return ChatMessageModifier::Result::Error;
 }
 
@@ -107,6 +126,10 @@ void FileTransferChatMessageModifier::fileTransferOnProgress (
 	if (!message)
 		return;
 
+	// A resumed download reports the progress of the whole file.
+	offset += resumeOffset;
+	total += resumeOffset;
+
 	LinphoneChatMessage *msg = L_GET_C_BACK_PTR(message);
 	LinphoneChatMessageCbs *cbs = linphone_chat_message_get_callbacks(msg);
 	LinphoneContent *content = L_GET_C_BACK_PTR((Content *)currentFileContentToTransfer);
@@ -151,20 +174,38 @@ int FileTransferChatMessageModifier::onSendBody (
 		return BELLE_SIP_STOP;
 	}
 
-	// if we've not reach the end of file yet, ask for more data
-	// in case of file body handler, won't be called
-	if (currentFileContentToTransfer->getFilePath().empty() && offset < currentFileContentToTransfer->getFileSize()) {
+	// The thumbnail is sent as is: it is never encrypted and its progress is not reported.
+	if (uploadingThumbnail)
+		return readUploadChunk(offset, buffer, size) ? BELLE_SIP_CONTINUE : BELLE_SIP_STOP;
+
+	LinphoneImEncryptionEngineCbsUploadingFileCb cb_process_uploading_file = nullptr;
+	LinphoneImEncryptionEngine *imee = linphone_core_get_im_encryption_engine(message->getCore()->getCCore());
+	if (imee)
+		cb_process_uploading_file = linphone_im_encryption_engine_cbs_get_process_uploading_file(
+			linphone_im_encryption_engine_get_callbacks(imee)
+		);
+
+	// Plain data of the chunk, either already in the buffer or given by the application.
+	size_t max_size = *size;
+	const uint8_t *plain = buffer;
+	LinphoneBuffer *lb = nullptr;
+
+	if (uploadReader.isOpen()) {
+		if (!readUploadChunk(offset, buffer, size))
+			return BELLE_SIP_STOP;
+	} else if (currentFileContentToTransfer->getFilePath().empty() && offset < currentFileContentToTransfer->getFileSize()) {
+		// if we've not reach the end of file yet, ask for more data
+		// in case of file body handler, won't be called
 		// get data from call back
 		LinphoneChatMessageCbs *cbs = linphone_chat_message_get_callbacks(msg);
 		LinphoneChatMessageCbsFileTransferSendCb file_transfer_send_cb =
 			linphone_chat_message_cbs_get_file_transfer_send(cbs);
 		LinphoneContent *content = L_GET_C_BACK_PTR((Content *)currentFileContentToTransfer);
 		if (file_transfer_send_cb) {
-			LinphoneBuffer *lb = file_transfer_send_cb(msg, content, offset, *size);
+			lb = file_transfer_send_cb(msg, content, offset, *size);
 			if (lb) {
 				*size = linphone_buffer_get_size(lb);
-				memcpy(buffer, linphone_buffer_get_content(lb), *size);
-				linphone_buffer_unref(lb);
+				plain = linphone_buffer_get_content(lb);
 			} else {
 				*size = 0;
 			}
@@ -174,35 +215,56 @@ int FileTransferChatMessageModifier::onSendBody (
 		}
 	}
 
-	LinphoneImEncryptionEngine *imee = linphone_core_get_im_encryption_engine(message->getCore()->getCCore());
-	if (imee) {
-		LinphoneImEncryptionEngineCbs *imee_cbs = linphone_im_encryption_engine_get_callbacks(imee);
-		LinphoneImEncryptionEngineCbsUploadingFileCb cb_process_uploading_file =
-			linphone_im_encryption_engine_cbs_get_process_uploading_file(imee_cbs);
-		if (cb_process_uploading_file) {
-			size_t max_size = *size;
-			uint8_t *encrypted_buffer = (uint8_t *)ms_malloc0(max_size);
-			retval = cb_process_uploading_file(imee, msg, offset, (const uint8_t *)buffer, size, encrypted_buffer);
-			if (retval == 0) {
-				if (*size > max_size) {
-					lError() << "IM encryption engine process upload file callback returned a size bigger than the size of the buffer, so it will be truncated !";
-					*size = max_size;
-				}
-				memcpy(buffer, encrypted_buffer, *size);
+	if (cb_process_uploading_file) {
+		// Data given by the application is encrypted straight into the buffer. Data already in the buffer goes through
+		// a scratch buffer kept from one chunk to the next, the engine may not support encrypting in place.
+		uint8_t *encrypted_buffer = buffer;
+		if (plain == buffer) {
+			if (cryptoBuffer.size() < max_size)
+				cryptoBuffer.resize(max_size);
+			encrypted_buffer = cryptoBuffer.data();
+		}
+		retval = cb_process_uploading_file(imee, msg, offset, plain, size, encrypted_buffer);
+		if (retval == 0) {
+			if (*size > max_size) {
+				lError() << "IM encryption engine process upload file callback returned a size bigger than the size of the buffer, so it will be truncated !";
+				*size = max_size;
 			}
-			ms_free(encrypted_buffer);
+			if (encrypted_buffer != buffer)
+				memcpy(buffer, encrypted_buffer, *size);
 		}
+	} else if (plain != buffer) {
+		memcpy(buffer, plain, *size);
 	}
 
+	if (lb)
+		linphone_buffer_unref(lb);
+
 	return retval <= 0 ? BELLE_SIP_CONTINUE : BELLE_SIP_STOP;
 }
 
+bool FileTransferChatMessageModifier::readUploadChunk (size_t offset, uint8_t *buffer, size_t *size) {
+	// The length of the body is announced before it is sent: a short read cannot be made up for, the upload fails.
+	size_t fileSize = uploadReader.getSize();
+	size_t expected = offset < fileSize ? min(*size, fileSize - offset) : 0;
+	*size = uploadReader.read(offset, buffer, *size);
+	if (*size == expected)
+		return true;
+
+	lError() << "Short read at offset " << offset << " of file uploaded by msg [" << this << "], aborting upload";
+	return false;
+}
+
 static void _chat_message_on_send_end (belle_sip_user_body_handler_t *bh, void *data) {
 	FileTransferChatMessageModifier *d = (FileTransferChatMessageModifier *)data;
 	d->onSendEnd(bh);
 }
 
 void FileTransferChatMessageModifier::onSendEnd (belle_sip_user_body_handler_t *bh) {
+	uploadReader.close();
+	if (uploadingThumbnail)
+		return;
+
 	shared_ptr<ChatMessage> message = chatMessage.lock();
 	if (!message)
 		return;
@@ -235,6 +297,11 @@ void FileTransferChatMessageModifier::processResponseFromPostFile (const belle_h
 	// check the answer code
 	if (event->response) {
 		int code = belle_http_response_get_status_code(event->response);
+		if (uploadingThumbnail) {
+			processResponseFromPostThumbnail(message, event);
+			return;
+		}
+
 		if (code == 204) { // this is the reply to the first post to the server - an empty msg
 			// start uploading the file
 			belle_sip_multipart_body_handler_t *bh;
@@ -275,17 +342,27 @@ void FileTransferChatMessageModifier::processResponseFromPostFile (const belle_h
 				first_part_header = "form-data; name=\"File\"; filename=\"" + currentFileContentToTransfer->getFileName() + "\"";
 			}
 
+			// A file is read by onSendBody through a FileReader, mapped when possible. If the reader cannot open it,
+			// the file body handler of belle-sip reads it.
+			const string &filePath = currentFileContentToTransfer->getFilePath();
+			if (!filePath.empty() && uploadReader.open(filePath)) {
+				currentFileContentToTransfer->setFileSize(uploadReader.getSize());
+				fileTransferContent->setFileSize(uploadReader.getSize());
+			}
+
 			// create a user body handler to take care of the file and add the content disposition and content-type headers
 			first_part_bh = (belle_sip_body_handler_t *)belle_sip_user_body_handler_new(currentFileContentToTransfer->getFileSize(),
 					_chat_message_file_transfer_on_progress, nullptr, nullptr,
 					_chat_message_on_send_body, _chat_message_on_send_end, this);
-			if (!currentFileContentToTransfer->getFilePath().empty()) {
-				belle_sip_user_body_handler_t *body_handler = (belle_sip_user_body_handler_t *)first_part_bh;
-				// No need to add again the callback for progression, otherwise it will be called twice
-				first_part_bh = (belle_sip_body_handler_t *)belle_sip_file_body_handler_new(currentFileContentToTransfer->getFilePath().c_str(), nullptr, this);
-				belle_sip_file_body_handler_set_user_body_handler((belle_sip_file_body_handler_t *)first_part_bh, body_handler);
-				// Ensure the file size has been set to the correct value
-				fileTransferContent->setFileSize(belle_sip_file_body_handler_get_file_size((belle_sip_file_body_handler_t *)first_part_bh));
+			if (!filePath.empty()) {
+				if (!uploadReader.isOpen()) {
+					belle_sip_user_body_handler_t *body_handler = (belle_sip_user_body_handler_t *)first_part_bh;
+					// No need to add again the callback for progression, otherwise it will be called twice
+					first_part_bh = (belle_sip_body_handler_t *)belle_sip_file_body_handler_new(filePath.c_str(), nullptr, this);
+					belle_sip_file_body_handler_set_user_body_handler((belle_sip_file_body_handler_t *)first_part_bh, body_handler);
+					// Ensure the file size has been set to the correct value
+					fileTransferContent->setFileSize(belle_sip_file_body_handler_get_file_size((belle_sip_file_body_handler_t *)first_part_bh));
+				}
 			} else if (!currentFileContentToTransfer->isEmpty()) {
 				first_part_bh = (belle_sip_body_handler_t *)belle_sip_memory_body_handler_new_from_buffer(
 						ms_strdup(currentFileContentToTransfer->getBodyAsString().c_str()),
@@ -302,7 +379,7 @@ void FileTransferChatMessageModifier::processResponseFromPostFile (const belle_h
 			// insert it in a multipart body handler which will manage the boundaries of multipart msg
 			bh = belle_sip_multipart_body_handler_new(_chat_message_file_transfer_on_progress, this, first_part_bh, nullptr);
 
-			releaseHttpRequest();
+			releaseHttpRequest(false);
 			fileUploadBeginBackgroundTask();
 			uploadFile();
 			belle_sip_message_set_body_handler(BELLE_SIP_MESSAGE(httpRequest), BELLE_SIP_BODY_HANDLER(bh));
@@ -381,15 +458,8 @@ void FileTransferChatMessageModifier::processResponseFromPostFile (const belle_h
 					fileTransferContent->setBody(body);
 				}
 
-				FileContent *fileContent = currentFileContentToTransfer;
-				fileTransferContent->setFileContent(fileContent);
-
-				message->getPrivate()->removeContent(fileContent);
-
-				message->getPrivate()->setState(ChatMessage::State::FileTransferDone);
-				releaseHttpRequest();
-				message->getPrivate()->send();
-				fileUploadEndBackgroundTask();
+				if (!startThumbnailUpload(fileTransferContent))
+					fileUploadDone(message, fileTransferContent);
 			} else {
 				lWarning() << "Received empty response from server, file transfer failed";
 				FileTransferContent *fileTransferContent = nullptr;
@@ -447,6 +517,10 @@ void FileTransferChatMessageModifier::processIoErrorUpload (const belle_sip_io_e
 	shared_ptr<ChatMessage> message = chatMessage.lock();
 	if (!message)
 		return;
+	if (uploadingThumbnail) {
+		endThumbnailUpload(message, nullptr);
+		return;
+	}
 	message->getPrivate()->setState(ChatMessage::State::NotDelivered);
 	releaseHttpRequest();
 }
@@ -461,6 +535,10 @@ void FileTransferChatMessageModifier::processAuthRequestedUpload (const belle_si
 	shared_ptr<ChatMessage> message = chatMessage.lock();
 	if (!message)
 		return;
+	if (uploadingThumbnail) {
+		endThumbnailUpload(message, nullptr);
+		return;
+	}
 	message->getPrivate()->setState(ChatMessage::State::NotDelivered);
 	releaseHttpRequest();
 }
@@ -518,6 +596,13 @@ int FileTransferChatMessageModifier::startHttpTransfer (const string &url, const
 		lWarning() << "Could not create http request for uri " << url;
 		goto error;
 	}
+	if (action == "GET" && resumeOffset > 0) {
+		belle_sip_message_add_header(
+			BELLE_SIP_MESSAGE(httpRequest),
+			belle_sip_header_create("Range", ("bytes=" + to_string(resumeOffset) + "-").c_str())
+		);
+		belle_sip_message_add_header(BELLE_SIP_MESSAGE(httpRequest), belle_sip_header_create("If-Range", resumeValidator.c_str()));
+	}
 	// keep a reference to the http request to be able to cancel it during upload
 	belle_sip_object_ref(httpRequest);
 
@@ -544,6 +629,192 @@ void FileTransferChatMessageModifier::fileUploadEndBackgroundTask () {
 	bgTask.stop();
 }
 
+void FileTransferChatMessageModifier::fileUploadDone (
+	const shared_ptr<ChatMessage> &message,
+	FileTransferContent *fileTransferContent
+) {
+	FileContent *fileContent = currentFileContentToTransfer;
+	removeGeneratedThumbnail();
+	fileTransferContent->setFileContent(fileContent);
+
+	message->getPrivate()->removeContent(fileContent);
+
+	message->getPrivate()->setState(ChatMessage::State::FileTransferDone);
+	releaseHttpRequest();
+	message->getPrivate()->send();
+	fileUploadEndBackgroundTask();
+}
+
+// ----------------------------------------------------------
+
+static xmlNodePtr findFileInfoNode (xmlDocPtr xmlMessageBody, const char *type) {
+	xmlNodePtr cur = xmlMessageBody ? xmlDocGetRootElement(xmlMessageBody) : nullptr;
+	for (cur = cur ? cur->xmlChildrenNode : nullptr; cur; cur = cur->next) {
+		if (xmlStrcmp(cur->name, (const xmlChar *)"file-info"))
+			continue;
+		xmlChar *typeAttribute = xmlGetProp(cur, (const xmlChar *)"type");
+		bool found = !xmlStrcmp(typeAttribute, (const xmlChar *)type);
+		xmlFree(typeAttribute);
+		if (found)
+			return cur;
+	}
+	return nullptr;
+}
+
+bool FileTransferChatMessageModifier::startThumbnailUpload (FileTransferContent *fileTransferContent) {
+	// A thumbnail in clear would give away the content of an encrypted file.
+	if (fileTransferContent->getFileKeySize() > 0)
+		return false;
+	if (currentFileContentToTransfer->getThumbnailFilePath().empty())
+		return startThumbnailGeneration(fileTransferContent);
+
+	lInfo() << "Uploading thumbnail of file transfer msg [" << this << "]";
+	uploadingThumbnail = true;
+	uploadedFileTransferContent = fileTransferContent;
+	releaseHttpRequest(false);
+	if (uploadFile() == 0)
+		return true;
+
+	uploadingThumbnail = false;
+	uploadedFileTransferContent = nullptr;
+	return false;
+}
+
+bool FileTransferChatMessageModifier::startThumbnailGeneration (FileTransferContent *fileTransferContent) {
+	shared_ptr<ChatMessage> message = chatMessage.lock();
+	if (!message)
+		return false;
+
+	shared_ptr<Core> core = message->getCore();
+	if (!lp_config_get_int(linphone_core_get_config(core->getCCore()), "misc", "file_transfer_generate_thumbnails", 0))
+		return false;
+
+	const ContentType &contentType = currentFileContentToTransfer->getContentType();
+	const string &filePath = currentFileContentToTransfer->getFilePath();
+	if (filePath.empty() || contentType.getType() != "image" || contentType.getSubType() != "jpeg")
+		return false;
+
+	// Unlike one given by the application, the generated thumbnail is removed once the file is uploaded.
+	char token[11];
+	const string thumbnailPath = core->getDataPath() + "thumbnail-" + belle_sip_random_token(token, sizeof(token)) + ".jpg";
+	lInfo() << "Generating thumbnail " << thumbnailPath << " of file transfer msg [" << this << "]";
+	uploadedFileTransferContent = fileTransferContent;
+	generatedThumbnailPath = thumbnailPath;
+	if (thumbnailGenerator.start(core, filePath, thumbnailPath, [this, thumbnailPath] (bool success) {
+		onThumbnailGenerated(thumbnailPath, success);
+	}))
+		return true;
+
+	uploadedFileTransferContent = nullptr;
+	removeGeneratedThumbnail();
+	return false;
+}
+
+void FileTransferChatMessageModifier::onThumbnailGenerated (const string &thumbnailPath, bool success) {
+	FileTransferContent *fileTransferContent = uploadedFileTransferContent;
+	uploadedFileTransferContent = nullptr;
+
+	shared_ptr<ChatMessage> message = chatMessage.lock();
+	if (!message) {
+		removeGeneratedThumbnail();
+		return;
+	}
+
+	if (success)
+		currentFileContentToTransfer->setThumbnailFilePath(thumbnailPath);
+	else
+		lWarning() << "Unable to generate thumbnail of file transfer msg [" << this << "], sending file without it";
+
+	if (!success || !startThumbnailUpload(fileTransferContent))
+		fileUploadDone(message, fileTransferContent);
+}
+
+void FileTransferChatMessageModifier::removeGeneratedThumbnail () {
+	if (generatedThumbnailPath.empty())
+		return;
+
+	if (currentFileContentToTransfer && currentFileContentToTransfer->getThumbnailFilePath() == generatedThumbnailPath)
+		currentFileContentToTransfer->setThumbnailFilePath("");
+	// The generation may have failed before creating the file.
+	if (remove(generatedThumbnailPath.c_str()) == 0)
+		lInfo() << "Removed generated thumbnail " << generatedThumbnailPath;
+	generatedThumbnailPath.clear();
+}
+
+void FileTransferChatMessageModifier::processResponseFromPostThumbnail (
+	const shared_ptr<ChatMessage> &message,
+	const belle_http_response_event_t *event
+) {
+	int code = belle_http_response_get_status_code(event->response);
+	if (code == 200) {
+		endThumbnailUpload(message, belle_sip_message_get_body((belle_sip_message_t *)event->response));
+		return;
+	}
+	if (code != 204) {
+		lWarning() << "Received HTTP code response " << code << " for thumbnail upload, sending file without it";
+		endThumbnailUpload(message, nullptr);
+		return;
+	}
+
+	const string &filePath = currentFileContentToTransfer->getThumbnailFilePath();
+	if (!uploadReader.open(filePath) || uploadReader.getSize() == 0) {
+		lWarning() << "Unable to read thumbnail " << filePath << ", sending file without it";
+		endThumbnailUpload(message, nullptr);
+		return;
+	}
+
+	string fileName = filePath.substr(filePath.find_last_of("/\\") + 1);
+	string extension = fileName.substr(fileName.find_last_of('.') + 1);
+	transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+
+	belle_sip_body_handler_t *first_part_bh = (belle_sip_body_handler_t *)belle_sip_user_body_handler_new(
+		uploadReader.getSize(), nullptr, nullptr, nullptr, _chat_message_on_send_body, _chat_message_on_send_end, this
+	);
+	belle_sip_body_handler_add_header(first_part_bh,
+		belle_sip_header_create("Content-disposition", ("form-data; name=\"File\"; filename=\"" + fileName + "\"").c_str()));
+	belle_sip_body_handler_add_header(first_part_bh,
+		(belle_sip_header_t *)belle_sip_header_content_type_create("image", extension == "png" ? "png" : "jpeg"));
+	belle_sip_multipart_body_handler_t *bh = belle_sip_multipart_body_handler_new(nullptr, nullptr, first_part_bh, nullptr);
+
+	releaseHttpRequest(false);
+	if (uploadFile() != 0) {
+		belle_sip_object_unref(bh);
+		endThumbnailUpload(message, nullptr);
+		return;
+	}
+	belle_sip_message_set_body_handler(BELLE_SIP_MESSAGE(httpRequest), BELLE_SIP_BODY_HANDLER(bh));
+}
+
+void FileTransferChatMessageModifier::endThumbnailUpload (const shared_ptr<ChatMessage> &message, const char *serverResponse) {
+	FileTransferContent *fileTransferContent = uploadedFileTransferContent;
+	uploadingThumbnail = false;
+	uploadedFileTransferContent = nullptr;
+
+	if (serverResponse && strlen(serverResponse) > 0) {
+		xmlDocPtr thumbnailXml = xmlParseDoc((const xmlChar *)serverResponse);
+		xmlDocPtr fileXml = xmlParseDoc((const xmlChar *)fileTransferContent->getBodyAsString().c_str());
+		xmlNodePtr thumbnailInfo = findFileInfoNode(thumbnailXml, "file");
+		xmlNodePtr fileInfo = findFileInfoNode(fileXml, "file");
+		if (thumbnailInfo && fileInfo) {
+			// As in RCS, the file-info of the thumbnail comes before the one of the file.
+			xmlNodePtr node = xmlDocCopyNode(thumbnailInfo, fileXml, 1);
+			xmlSetProp(node, (const xmlChar *)"type", (const xmlChar *)"thumbnail");
+			xmlAddPrevSibling(fileInfo, node);
+
+			xmlChar *buffer;
+			int xmlStringLength;
+			xmlDocDumpFormatMemoryEnc(fileXml, &buffer, &xmlStringLength, "UTF-8", 0);
+			fileTransferContent->setBody((const char *)buffer);
+			xmlFree(buffer);
+		} else
+			lWarning() << "Unexpected response to thumbnail upload, sending file without it";
+		xmlFreeDoc(thumbnailXml);
+		xmlFreeDoc(fileXml);
+	}
+
+	fileUploadDone(message, fileTransferContent);
+}
+
 // ----------------------------------------------------------
 
 static void fillFileTransferContentInformationsFromVndGsmaRcsFtHttpXml (FileTransferContent *fileTransferContent) {
@@ -606,6 +877,15 @@ static void fillFileTransferContentInformationsFromVndGsmaRcsFtHttpXml (FileTran
 			cur = cur->next;
 		}
 	}
+	xmlNodePtr thumbnailInfo = findFileInfoNode(xmlMessageBody, "thumbnail");
+	for (cur = thumbnailInfo ? thumbnailInfo->xmlChildrenNode : nullptr; cur; cur = cur->next) {
+		if (!xmlStrcmp(cur->name, (const xmlChar *)"data")) {
+			xmlChar *thumbnailUrl = xmlGetProp(cur, (const xmlChar *)"url");
+			fileTransferContent->setThumbnailUrl(thumbnailUrl ? (const char *)thumbnailUrl : "");
+			xmlFree(thumbnailUrl);
+			break;
+		}
+	}
 	xmlFreeDoc(xmlMessageBody);
 
 	fileTransferContent->setFileUrl(fileUrl ? (const char *)fileUrl : "");
@@ -620,7 +900,7 @@ ChatMessageModifier::Result FileTransferChatMessageModifier::decode (const share
 	if (internalContent.getContentType() == ContentType::FileTransfer) {
 		FileTransferContent *fileTransferContent = new FileTransferContent();
 		fileTransferContent->setContentType(internalContent.getContentType());
-		fileTransferContent->setBody(internalContent.getBody());
+		fileTransferContent->shareBody(internalContent);
 		fillFileTransferContentInformationsFromVndGsmaRcsFtHttpXml(fileTransferContent);
 		message->addContent(fileTransferContent);
 		return ChatMessageModifier::Result::Done;
@@ -743,17 +1023,25 @@ void FileTransferChatMessageModifier::onRecvBody (belle_sip_user_body_handler_t
 		return;
 
 	int retval = -1;
+	uint8_t *plain = buffer;
 	LinphoneImEncryptionEngine *imee = linphone_core_get_im_encryption_engine(message->getCore()->getCCore());
 	if (imee) {
 		LinphoneImEncryptionEngineCbs *imee_cbs = linphone_im_encryption_engine_get_callbacks(imee);
 		LinphoneImEncryptionEngineCbsDownloadingFileCb cb_process_downloading_file = linphone_im_encryption_engine_cbs_get_process_downloading_file(imee_cbs);
 		if (cb_process_downloading_file) {
-			uint8_t *decrypted_buffer = (uint8_t *)ms_malloc0(size);
-			retval = cb_process_downloading_file(imee, L_GET_C_BACK_PTR(message), offset, (const uint8_t *)buffer, size, decrypted_buffer);
+			// One more byte to NUL terminate the decrypted chunk, as a LinphoneBuffer is.
+			if (cryptoBuffer.size() < size + 1)
+				cryptoBuffer.resize(size + 1);
+			retval = cb_process_downloading_file(imee, L_GET_C_BACK_PTR(message), offset, (const uint8_t *)buffer, size, cryptoBuffer.data());
 			if (retval == 0) {
-				memcpy(buffer, decrypted_buffer, size);
+				cryptoBuffer[size] = '\0';
+				plain = cryptoBuffer.data();
+				// The file body handler writes the content of the buffer to the file once this returns.
+				if (!currentFileContentToTransfer->getFilePath().empty() && !resumedFile) {
+					memcpy(buffer, plain, size);
+					plain = buffer;
+				}
 			}
-			ms_free(decrypted_buffer);
 		}
 	}
 
@@ -763,12 +1051,24 @@ void FileTransferChatMessageModifier::onRecvBody (belle_sip_user_body_handler_t
 			LinphoneChatMessageCbs *cbs = linphone_chat_message_get_callbacks(msg);
 			LinphoneContent *content = L_GET_C_BACK_PTR((Content *)currentFileContentToTransfer);
 			if (linphone_chat_message_cbs_get_file_transfer_recv(cbs)) {
-				LinphoneBuffer *lb = linphone_buffer_new_from_data(buffer, size);
-				linphone_chat_message_cbs_get_file_transfer_recv(cbs)(msg, content, lb);
-				linphone_buffer_unref(lb);
+				// Only the decrypted chunk can be lent, the buffer of belle-sip has no room for a terminating NUL.
+				if (plain == buffer) {
+					LinphoneBuffer *lb = linphone_buffer_new_from_data(plain, size);
+					linphone_chat_message_cbs_get_file_transfer_recv(cbs)(msg, content, lb);
+					linphone_buffer_unref(lb);
+				} else {
+					LinphoneBuffer *lb = _linphone_buffer_new_borrowing_data(plain, size);
+					linphone_chat_message_cbs_get_file_transfer_recv(cbs)(msg, content, lb);
+					_linphone_buffer_release_borrowed_data(lb);
+				}
 			} else {
 				// Legacy: call back given by application level
-				linphone_core_notify_file_transfer_recv(message->getCore()->getCCore(), msg, content, (const char *)buffer, size);
+				linphone_core_notify_file_transfer_recv(message->getCore()->getCCore(), msg, content, (const char *)plain, size);
+			}
+		} else if (resumedFile) {
+			if (bctbx_file_write(resumedFile, plain, size, static_cast<off_t>(resumeOffset + offset)) < 0) {
+				lError() << "Unable to write resumed download of msg [" << this << "] to " << currentFileContentToTransfer->getFilePath();
+				message->getPrivate()->setState(ChatMessage::State::FileTransferError);
 			}
 		}
 	} else {
@@ -783,6 +1083,8 @@ static void _chat_message_on_recv_end (belle_sip_user_body_handler_t *bh, void *
 }
 
 void FileTransferChatMessageModifier::onRecvEnd (belle_sip_user_body_handler_t *bh) {
+	closeResumedFile();
+
 	shared_ptr<ChatMessage> message = chatMessage.lock();
 	if (!message)
 		return;
@@ -814,6 +1116,8 @@ void FileTransferChatMessageModifier::onRecvEnd (belle_sip_user_body_handler_t *
 	}
 
 	if (retval <= 0 && message->getState() != ChatMessage::State::FileTransferError) {
+		resetDownloadResumption();
+
 		// Remove the FileTransferContent from the message and store the FileContent
 		FileContent *fileContent = currentFileContentToTransfer;
 		message->getPrivate()->addContent(fileContent);
@@ -867,6 +1171,9 @@ void FileTransferChatMessageModifier::processResponseHeadersFromGetFile (const b
 		if (!message)
 			return;
 
+		if (startResumedDownload(response))
+			return;
+
 		if (currentFileContentToTransfer) {
 			belle_sip_header_content_length_t *content_length_hdr = BELLE_SIP_HEADER_CONTENT_LENGTH(belle_sip_message_get_header(response, "Content-Length"));
 			currentFileContentToTransfer->setFileSize(belle_sip_header_content_length_get_content_length(content_length_hdr));
@@ -921,6 +1228,8 @@ static void _chat_message_process_io_error_download (void *data, const belle_sip
 
 void FileTransferChatMessageModifier::processIoErrorDownload (const belle_sip_io_error_event_t *event) {
 	lError() << "I/O Error during file download msg [" << this << "]";
+	// Keep the resumption state: the next download of this file continues from what has been written.
+	closeResumedFile();
 	shared_ptr<ChatMessage> message = chatMessage.lock();
 	if (!message)
 		return;
@@ -943,8 +1252,9 @@ void FileTransferChatMessageModifier::processResponseFromGetFile (const belle_ht
 		int code = belle_http_response_get_status_code(event->response);
 		if (code >= 400 && code < 500) {
 			lWarning() << "File transfer failed with code " << code;
+			resetDownloadResumption();
 			message->getPrivate()->setState(ChatMessage::State::FileTransferError);
-		} else if (code != 200) {
+		} else if (code != 200 && code != 206) {
 			lWarning() << "Unhandled HTTP code response " << code << " for file transfer";
 		}
 		releaseHttpRequest();
@@ -957,7 +1267,7 @@ bool FileTransferChatMessageModifier::downloadFile (
 ) {
 	chatMessage = message;
 
-	if (httpRequest) {
+	if (httpRequest || isFileTransferQueued()) {
 		lError() << "There is already a download in progress.";
 		return false;
 	}
@@ -978,22 +1288,45 @@ bool FileTransferChatMessageModifier::downloadFile (
 		currentFileContentToTransfer->setFilePath(message->getPrivate()->getFileTransferFilepath());
 	}
 
+	prepareDownloadResumption(fileTransferContent);
+
+	downloadUrl = fileTransferContent->getFileUrl(); // File URL has been set by createFileTransferInformationsFromVndGsmaRcsFtHttpXml
+	if (scheduleTransfer(message, FileTransferScheduler::Direction::Download) && startDownload() == -1) {
+		endScheduledTransfer();
+		return false;
+	}
+	// start the download, status is In Progress
+	message->getPrivate()->setState(ChatMessage::State::InProgress);
+	return true;
+}
+
+int FileTransferChatMessageModifier::startDownload () {
 	belle_http_request_listener_callbacks_t cbs = { 0 };
 	cbs.process_response_headers = _chat_process_response_headers_from_get_file;
 	cbs.process_response = _chat_message_process_response_from_get_file;
 	cbs.process_io_error = _chat_message_process_io_error_download;
 	cbs.process_auth_requested = _chat_message_process_auth_requested_download;
-	int err = startHttpTransfer(fileTransferContent->getFileUrl(), "GET", &cbs); // File URL has been set by createFileTransferInformationsFromVndGsmaRcsFtHttpXml
-	if (err == -1)
-		return false;
-	// start the download, status is In Progress
-	message->getPrivate()->setState(ChatMessage::State::InProgress);
-	return true;
+	return startHttpTransfer(downloadUrl, "GET", &cbs);
 }
 
 // ----------------------------------------------------------
 
 void FileTransferChatMessageModifier::cancelFileTransfer () {
+	if (isFileTransferQueued()) {
+		lInfo() << "Canceling queued file transfer [" << this << "]";
+		endScheduledTransfer();
+		return;
+	}
+
+	if (thumbnailGenerator.isRunning()) {
+		lInfo() << "Canceling thumbnail generation of file transfer [" << this << "]";
+		thumbnailGenerator.stop();
+		uploadedFileTransferContent = nullptr;
+		releaseHttpRequest();
+		removeGeneratedThumbnail();
+		return;
+	}
+
 	if (!httpRequest) {
 		lInfo() << "No existing file transfer - nothing to cancel";
 		return;
@@ -1014,13 +1347,15 @@ void FileTransferChatMessageModifier::cancelFileTransfer () {
 		belle_http_provider_cancel_request(provider, httpRequest);
 	}
 	releaseHttpRequest();
+	closeResumedFile();
+	removeGeneratedThumbnail();
 }
 
 bool FileTransferChatMessageModifier::isFileTransferInProgressAndValid () const {
-	return httpRequest && !belle_http_request_is_cancelled(httpRequest);
+	return (httpRequest && !belle_http_request_is_cancelled(httpRequest)) || thumbnailGenerator.isRunning();
 }
 
-void FileTransferChatMessageModifier::releaseHttpRequest () {
+void FileTransferChatMessageModifier::releaseHttpRequest (bool transferEnded) {
 	if (httpRequest) {
 		belle_sip_object_unref(httpRequest);
 		httpRequest = nullptr;
@@ -1029,6 +1364,179 @@ void FileTransferChatMessageModifier::releaseHttpRequest () {
 			httpListener = nullptr;
 		}
 	}
+	if (transferEnded) {
+		uploadReader.close();
+		endScheduledTransfer();
+	}
+}
+
+// ----------------------------------------------------------
+
+bool FileTransferChatMessageModifier::isFileTransferQueued () const {
+	if (!scheduled)
+		return false;
+	shared_ptr<Core> core = scheduledCore.lock();
+	if (!core || !core->getPrivate()->fileTransferScheduler)
+		return false;
+	return core->getPrivate()->fileTransferScheduler->isQueued(this);
+}
+
+void FileTransferChatMessageModifier::startScheduledTransfer () {
+	shared_ptr<ChatMessage> message = chatMessage.lock();
+	if (!message) {
+		endScheduledTransfer();
+		return;
+	}
+
+	bool isUpload = scheduledDirection == FileTransferScheduler::Direction::Upload;
+	if ((isUpload ? uploadFile() : startDownload()) == 0)
+		return;
+
+	endScheduledTransfer();
+	message->getPrivate()->setState(isUpload ? ChatMessage::State::NotDelivered : ChatMessage::State::FileTransferError);
+}
+
+bool FileTransferChatMessageModifier::scheduleTransfer (
+	const shared_ptr<ChatMessage> &message,
+	FileTransferScheduler::Direction direction
+) {
+	shared_ptr<Core> core = message->getCore();
+	const unique_ptr<FileTransferScheduler> &scheduler = core->getPrivate()->fileTransferScheduler;
+	if (!scheduler)
+		return true;
+
+	scheduled = true;
+	scheduledCore = core;
+	scheduledDirection = direction;
+	string url = downloadUrl;
+	if (direction == FileTransferScheduler::Direction::Upload)
+		url = L_C_TO_STRING(linphone_core_get_file_transfer_server(core->getCCore()));
+	return scheduler->requestStart(this, direction, url);
+}
+
+void FileTransferChatMessageModifier::endScheduledTransfer () {
+	if (!scheduled)
+		return;
+
+	scheduled = false;
+	shared_ptr<Core> core = scheduledCore.lock();
+	if (core && core->getPrivate()->fileTransferScheduler)
+		core->getPrivate()->fileTransferScheduler->transferEnded(this);
+}
+
+// ----------------------------------------------------------
+
+void FileTransferChatMessageModifier::prepareDownloadResumption (FileTransferContent *fileTransferContent) {
+	closeResumedFile();
+	resumeOffset = 0;
+	resumeContent = fileTransferContent;
+	resumeValidator = fileTransferContent->getAppData(ResumeValidatorAppDataKey);
+
+	// Encrypted files are decrypted as a single stream that cannot be restarted in the middle. Without a validator
+	// from a previous attempt, there is no way to make sure that the remote file has not changed in between.
+	const string &filePath = currentFileContentToTransfer->getFilePath();
+	if (filePath.empty() || fileTransferContent->getFileKeySize() > 0 || resumeValidator.empty())
+		return;
+
+	bctbx_vfs_file_t *file = bctbx_file_open(bctbx_vfs_get_default(), filePath.c_str(), "r");
+	if (!file)
+		return;
+	int64_t size = bctbx_file_size(file);
+	bctbx_file_close(file);
+
+	size_t fileSize = currentFileContentToTransfer->getFileSize();
+	if (size > 0 && (fileSize == 0 || static_cast<size_t>(size) < fileSize)) {
+		resumeOffset = static_cast<size_t>(size);
+		lInfo() << "Resuming download of msg [" << this << "] from byte " << resumeOffset;
+	}
+}
+
+bool FileTransferChatMessageModifier::startResumedDownload (belle_sip_message_t *response) {
+	int code = belle_http_response_get_status_code(BELLE_HTTP_RESPONSE(response));
+	belle_sip_header_content_length_t *contentLengthHeader = BELLE_SIP_HEADER_CONTENT_LENGTH(
+		belle_sip_message_get_header(response, "Content-Length")
+	);
+	size_t contentLength = contentLengthHeader ? belle_sip_header_content_length_get_content_length(contentLengthHeader) : 0;
+
+	if (resumeOffset > 0) {
+		// The server sends the whole file instead of the range if it does not support ranges or if the file has changed.
+		belle_sip_header_t *contentRangeHeader = belle_sip_message_get_header(response, "Content-Range");
+		string expectedRange = "bytes " + to_string(resumeOffset) + "-";
+		if (code != 206 || !contentRangeHeader
+			|| strncmp(belle_sip_header_get_unparsed_value(contentRangeHeader), expectedRange.c_str(), expectedRange.size()) != 0
+		) {
+			lInfo() << "Download of msg [" << this << "] cannot be resumed, restarting from the beginning";
+			resumeOffset = 0;
+
+			// The file body handler writes the whole file after what is already there.
+			const string &filePath = currentFileContentToTransfer->getFilePath();
+			bctbx_vfs_file_t *file = bctbx_file_open(bctbx_vfs_get_default(), filePath.c_str(), "r+");
+			if (!file || bctbx_file_truncate(file, 0) < 0)
+				lError() << "Unable to truncate " << filePath << " to restart download of msg [" << this << "]";
+			if (file)
+				bctbx_file_close(file);
+		}
+	}
+
+	if (resumeOffset == 0) {
+		// Remember how to validate this version of the file in case the download is interrupted.
+		// If-Range only accepts strong entity tags.
+		string validator;
+		if (code == 200 && !currentFileContentToTransfer->getFilePath().empty()) {
+			belle_sip_header_t *etag = belle_sip_message_get_header(response, "ETag");
+			belle_sip_header_t *lastModified = belle_sip_message_get_header(response, "Last-Modified");
+			if (etag && strncmp(belle_sip_header_get_unparsed_value(etag), "W/", 2) != 0)
+				validator = belle_sip_header_get_unparsed_value(etag);
+			else if (lastModified)
+				validator = belle_sip_header_get_unparsed_value(lastModified);
+		}
+		setResumeValidator(validator);
+		return false;
+	}
+
+	resumedFile = bctbx_file_open(bctbx_vfs_get_default(), currentFileContentToTransfer->getFilePath().c_str(), "r+");
+	if (!resumedFile) {
+		lError() << "Unable to open " << currentFileContentToTransfer->getFilePath() << " to resume download of msg [" << this << "]";
+		resetDownloadResumption();
+		shared_ptr<ChatMessage> message = chatMessage.lock();
+		if (message)
+			message->getPrivate()->setState(ChatMessage::State::FileTransferError);
+		return true;
+	}
+
+	currentFileContentToTransfer->setFileSize(resumeOffset + contentLength);
+	belle_sip_body_handler_t *bodyHandler = (belle_sip_body_handler_t *)belle_sip_user_body_handler_new(
+		contentLength, _chat_message_file_transfer_on_progress,
+		nullptr, _chat_message_on_recv_body,
+		nullptr, _chat_message_on_recv_end, this
+	);
+	belle_sip_message_set_body_handler(response, bodyHandler);
+	return true;
+}
+
+void FileTransferChatMessageModifier::setResumeValidator (const string &validator) {
+	resumeValidator = validator;
+	if (!resumeContent || resumeContent->getAppData(ResumeValidatorAppDataKey) == validator)
+		return;
+
+	resumeContent->setAppData(ResumeValidatorAppDataKey, validator);
+	shared_ptr<ChatMessage> message = chatMessage.lock();
+	if (message)
+		message->getPrivate()->updateInDb();
+}
+
+void FileTransferChatMessageModifier::resetDownloadResumption () {
+	closeResumedFile();
+	setResumeValidator("");
+	resumeContent = nullptr;
+	resumeOffset = 0;
+}
+
+void FileTransferChatMessageModifier::closeResumedFile () {
+	if (resumedFile) {
+		bctbx_file_close(resumedFile);
+		resumedFile = nullptr;
+	}
 }
 
 string FileTransferChatMessageModifier::createFakeFileTransferFromUrl (const string &url) {
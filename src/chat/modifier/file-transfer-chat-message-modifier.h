@@ -20,10 +20,16 @@
 #ifndef _L_FILE_TRANSFER_CHAT_MESSAGE_MODIFIER_H_
 #define _L_FILE_TRANSFER_CHAT_MESSAGE_MODIFIER_H_
 
+#include <vector>
+
 #include <belle-sip/belle-sip.h>
+#include <bctoolbox/vfs.h>
 
+#include "chat/chat-message/file-transfer-scheduler.h"
 #include "chat-message-modifier.h"
 #include "utils/background-task.h"
+#include "utils/file-reader.h"
+#include "utils/thumbnail-generator.h"
 
 // =============================================================================
 
@@ -63,24 +69,76 @@ public:
 	bool downloadFile (const std::shared_ptr<ChatMessage> &message, FileTransferContent *fileTransferContent);
 	void cancelFileTransfer ();
 	bool isFileTransferInProgressAndValid () const;
+	bool isFileTransferQueued () const;
+	void startScheduledTransfer ();
 	std::string createFakeFileTransferFromUrl (const std::string &url);
 
 private:
 	int uploadFile ();
+	bool readUploadChunk (size_t offset, uint8_t *buffer, size_t *size);
+	int startDownload ();
 	int startHttpTransfer (const std::string &url, const std::string &action, belle_http_request_listener_callbacks_t *cbs);
 	void fileUploadBeginBackgroundTask ();
 	void fileUploadEndBackgroundTask ();
+	void fileUploadDone (const std::shared_ptr<ChatMessage> &message, FileTransferContent *fileTransferContent);
+
+	bool startThumbnailUpload (FileTransferContent *fileTransferContent);
+	bool startThumbnailGeneration (FileTransferContent *fileTransferContent);
+	void onThumbnailGenerated (const std::string &thumbnailPath, bool success);
+	void removeGeneratedThumbnail ();
+	void processResponseFromPostThumbnail (
+		const std::shared_ptr<ChatMessage> &message,
+		const belle_http_response_event_t *event
+	);
+	void endThumbnailUpload (const std::shared_ptr<ChatMessage> &message, const char *serverResponse);
+
+	void releaseHttpRequest (bool transferEnded = true);
 
-	void releaseHttpRequest ();
+	bool scheduleTransfer (const std::shared_ptr<ChatMessage> &message, FileTransferScheduler::Direction direction);
+	void endScheduledTransfer ();
+
+	void prepareDownloadResumption (FileTransferContent *fileTransferContent);
+	bool startResumedDownload (belle_sip_message_t *response);
+	void setResumeValidator (const std::string &validator);
+	void resetDownloadResumption ();
+	void closeResumedFile ();
 
 	std::weak_ptr<ChatMessage> chatMessage;
+	std::string downloadUrl;
 	FileContent* currentFileContentToTransfer = nullptr;
 
 	belle_http_request_t *httpRequest = nullptr;
 	belle_http_request_listener_t *httpListener = nullptr;
 	belle_http_provider_t *provider  = nullptr;
 
+	// Interrupted downloads to a file are resumed with a Range request, validated by If-Range. The validator is stored
+	// in the app data of the file transfer content, so that it survives a reload of the message from the database.
+	// Uploads are not resumed: the file transfer server only accepts a whole file in a single POST.
+	FileTransferContent *resumeContent = nullptr;
+	std::string resumeValidator;
+	size_t resumeOffset = 0;
+	bctbx_vfs_file_t *resumedFile = nullptr;
+
+	// Scratch buffer for the IM encryption engine, reused from one chunk to the next.
+	std::vector<uint8_t> cryptoBuffer;
+
+	// Source of the file being uploaded when it is given by path.
+	FileReader uploadReader;
+
+	// The thumbnail of a file is uploaded once the file is, its file-info is then added to the one of the file.
+	bool uploadingThumbnail = false;
+	FileTransferContent *uploadedFileTransferContent = nullptr;
+	// Thumbnail made by the core in its data path, removed when it is no longer needed.
+	std::string generatedThumbnailPath;
+
+	// Makes the thumbnail of a JPEG image sent without one, when enabled by [misc] file_transfer_generate_thumbnails.
+	ThumbnailGenerator thumbnailGenerator;
+
 	BackgroundTask bgTask;
+
+	bool scheduled = false;
+	std::weak_ptr<Core> scheduledCore;
+	FileTransferScheduler::Direction scheduledDirection = FileTransferScheduler::Direction::Download;
 };
 
 LINPHONE_END_NAMESPACE
@@ -17,7 +17,14 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
 #include "linphone/utils/algorithm.h"
+#include "linphone/utils/utils.h"
 
 #include "chat/chat-message/imdn-message-p.h"
 #include "chat/chat-room/chat-room-p.h"
@@ -36,8 +43,213 @@ LINPHONE_BEGIN_NAMESPACE
 
 // -----------------------------------------------------------------------------
 
+namespace {
+	// Size of an IMDN part once wrapped in a multipart body, used to estimate the size of aggregated messages.
+	constexpr size_t EstimatedNotificationSize = 360;
+
+	constexpr char ImdnNamespace[] = "urn:ietf:params:xml:ns:imdn";
+	constexpr char LinphoneImdnNamespace[] = "http://www.linphone.org/xsds/imdn.xsd";
+
+	inline bool isXmlWhitespace (char c) {
+		return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n');
+	}
+
+	bool isXmlWhitespace (const char *begin, const char *end) {
+		for (; begin < end; begin++) {
+			if (!isXmlWhitespace(*begin))
+				return false;
+		}
+		return true;
+	}
+
+	const char *findXml (const char *begin, const char *end, const char *pattern) {
+		size_t patternSize = strlen(pattern);
+		for (; static_cast<size_t>(end - begin) >= patternSize; begin++) {
+			if (strncmp(begin, pattern, patternSize) == 0)
+				return begin;
+		}
+		return nullptr;
+	}
+
+	// Finds the closing '>' of a tag, ignoring the ones found in attribute values.
+	const char *findXmlTagEnd (const char *begin, const char *end) {
+		char quote = '\0';
+		for (; begin < end; begin++) {
+			if (quote) {
+				if (*begin == quote)
+					quote = '\0';
+			} else if ((*begin == '"') || (*begin == '\''))
+				quote = *begin;
+			else if (*begin == '>')
+				return begin;
+		}
+		return nullptr;
+	}
+
+	string getXmlLocalName (const char *begin, const char *end) {
+		const char *colon = static_cast<const char *>(memchr(begin, ':', static_cast<size_t>(end - begin)));
+		return colon ? string(colon + 1, end) : string(begin, end);
+	}
+
+	bool appendUnescapedXml (string &text, const char *begin, const char *end) {
+		while (begin < end) {
+			const char *ampersand = static_cast<const char *>(memchr(begin, '&', static_cast<size_t>(end - begin)));
+			if (!ampersand) {
+				text.append(begin, end);
+				break;
+			}
+			text.append(begin, ampersand);
+			const char *semicolon = static_cast<const char *>(memchr(ampersand, ';', static_cast<size_t>(end - ampersand)));
+			if (!semicolon)
+				return false;
+
+			string entity(ampersand + 1, semicolon);
+			if (entity == "amp")
+				text.push_back('&');
+			else if (entity == "lt")
+				text.push_back('<');
+			else if (entity == "gt")
+				text.push_back('>');
+			else if (entity == "quot")
+				text.push_back('"');
+			else if (entity == "apos")
+				text.push_back('\'');
+			else if ((entity.size() > 1) && (entity[0] == '#')) {
+				// Only ASCII character references, the others need an UTF-8 encoder.
+				unsigned long value = (entity[1] == 'x')
+					? strtoul(entity.c_str() + 2, nullptr, 16)
+					: strtoul(entity.c_str() + 1, nullptr, 10);
+				if ((value == 0) || (value > 0x7f))
+					return false;
+				text.push_back(static_cast<char>(value));
+			} else
+				return false;
+			begin = semicolon + 1;
+		}
+		return true;
+	}
+
+	void appendEscapedXml (string &xml, const string &text) {
+		for (char c : text) {
+			switch (c) {
+				case '&':
+					xml.append("&amp;");
+					break;
+				case '<':
+					xml.append("&lt;");
+					break;
+				case '>':
+					xml.append("&gt;");
+					break;
+				default:
+					xml.push_back(c);
+					break;
+			}
+		}
+	}
+
+	bool findXmlAttribute (const char *begin, const char *end, const string &name, string &value) {
+		while (begin < end) {
+			while ((begin < end) && isXmlWhitespace(*begin))
+				begin++;
+			const char *nameEnd = begin;
+			while ((nameEnd < end) && (*nameEnd != '=') && !isXmlWhitespace(*nameEnd))
+				nameEnd++;
+			const char *quote = nameEnd;
+			while ((quote < end) && ((*quote == '=') || isXmlWhitespace(*quote)))
+				quote++;
+			if ((quote >= end) || ((*quote != '"') && (*quote != '\'')))
+				return false;
+			const char *valueEnd = static_cast<const char *>(memchr(quote + 1, *quote, static_cast<size_t>(end - quote - 1)));
+			if (!valueEnd)
+				return false;
+			if ((static_cast<size_t>(nameEnd - begin) == name.size()) && (strncmp(begin, name.c_str(), name.size()) == 0)) {
+				value.clear();
+				return appendUnescapedXml(value, quote + 1, valueEnd);
+			}
+			begin = valueEnd + 1;
+		}
+		return false;
+	}
+
+	string collapseXmlWhitespace (const string &text) {
+		string result;
+		result.reserve(text.size());
+		bool pendingSpace = false;
+		for (char c : text) {
+			if (isXmlWhitespace(c))
+				pendingSpace = !result.empty();
+			else {
+				if (pendingSpace)
+					result.push_back(' ');
+				pendingSpace = false;
+				result.push_back(c);
+			}
+		}
+		return result;
+	}
+
+	bool parseXmlWithXsd (const string &xml, Imdn::Notification &notification) {
+		istringstream data(xml);
+		unique_ptr<Xsd::Imdn::Imdn> imdn(Xsd::Imdn::parseImdn(data, Xsd::XmlSchema::Flags::dont_validate));
+		if (!imdn)
+			return false;
+
+		notification = Imdn::Notification();
+		notification.messageId = imdn->getMessageId();
+		notification.datetime = imdn->getDatetime();
+		auto &deliveryNotification = imdn->getDeliveryNotification();
+		auto &displayNotification = imdn->getDisplayNotification();
+		if (deliveryNotification.present()) {
+			notification.type = Imdn::Type::Delivery;
+			auto &status = deliveryNotification.get().getStatus();
+			if (status.getDelivered().present())
+				notification.status = Imdn::Status::Delivered;
+			else if (status.getFailed().present())
+				notification.status = Imdn::Status::Failed;
+			else if (status.getForbidden().present())
+				notification.status = Imdn::Status::Forbidden;
+			else if (status.getError().present())
+				notification.status = Imdn::Status::Error;
+		} else if (displayNotification.present()) {
+			notification.type = Imdn::Type::Display;
+			auto &status = displayNotification.get().getStatus();
+			if (status.getDisplayed().present())
+				notification.status = Imdn::Status::Displayed;
+			else if (status.getForbidden().present())
+				notification.status = Imdn::Status::Forbidden;
+			else if (status.getError().present())
+				notification.status = Imdn::Status::Error;
+		}
+		return true;
+	}
+}
+
+// -----------------------------------------------------------------------------
+
 Imdn::Imdn (ChatRoom *chatRoom) : chatRoom(chatRoom) {
 	chatRoom->getCore()->getPrivate()->registerListener(this);
+
+	auto config = linphone_core_get_config(chatRoom->getCore()->getCCore());
+	aggregationAllowed = !!linphone_config_get_bool(config, "misc", "aggregate_imdn", TRUE);
+	aggregationPolicy.displayedDelay = static_cast<unsigned int>(max(0, linphone_config_get_int(
+		config, "misc", "imdn_displayed_aggregation_delay", static_cast<int>(aggregationPolicy.displayedDelay)
+	)));
+	aggregationPolicy.deliveredDelay = static_cast<unsigned int>(max(0, linphone_config_get_int(
+		config, "misc", "imdn_delivered_aggregation_delay", static_cast<int>(aggregationPolicy.deliveredDelay)
+	)));
+	aggregationPolicy.maxCount = static_cast<size_t>(max(1, linphone_config_get_int(
+		config, "misc", "imdn_aggregation_max_count", static_cast<int>(aggregationPolicy.maxCount)
+	)));
+	aggregationPolicy.maxSize = static_cast<size_t>(max(1, linphone_config_get_int(
+		config, "misc", "imdn_aggregation_max_size", static_cast<int>(aggregationPolicy.maxSize)
+	)));
+	aggregationPolicy.retryDelay = static_cast<unsigned int>(max(1, linphone_config_get_int(
+		config, "misc", "imdn_retry_delay", static_cast<int>(aggregationPolicy.retryDelay)
+	)));
+	aggregationPolicy.maxRetries = static_cast<unsigned int>(max(0, linphone_config_get_int(
+		config, "misc", "imdn_max_retries", static_cast<int>(aggregationPolicy.maxRetries)
+	)));
 }
 
 Imdn::~Imdn () {
@@ -48,32 +260,18 @@ Imdn::~Imdn () {
 // -----------------------------------------------------------------------------
 
 void Imdn::notifyDelivery (const shared_ptr<ChatMessage> &message) {
-	if (find(deliveredMessages, message) == deliveredMessages.end()) {
-		deliveredMessages.push_back(message);
+	if (addDelivered(message))
 		startTimer();
-	}
 }
 
 void Imdn::notifyDeliveryError (const shared_ptr<ChatMessage> &message, LinphoneReason reason) {
-	if (
-		findIf(nonDeliveredMessages, [message](const MessageReason &mr) {
-			return message == mr.message;
-		}) == nonDeliveredMessages.end()
-	) {
-		nonDeliveredMessages.emplace_back(message, reason);
+	if (addDeliveryError(message, reason))
 		startTimer();
-	}
 }
 
 void Imdn::notifyDisplay (const shared_ptr<ChatMessage> &message) {
-	auto it = find(deliveredMessages.begin(), deliveredMessages.end(), message);
-	if (it != deliveredMessages.end())
-		deliveredMessages.erase(it);
-
-	if (find(displayedMessages.begin(), displayedMessages.end(), message) == displayedMessages.end()) {
-		displayedMessages.push_back(message);
+	if (addDisplayed(message))
 		startTimer();
-	}
 }
 
 // -----------------------------------------------------------------------------
@@ -96,6 +294,26 @@ void Imdn::onImdnMessageDelivered (const std::shared_ptr<ImdnMessage> &message)
 		nonDeliveredMessages.remove(chatMessage);
 
 	sentImdnMessages.remove(message);
+	retryCount = 0;
+}
+
+void Imdn::onImdnMessageNotDelivered (const std::shared_ptr<ImdnMessage> &message) {
+	if (find(sentImdnMessages, message) == sentImdnMessages.end())
+		return;
+
+	// The notifications of an IMDN that failed for a transient reason are sent again after a growing delay,
+	// the ones rejected by the recipient or failing too many times in a row are dropped.
+	int code = linphone_error_info_get_protocol_code(message->getErrorInfo());
+	if (!isTransientFailure(code) || (retryCount >= aggregationPolicy.maxRetries)) {
+		lWarning() << "Dropping the notifications of IMDN message [" << message << "] that failed with code " << code
+			<< " after " << retryCount << " retries";
+		sentImdnMessages.remove(message);
+		return;
+	}
+
+	requeue(message);
+	retryCount++;
+	startRetryTimer();
 }
 
 // -----------------------------------------------------------------------------
@@ -112,8 +330,11 @@ void Imdn::onGlobalStateChanged (LinphoneGlobalState state) {
 
 void Imdn::onNetworkReachable (bool sipNetworkReachable, bool mediaNetworkReachable) {
 	if (sipNetworkReachable) {
-		// When the SIP network gets up, retry notification
-		sentImdnMessages.clear();
+		// When the SIP network gets up, retry the notifications that have not been acknowledged.
+		while (!sentImdnMessages.empty())
+			requeue(sentImdnMessages.front());
+		retryCount = 0;
+		stopTimer();
 		send();
 	}
 }
@@ -121,75 +342,195 @@ void Imdn::onNetworkReachable (bool sipNetworkReachable, bool mediaNetworkReacha
 // -----------------------------------------------------------------------------
 
 string Imdn::createXml (const string &id, time_t timestamp, Imdn::Type imdnType, LinphoneReason reason) {
+	// Written by hand rather than through Xsd::Imdn::serializeImdn, the output is the same as the one of
+	// the xsd serializer with the dont_pretty_print flag.
 	char *datetime = linphone_timestamp_to_rfc3339_string(timestamp);
-	Xsd::Imdn::Imdn imdn(id, datetime);
+	bool needLinphoneImdnNamespace = (imdnType == Imdn::Type::Delivery) && (reason != LinphoneReasonNone);
+
+	string xml;
+	xml.reserve(384);
+	xml.append("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\" ?>");
+	xml.append("<imdn xmlns=\"").append(ImdnNamespace).append("\"");
+	if (needLinphoneImdnNamespace)
+		xml.append(" xmlns:imdn=\"").append(LinphoneImdnNamespace).append("\"");
+	xml.append("><message-id>");
+	appendEscapedXml(xml, id);
+	xml.append("</message-id><datetime>");
+	appendEscapedXml(xml, datetime);
+	xml.append("</datetime>");
 	ms_free(datetime);
-	bool needLinphoneImdnNamespace = false;
+
 	if (imdnType == Imdn::Type::Delivery) {
-		Xsd::Imdn::Status status;
-		if (reason == LinphoneReasonNone) {
-			auto delivered = Xsd::Imdn::Delivered();
-			status.setDelivered(delivered);
-		} else {
-			auto failed = Xsd::Imdn::Failed();
-			status.setFailed(failed);
-			Xsd::LinphoneImdn::ImdnReason imdnReason(linphone_reason_to_string(reason));
-			imdnReason.setCode(linphone_reason_to_error_code(reason));
-			status.setReason(imdnReason);
-			needLinphoneImdnNamespace = true;
+		xml.append("<delivery-notification><status>");
+		if (reason == LinphoneReasonNone)
+			xml.append("<delivered/>");
+		else {
+			xml.append("<failed/><imdn:reason code=\"");
+			xml.append(Utils::toString(linphone_reason_to_error_code(reason)));
+			xml.append("\">");
+			appendEscapedXml(xml, linphone_reason_to_string(reason));
+			xml.append("</imdn:reason>");
 		}
-		Xsd::Imdn::DeliveryNotification deliveryNotification(status);
-		imdn.setDeliveryNotification(deliveryNotification);
-	} else if (imdnType == Imdn::Type::Display) {
-		Xsd::Imdn::Status1 status;
-		auto displayed = Xsd::Imdn::Displayed();
-		status.setDisplayed(displayed);
-		Xsd::Imdn::DisplayNotification displayNotification(status);
-		imdn.setDisplayNotification(displayNotification);
-	}
+		xml.append("</status></delivery-notification>");
+	} else if (imdnType == Imdn::Type::Display)
+		xml.append("<display-notification><status><displayed/></status></display-notification>");
 
-	stringstream ss;
-	Xsd::XmlSchema::NamespaceInfomap map;
-	map[""].name = "urn:ietf:params:xml:ns:imdn";
-	if (needLinphoneImdnNamespace)
-		map["imdn"].name = "http://www.linphone.org/xsds/imdn.xsd";
-	Xsd::Imdn::serializeImdn(ss, imdn, map, "UTF-8", Xsd::XmlSchema::Flags::dont_pretty_print);
-	return ss.str();
+	xml.append("</imdn>");
+	return xml;
 }
 
 void Imdn::parse (const shared_ptr<ChatMessage> &chatMessage) {
 	shared_ptr<AbstractChatRoom> cr = chatMessage->getChatRoom();
 	for (const auto &content : chatMessage->getPrivate()->getContents()) {
-		istringstream data(content->getBodyAsString());
-		unique_ptr<Xsd::Imdn::Imdn> imdn(Xsd::Imdn::parseImdn(data, Xsd::XmlSchema::Flags::dont_validate));
-		if (!imdn)
+		Notification notification;
+		const string body = content->getBodyAsString();
+		if (!parseXml(body, notification) && !parseXmlWithXsd(body, notification))
 			continue;
-		shared_ptr<ChatMessage> cm = cr->findChatMessage(imdn->getMessageId());
+
+		shared_ptr<ChatMessage> cm = cr->findChatMessage(notification.messageId);
 		if (!cm) {
-			lWarning() << "Received IMDN for unknown message " << imdn->getMessageId();
+			lWarning() << "Received IMDN for unknown message " << notification.messageId;
 		} else {
 			auto policy = linphone_core_get_im_notif_policy(cr->getCore()->getCCore());
 			time_t imdnTime = chatMessage->getTime();
 			const IdentityAddress &participantAddress = chatMessage->getFromAddress().getAddressWithoutGruu();
-			auto &deliveryNotification = imdn->getDeliveryNotification();
-			auto &displayNotification = imdn->getDisplayNotification();
-			if (deliveryNotification.present()) {
-				auto &status = deliveryNotification.get().getStatus();
-				if (status.getDelivered().present() && linphone_im_notif_policy_get_recv_imdn_delivered(policy))
+			if (notification.type == Imdn::Type::Delivery) {
+				if ((notification.status == Status::Delivered) && linphone_im_notif_policy_get_recv_imdn_delivered(policy))
 					cm->getPrivate()->setParticipantState(participantAddress, ChatMessage::State::DeliveredToUser, imdnTime);
-				else if ((status.getFailed().present() || status.getError().present())
+				else if (((notification.status == Status::Failed) || (notification.status == Status::Error))
 					&& linphone_im_notif_policy_get_recv_imdn_delivered(policy)
 				)
 					cm->getPrivate()->setParticipantState(participantAddress, ChatMessage::State::NotDelivered, imdnTime);
-			} else if (displayNotification.present()) {
-				auto &status = displayNotification.get().getStatus();
-				if (status.getDisplayed().present() && linphone_im_notif_policy_get_recv_imdn_displayed(policy))
+			} else if (notification.type == Imdn::Type::Display) {
+				if ((notification.status == Status::Displayed) && linphone_im_notif_policy_get_recv_imdn_displayed(policy))
 					cm->getPrivate()->setParticipantState(participantAddress, ChatMessage::State::Displayed, imdnTime);
 			}
 		}
 	}
 }
 
+bool Imdn::parseXml (const string &xml, Notification &notification) {
+	notification = Notification();
+
+	const char *cur = xml.c_str();
+	const char *end = cur + xml.size();
+	vector<string> elements; // Local names of the currently opened elements.
+	string *text = nullptr;
+	bool rootFound = false;
+	bool messageIdFound = false;
+	bool datetimeFound = false;
+
+	while (cur < end) {
+		const char *tagStart = static_cast<const char *>(memchr(cur, '<', static_cast<size_t>(end - cur)));
+		const char *textEnd = tagStart ? tagStart : end;
+		if (text) {
+			if (!appendUnescapedXml(*text, cur, textEnd))
+				return false;
+		} else if (elements.empty() && !isXmlWhitespace(cur, textEnd))
+			return false;
+		if (!tagStart)
+			break;
+
+		cur = tagStart + 1;
+		if (cur >= end)
+			return false;
+
+		if (*cur == '?') {
+			cur = findXml(cur, end, "?>");
+			if (!cur)
+				return false;
+			cur += 2;
+			continue;
+		}
+
+		if (*cur == '!') {
+			// Comments are skipped, CDATA sections and DTDs are left to the xsd parser.
+			if ((end - cur < 3) || (strncmp(cur, "!--", 3) != 0))
+				return false;
+			cur = findXml(cur + 3, end, "-->");
+			if (!cur)
+				return false;
+			cur += 3;
+			continue;
+		}
+
+		const char *tagEnd = findXmlTagEnd(cur, end);
+		if (!tagEnd)
+			return false;
+
+		if (*cur == '/') {
+			const char *nameEnd = cur + 1;
+			while ((nameEnd < tagEnd) && !isXmlWhitespace(*nameEnd))
+				nameEnd++;
+			if (elements.empty() || (elements.back() != getXmlLocalName(cur + 1, nameEnd)))
+				return false;
+			elements.pop_back();
+			text = nullptr;
+			cur = tagEnd + 1;
+			continue;
+		}
+
+		// Mixed content is not part of the subset.
+		if (text)
+			return false;
+
+		bool selfClosing = (tagEnd[-1] == '/');
+		const char *attributesEnd = selfClosing ? tagEnd - 1 : tagEnd;
+		const char *nameEnd = cur;
+		while ((nameEnd < attributesEnd) && !isXmlWhitespace(*nameEnd))
+			nameEnd++;
+		string localName = getXmlLocalName(cur, nameEnd);
+
+		size_t depth = elements.size();
+		if (depth == 0) {
+			if (rootFound || (localName != "imdn"))
+				return false;
+			const char *colon = static_cast<const char *>(memchr(cur, ':', static_cast<size_t>(nameEnd - cur)));
+			string namespaceAttribute = colon ? "xmlns:" + string(cur, colon) : "xmlns";
+			string rootNamespace;
+			if (!findXmlAttribute(nameEnd, attributesEnd, namespaceAttribute, rootNamespace) || (rootNamespace != ImdnNamespace))
+				return false;
+			rootFound = true;
+		} else if (depth == 1) {
+			if (localName == "message-id") {
+				text = &notification.messageId;
+				messageIdFound = true;
+			} else if (localName == "datetime") {
+				text = &notification.datetime;
+				datetimeFound = true;
+			} else if (localName == "delivery-notification")
+				notification.type = Imdn::Type::Delivery;
+			else if (localName == "display-notification")
+				notification.type = Imdn::Type::Display;
+		} else if ((depth == 3) && (elements[2] == "status") && (notification.status == Status::None)) {
+			if (localName == "forbidden")
+				notification.status = Status::Forbidden;
+			else if (localName == "error")
+				notification.status = Status::Error;
+			else if (elements[1] == "delivery-notification") {
+				if (localName == "delivered")
+					notification.status = Status::Delivered;
+				else if (localName == "failed")
+					notification.status = Status::Failed;
+			} else if ((elements[1] == "display-notification") && (localName == "displayed"))
+				notification.status = Status::Displayed;
+		}
+
+		if (selfClosing)
+			text = nullptr;
+		else
+			elements.push_back(move(localName));
+		cur = tagEnd + 1;
+	}
+
+	if (!rootFound || !elements.empty() || !messageIdFound || !datetimeFound)
+		return false;
+
+	// message-id is a xs:token.
+	notification.messageId = collapseXmlWhitespace(notification.messageId);
+	return true;
+}
+
 // -----------------------------------------------------------------------------
 
 int Imdn::timerExpired (void *data, unsigned int revents) {
@@ -201,73 +542,173 @@ int Imdn::timerExpired (void *data, unsigned int revents) {
 
 // -----------------------------------------------------------------------------
 
+bool Imdn::addDelivered (const shared_ptr<ChatMessage> &message) {
+	// A displayed notification supersedes the delivered one.
+	if (find(displayedMessages, message) != displayedMessages.end())
+		return false;
+	if (find(deliveredMessages, message) != deliveredMessages.end())
+		return false;
+	deliveredMessages.push_back(message);
+	return true;
+}
+
+bool Imdn::addDeliveryError (const shared_ptr<ChatMessage> &message, LinphoneReason reason) {
+	if (
+		findIf(nonDeliveredMessages, [message](const MessageReason &mr) {
+			return message == mr.message;
+		}) != nonDeliveredMessages.end()
+	)
+		return false;
+	nonDeliveredMessages.emplace_back(message, reason);
+	return true;
+}
+
+bool Imdn::addDisplayed (const shared_ptr<ChatMessage> &message) {
+	auto it = find(deliveredMessages, message);
+	if (it != deliveredMessages.end())
+		deliveredMessages.erase(it);
+
+	if (find(displayedMessages, message) != displayedMessages.end())
+		return false;
+	displayedMessages.push_back(message);
+	return true;
+}
+
+size_t Imdn::getMaxAggregatedCount () const {
+	return max(size_t(1), min(aggregationPolicy.maxCount, aggregationPolicy.maxSize / EstimatedNotificationSize));
+}
+
+void Imdn::requeue (const shared_ptr<ImdnMessage> &message) {
+	auto context = message->getPrivate()->getContext();
+	for (const auto &chatMessage : context.deliveredMessages)
+		addDelivered(chatMessage);
+	for (const auto &chatMessage : context.displayedMessages)
+		addDisplayed(chatMessage);
+	for (const auto &mr : context.nonDeliveredMessages)
+		addDeliveryError(mr.message, mr.reason);
+	sentImdnMessages.remove(message);
+}
+
+bool Imdn::isTransientFailure (int code) {
+	// No response at all (e.g. a transport error), request timeout and the server errors that may go away.
+	return (code == 0) || (code == 408) || (code == 480) || (code == 500) || (code == 503) || (code == 504);
+}
+
 bool Imdn::aggregationEnabled () const {
-	auto config = linphone_core_get_config(chatRoom->getCore()->getCCore());
-	return (chatRoom->canHandleCpim() && linphone_config_get_bool(config, "misc", "aggregate_imdn", TRUE));
+	return aggregationAllowed && chatRoom->canHandleCpim();
 }
 
 void Imdn::send () {
 	if (!linphone_core_is_network_reachable(chatRoom->getCore()->getCCore()))
 		return;
 
-	if (!deliveredMessages.empty() || !displayedMessages.empty()) {
-		if (aggregationEnabled()) {
-			auto imdnMessage = chatRoom->getPrivate()->createImdnMessage(deliveredMessages, displayedMessages);
-			sentImdnMessages.push_back(imdnMessage);
-			imdnMessage->getPrivate()->send();
-		} else {
-			list<shared_ptr<ImdnMessage>> imdnMessages;
-			for (const auto &message : deliveredMessages) {
-				list<shared_ptr<ChatMessage>> l;
-				l.push_back(message);
-				imdnMessages.push_back(chatRoom->getPrivate()->createImdnMessage(l, list<shared_ptr<ChatMessage>>()));
-			}
-			for (const auto &message : displayedMessages) {
-				list<shared_ptr<ChatMessage>> l;
-				l.push_back(message);
-				imdnMessages.push_back(chatRoom->getPrivate()->createImdnMessage(list<shared_ptr<ChatMessage>>(), l));
-			}
-			for (const auto &message : imdnMessages) {
-				sentImdnMessages.push_back(message);
-				message->getPrivate()->send();
-			}
-			deliveredMessages.clear();
-			displayedMessages.clear();
-		}
+	if (aggregationEnabled()) {
+		sendAggregated();
+		return;
 	}
-	if (!nonDeliveredMessages.empty()) {
-		if (aggregationEnabled()) {
-			auto imdnMessage = chatRoom->getPrivate()->createImdnMessage(nonDeliveredMessages);
-			sentImdnMessages.push_back(imdnMessage);
-			imdnMessage->getPrivate()->send();
-		} else {
-			list<shared_ptr<ImdnMessage>> imdnMessages;
-			for (const auto &message : nonDeliveredMessages) {
-				list<MessageReason> l;
-				l.push_back(message);
-				imdnMessages.push_back(chatRoom->getPrivate()->createImdnMessage(l));
-			}
-			for (const auto &message : imdnMessages) {
-				sentImdnMessages.push_back(message);
-				message->getPrivate()->send();
-			}
-			nonDeliveredMessages.clear();
-		}
+
+	// Compatibility mode for chat rooms that cannot handle CPIM, one message per notification.
+	list<shared_ptr<ImdnMessage>> imdnMessages;
+	for (const auto &message : deliveredMessages) {
+		list<shared_ptr<ChatMessage>> l;
+		l.push_back(message);
+		imdnMessages.push_back(chatRoom->getPrivate()->createImdnMessage(l, list<shared_ptr<ChatMessage>>()));
+	}
+	for (const auto &message : displayedMessages) {
+		list<shared_ptr<ChatMessage>> l;
+		l.push_back(message);
+		imdnMessages.push_back(chatRoom->getPrivate()->createImdnMessage(list<shared_ptr<ChatMessage>>(), l));
+	}
+	for (const auto &message : nonDeliveredMessages) {
+		list<MessageReason> l;
+		l.push_back(message);
+		imdnMessages.push_back(chatRoom->getPrivate()->createImdnMessage(l));
+	}
+	deliveredMessages.clear();
+	displayedMessages.clear();
+	nonDeliveredMessages.clear();
+	for (const auto &message : imdnMessages) {
+		sentImdnMessages.push_back(message);
+		message->getPrivate()->send();
+	}
+}
+
+void Imdn::sendAggregated () {
+	list<shared_ptr<ImdnMessage>> imdnMessages;
+	size_t maxCount = getMaxAggregatedCount();
+
+	// Displayed notifications are taken first so that they never wait behind a batch of delivered ones.
+	while (!displayedMessages.empty() || !deliveredMessages.empty()) {
+		list<shared_ptr<ChatMessage>> displayed;
+		list<shared_ptr<ChatMessage>> delivered;
+		auto displayedEnd = displayedMessages.begin();
+		advance(displayedEnd, min(maxCount, displayedMessages.size()));
+		displayed.splice(displayed.end(), displayedMessages, displayedMessages.begin(), displayedEnd);
+		auto deliveredEnd = deliveredMessages.begin();
+		advance(deliveredEnd, min(maxCount - displayed.size(), deliveredMessages.size()));
+		delivered.splice(delivered.end(), deliveredMessages, deliveredMessages.begin(), deliveredEnd);
+		imdnMessages.push_back(chatRoom->getPrivate()->createImdnMessage(delivered, displayed));
+	}
+
+	while (!nonDeliveredMessages.empty()) {
+		list<MessageReason> nonDelivered;
+		auto nonDeliveredEnd = nonDeliveredMessages.begin();
+		advance(nonDeliveredEnd, min(maxCount, nonDeliveredMessages.size()));
+		nonDelivered.splice(nonDelivered.end(), nonDeliveredMessages, nonDeliveredMessages.begin(), nonDeliveredEnd);
+		imdnMessages.push_back(chatRoom->getPrivate()->createImdnMessage(nonDelivered));
+	}
+
+	for (const auto &message : imdnMessages) {
+		sentImdnMessages.push_back(message);
+		message->getPrivate()->send();
 	}
 }
 
 void Imdn::startTimer () {
+	// Everything pending is flushed by the retry timer, the thresholds apply again once it has.
+	if (retryPending)
+		return;
+
 	if (!aggregationEnabled()) {
 		// Compatibility mode for basic chat rooms, do not aggregate notifications
 		send();
 		return;
 	}
 
-	unsigned int duration = 500;
-	if (!timer)
-		timer = chatRoom->getCore()->getCCore()->sal->createTimer(timerExpired, this, duration, "imdn timeout");
-	else
-		belle_sip_source_set_timeout(timer, duration);
+	size_t pendingCount = deliveredMessages.size() + displayedMessages.size() + nonDeliveredMessages.size();
+	if (pendingCount >= getMaxAggregatedCount()) {
+		stopTimer();
+		send();
+		return;
+	}
+
+	// The delay is counted from the oldest pending notification, later ones do not postpone the flush.
+	unsigned int delay = displayedMessages.empty() ? aggregationPolicy.deliveredDelay : aggregationPolicy.displayedDelay;
+	uint64_t now = ms_get_cur_time_ms();
+	if (!timer) {
+		firstPendingTime = now;
+		timerDelay = delay;
+		timer = chatRoom->getCore()->getCCore()->sal->createTimer(timerExpired, this, delay, "imdn timeout");
+		bgTask.start(chatRoom->getCore(), 1);
+	} else if (delay < timerDelay) {
+		uint64_t elapsed = now - firstPendingTime;
+		timerDelay = delay;
+		belle_sip_source_set_timeout(timer, (elapsed >= delay) ? 0 : static_cast<unsigned int>(delay - elapsed));
+	}
+}
+
+void Imdn::startRetryTimer () {
+	unsigned int delay = aggregationPolicy.retryDelay;
+	for (unsigned int i = 1; (i < retryCount) && (delay < aggregationPolicy.maxRetryDelay); i++)
+		delay *= 2;
+	delay = min(delay, aggregationPolicy.maxRetryDelay);
+
+	lInfo() << "Retrying IMDN notifications in " << delay << "ms (attempt " << retryCount << ")";
+	stopTimer();
+	firstPendingTime = ms_get_cur_time_ms();
+	timerDelay = delay;
+	retryPending = true;
+	timer = chatRoom->getCore()->getCCore()->sal->createTimer(timerExpired, this, delay, "imdn retry");
 	bgTask.start(chatRoom->getCore(), 1);
 }
 
@@ -279,6 +720,9 @@ void Imdn::stopTimer () {
 		belle_sip_object_unref(timer);
 		timer = nullptr;
 	}
+	timerDelay = 0;
+	firstPendingTime = 0;
+	retryPending = false;
 	bgTask.stop();
 }
 
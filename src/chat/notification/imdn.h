@@ -42,6 +42,33 @@ public:
 		Display
 	};
 
+	enum class Status {
+		None,
+		Delivered,
+		Failed,
+		Forbidden,
+		Error,
+		Displayed
+	};
+
+	struct Notification {
+		std::string messageId;
+		std::string datetime;
+		Type type = Type::Delivery;
+		Status status = Status::None;
+	};
+
+	// Thresholds at which the pending notifications of a chat room are flushed.
+	struct AggregationPolicy {
+		unsigned int displayedDelay = 500; // In milliseconds.
+		unsigned int deliveredDelay = 500; // In milliseconds, also used for delivery errors.
+		size_t maxCount = 1000;
+		size_t maxSize = 256 * 1024; // Estimated size of the IMDN parts of a single message, in bytes.
+		unsigned int retryDelay = 1000; // In milliseconds, doubled after each consecutive failure.
+		unsigned int maxRetryDelay = 60000; // In milliseconds.
+		unsigned int maxRetries = 5; // Consecutive failures after which the notifications are dropped.
+	};
+
 	struct MessageReason {
 		MessageReason (const std::shared_ptr<ChatMessage> &message, LinphoneReason reason)
 			: message(message), reason(reason) {}
@@ -62,21 +89,38 @@ public:
 	void notifyDisplay (const std::shared_ptr<ChatMessage> &message);
 
 	void onImdnMessageDelivered (const std::shared_ptr<ImdnMessage> &message);
+	void onImdnMessageNotDelivered (const std::shared_ptr<ImdnMessage> &message);
 
 	// CoreListener
 	void onGlobalStateChanged (LinphoneGlobalState state) override;
 	void onNetworkReachable (bool sipNetworkReachable, bool mediaNetworkReachable) override;
 
 	bool aggregationEnabled () const;
+	const AggregationPolicy &getAggregationPolicy () const { return aggregationPolicy; }
+	void setAggregationPolicy (const AggregationPolicy &policy) { aggregationPolicy = policy; }
 
 	static std::string createXml (const std::string &id, time_t time, Imdn::Type imdnType, LinphoneReason reason);
 	static void parse (const std::shared_ptr<ChatMessage> &chatMessage);
 
+	// Reads the RFC 5438 subset used by chat rooms without building a DOM.
+	// Returns false for anything outside of it so that the xsd parser can be used instead.
+	static bool parseXml (const std::string &xml, Notification &notification);
+
 private:
 	static int timerExpired (void *data, unsigned int revents);
 
+	bool addDelivered (const std::shared_ptr<ChatMessage> &message);
+	bool addDeliveryError (const std::shared_ptr<ChatMessage> &message, LinphoneReason reason);
+	bool addDisplayed (const std::shared_ptr<ChatMessage> &message);
+	size_t getMaxAggregatedCount () const;
+	void requeue (const std::shared_ptr<ImdnMessage> &message);
+
+	static bool isTransientFailure (int code);
+
 	void send ();
+	void sendAggregated ();
 	void startTimer ();
+	void startRetryTimer ();
 	void stopTimer ();
 
 private:
@@ -86,6 +130,12 @@ private:
 	std::list<MessageReason> nonDeliveredMessages;
 	std::list<std::shared_ptr<ImdnMessage>> sentImdnMessages;
 	belle_sip_source_t *timer = nullptr;
+	unsigned int timerDelay = 0;
+	uint64_t firstPendingTime = 0;
+	unsigned int retryCount = 0;
+	bool retryPending = false;
+	bool aggregationAllowed = true;
+	AggregationPolicy aggregationPolicy;
 	BackgroundTask bgTask { "IMDN sending" };
 };
 
@@ -82,6 +82,40 @@ void IsComposing::parse (const Address &remoteAddr, const string &text) {
 	}
 }
 
+bool IsComposing::canSendNotification (bool isComposing, bool isRefresh) {
+	pendingState = isComposing;
+	if (coalescingTimer)
+		return false; // The state will be sent, if still needed, when the coalescing timer expires.
+
+	// A refresh is only useful if the remote side has been told that we are composing.
+	if (isRefresh)
+		return isComposing && lastSentState;
+
+	if (isComposing == lastSentState)
+		return false;
+
+	uint64_t elapsed = ms_get_cur_time_ms() - lastSentTime;
+	unsigned int minInterval = getCoalescingTimerDuration();
+	if ((lastSentTime != 0) && (elapsed < minInterval)) {
+		coalescingTimer = core->sal->createTimer(coalescingTimerExpired, this,
+			minInterval - static_cast<unsigned int>(elapsed), "composing coalescing timeout");
+		return false;
+	}
+	return true;
+}
+
+void IsComposing::notificationSent (bool isComposing) {
+	lastSentState = isComposing;
+	lastSentTime = ms_get_cur_time_ms();
+}
+
+void IsComposing::resetSentState () {
+	// The remote side considers us idle as soon as it receives a chat message.
+	stopCoalescingTimer();
+	lastSentState = false;
+	pendingState = false;
+}
+
 void IsComposing::startIdleTimer () {
 	unsigned int duration = getIdleTimerDuration();
 	if (!idleTimer) {
@@ -103,6 +137,7 @@ void IsComposing::startRefreshTimer () {
 }
 
 void IsComposing::stopTimers () {
+	stopCoalescingTimer();
 	stopIdleTimer();
 	stopRefreshTimer();
 	stopAllRemoteRefreshTimers();
@@ -110,6 +145,15 @@ void IsComposing::stopTimers () {
 
 // -----------------------------------------------------------------------------
 
+void IsComposing::stopCoalescingTimer () {
+	if (coalescingTimer) {
+		if (core && core->sal)
+			core->sal->cancelTimer(coalescingTimer);
+		belle_sip_object_unref(coalescingTimer);
+		coalescingTimer = nullptr;
+	}
+}
+
 void IsComposing::stopIdleTimer () {
 	if (idleTimer) {
 		if (core && core->sal)
@@ -136,6 +180,11 @@ void IsComposing::stopRemoteRefreshTimer (const string &uri) {
 
 // -----------------------------------------------------------------------------
 
+unsigned int IsComposing::getCoalescingTimerDuration () {
+	int minInterval = lp_config_get_int(core->config, "sip", "composing_min_interval", defaultMinInterval);
+	return minInterval < 0 ? 0 : static_cast<unsigned int>(minInterval);
+}
+
 unsigned int IsComposing::getIdleTimerDuration () {
 	int idleTimerDuration = lp_config_get_int(core->config, "sip", "composing_idle_timeout", defaultIdleTimeout);
 	return idleTimerDuration < 0 ? 0 : static_cast<unsigned int>(idleTimerDuration);
@@ -151,6 +200,14 @@ unsigned int IsComposing::getRemoteRefreshTimerDuration () {
 	return remoteRefreshTimerDuration < 0 ? 0 : static_cast<unsigned int>(remoteRefreshTimerDuration);
 }
 
+int IsComposing::coalescingTimerExpired () {
+	stopCoalescingTimer();
+	// Changes that were reverted during the interval (e.g. idle then composing again) are not sent at all.
+	if (pendingState != lastSentState)
+		listener->onIsComposingStateChanged(pendingState);
+	return BELLE_SIP_STOP;
+}
+
 int IsComposing::idleTimerExpired () {
 	stopRefreshTimer();
 	stopIdleTimer();
@@ -199,6 +256,11 @@ unordered_map<string, belle_sip_source_t *>::iterator IsComposing::stopRemoteRef
 	return remoteRefreshTimers.erase(it);
 }
 
+int IsComposing::coalescingTimerExpired (void *data, unsigned int revents) {
+	IsComposing *d = reinterpret_cast<IsComposing *>(data);
+	return d->coalescingTimerExpired();
+}
+
 int IsComposing::idleTimerExpired (void *data, unsigned int revents) {
 	IsComposing *d = reinterpret_cast<IsComposing *>(data);
 	return d->idleTimerExpired();
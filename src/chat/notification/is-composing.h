@@ -40,17 +40,28 @@ public:
 
 	std::string createXml (bool isComposing);
 	void parse (const Address &remoteAddr, const std::string &content);
+
+	// Rate limiting of the outgoing notifications: a state change happening less than
+	// sip/composing_min_interval ms after the previous notification is deferred, and only
+	// the state still current when the interval elapses is sent.
+	bool canSendNotification (bool isComposing, bool isRefresh);
+	void notificationSent (bool isComposing);
+	void resetSentState ();
+
 	void startIdleTimer ();
 	void startRefreshTimer ();
 	void stopIdleTimer ();
 	void stopRefreshTimer ();
 	void stopRemoteRefreshTimer (const std::string &uri);
+	void stopCoalescingTimer ();
 	void stopTimers ();
 
 private:
+	unsigned int getCoalescingTimerDuration ();
 	unsigned int getIdleTimerDuration ();
 	unsigned int getRefreshTimerDuration ();
 	unsigned int getRemoteRefreshTimerDuration ();
+	int coalescingTimerExpired ();
 	int idleTimerExpired ();
 	int refreshTimerExpired ();
 	int remoteRefreshTimerExpired (const std::string &uri);
@@ -58,6 +69,7 @@ private:
 	void stopAllRemoteRefreshTimers ();
 	std::unordered_map<std::string, belle_sip_source_t *>::iterator stopRemoteRefreshTimer (const std::unordered_map<std::string, belle_sip_source_t *>::const_iterator it);
 
+	static int coalescingTimerExpired (void *data, unsigned int revents);
 	static int idleTimerExpired (void *data, unsigned int revents);
 	static int refreshTimerExpired (void *data, unsigned int revents);
 	static int remoteRefreshTimerExpired (void *data, unsigned int revents);
@@ -66,12 +78,17 @@ private:
 	static const int defaultIdleTimeout = 15;
 	static const int defaultRefreshTimeout = 60;
 	static const int defaultRemoteRefreshTimeout = 120;
+	static const int defaultMinInterval = 2000;
 
 	LinphoneCore *core = nullptr;
 	IsComposingListener *listener = nullptr;
 	std::unordered_map<std::string, belle_sip_source_t *>remoteRefreshTimers;
 	belle_sip_source_t *idleTimer = nullptr;
 	belle_sip_source_t *refreshTimer = nullptr;
+	belle_sip_source_t *coalescingTimer = nullptr;
+	uint64_t lastSentTime = 0;
+	bool lastSentState = false;
+	bool pendingState = false;
 };
 
 LINPHONE_END_NAMESPACE
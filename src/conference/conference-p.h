@@ -34,9 +34,16 @@ class ConferencePrivate {
 public:
 	virtual ~ConferencePrivate () = default;
 
+	void setConferenceAddress (const IdentityAddress &address) {
+		conferenceAddress = address;
+		stateRevision++;
+	}
+
 	IdentityAddress conferenceAddress;
 	std::list<std::shared_ptr<Participant>> participants;
 	std::string subject;
+	// Bumped whenever the address, the subject, the participants, their admin status or devices change.
+	unsigned int stateRevision = 0;
 
 protected:
 	std::shared_ptr<Participant> activeParticipant;
@@ -98,6 +98,11 @@ const string &Conference::getSubject () const {
 	return d->subject;
 }
 
+unsigned int Conference::getStateRevision () const {
+	L_D();
+	return d->stateRevision;
+}
+
 void Conference::join () {}
 
 void Conference::leave () {}
@@ -118,6 +123,7 @@ void Conference::setParticipantAdminStatus (const shared_ptr<Participant> &parti
 void Conference::setSubject (const string &subject) {
 	L_D();
 	d->subject = subject;
+	d->stateRevision++;
 }
 
 // -----------------------------------------------------------------------------
@@ -42,6 +42,7 @@ class LINPHONE_PUBLIC Conference :
 	public ConferenceListener,
 	public CoreAccessor {
 	friend class CallSessionPrivate;
+	friend class ParticipantPrivate;
 
 public:
 	~Conference();
@@ -61,6 +62,7 @@ public:
 	int getParticipantCount () const override;
 	const std::list<std::shared_ptr<Participant>> &getParticipants () const override;
 	const std::string &getSubject () const override;
+	unsigned int getStateRevision () const;
 	void join () override;
 	void leave () override;
 	void removeParticipant (const std::shared_ptr<Participant> &participant) override;
@@ -20,9 +20,12 @@
 #ifndef _L_LOCAL_CONFERENCE_EVENT_HANDLER_P_H_
 #define _L_LOCAL_CONFERENCE_EVENT_HANDLER_P_H_
 
+#include <deque>
 #include <string>
 
 #include "chat/chat-room/chat-room-id.h"
+#include "containers/lru-cache.h"
+#include "content/content.h"
 #include "local-conference-event-handler.h"
 #include "object/object-p.h"
 #include "xml/conference-info.h"
@@ -37,6 +40,8 @@ public:
 	void notifyFullState (const std::string &notify, const std::shared_ptr<ParticipantDevice> &device);
 	void notifyAllExcept (const std::string &notify, const std::shared_ptr<Participant> &exceptParticipant);
 	void notifyAll (const std::string &notify);
+	const std::string &getNotifyFullState (bool oneToOne = false);
+	const std::string &getNotifyMultipart (int notifyId);
 	std::string createNotifyFullState (int notifyId = -1, bool oneToOne = false);
 	std::string createNotifyMultipart (int notifyId);
 	std::string createNotifyParticipantAdded (const Address &addr, int notifyId = -1);
@@ -47,19 +52,47 @@ public:
 	std::string createNotifySubjectChanged (int notifyId = -1);
 
 	inline unsigned int getLastNotify () const { return lastNotify; };
+	void invalidateNotifyCache ();
 
 	static void notifyResponseCb (const LinphoneEvent *ev);
 
 private:
 	ChatRoomId chatRoomId;
 
+	// Serialized NOTIFY bodies are shared by all subscribers of a given conference version.
+	struct FullStateCacheEntry {
+		unsigned int version = 0;
+		unsigned int stateRevision = 0;
+		std::string body;
+	};
+
+	static constexpr int PartialNotifyCacheCapacity = 100;
+	static constexpr int MultipartNotifyCacheCapacity = 20;
+	static constexpr int DefaultNotifiedEventRingCapacity = 100;
+
 	LocalConference *conf = nullptr;
 	unsigned int lastNotify = 1;
 
+	FullStateCacheEntry fullStateCache[2]; // Indexed by the one-to-one flag.
+
+	// Serialized partial NOTIFYs of the last notified events, with contiguous notify ids ending at lastNotify.
+	std::deque<std::pair<unsigned int, std::string>> notifiedEventRing;
+	size_t notifiedEventRingCapacity = DefaultNotifiedEventRingCapacity;
+
+	// Partial NOTIFYs rebuilt from the database for versions older than the ring.
+	LruCache<unsigned int, std::string> partialNotifyCache { PartialNotifyCacheCapacity };
+	LruCache<unsigned int, std::string> multipartNotifyCache { MultipartNotifyCacheCapacity };
+	unsigned int multipartNotifyCacheVersion = 0;
+
+	void addNotifiedEventToRing (unsigned int notifyId, const std::string &notify);
+	bool getNotifiedEventsFromRing (unsigned int notifyId, std::list<Content> &contents) const;
+	void getNotifiedEventsFromDb (unsigned int notifyId, std::list<Content> &contents);
+	Content createNotifyContent (const std::string &notify, bool multipart = false) const;
 	std::string createNotify (Xsd::ConferenceInfo::ConferenceType confInfo, int notifyId = -1, bool isFullState = false);
 	std::string createNotifySubjectChanged (const std::string &subject, int notifyId = -1);
-	void notifyParticipant (const std::string &notify, const std::shared_ptr<Participant> &participant);
+	void notifyParticipant (const Content &content, const std::shared_ptr<Participant> &participant);
 	void notifyParticipantDevice (const std::string &notify, const std::shared_ptr<ParticipantDevice> &device, bool multipart = false);
+	void notifyParticipantDevice (const Content &content, const std::shared_ptr<ParticipantDevice> &device);
 
 	L_DECLARE_PUBLIC(LocalConferenceEventHandler);
 };
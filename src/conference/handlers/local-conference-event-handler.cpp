@@ -17,6 +17,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <algorithm>
 #include <ctime>
 
 #include "linphone/api/c-content.h"
@@ -33,6 +34,7 @@
 #include "db/main-db.h"
 #include "event-log/events.h"
 #include "local-conference-event-handler-p.h"
+#include "local-conference-list-event-handler.h"
 #include "logger/logger.h"
 #include "object/object-p.h"
 
@@ -54,15 +56,55 @@ void LocalConferenceEventHandlerPrivate::notifyFullState (const string &notify,
 }
 
 void LocalConferenceEventHandlerPrivate::notifyAllExcept (const string &notify, const shared_ptr<Participant> &exceptParticipant) {
+	if (notify.empty())
+		return;
+
+	Content content = createNotifyContent(notify);
 	for (const auto &participant : conf->getParticipants()) {
 		if (participant != exceptParticipant)
-			notifyParticipant(notify, participant);
+			notifyParticipant(content, participant);
 	}
 }
 
 void LocalConferenceEventHandlerPrivate::notifyAll (const string &notify) {
+	if (notify.empty())
+		return;
+
+	Content content = createNotifyContent(notify);
 	for (const auto &participant : conf->getParticipants())
-		notifyParticipant(notify, participant);
+		notifyParticipant(content, participant);
+}
+
+const string &LocalConferenceEventHandlerPrivate::getNotifyFullState (bool oneToOne) {
+	// Participants and devices may be updated before the corresponding NOTIFY is sent (or without any NOTIFY
+	// at all for one-to-one chat rooms), so the version alone is not enough to validate a full state body.
+	FullStateCacheEntry &entry = fullStateCache[oneToOne ? 1 : 0];
+	unsigned int stateRevision = conf->getStateRevision();
+	if (entry.body.empty() || (entry.version != lastNotify) || (entry.stateRevision != stateRevision)) {
+		entry.body = createNotifyFullState(static_cast<int>(lastNotify), oneToOne);
+		entry.version = lastNotify;
+		entry.stateRevision = stateRevision;
+	}
+	return entry.body;
+}
+
+const string &LocalConferenceEventHandlerPrivate::getNotifyMultipart (int notifyId) {
+	if (multipartNotifyCacheVersion != lastNotify) {
+		multipartNotifyCache.clear();
+		multipartNotifyCacheVersion = lastNotify;
+	}
+
+	unsigned int key = static_cast<unsigned int>(notifyId);
+	const string *cachedBody = multipartNotifyCache[key];
+	if (cachedBody)
+		return *cachedBody;
+
+	string multipart = createNotifyMultipart(notifyId);
+	if (multipart.empty())
+		return Utils::getEmptyConstRefObject<string>();
+
+	multipartNotifyCache.insert(key, move(multipart));
+	return *multipartNotifyCache[key];
 }
 
 string LocalConferenceEventHandlerPrivate::createNotifyFullState (int notifyId, bool oneToOne) {
@@ -104,88 +146,9 @@ string LocalConferenceEventHandlerPrivate::createNotifyFullState (int notifyId,
 }
 
 string LocalConferenceEventHandlerPrivate::createNotifyMultipart (int notifyId) {
-	list<shared_ptr<EventLog>> events = conf->getCore()->getPrivate()->mainDb->getConferenceNotifiedEvents(
-		ChatRoomId(conf->getConferenceAddress(), conf->getConferenceAddress()),
-		static_cast<unsigned int>(notifyId)
-	);
-
 	list<Content> contents;
-	for (const auto &eventLog : events) {
-		Content *content = new Content();
-		content->setContentType(ContentType::ConferenceInfo);
-		string body;
-		shared_ptr<ConferenceNotifiedEvent> notifiedEvent = static_pointer_cast<ConferenceNotifiedEvent>(eventLog);
-		int eventNotifyId = static_cast<int>(notifiedEvent->getNotifyId());
-		switch (eventLog->getType()) {
-			case EventLog::Type::ConferenceParticipantAdded: {
-				shared_ptr<ConferenceParticipantEvent> addedEvent = static_pointer_cast<ConferenceParticipantEvent>(eventLog);
-				body = createNotifyParticipantAdded(
-					addedEvent->getParticipantAddress(),
-					eventNotifyId
-				);
-			} break;
-
-			case EventLog::Type::ConferenceParticipantRemoved: {
-				shared_ptr<ConferenceParticipantEvent> removedEvent = static_pointer_cast<ConferenceParticipantEvent>(eventLog);
-				body = createNotifyParticipantRemoved(
-					removedEvent->getParticipantAddress(),
-					eventNotifyId
-				);
-			} break;
-
-			case EventLog::Type::ConferenceParticipantSetAdmin: {
-				shared_ptr<ConferenceParticipantEvent> setAdminEvent = static_pointer_cast<ConferenceParticipantEvent>(eventLog);
-				body = createNotifyParticipantAdminStatusChanged(
-					setAdminEvent->getParticipantAddress(),
-					true,
-					eventNotifyId
-				);
-			} break;
-
-			case EventLog::Type::ConferenceParticipantUnsetAdmin: {
-				shared_ptr<ConferenceParticipantEvent> unsetAdminEvent = static_pointer_cast<ConferenceParticipantEvent>(eventLog);
-				body = createNotifyParticipantAdminStatusChanged(
-					unsetAdminEvent->getParticipantAddress(),
-					false,
-					eventNotifyId
-				);
-			} break;
-
-			case EventLog::Type::ConferenceParticipantDeviceAdded: {
-				shared_ptr<ConferenceParticipantDeviceEvent> deviceAddedEvent = static_pointer_cast<ConferenceParticipantDeviceEvent>(eventLog);
-				body = createNotifyParticipantDeviceAdded(
-					deviceAddedEvent->getParticipantAddress(),
-					deviceAddedEvent->getDeviceAddress(),
-					eventNotifyId
-				);
-			} break;
-
-			case EventLog::Type::ConferenceParticipantDeviceRemoved: {
-				shared_ptr<ConferenceParticipantDeviceEvent> deviceRemovedEvent = static_pointer_cast<ConferenceParticipantDeviceEvent>(eventLog);
-				body = createNotifyParticipantDeviceRemoved(
-					deviceRemovedEvent->getParticipantAddress(),
-					deviceRemovedEvent->getDeviceAddress(),
-					eventNotifyId
-				);
-			} break;
-
-			case EventLog::Type::ConferenceSubjectChanged: {
-				shared_ptr<ConferenceSubjectEvent> subjectEvent = static_pointer_cast<ConferenceSubjectEvent>(eventLog);
-				body = createNotifySubjectChanged(
-					subjectEvent->getSubject(),
-					eventNotifyId
-				);
-			} break;
-
-			default:
-				// We should never pass here!
-				L_ASSERT(false);
-				continue;
-		}
-		contents.emplace_back(Content());
-		contents.back().setContentType(ContentType::ConferenceInfo);
-		contents.back().setBody(body);
-	}
+	if (!getNotifiedEventsFromRing(static_cast<unsigned int>(notifyId), contents))
+		getNotifiedEventsFromDb(static_cast<unsigned int>(notifyId), contents);
 
 	if (contents.empty())
 		return Utils::getEmptyConstRefObject<string>();
@@ -304,6 +267,14 @@ string LocalConferenceEventHandlerPrivate::createNotifySubjectChanged (int notif
 	return createNotifySubjectChanged(conf->getSubject(), notifyId);
 }
 
+void LocalConferenceEventHandlerPrivate::invalidateNotifyCache () {
+	for (auto &entry : fullStateCache)
+		entry = FullStateCacheEntry();
+	notifiedEventRing.clear();
+	partialNotifyCache.clear();
+	multipartNotifyCache.clear();
+}
+
 // -----------------------------------------------------------------------------
 
 void LocalConferenceEventHandlerPrivate::notifyResponseCb (const LinphoneEvent *ev) {
@@ -329,6 +300,140 @@ void LocalConferenceEventHandlerPrivate::notifyResponseCb (const LinphoneEvent *
 
 // -----------------------------------------------------------------------------
 
+Content LocalConferenceEventHandlerPrivate::createNotifyContent (const string &notify, bool multipart) const {
+	Content content;
+	content.setBody(notify);
+	ContentType contentType;
+	if (multipart) {
+		contentType = ContentType(ContentType::Multipart);
+		contentType.addParameter("boundary", MultipartBoundary);
+	} else
+		contentType = ContentType(ContentType::ConferenceInfo);
+
+	content.setContentType(contentType);
+	if (linphone_core_should_apply_content_encoding(conf->getCore()->getCCore(), "deflate", notify.size()))
+		content.setContentEncoding("deflate");
+	return content;
+}
+
+void LocalConferenceEventHandlerPrivate::addNotifiedEventToRing (unsigned int notifyId, const string &notify) {
+	if (notifiedEventRingCapacity == 0)
+		return;
+
+	// The ring must only contain contiguous notify ids, otherwise a missed event would not be sent.
+	if (!notifiedEventRing.empty() && (notifiedEventRing.back().first + 1 != notifyId))
+		notifiedEventRing.clear();
+
+	notifiedEventRing.emplace_back(notifyId, notify);
+	while (notifiedEventRing.size() > notifiedEventRingCapacity)
+		notifiedEventRing.pop_front();
+}
+
+bool LocalConferenceEventHandlerPrivate::getNotifiedEventsFromRing (unsigned int notifyId, list<Content> &contents) const {
+	if (notifiedEventRing.empty() || (notifiedEventRing.back().first != lastNotify) || (notifiedEventRing.front().first > notifyId + 1))
+		return false;
+
+	for (const auto &fragment : notifiedEventRing) {
+		if (fragment.first <= notifyId)
+			continue;
+		contents.emplace_back(Content());
+		contents.back().setContentType(ContentType::ConferenceInfo);
+		contents.back().setBody(fragment.second);
+	}
+	return true;
+}
+
+void LocalConferenceEventHandlerPrivate::getNotifiedEventsFromDb (unsigned int notifyId, list<Content> &contents) {
+	list<shared_ptr<EventLog>> events = conf->getCore()->getPrivate()->mainDb->getConferenceNotifiedEvents(
+		ChatRoomId(conf->getConferenceAddress(), conf->getConferenceAddress()),
+		notifyId
+	);
+
+	for (const auto &eventLog : events) {
+		string body;
+		shared_ptr<ConferenceNotifiedEvent> notifiedEvent = static_pointer_cast<ConferenceNotifiedEvent>(eventLog);
+		int eventNotifyId = static_cast<int>(notifiedEvent->getNotifyId());
+		const string *cachedBody = partialNotifyCache[notifiedEvent->getNotifyId()];
+		if (cachedBody) {
+			contents.emplace_back(Content());
+			contents.back().setContentType(ContentType::ConferenceInfo);
+			contents.back().setBody(*cachedBody);
+			continue;
+		}
+
+		switch (eventLog->getType()) {
+			case EventLog::Type::ConferenceParticipantAdded: {
+				shared_ptr<ConferenceParticipantEvent> addedEvent = static_pointer_cast<ConferenceParticipantEvent>(eventLog);
+				body = createNotifyParticipantAdded(
+					addedEvent->getParticipantAddress(),
+					eventNotifyId
+				);
+			} break;
+
+			case EventLog::Type::ConferenceParticipantRemoved: {
+				shared_ptr<ConferenceParticipantEvent> removedEvent = static_pointer_cast<ConferenceParticipantEvent>(eventLog);
+				body = createNotifyParticipantRemoved(
+					removedEvent->getParticipantAddress(),
+					eventNotifyId
+				);
+			} break;
+
+			case EventLog::Type::ConferenceParticipantSetAdmin: {
+				shared_ptr<ConferenceParticipantEvent> setAdminEvent = static_pointer_cast<ConferenceParticipantEvent>(eventLog);
+				body = createNotifyParticipantAdminStatusChanged(
+					setAdminEvent->getParticipantAddress(),
+					true,
+					eventNotifyId
+				);
+			} break;
+
+			case EventLog::Type::ConferenceParticipantUnsetAdmin: {
+				shared_ptr<ConferenceParticipantEvent> unsetAdminEvent = static_pointer_cast<ConferenceParticipantEvent>(eventLog);
+				body = createNotifyParticipantAdminStatusChanged(
+					unsetAdminEvent->getParticipantAddress(),
+					false,
+					eventNotifyId
+				);
+			} break;
+
+			case EventLog::Type::ConferenceParticipantDeviceAdded: {
+				shared_ptr<ConferenceParticipantDeviceEvent> deviceAddedEvent = static_pointer_cast<ConferenceParticipantDeviceEvent>(eventLog);
+				body = createNotifyParticipantDeviceAdded(
+					deviceAddedEvent->getParticipantAddress(),
+					deviceAddedEvent->getDeviceAddress(),
+					eventNotifyId
+				);
+			} break;
+
+			case EventLog::Type::ConferenceParticipantDeviceRemoved: {
+				shared_ptr<ConferenceParticipantDeviceEvent> deviceRemovedEvent = static_pointer_cast<ConferenceParticipantDeviceEvent>(eventLog);
+				body = createNotifyParticipantDeviceRemoved(
+					deviceRemovedEvent->getParticipantAddress(),
+					deviceRemovedEvent->getDeviceAddress(),
+					eventNotifyId
+				);
+			} break;
+
+			case EventLog::Type::ConferenceSubjectChanged: {
+				shared_ptr<ConferenceSubjectEvent> subjectEvent = static_pointer_cast<ConferenceSubjectEvent>(eventLog);
+				body = createNotifySubjectChanged(
+					subjectEvent->getSubject(),
+					eventNotifyId
+				);
+			} break;
+
+			default:
+				// We should never pass here!
+				L_ASSERT(false);
+				continue;
+		}
+		partialNotifyCache.insert(notifiedEvent->getNotifyId(), body);
+		contents.emplace_back(Content());
+		contents.back().setContentType(ContentType::ConferenceInfo);
+		contents.back().setBody(body);
+	}
+}
+
 string LocalConferenceEventHandlerPrivate::createNotify (ConferenceType confInfo, int notifyId, bool isFullState) {
 	confInfo.setVersion(notifyId == -1 ? ++lastNotify : static_cast<unsigned int>(notifyId));
 	confInfo.setState(isFullState ? StateType::full : StateType::partial);
@@ -345,7 +450,10 @@ string LocalConferenceEventHandlerPrivate::createNotify (ConferenceType confInfo
 	Xsd::XmlSchema::NamespaceInfomap map;
 	map[""].name = "urn:ietf:params:xml:ns:conference-info";
 	serializeConferenceInfo(notify, confInfo, map);
-	return notify.str();
+	string body = notify.str();
+	if (!isFullState && (notifyId == -1))
+		addNotifiedEventToRing(lastNotify, body);
+	return body;
 }
 
 string LocalConferenceEventHandlerPrivate::createNotifySubjectChanged (const string &subject, int notifyId) {
@@ -358,32 +466,27 @@ string LocalConferenceEventHandlerPrivate::createNotifySubjectChanged (const str
 	return createNotify(confInfo, notifyId);
 }
 
-void LocalConferenceEventHandlerPrivate::notifyParticipant (const string &notify, const shared_ptr<Participant> &participant) {
+void LocalConferenceEventHandlerPrivate::notifyParticipant (const Content &content, const shared_ptr<Participant> &participant) {
 	for (const auto &device : participant->getPrivate()->getDevices())
-		notifyParticipantDevice(notify, device);
+		notifyParticipantDevice(content, device);
 }
 
 void LocalConferenceEventHandlerPrivate::notifyParticipantDevice (const string &notify, const shared_ptr<ParticipantDevice> &device, bool multipart) {
 	if (!device->isSubscribedToConferenceEventPackage() || notify.empty())
 		return;
 
+	notifyParticipantDevice(createNotifyContent(notify, multipart), device);
+}
+
+void LocalConferenceEventHandlerPrivate::notifyParticipantDevice (const Content &content, const shared_ptr<ParticipantDevice> &device) {
+	if (!device->isSubscribedToConferenceEventPackage() || content.isEmpty())
+		return;
+
 	LinphoneEvent *ev = device->getConferenceSubscribeEvent();
 	LinphoneEventCbs *cbs = linphone_event_get_callbacks(ev);
 	linphone_event_cbs_set_user_data(cbs, this);
 	linphone_event_cbs_set_notify_response(cbs, notifyResponseCb);
 
-	Content content;
-	content.setBody(notify);
-	ContentType contentType;
-	if (multipart) {
-		contentType = ContentType(ContentType::Multipart);
-		contentType.addParameter("boundary", MultipartBoundary);
-	} else
-		contentType = ContentType(ContentType::ConferenceInfo);
-
-	content.setContentType(contentType);
-	if (linphone_core_content_encoding_supported(conf->getCore()->getCCore(), "deflate"))
-		content.setContentEncoding("deflate");
 	LinphoneContent *cContent = L_GET_C_BACK_PTR(&content);
 	linphone_event_notify(ev, cContent);
 }
@@ -395,6 +498,12 @@ LocalConferenceEventHandler::LocalConferenceEventHandler (LocalConference *local
 	L_D();
 	d->conf = localConference;
 	d->lastNotify = notify;
+	d->notifiedEventRingCapacity = static_cast<size_t>(max(0, lp_config_get_int(
+		linphone_core_get_config(localConference->getCore()->getCCore()),
+		"misc",
+		"conference_event_ring_size",
+		LocalConferenceEventHandlerPrivate::DefaultNotifiedEventRingCapacity
+	)));
 }
 
 // -----------------------------------------------------------------------------
@@ -429,11 +538,11 @@ void LocalConferenceEventHandler::subscribeReceived (LinphoneEvent *lev, bool on
 		device->setConferenceSubscribeEvent(lev);
 		if (lastNotify == 0 || (device->getState() == ParticipantDevice::State::Joining)) {
 			lInfo() << "Sending initial notify of conference [" << d->conf->getConferenceAddress() << "] to: " << device->getAddress();
-			d->notifyFullState(d->createNotifyFullState(static_cast<int>(d->lastNotify), oneToOne), device);
+			d->notifyFullState(d->getNotifyFullState(oneToOne), device);
 		} else if (lastNotify < d->lastNotify) {
 			lInfo() << "Sending all missed notify [" << lastNotify << "-" << d->lastNotify <<
 				"] for conference [" << d->conf->getConferenceAddress() << "] to: " << participant->getAddress();
-			d->notifyParticipantDevice(d->createNotifyMultipart(static_cast<int>(lastNotify)), device, true);
+			d->notifyParticipantDevice(d->getNotifyMultipart(static_cast<int>(lastNotify)), device, true);
 		} else if (lastNotify > d->lastNotify) {
 			lError() << "Last notify received by client [" << lastNotify << "] for conference [" <<
 				d->conf->getConferenceAddress() <<
@@ -527,11 +636,15 @@ shared_ptr<ConferenceParticipantDeviceEvent> LocalConferenceEventHandler::notify
 void LocalConferenceEventHandler::setLastNotify (unsigned int lastNotify) {
 	L_D();
 	d->lastNotify = lastNotify;
+	d->invalidateNotifyCache();
 }
 
 void LocalConferenceEventHandler::setChatRoomId (const ChatRoomId &chatRoomId) {
 	L_D();
 	d->chatRoomId = chatRoomId;
+	const unique_ptr<LocalConferenceListEventHandler> &listHandler = d->conf->getCore()->getPrivate()->localListEventHandler;
+	if (listHandler)
+		listHandler->updateHandler(this);
 }
 
 ChatRoomId LocalConferenceEventHandler::getChatRoomId () const {
@@ -539,12 +652,12 @@ ChatRoomId LocalConferenceEventHandler::getChatRoomId () const {
 	return d->chatRoomId;
 }
 
-string LocalConferenceEventHandler::getNotifyForId (int notifyId, bool oneToOne) {
+const string &LocalConferenceEventHandler::getNotifyForId (int notifyId, bool oneToOne) {
 	L_D();
 	if (notifyId == 0)
-		return d->createNotifyFullState(static_cast<int>(d->lastNotify), oneToOne);
+		return d->getNotifyFullState(oneToOne);
 	else if (notifyId < static_cast<int>(d->lastNotify))
-		return d->createNotifyMultipart(notifyId);
+		return d->getNotifyMultipart(notifyId);
 
 	return Utils::getEmptyConstRefObject<string>();
 }
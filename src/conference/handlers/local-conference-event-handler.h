@@ -54,7 +54,8 @@ public:
 	void setChatRoomId (const ChatRoomId &chatRoomId);
 	ChatRoomId getChatRoomId () const;
 
-	std::string getNotifyForId (int notifyId, bool oneToOne = false);
+	// The returned body is owned by the handler cache and stays valid until the next conference change.
+	const std::string &getNotifyForId (int notifyId, bool oneToOne = false);
 
 private:
 	L_DECLARE_PRIVATE(LocalConferenceEventHandler);
@@ -17,6 +17,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <iterator>
+
 #include "belle-sip/utils.h"
 #include "linphone/enums/chat-room-enums.h"
 #include "linphone/utils/utils.h"
@@ -30,12 +32,13 @@
 #include "content/content.h"
 #include "content/content-manager.h"
 #include "content/content-type.h"
+#include "content/header/header.h"
+#include "content/multipart-builder.h"
 #include "core/core.h"
 #include "local-conference-event-handler-p.h"
 #include "local-conference-list-event-handler.h"
 #include "logger/logger.h"
 #include "xml/resource-lists.h"
-#include "xml/rlmi.h"
 
 // TODO: Remove me later.
 #include "private.h"
@@ -48,6 +51,39 @@ LINPHONE_BEGIN_NAMESPACE
 
 namespace {
 	constexpr const char MultipartBoundaryListEventHandler[] = "---------------------------14737809831412343453453";
+
+	// Room for the closing delimiter of the multipart body.
+	constexpr size_t MultipartTrailerReserve = 128;
+
+	string escapeXmlAttribute (const string &value) {
+		string escaped;
+		escaped.reserve(value.size());
+		for (const char c : value) {
+			switch (c) {
+				case '&': escaped += "&amp;"; break;
+				case '<': escaped += "&lt;"; break;
+				case '>': escaped += "&gt;"; break;
+				case '"': escaped += "&quot;"; break;
+				case '\'': escaped += "&apos;"; break;
+				default: escaped += c; break;
+			}
+		}
+		return escaped;
+	}
+
+	// Written directly rather than through the xsd tree, the document only lists the resources and their content ids.
+	template<typename Iterator>
+	string createRlmiBody (Iterator begin, Iterator end) {
+		string body = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
+			"<list xmlns=\"urn:ietf:params:xml:ns:rlmi\" fullState=\"true\" uri=\"\" version=\"0\">\n";
+		for (Iterator it = begin; it != end; it++) {
+			body += "  <resource uri=\"" + escapeXmlAttribute(it->uri) + "\">\n";
+			body += "    <instance id=\"" + escapeXmlAttribute(it->cid) + "\" state=\"active\"/>\n";
+			body += "  </resource>\n";
+		}
+		body += "</list>\n";
+		return body;
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -101,120 +137,171 @@ void LocalConferenceListEventHandler::subscribeReceived (LinphoneEvent *lev, con
 	IdentityAddress deviceAddr(deviceAddrStr);
 	bctbx_free(deviceAddrStr);
 
-	list<Content *> contents;
-	Content *rlmiContent = new Content();
-	rlmiContent->setContentType(ContentType::Rlmi);
+	// Bodies point into the per-conference NOTIFY caches, they are only copied once, into the multipart buffer.
+	struct Resource {
+		string uri;
+		string cid;
+		const string *body;
+		bool multipart;
+	};
+	list<Resource> resources;
+	size_t bodiesSize = 0;
+
+	for (const auto &subscribedHandler : findSubscribedHandlers(xmlBody)) {
+		const Address &addr = subscribedHandler.address;
+		LocalConferenceEventHandler *handler = subscribedHandler.handler;
+		const ChatRoomId &chatRoomId = handler->getChatRoomId();
+
+		shared_ptr<AbstractChatRoom> chatRoom = L_GET_CPP_PTR_FROM_C_OBJECT(linphone_event_get_core(lev))->findChatRoom(chatRoomId);
+		if (!chatRoom) {
+			lError() << "Received subscribe for unknown chat room: " << chatRoomId;
+			continue;
+		}
 
-	// Create Rlmi body
-	Xsd::Rlmi::List::ResourceSequence resources;
+		shared_ptr<Participant> participant = chatRoom->findParticipant(participantAddr);
+		if (!participant) {
+			lError() << "Received subscribe for unknown participant: " << participantAddr <<  " for chat room: " << chatRoomId;
+			continue;
+		}
+		shared_ptr<ParticipantDevice> device = participant->getPrivate()->findDevice(deviceAddr);
+		if (!device || (device->getState() != ParticipantDevice::State::Present && device->getState() != ParticipantDevice::State::Joining)) {
+			lError() << "Received subscribe for unknown device: " << deviceAddr << " for participant: "
+				<< participantAddr <<  " for chat room: " << chatRoomId;
+			continue;
+		}
+		device->setConferenceSubscribeEvent((subscriptionState == LinphoneSubscriptionIncomingReceived) ? lev : nullptr);
 
-	// Parse resource list
-	bool noContent = true;
-	istringstream data(xmlBody);
-	unique_ptr<Xsd::ResourceLists::ResourceLists> rl(Xsd::ResourceLists::parseResourceLists(
-		data,
-		Xsd::XmlSchema::Flags::dont_validate
-	));
-	for (const auto &l : rl->getList()) {
-		for (const auto &entry : l.getEntry()) {
-			Address addr(entry.getUri());
-			string notifyIdStr = addr.getUriParamValue("Last-Notify");
-			addr.removeUriParam("Last-Notify");
-			ChatRoomId chatRoomId(addr, addr);
-			LocalConferenceEventHandler *handler = findHandler(chatRoomId);
-			if (!handler)
-				continue;
-
-			shared_ptr<AbstractChatRoom> chatRoom = L_GET_CPP_PTR_FROM_C_OBJECT(linphone_event_get_core(lev))->findChatRoom(chatRoomId);
-			if (!chatRoom) {
-				lError() << "Received subscribe for unknown chat room: " << chatRoomId;
-				continue;
-			}
+		int notifyId = (subscribedHandler.lastNotify.empty() || device->getState() == ParticipantDevice::State::Joining) ? 0 : Utils::stoi(subscribedHandler.lastNotify);
+		const string &notifyBody = handler->getNotifyForId(notifyId, !!(chatRoom->getCapabilities() & AbstractChatRoom::Capabilities::OneToOne));
+		if (notifyBody.empty())
+			continue;
 
-			shared_ptr<Participant> participant = chatRoom->findParticipant(participantAddr);
-			if (!participant) {
-				lError() << "Received subscribe for unknown participant: " << participantAddr <<  " for chat room: " << chatRoomId;
-				continue;
-			}
-			shared_ptr<ParticipantDevice> device = participant->getPrivate()->findDevice(deviceAddr);
-			if (!device || (device->getState() != ParticipantDevice::State::Present && device->getState() != ParticipantDevice::State::Joining)) {
-				lError() << "Received subscribe for unknown device: " << deviceAddr << " for participant: "
-					<< participantAddr <<  " for chat room: " << chatRoomId;
-				continue;
-			}
-			device->setConferenceSubscribeEvent((subscriptionState == LinphoneSubscriptionIncomingReceived) ? lev : nullptr);
-
-			int notifyId = (notifyIdStr.empty() || device->getState() == ParticipantDevice::State::Joining) ? 0 : Utils::stoi(notifyIdStr);
-			string notifyBody = handler->getNotifyForId(notifyId, !!(chatRoom->getCapabilities() & AbstractChatRoom::Capabilities::OneToOne));
-			if (notifyBody.empty())
-				continue;
-
-			noContent = false;
-			Content *content = new Content();
-			if (notifyId > 0) {
-				ContentType contentType(ContentType::Multipart);
-				contentType.addParameter("boundary", string(MultipartBoundary));
-				content->setContentType(contentType);
-			} else
-				content->setContentType(ContentType::ConferenceInfo);
-
-			content->setBody(notifyBody);
-			char token[17];
-			belle_sip_random_token(token, sizeof(token));
-			content->addHeader("Content-Id", token);
-			content->addHeader("Content-Length", Utils::toString(notifyBody.size()));
-			contents.push_back(content);
-
-			// Add entry into the Rlmi content of the notify body
-			Xsd::Rlmi::Resource resource(addr.asStringUriOnly());
-			Xsd::Rlmi::Resource::InstanceSequence instances;
-			Xsd::Rlmi::Instance instance(token, Xsd::Rlmi::State::Value::active);
-			instances.push_back(instance);
-			resource.setInstance(instances);
-			resources.push_back(resource);
-		}
+		char token[17];
+		belle_sip_random_token(token, sizeof(token));
+		resources.push_back({ addr.asStringUriOnly(), token, &notifyBody, notifyId > 0 });
+		bodiesSize += notifyBody.size();
 	}
 
-	if (noContent)
+	if (resources.empty())
 		return;
 
-	Xsd::Rlmi::List list("", 0, TRUE);
-	list.setResource(resources);
-	Xsd::XmlSchema::NamespaceInfomap map;
-	stringstream rlmiBody;
-	Xsd::Rlmi::serializeList(rlmiBody, list, map);
-	rlmiContent->setBody(rlmiBody.str());
+	ContentType multipartType(ContentType::Multipart);
+	multipartType.addParameter("boundary", string(MultipartBoundary));
 
-	contents.push_front(rlmiContent);
-	Content multipart = ContentManager::contentListToMultipart(contents, MultipartBoundaryListEventHandler);
-	if (linphone_core_content_encoding_supported(getCore()->getCCore(), "deflate"))
+	// Create Rlmi body
+	string rlmiBody = createRlmiBody(resources.cbegin(), resources.cend());
+
+	MultipartBuilder builder(MultipartBoundaryListEventHandler);
+	size_t size = builder.getPartOverhead(ContentType::Rlmi, rlmiBody.size()) + rlmiBody.size() + bodiesSize;
+	for (const auto &resource : resources) {
+		size += builder.getPartOverhead(
+			resource.multipart ? multipartType : ContentType::ConferenceInfo,
+			resource.body->size(),
+			{ Header("Content-Id", resource.cid) }
+		);
+	}
+	builder.reserve(size + MultipartTrailerReserve);
+
+	builder.addPart(ContentType::Rlmi, rlmiBody);
+	for (const auto &resource : resources) {
+		builder.addPart(
+			resource.multipart ? multipartType : ContentType::ConferenceInfo,
+			*resource.body,
+			{ Header("Content-Id", resource.cid) }
+		);
+	}
+
+	Content multipart = builder.finish();
+	if (linphone_core_should_apply_content_encoding(getCore()->getCCore(), "deflate", multipart.getSize()))
 		multipart.setContentEncoding("deflate");
 	LinphoneContent *cContent = L_GET_C_BACK_PTR(&multipart);
 	LinphoneEventCbs *cbs = linphone_event_get_callbacks(lev);
 	linphone_event_cbs_set_user_data(cbs, this);
 	linphone_event_cbs_set_notify_response(cbs, notifyResponseCb);
 	linphone_event_notify(lev, cContent);
-	contents.clear();
 }
 
 // -----------------------------------------------------------------------------
 
 void LocalConferenceListEventHandler::addHandler (LocalConferenceEventHandler *handler) {
-	if (handler)
-		handlers.push_back(handler);
+	if (!handler)
+		return;
+
+	handlers.push_back(handler);
+	handlerIds[handler] = ChatRoomId();
+	updateHandler(handler);
 }
 
 void LocalConferenceListEventHandler::removeHandler (LocalConferenceEventHandler *handler) {
-	if (handler)
-		handlers.remove(handler);
+	if (!handler)
+		return;
+
+	handlers.remove(handler);
+	auto it = handlerIds.find(handler);
+	if (it == handlerIds.end())
+		return;
+
+	unindexHandler(handler, it->second);
+	handlerIds.erase(it);
+}
+
+void LocalConferenceListEventHandler::updateHandler (LocalConferenceEventHandler *handler) {
+	auto it = handlerIds.find(handler);
+	if (it == handlerIds.end())
+		return;
+
+	unindexHandler(handler, it->second);
+	it->second = handler->getChatRoomId();
+	if (it->second.isValid())
+		handlersById.emplace(it->second, handler);
+}
+
+void LocalConferenceListEventHandler::unindexHandler (const LocalConferenceEventHandler *handler, const ChatRoomId &chatRoomId) {
+	auto range = handlersById.equal_range(chatRoomId);
+	for (auto idIt = range.first; idIt != range.second; idIt++) {
+		if (idIt->second == handler) {
+			handlersById.erase(idIt);
+			return;
+		}
+	}
+}
+
+list<LocalConferenceListEventHandler::SubscribedHandler> LocalConferenceListEventHandler::findSubscribedHandlers (
+	const string &xmlBody
+) const {
+	list<SubscribedHandler> subscribedHandlers;
+	istringstream data(xmlBody);
+	unique_ptr<Xsd::ResourceLists::ResourceLists> rl(Xsd::ResourceLists::parseResourceLists(
+		data,
+		Xsd::XmlSchema::Flags::dont_validate
+	));
+	for (const auto &l : rl->getList()) {
+		for (const auto &entry : l.getEntry()) {
+			Address addr(entry.getUri());
+			string lastNotify = addr.getUriParamValue("Last-Notify");
+			addr.removeUriParam("Last-Notify");
+			LocalConferenceEventHandler *handler = findHandler(ChatRoomId(addr, addr));
+			if (handler)
+				subscribedHandlers.push_back({ move(addr), move(lastNotify), handler });
+		}
+	}
+	return subscribedHandlers;
 }
 
 LocalConferenceEventHandler *LocalConferenceListEventHandler::findHandler (const ChatRoomId &chatRoomId) const {
+	auto range = handlersById.equal_range(chatRoomId);
+	if (range.first == range.second)
+		return nullptr;
+	if (next(range.first) == range.second)
+		return range.first->second;
+
+	// The first registered one, as when the handlers were walked in order.
 	for (const auto &handler : handlers) {
-		if (handler->getChatRoomId() == chatRoomId)
-			return handler;
+		for (auto it = range.first; it != range.second; it++) {
+			if (it->second == handler)
+				return handler;
+		}
 	}
-
 	return nullptr;
 }
 
@@ -20,9 +20,12 @@
 #ifndef _L_LOCAL_CONFERENCE_LIST_EVENT_HANDLER_H_
 #define _L_LOCAL_CONFERENCE_LIST_EVENT_HANDLER_H_
 
-#include <memory>
 #include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
 
+#include "address/address.h"
 #include "chat/chat-room/chat-room-id.h"
 #include "core/core-accessor.h"
 #include "linphone/utils/general.h"
@@ -40,7 +43,18 @@ public:
 	void subscribeReceived (LinphoneEvent *lev, const LinphoneContent *body);
 	void addHandler (LocalConferenceEventHandler *handler);
 	void removeHandler (LocalConferenceEventHandler *handler);
+	// Must be called when the chat room id of a handler changes, does nothing if the handler is not registered.
+	void updateHandler (LocalConferenceEventHandler *handler);
 	LocalConferenceEventHandler *findHandler (const ChatRoomId &chatRoomId) const;
+
+	struct SubscribedHandler {
+		Address address;
+		std::string lastNotify;
+		LocalConferenceEventHandler *handler;
+	};
+
+	// Parses the resource list of a SUBSCRIBE and returns the handlers of the known conferences it lists.
+	std::list<SubscribedHandler> findSubscribedHandlers (const std::string &xmlBody) const;
 	const std::list<LocalConferenceEventHandler *> &getHandlers () const;
 
 	static void notifyResponseCb (const LinphoneEvent *ev);
@@ -48,6 +62,14 @@ public:
 private:
 	std::list<LocalConferenceEventHandler *> handlers;
 
+	// Handlers indexed by chat room id, and the id each registered handler is indexed with.
+	// A handler may be added before its chat room id is known, it is indexed once the id is set.
+	// Several handlers may share an id: findHandler() returns the first registered one.
+	std::unordered_multimap<ChatRoomId, LocalConferenceEventHandler *> handlersById;
+	std::unordered_map<const LocalConferenceEventHandler *, ChatRoomId> handlerIds;
+
+	void unindexHandler (const LocalConferenceEventHandler *handler, const ChatRoomId &chatRoomId);
+
 };
 
 LINPHONE_END_NAMESPACE
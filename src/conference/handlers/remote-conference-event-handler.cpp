@@ -29,6 +29,7 @@
 #include "core/core-p.h"
 #include "logger/logger.h"
 #include "remote-conference-event-handler-p.h"
+#include "remote-conference-list-event-handler.h"
 #include "xml/conference-info.h"
 
 // TODO: Remove me later.
@@ -310,6 +311,9 @@ void RemoteConferenceEventHandler::multipartNotifyReceived (const string &xmlBod
 void RemoteConferenceEventHandler::setChatRoomId (ChatRoomId chatRoomId) {
 	L_D();
 	d->chatRoomId = chatRoomId;
+	const unique_ptr<RemoteConferenceListEventHandler> &listHandler = d->conf->getCore()->getPrivate()->remoteListEventHandler;
+	if (listHandler)
+		listHandler->updateHandler(this);
 }
 
 const ChatRoomId &RemoteConferenceEventHandler::getChatRoomId () const {
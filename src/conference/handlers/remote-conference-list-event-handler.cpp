@@ -17,6 +17,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <iterator>
+
 #include "linphone/core.h"
 #include "linphone/event.h"
 #include "linphone/proxy_config.h"
@@ -116,7 +118,8 @@ void RemoteConferenceListEventHandler::subscribe () {
 	linphone_event_add_custom_header(lev, "Accept", "multipart/related, application/conference-info+xml, application/rlmi+xml");
 	linphone_event_add_custom_header(lev, "Content-Disposition", "recipient-list");
 	if (linphone_core_content_encoding_supported(lc, "deflate")) {
-		content.setContentEncoding("deflate");
+		if (linphone_core_should_apply_content_encoding(lc, "deflate", content.getSize()))
+			content.setContentEncoding("deflate");
 		linphone_event_add_custom_header(lev, "Accept-Encoding", "deflate");
 	}
 	linphone_event_set_user_data(lev, this);
@@ -186,11 +189,19 @@ void RemoteConferenceListEventHandler::notifyReceived (const Content *notifyCont
 // -----------------------------------------------------------------------------
 
 RemoteConferenceEventHandler *RemoteConferenceListEventHandler::findHandler (const ChatRoomId &chatRoomId) const {
+	auto range = handlersById.equal_range(chatRoomId);
+	if (range.first == range.second)
+		return nullptr;
+	if (next(range.first) == range.second)
+		return range.first->second;
+
+	// The first registered one, as when the handlers were walked in order.
 	for (const auto &handler : handlers) {
-		if (handler->getChatRoomId() == chatRoomId)
-			return handler;
+		for (auto it = range.first; it != range.second; it++) {
+			if (it->second == handler)
+				return handler;
+		}
 	}
-
 	return nullptr;
 }
 
@@ -199,13 +210,46 @@ const list<RemoteConferenceEventHandler *> &RemoteConferenceListEventHandler::ge
 }
 
 void RemoteConferenceListEventHandler::addHandler (RemoteConferenceEventHandler *handler) {
-	if (handler)
-		handlers.push_back(handler);
+	if (!handler)
+		return;
+
+	handlers.push_back(handler);
+	handlerIds[handler] = ChatRoomId();
+	updateHandler(handler);
 }
 
 void RemoteConferenceListEventHandler::removeHandler (RemoteConferenceEventHandler *handler) {
-	if (handler)
-		handlers.remove(handler);
+	if (!handler)
+		return;
+
+	handlers.remove(handler);
+	auto it = handlerIds.find(handler);
+	if (it == handlerIds.end())
+		return;
+
+	unindexHandler(handler, it->second);
+	handlerIds.erase(it);
+}
+
+void RemoteConferenceListEventHandler::updateHandler (RemoteConferenceEventHandler *handler) {
+	auto it = handlerIds.find(handler);
+	if (it == handlerIds.end())
+		return;
+
+	unindexHandler(handler, it->second);
+	it->second = handler->getChatRoomId();
+	if (it->second.isValid())
+		handlersById.emplace(it->second, handler);
+}
+
+void RemoteConferenceListEventHandler::unindexHandler (const RemoteConferenceEventHandler *handler, const ChatRoomId &chatRoomId) {
+	auto range = handlersById.equal_range(chatRoomId);
+	for (auto idIt = range.first; idIt != range.second; idIt++) {
+		if (idIt->second == handler) {
+			handlersById.erase(idIt);
+			return;
+		}
+	}
 }
 
 map<string, IdentityAddress> RemoteConferenceListEventHandler::parseRlmi (const string &xmlBody) const {
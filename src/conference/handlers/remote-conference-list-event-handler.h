@@ -23,6 +23,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <unordered_map>
 
 #include "linphone/types.h"
 #include "linphone/utils/general.h"
@@ -49,11 +50,21 @@ public:
 	void notifyReceived (const Content *notifyContent);
 	void addHandler (RemoteConferenceEventHandler *handler);
 	void removeHandler (RemoteConferenceEventHandler *handler);
+	// Must be called when the chat room id of a handler changes, does nothing if the handler is not registered.
+	void updateHandler (RemoteConferenceEventHandler *handler);
 	RemoteConferenceEventHandler *findHandler (const ChatRoomId &chatRoomId) const;
 	const std::list<RemoteConferenceEventHandler *> &getHandlers () const;
 
 private:
 	std::list<RemoteConferenceEventHandler *> handlers;
+
+	// Handlers indexed by chat room id, and the id each registered handler is indexed with.
+	// A handler may be added before its chat room id is known, it is indexed once the id is set.
+	// Several handlers may share an id: findHandler() returns the first registered one.
+	std::unordered_multimap<ChatRoomId, RemoteConferenceEventHandler *> handlersById;
+	std::unordered_map<const RemoteConferenceEventHandler *, ChatRoomId> handlerIds;
+
+	void unindexHandler (const RemoteConferenceEventHandler *handler, const ChatRoomId &chatRoomId);
 	LinphoneEvent *lev = nullptr;
 
 	std::map<std::string, IdentityAddress> parseRlmi (const std::string &xmlBody) const;
@@ -51,6 +51,7 @@ void LocalConference::addParticipant (const IdentityAddress &addr, const CallSes
 	participant = make_shared<Participant>(this, addr);
 	participant->getPrivate()->createSession(*this, params, hasMedia, d->listener);
 	d->participants.push_back(participant);
+	d->stateRevision++;
 	if (!d->activeParticipant)
 		d->activeParticipant = participant;
 }
@@ -60,6 +61,7 @@ void LocalConference::removeParticipant (const shared_ptr<Participant> &particip
 	for (const auto &p : d->participants) {
 		if (participant->getAddress() == p->getAddress()) {
 			d->participants.remove(p);
+			d->stateRevision++;
 			return;
 		}
 	}
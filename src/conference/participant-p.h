@@ -40,8 +40,8 @@ public:
 	std::shared_ptr<CallSession> createSession (const Conference &conference, const CallSessionParams *params, bool hasMedia, CallSessionListener *listener);
 	inline std::shared_ptr<CallSession> getSession () const { return session; }
 	inline void removeSession () { session.reset(); }
-	inline void setAddress (const IdentityAddress &newAddr) { addr = newAddr; }
-	inline void setAdmin (bool isAdmin) { this->isAdmin = isAdmin; }
+	void setAddress (const IdentityAddress &newAddr);
+	void setAdmin (bool isAdmin);
 
 	std::shared_ptr<ParticipantDevice> addDevice (const IdentityAddress &gruu);
 	void clearDevices ();
@@ -51,6 +51,8 @@ public:
 	void removeDevice (const IdentityAddress &gruu);
 
 private:
+	void stateChanged ();
+
 	Conference *mConference = nullptr;
 	IdentityAddress addr;
 	bool isAdmin = false;
@@ -19,6 +19,7 @@
 
 #include <algorithm>
 
+#include "conference-p.h"
 #include "object/object-p.h"
 #include "participant-device.h"
 #include "participant-p.h"
@@ -45,6 +46,18 @@ shared_ptr<CallSession> ParticipantPrivate::createSession (
 	return session;
 }
 
+void ParticipantPrivate::setAddress (const IdentityAddress &newAddr) {
+	addr = newAddr;
+	stateChanged();
+}
+
+void ParticipantPrivate::setAdmin (bool isAdmin) {
+	if (this->isAdmin == isAdmin)
+		return;
+	this->isAdmin = isAdmin;
+	stateChanged();
+}
+
 // -----------------------------------------------------------------------------
 
 shared_ptr<ParticipantDevice> ParticipantPrivate::addDevice (const IdentityAddress &gruu) {
@@ -54,11 +67,13 @@ shared_ptr<ParticipantDevice> ParticipantPrivate::addDevice (const IdentityAddre
 		return device;
 	device = make_shared<ParticipantDevice>(q, gruu);
 	devices.push_back(device);
+	stateChanged();
 	return device;
 }
 
 void ParticipantPrivate::clearDevices () {
 	devices.clear();
+	stateChanged();
 }
 
 shared_ptr<ParticipantDevice> ParticipantPrivate::findDevice (const IdentityAddress &gruu) const {
@@ -85,11 +100,17 @@ void ParticipantPrivate::removeDevice (const IdentityAddress &gruu) {
 	for (auto it = devices.begin(); it != devices.end(); it++) {
 		if ((*it)->getAddress() == gruu) {
 			devices.erase(it);
+			stateChanged();
 			return;
 		}
 	}
 }
 
+void ParticipantPrivate::stateChanged () {
+	if (mConference)
+		mConference->getPrivate()->stateRevision++;
+}
+
 // =============================================================================
 
 Participant::Participant (Conference *conference, const IdentityAddress &address) : Object(*new ParticipantPrivate) {
@@ -54,6 +54,7 @@ public:
 	virtual void onIncomingCallSessionTimeoutCheck (const std::shared_ptr<CallSession> &session, int elapsed, bool oneSecondElapsed) {}
 	virtual void onInfoReceived (const std::shared_ptr<CallSession> &session, const LinphoneInfoMessage *im) {}
 	virtual void onNoMediaTimeoutCheck (const std::shared_ptr<CallSession> &session, bool oneSecondElapsed) {}
+	virtual void onPendingWorkChanged (const std::shared_ptr<CallSession> &session, bool pendingWork) {}
 	virtual void onTmmbrReceived (const std::shared_ptr<CallSession> &session, int streamIndex, int tmmbr) {}
 	virtual void onSnapshotTaken(const std::shared_ptr<CallSession> &session, const char *file_path) {}
 
@@ -45,6 +45,9 @@ public:
 	LinphoneProxyConfig * getDestProxy () const { return destProxy; }
 	SalCallOp * getOp () const { return op; }
 	bool isBroken () const { return broken; }
+	virtual bool hasPendingWork () const;
+	// Tells the listener when hasPendingWork() changed, to be called whenever one of its inputs may have.
+	void updatePendingWork ();
 	bool isInConference () const;
 	void setParams (CallSessionParams *csp);
 	void setReferPending (bool value) { referPending = value; }
@@ -132,6 +135,7 @@ protected:
 	std::shared_ptr<CallSession> transferTarget;
 
 	bool broken = false;
+	bool pendingWork = false;
 	bool deferIncomingNotification = false;
 	bool deferUpdate = false;
 	bool deferUpdateInternal = false;
@@ -135,6 +135,7 @@ void CallSessionPrivate::setState (CallSession::State newState, const string &me
 			lError() << "You must fill a reason when changing call state (from " <<
 				Utils::toString(prevState) << " to " << Utils::toString(state) << ")";
 		}
+		updatePendingWork();
 		if (listener)
 			listener->onCallSessionStateChanged(q->getSharedFromThis(), newState, message);
 		if (newState == CallSession::State::Released)
@@ -550,6 +551,30 @@ void CallSessionPrivate::handleIncomingReceivedStateInIncomingNotification () {
 		q->accept();
 }
 
+bool CallSessionPrivate::hasPendingWork () const {
+	// In these states, the session waits for the remote party or for timeouts checked every second.
+	switch (state) {
+		case CallSession::State::IncomingReceived:
+		case CallSession::State::OutgoingRinging:
+		case CallSession::State::StreamsRunning:
+		case CallSession::State::Paused:
+		case CallSession::State::PausedByRemote:
+			return false;
+		default:
+			return true;
+	}
+}
+
+void CallSessionPrivate::updatePendingWork () {
+	L_Q();
+	bool value = hasPendingWork();
+	if (value == pendingWork)
+		return;
+	pendingWork = value;
+	if (listener)
+		listener->onPendingWorkChanged(q->getSharedFromThis(), pendingWork);
+}
+
 bool CallSessionPrivate::isReadyForInvite () const {
 	bool pingReady = false;
 	if (pingOp) {
@@ -0,0 +1,80 @@
+/*
+ * call-stats-history.cpp
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+
+#include "call-stats-history.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+void CallStatsHistory::setCapacity (size_t capacity) {
+	samples.assign(capacity, LinphoneCallStatsSample());
+	first = 0;
+	size = 0;
+}
+
+void CallStatsHistory::add (const LinphoneCallStatsSample &sample) {
+	if (samples.empty())
+		return;
+
+	if (size < samples.size()) {
+		samples[(first + size) % samples.size()] = sample;
+		size++;
+	} else {
+		samples[first] = sample;
+		first = (first + 1) % samples.size();
+	}
+}
+
+void CallStatsHistory::clear () {
+	first = 0;
+	size = 0;
+}
+
+size_t CallStatsHistory::copy (time_t since, LinphoneCallStatsSample *result, size_t count) const {
+	// Samples are added in time order: look for the first one to copy by dichotomy.
+	size_t low = 0;
+	size_t high = size;
+	while (low < high) {
+		size_t middle = low + (high - low) / 2;
+		if (at(middle).time < since)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	size_t available = size - low;
+	if (!result)
+		return available;
+
+	count = min(count, available);
+	for (size_t i = 0; i < count; i++)
+		result[i] = at(low + i);
+	return count;
+}
+
+const LinphoneCallStatsSample &CallStatsHistory::at (size_t index) const {
+	return samples[(first + index) % samples.size()];
+}
+
+LINPHONE_END_NAMESPACE
@@ -0,0 +1,56 @@
+/*
+ * call-stats-history.h
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _L_CALL_STATS_HISTORY_H_
+#define _L_CALL_STATS_HISTORY_H_
+
+#include <vector>
+
+#include "linphone/api/c-call-stats.h"
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+// Fixed-size ring buffer of the last statistics samples of a stream, oldest overwritten first.
+class CallStatsHistory {
+public:
+	void setCapacity (size_t capacity);
+	size_t getCapacity () const { return samples.size(); }
+	size_t getSize () const { return size; }
+
+	void add (const LinphoneCallStatsSample &sample);
+	void clear ();
+
+	// Copies at most count samples taken at or after since, the oldest first. Returns the number of samples copied,
+	// or the number of samples available if result is null.
+	size_t copy (time_t since, LinphoneCallStatsSample *result, size_t count) const;
+
+private:
+	const LinphoneCallStatsSample &at (size_t index) const;
+
+	std::vector<LinphoneCallStatsSample> samples;
+	size_t first = 0;
+	size_t size = 0;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_CALL_STATS_HISTORY_H_
@@ -22,6 +22,7 @@
 
 #include "call-session-p.h"
 
+#include "call-stats-history.h"
 #include "media-session.h"
 #include "port-config.h"
 #include "nat/ice-agent.h"
@@ -33,6 +34,8 @@
 
 LINPHONE_BEGIN_NAMESPACE
 
+class PayloadTypeHandler;
+
 class MediaSessionPrivate : public CallSessionPrivate {
 public:
 	static int resumeAfterFailedTransfer (void *userData, unsigned int);
@@ -140,11 +143,10 @@ private:
 	MediaStream *getMediaStream (int streamIndex) const;
 
 	void fillMulticastMediaAddresses ();
-	int selectFixedPort (int streamIndex, std::pair<int, int> portRange);
-	int selectRandomPort (int streamIndex, std::pair<int, int> portRange);
 	void setPortConfig (int streamIndex, std::pair<int, int> portRange);
 	void setPortConfigFromRtpSession (int streamIndex, RtpSession *session);
 	void setRandomPortConfig (int streamIndex);
+	void releasePorts ();
 
 	void discoverMtu (const Address &remoteAddr);
 	std::string getBindIpForStream (int streamIndex);
@@ -157,6 +159,8 @@ private:
 	void forceStreamsDirAccordingToState (SalMediaDescription *md);
 	bool generateB64CryptoKey (size_t keyLength, char *keyOut, size_t keyOutSize);
 	void makeLocalMediaDescription ();
+	bctbx_list_t *makeStreamCodecsList (PayloadTypeHandler &pth, SalStreamType type, int bandwidthLimit, int streamIndex, const SalMediaDescription *oldMd);
+	void clearCachedCodecs ();
 	int setupEncryptionKey (SalSrtpCryptoAlgo *crypto, MSCryptoSuite suite, unsigned int tag);
 	void setupDtlsKeys (SalMediaDescription *md);
 	void setupEncryptionKeys (SalMediaDescription *md);
@@ -230,9 +234,11 @@ private:
 	void updateLocalStats (LinphoneCallStats *stats, MediaStream *stream) const;
 	void updateRtpStats (LinphoneCallStats *stats, int streamIndex);
 
+	bool hasPendingWork () const override;
 	void executeBackgroundTasks (bool oneSecondElapsed);
 	void reportBandwidth ();
 	void reportBandwidthForStream (MediaStream *ms, LinphoneStreamType type);
+	void addStatsSample (MediaStream *ms, const LinphoneCallStats *stats, LinphoneStreamType type);
 
 	void abort (const std::string &errorMsg) override;
 	void handleIncomingReceivedStateInIncomingNotification () override;
@@ -262,6 +268,8 @@ private:
 private:
 	static const std::string ecStateStore;
 	static const int ecStateMaxLen;
+	static const int defaultPortReuseDelay;
+	static const int defaultStatsHistorySize;
 
 	std::weak_ptr<Participant> me;
 
@@ -284,6 +292,11 @@ private:
 	TextStream *textStream = nullptr;
 	OrtpEvQueue *textStreamEvQueue = nullptr;
 	LinphoneCallStats *textStats = nullptr;
+
+	// Last samples of the audio, video and text statistics, indexed by LinphoneStreamType.
+	CallStatsHistory statsHistories[LinphoneStreamTypeUnknown];
+	// [rtp] log_bandwidth_usage, the bandwidth and thread load are logged every second when set.
+	bool logBandwidthUsage = true;
 	RtpProfile *textProfile = nullptr;
 	int mainTextStreamIndex = LINPHONE_CALL_STATS_TEXT;
 
@@ -299,6 +312,8 @@ private:
 
 	std::string mediaLocalIp;
 	PortConfig mediaPorts[SAL_MEDIA_DESCRIPTION_MAX_STREAMS];
+	// RTP ports taken from the port allocator of the core, given back when the session is released.
+	std::vector<int> allocatedPorts;
 	bool needMediaLocalIpRefresh = false;
 
 	// The rtp, srtp, zrtp contexts for each stream.
@@ -306,6 +321,17 @@ private:
 
 	SalMediaDescription *localDesc = nullptr;
 	int localDescChanged = 0;
+	// Payload types of each stream as made for the last local description, before they are modified by setupRtcpFb()
+	// and the like, with the codecs revision of the core, the bandwidth limit and the frozen payload types they were made from.
+	struct CachedCodecs {
+		bctbx_list_t *payloads = nullptr;
+		unsigned int revision = 0;
+		int bandwidthLimit = 0;
+		unsigned int frozenPayloadsGeneration = 0;
+	};
+	CachedCodecs cachedCodecs[SAL_MEDIA_DESCRIPTION_MAX_STREAMS];
+	// Incremented each time the remote imposes payload type numbers that must be kept in the dialog.
+	unsigned int frozenPayloadsGeneration = 0;
 	SalMediaDescription *biggestDesc = nullptr;
 	SalMediaDescription *resultDesc = nullptr;
 	bool expectMediaInAck = false;
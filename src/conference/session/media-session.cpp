@@ -27,8 +27,10 @@
 #include "conference/participant-p.h"
 #include "conference/params/media-session-params-p.h"
 #include "conference/session/media-session.h"
+#include "conference/session/rtp-port-allocator.h"
 #include "core/core-p.h"
 #include "sal/sal.h"
+#include "utils/metrics.h"
 #include "utils/payload-type-handler.h"
 
 #include "logger/logger.h"
@@ -66,6 +68,8 @@ inline OrtpRtcpXrStatSummaryFlag operator|(OrtpRtcpXrStatSummaryFlag a, OrtpRtcp
 
 const string MediaSessionPrivate::ecStateStore = ".linphone.ecstate";
 const int MediaSessionPrivate::ecStateMaxLen = 1048576; /* 1Mo */
+const int MediaSessionPrivate::defaultPortReuseDelay = 5000; /* ms */
+const int MediaSessionPrivate::defaultStatsHistorySize = 60; /* One sample per second */
 
 // =============================================================================
 
@@ -732,6 +736,9 @@ void MediaSessionPrivate::setState (CallSession::State newState, const string &m
 				lInfo() << "CallSession [" << q << "]: ICE reinvite received, but one or more check-lists are not completed. Response will be sent later, when ICE has completed";
 			}
 			break;
+		case CallSession::State::Released:
+			releasePorts();
+			break;
 		default:
 			break;
 	}
@@ -1033,72 +1040,56 @@ void MediaSessionPrivate::fillMulticastMediaAddresses () {
 		mediaPorts[mainVideoStreamIndex].multicastIp.clear();
 }
 
-int MediaSessionPrivate::selectFixedPort (int streamIndex, pair<int, int> portRange) {
+void MediaSessionPrivate::setPortConfig(int streamIndex, pair<int, int> portRange) {
 	L_Q();
-	for (int triedPort = portRange.first; triedPort < (portRange.first + 100); triedPort += 2) {
-		bool alreadyUsed = false;
-		for (const bctbx_list_t *elem = linphone_core_get_calls(q->getCore()->getCCore()); elem != nullptr; elem = bctbx_list_next(elem)) {
-			LinphoneCall *lcall = reinterpret_cast<LinphoneCall *>(bctbx_list_get_data(elem));
-			shared_ptr<MediaSession> session = static_pointer_cast<MediaSession>(L_GET_CPP_PTR_FROM_C_OBJECT(lcall)->getPrivate()->getActiveSession());
-			int existingPort = session->getPrivate()->mediaPorts[streamIndex].rtpPort;
-			if (existingPort == triedPort) {
-				alreadyUsed = true;
-				break;
-			}
-		}
-		if (!alreadyUsed)
-			return triedPort;
+	if ((portRange.first <= 0) && (portRange.second <= 0)) {
+		setRandomPortConfig(streamIndex);
+		return;
 	}
 
-	lError() << "Could not find any free port !";
-	return -1;
-}
+	const unique_ptr<RtpPortAllocator> &allocator = q->getCore()->getPrivate()->rtpPortAllocator;
+	if (!allocator) {
+		setRandomPortConfig(streamIndex);
+		return;
+	}
 
-int MediaSessionPrivate::selectRandomPort (int streamIndex, pair<int, int> portRange) {
-	L_Q();
-	for (int nbTries = 0; nbTries < 100; nbTries++) {
-		bool alreadyUsed = false;
-		unsigned int rangeSize = static_cast<unsigned int>(portRange.second - portRange.first);
-		unsigned int randomInRangeSize = ortp_random() % rangeSize;
-		unsigned int mask = 1;
-		unsigned int realRandom = randomInRangeSize + static_cast<unsigned int >(portRange.first);
-		int triedPort = static_cast<int>(realRandom & ~mask);
-		if (triedPort < portRange.first) triedPort = portRange.first + 2;
-		for (const bctbx_list_t *elem = linphone_core_get_calls(q->getCore()->getCCore()); elem != nullptr; elem = bctbx_list_next(elem)) {
-			LinphoneCall *lcall = reinterpret_cast<LinphoneCall *>(bctbx_list_get_data(elem));
-			shared_ptr<MediaSession> session = static_pointer_cast<MediaSession>(L_GET_CPP_PTR_FROM_C_OBJECT(lcall)->getPrivate()->getActiveSession());
-			int existingPort = session->getPrivate()->mediaPorts[streamIndex].rtpPort;
-			if (existingPort == triedPort) {
-				alreadyUsed = true;
-				break;
-			}
-		}
-		if (!alreadyUsed)
-			return triedPort;
+	int port;
+	if (portRange.first == portRange.second) {
+		/* Fixed port */
+		port = allocator->allocateFixed(portRange.first);
+	} else {
+		/* Select random port in the specified range */
+		unsigned int reuseDelay = static_cast<unsigned int>(max(0, lp_config_get_int(
+			linphone_core_get_config(q->getCore()->getCCore()), "rtp", "port_reuse_delay", defaultPortReuseDelay
+		)));
+		port = allocator->allocateInRange(portRange.first, portRange.second, reuseDelay);
+	}
+	if (port == -1) {
+		lError() << "Could not find any free port!";
+		setRandomPortConfig(streamIndex);
+		return;
 	}
 
-	lError() << "Could not find any free port!";
-	return -1;
+	mediaPorts[streamIndex].rtpPort = port;
+	mediaPorts[streamIndex].rtcpPort = port + 1;
+	allocatedPorts.push_back(port);
 }
 
-void MediaSessionPrivate::setPortConfig(int streamIndex, pair<int, int> portRange) {
-	if ((portRange.first <= 0) && (portRange.second <= 0)) {
-		setRandomPortConfig(streamIndex);
-	} else {
-		if (portRange.first == portRange.second) {
-			/* Fixed port */
-			int port = selectFixedPort(streamIndex, portRange);
-			if (port == -1) {
-				setRandomPortConfig(streamIndex);
-				return;
-			}
-			mediaPorts[streamIndex].rtpPort = port;
-		} else {
-			/* Select random port in the specified range */
-			mediaPorts[streamIndex].rtpPort = selectRandomPort(streamIndex, portRange);
+void MediaSessionPrivate::releasePorts () {
+	L_Q();
+	if (allocatedPorts.empty())
+		return;
+
+	try {
+		const unique_ptr<RtpPortAllocator> &allocator = q->getCore()->getPrivate()->rtpPortAllocator;
+		if (allocator) {
+			for (int port : allocatedPorts)
+				allocator->release(port);
 		}
-		mediaPorts[streamIndex].rtcpPort = mediaPorts[streamIndex].rtpPort + 1;
+	} catch (const bad_weak_ptr &) {
+		// Core is destroyed along with its ports.
 	}
+	allocatedPorts.clear();
 }
 
 void MediaSessionPrivate::setPortConfigFromRtpSession (int streamIndex, RtpSession *session) {
@@ -1404,8 +1395,7 @@ void MediaSessionPrivate::makeLocalMediaDescription () {
 
 	PayloadTypeHandler pth(q->getCore());
 
-	bctbx_list_t *l = pth.makeCodecsList(SalAudio, getParams()->getAudioBandwidthLimit(), -1,
-		oldMd ? oldMd->streams[mainAudioStreamIndex].already_assigned_payloads : nullptr);
+	bctbx_list_t *l = makeStreamCodecsList(pth, SalAudio, getParams()->getAudioBandwidthLimit(), mainAudioStreamIndex, oldMd);
 	if (l && getParams()->audioEnabled()) {
 		strncpy(md->streams[mainAudioStreamIndex].rtp_addr, getPublicIpForStream(mainAudioStreamIndex).c_str(), sizeof(md->streams[mainAudioStreamIndex].rtp_addr));
 		strncpy(md->streams[mainAudioStreamIndex].rtcp_addr, getPublicIpForStream(mainAudioStreamIndex).c_str(), sizeof(md->streams[mainAudioStreamIndex].rtcp_addr));
@@ -1447,8 +1437,7 @@ void MediaSessionPrivate::makeLocalMediaDescription () {
 	md->streams[mainVideoStreamIndex].rtcp_mux = rtcpMux;
 	strncpy(md->streams[mainVideoStreamIndex].name, "Video", sizeof(md->streams[mainVideoStreamIndex].name) - 1);
 
-	l = pth.makeCodecsList(SalVideo, 0, -1,
-		oldMd ? oldMd->streams[mainVideoStreamIndex].already_assigned_payloads : nullptr);
+	l = makeStreamCodecsList(pth, SalVideo, 0, mainVideoStreamIndex, oldMd);
 	if (l && getParams()->videoEnabled()){
 		strncpy(md->streams[mainVideoStreamIndex].rtp_addr, getPublicIpForStream(mainVideoStreamIndex).c_str(), sizeof(md->streams[mainVideoStreamIndex].rtp_addr));
 		strncpy(md->streams[mainVideoStreamIndex].rtcp_addr, getPublicIpForStream(mainVideoStreamIndex).c_str(), sizeof(md->streams[mainVideoStreamIndex].rtcp_addr));
@@ -1539,6 +1528,41 @@ void MediaSessionPrivate::makeLocalMediaDescription () {
 	forceStreamsDirAccordingToState(md);
 }
 
+bctbx_list_t *MediaSessionPrivate::makeStreamCodecsList (
+	PayloadTypeHandler &pth,
+	SalStreamType type,
+	int bandwidthLimit,
+	int streamIndex,
+	const SalMediaDescription *oldMd
+) {
+	L_Q();
+	unsigned int revision = q->getCore()->getCCore()->codecs_conf.revision;
+	CachedCodecs &cached = cachedCodecs[streamIndex];
+	// Session refreshes and hold/resume offers do not change the codecs: offer the payload types of the previous offer again,
+	// unless the remote imposed payload type numbers since they were made.
+	if (oldMd && cached.payloads && (cached.revision == revision) && (cached.bandwidthLimit == bandwidthLimit)
+		&& (cached.frozenPayloadsGeneration == frozenPayloadsGeneration))
+		return bctbx_list_copy_with_data(cached.payloads, (bctbx_list_copy_func)payload_type_clone);
+
+	bctbx_list_t *payloads = pth.makeCodecsList(type, bandwidthLimit, -1,
+		oldMd ? oldMd->streams[streamIndex].already_assigned_payloads : nullptr);
+	if (cached.payloads)
+		bctbx_list_free_with_data(cached.payloads, (bctbx_list_free_func)payload_type_destroy);
+	cached.payloads = bctbx_list_copy_with_data(payloads, (bctbx_list_copy_func)payload_type_clone);
+	cached.revision = revision;
+	cached.bandwidthLimit = bandwidthLimit;
+	cached.frozenPayloadsGeneration = frozenPayloadsGeneration;
+	return payloads;
+}
+
+void MediaSessionPrivate::clearCachedCodecs () {
+	for (CachedCodecs &cached : cachedCodecs) {
+		if (cached.payloads)
+			bctbx_list_free_with_data(cached.payloads, (bctbx_list_free_func)payload_type_destroy);
+		cached.payloads = nullptr;
+	}
+}
+
 void MediaSessionPrivate::setupDtlsKeys (SalMediaDescription *md) {
 	for (int i = 0; i < SAL_MEDIA_DESCRIPTION_MAX_STREAMS; i++) {
 		if (!sal_stream_description_active(&md->streams[i]))
@@ -2283,6 +2307,7 @@ void MediaSessionPrivate::handleIceEvents (OrtpEvent *ev) {
 		iceAgent->restartSession(IR_Controlling);
 		q->update(getCurrentParams());
 	}
+	updatePendingWork();
 }
 
 void MediaSessionPrivate::handleStreamEvents (int streamIndex) {
@@ -2870,6 +2895,7 @@ void MediaSessionPrivate::startStreams (CallSession::State targetState) {
 		/* Should not start dtls until ice is completed */
 		startDtlsOnAllStreams();
 	}
+	updatePendingWork();
 }
 
 void MediaSessionPrivate::startTextStream () {
@@ -3069,6 +3095,9 @@ void MediaSessionPrivate::stopAudioStream () {
 		}
 		audio_stream_get_local_rtp_stats(audioStream, &log->local_stats);
 		fillLogStats(&audioStream->ms);
+		float quality = media_stream_get_average_quality_rating(&audioStream->ms);
+		if (quality >= 0)
+			Metrics::get().callQualityRating.observe(quality);
 		if (listener)
 			listener->onCallSessionConferenceStreamStopping(q->getSharedFromThis());
 		ms_bandwidth_controller_remove_stream(q->getCore()->getCCore()->bw_controller, &audioStream->ms);
@@ -3166,6 +3195,7 @@ void MediaSessionPrivate::updateFrozenPayloads (SalMediaDescription *result) {
 			if (PayloadTypeHandler::isPayloadTypeNumberAvailable(localDesc->streams[i].already_assigned_payloads, payload_type_get_number(pt), nullptr)) {
 				/* New codec, needs to be added to the list */
 				localDesc->streams[i].already_assigned_payloads = bctbx_list_append(localDesc->streams[i].already_assigned_payloads, payload_type_clone(pt));
+				frozenPayloadsGeneration++;
 				lInfo() << "CallSession[" << q << "] : payload type " << payload_type_get_number(pt) << " " << pt->mime_type << "/" << pt->clock_rate
 					<< " fmtp=" << L_C_TO_STRING(pt->recv_fmtp) << " added to frozen list";
 			}
@@ -3460,6 +3490,15 @@ void MediaSessionPrivate::updateRtpStats (LinphoneCallStats *stats, int streamIn
 
 // -----------------------------------------------------------------------------
 
+bool MediaSessionPrivate::hasPendingWork () const {
+	// ICE checks are run by the iteration of the streams, and video requests (key frames, first decoded frame) need
+	// to be handled right away. The video stream is allocated for every call, only a running one matters.
+	if (CallSessionPrivate::hasPendingWork() || (iceAgent && !iceAgent->hasCompleted()))
+		return true;
+	return videoStream && (media_stream_get_state(&videoStream->ms) == MSStreamStarted)
+		&& getCurrentParams() && getCurrentParams()->videoEnabled();
+}
+
 void MediaSessionPrivate::executeBackgroundTasks (bool oneSecondElapsed) {
 	L_Q();
 	switch (state) {
@@ -3469,17 +3508,19 @@ void MediaSessionPrivate::executeBackgroundTasks (bool oneSecondElapsed) {
 	case CallSession::State::PausedByRemote:
 	case CallSession::State::Paused:
 		if (oneSecondElapsed) {
-			float audioLoad = 0.f;
-			float videoLoad = 0.f;
-			float textLoad = 0.f;
-			if (audioStream && audioStream->ms.sessions.ticker)
-				audioLoad = ms_ticker_get_average_load(audioStream->ms.sessions.ticker);
-			if (videoStream && videoStream->ms.sessions.ticker)
-				videoLoad = ms_ticker_get_average_load(videoStream->ms.sessions.ticker);
-			if (textStream && textStream->ms.sessions.ticker)
-				textLoad = ms_ticker_get_average_load(textStream->ms.sessions.ticker);
 			reportBandwidth();
-			lInfo() << "Thread processing load: audio=" << audioLoad << "\tvideo=" << videoLoad << "\ttext=" << textLoad;
+			if (logBandwidthUsage) {
+				float audioLoad = 0.f;
+				float videoLoad = 0.f;
+				float textLoad = 0.f;
+				if (audioStream && audioStream->ms.sessions.ticker)
+					audioLoad = ms_ticker_get_average_load(audioStream->ms.sessions.ticker);
+				if (videoStream && videoStream->ms.sessions.ticker)
+					videoLoad = ms_ticker_get_average_load(videoStream->ms.sessions.ticker);
+				if (textStream && textStream->ms.sessions.ticker)
+					textLoad = ms_ticker_get_average_load(textStream->ms.sessions.ticker);
+				lInfo() << "Thread processing load: audio=" << audioLoad << "\tvideo=" << videoLoad << "\ttext=" << textLoad;
+			}
 		}
 		break;
 	default:
@@ -3501,6 +3542,10 @@ void MediaSessionPrivate::reportBandwidth () {
 	reportBandwidthForStream(&videoStream->ms, LinphoneStreamTypeVideo);
 	reportBandwidthForStream(&textStream->ms, LinphoneStreamTypeText);
 
+	// The statistics history gives the same figures without parsing the logs.
+	if (!logBandwidthUsage)
+		return;
+
 	lInfo() << "Bandwidth usage for CallSession [" << q << "]:\n" << fixed << setprecision(2) <<
 		"\tRTP  audio=[d=" << linphone_call_stats_get_download_bandwidth(audioStats) << ",u=" << linphone_call_stats_get_upload_bandwidth(audioStats) <<
 		"], video=[d=" << linphone_call_stats_get_download_bandwidth(videoStats) << ",u=" << linphone_call_stats_get_upload_bandwidth(videoStats) << ",ed=" << linphone_call_stats_get_estimated_download_bandwidth(videoStats) <<
@@ -3529,6 +3574,8 @@ void MediaSessionPrivate::reportBandwidthForStream (MediaStream *ms, LinphoneStr
 	_linphone_call_stats_set_rtcp_upload_bandwidth(stats, active ? (float)(media_stream_get_rtcp_up_bw(ms) * 1e-3) : 0.f);
 	_linphone_call_stats_set_ip_family_of_remote(stats,
 		active ? (ortp_stream_is_ipv6(&ms->sessions.rtp_session->rtp.gs) ? LinphoneAddressFamilyInet6 : LinphoneAddressFamilyInet) : LinphoneAddressFamilyUnspec);
+	if (active)
+		addStatsSample(ms, stats, type);
 
 	if (q->getCore()->getCCore()->send_call_stats_periodical_updates) {
 		if (active)
@@ -3540,6 +3587,23 @@ void MediaSessionPrivate::reportBandwidthForStream (MediaStream *ms, LinphoneStr
 	}
 }
 
+void MediaSessionPrivate::addStatsSample (MediaStream *ms, const LinphoneCallStats *stats, LinphoneStreamType type) {
+	CallStatsHistory &history = statsHistories[type];
+	if (history.getCapacity() == 0)
+		return;
+
+	LinphoneCallStatsSample sample;
+	sample.time = ms_time(nullptr);
+	sample.download_bandwidth = linphone_call_stats_get_download_bandwidth(stats);
+	sample.upload_bandwidth = linphone_call_stats_get_upload_bandwidth(stats);
+	const MSQualityIndicator *qi = media_stream_get_quality_indicator(ms);
+	sample.local_loss_rate = qi ? ms_quality_indicator_get_local_loss_rate(qi) : 0.f;
+	sample.receiver_interarrival_jitter = linphone_call_stats_get_receiver_interarrival_jitter(stats);
+	sample.round_trip_delay = linphone_call_stats_get_round_trip_delay(stats);
+	sample.quality = media_stream_get_quality_rating(ms);
+	history.add(sample);
+}
+
 // -----------------------------------------------------------------------------
 
 void MediaSessionPrivate::abort (const string &errorMsg) {
@@ -3994,6 +4058,13 @@ MediaSession::MediaSession (const shared_ptr<Core> &core, shared_ptr<Participant
 	d->textStats = _linphone_call_stats_new();
 	d->initStats(d->textStats, LinphoneStreamTypeText);
 
+	// Read once for the session: the statistics are updated every second.
+	LinphoneConfig *config = linphone_core_get_config(getCore()->getCCore());
+	int statsHistorySize = lp_config_get_int(config, "rtp", "stats_history_size", MediaSessionPrivate::defaultStatsHistorySize);
+	for (auto &history : d->statsHistories)
+		history.setCapacity(static_cast<size_t>(max(0, statsHistorySize)));
+	d->logBandwidthUsage = !!lp_config_get_int(config, "rtp", "log_bandwidth_usage", 1);
+
 	int minPort, maxPort;
 	linphone_core_get_audio_port_range(getCore()->getCCore(), &minPort, &maxPort);
 	d->setPortConfig(d->mainAudioStreamIndex, make_pair(minPort, maxPort));
@@ -4011,6 +4082,7 @@ MediaSession::MediaSession (const shared_ptr<Core> &core, shared_ptr<Participant
 MediaSession::~MediaSession () {
 	L_D();
 	cancelDtmfs();
+	d->releasePorts();
 	if (d->audioStream || d->videoStream)
 		d->freeResources();
 	if (d->audioStats)
@@ -4027,6 +4099,7 @@ MediaSession::~MediaSession () {
 		sal_media_description_unref(d->biggestDesc);
 	if (d->resultDesc)
 		sal_media_description_unref(d->resultDesc);
+	d->clearCachedCodecs();
 }
 
 // -----------------------------------------------------------------------------
@@ -4735,6 +4808,19 @@ LinphoneCallStats * MediaSession::getStats (LinphoneStreamType type) const {
 	return statsCopy;
 }
 
+size_t MediaSession::getStatsHistory (
+	LinphoneStreamType type,
+	time_t since,
+	LinphoneCallStatsSample *samples,
+	size_t count
+) const {
+	L_D();
+	// The type comes from the C API: anything but audio, video or text, negative values included, has no history.
+	if (static_cast<size_t>(type) >= sizeof(d->statsHistories) / sizeof(d->statsHistories[0]))
+		return 0;
+	return d->statsHistories[type].copy(since, samples, count);
+}
+
 int MediaSession::getStreamCount () const {
 	/* TODO: Revisit when multiple media streams will be implemented */
 #ifdef VIDEO_ENABLED
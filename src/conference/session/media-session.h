@@ -93,6 +93,7 @@ public:
 	const MediaSessionParams *getRemoteParams ();
 	float getSpeakerVolumeGain () const;
 	LinphoneCallStats * getStats (LinphoneStreamType type) const;
+	size_t getStatsHistory (LinphoneStreamType type, time_t since, LinphoneCallStatsSample *samples, size_t count) const;
 	int getStreamCount () const;
 	MSFormatType getStreamType (int streamIndex) const;
 	LinphoneCallStats * getTextStats () const;
@@ -0,0 +1,181 @@
+/*
+ * rtp-port-allocator.cpp
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <mediastreamer2/mscommon.h>
+#include <ortp/ortp.h>
+
+#include "logger/logger.h"
+
+#include "rtp-port-allocator.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+int RtpPortAllocator::allocateFixed (int port) {
+	for (int triedPort = port; triedPort < port + 2 * maxFixedPortTries; triedPort += 2) {
+		if (isFree(triedPort)) {
+			take(triedPort);
+			return triedPort;
+		}
+	}
+	return -1;
+}
+
+int RtpPortAllocator::allocateInRange (int minPort, int maxPort, unsigned int reuseDelay) {
+	// Even ports whose RTCP port is still in the range.
+	int firstPort = max(minPort + (minPort & 1), 2);
+	int lastPort = min(maxPort, RtpPortAllocator::maxPort) - 1;
+	if (lastPort < firstPort)
+		return -1;
+
+	// The queue is sorted by release time: if its first valid port is still cooling down, all the others are too.
+	FreePortQueue &freePorts = getFreePorts(firstPort, lastPort);
+	while (!freePorts.empty()) {
+		const FreePort &freePort = freePorts.front();
+		if (!isValid(freePort)) {
+			freePorts.pop_front();
+			continue;
+		}
+
+		if (freePort.releaseTime != 0 && ms_get_cur_time_ms() - freePort.releaseTime < reuseDelay) {
+			lWarning() << "All free RTP ports in [" << minPort << ", " << maxPort << "] were released less than "
+				<< reuseDelay << " ms ago";
+			return -1;
+		}
+		int port = freePort.port;
+		freePorts.pop_front();
+		take(port);
+		return port;
+	}
+	return -1;
+}
+
+void RtpPortAllocator::release (int port) {
+	if (port <= 0 || port >= maxPort || !usedPorts.test(static_cast<size_t>(port)))
+		return;
+
+	usedPorts.reset(static_cast<size_t>(port));
+	usedPorts.reset(static_cast<size_t>(port + 1));
+
+	uint64_t now = ms_get_cur_time_ms();
+	releaseTimes[port] = now;
+	for (auto &entry : ranges) {
+		int firstPort = entry.first.first;
+		int lastPort = entry.first.second;
+		if (port < firstPort || port > lastPort || ((port - firstPort) & 1) != 0)
+			continue;
+
+		FreePortQueue &freePorts = entry.second.freePorts;
+		freePorts.push_back({ port, now });
+		// Ports taken from another range leave stale entries behind.
+		if (freePorts.size() > static_cast<size_t>(lastPort - firstPort + 2))
+			compact(freePorts);
+	}
+}
+
+bool RtpPortAllocator::isUsed (int port) const {
+	return port > 0 && port <= maxPort && usedPorts.test(static_cast<size_t>(port));
+}
+
+size_t RtpPortAllocator::getRangeCount () const {
+	return ranges.size();
+}
+
+// -----------------------------------------------------------------------------
+
+RtpPortAllocator::FreePortQueue &RtpPortAllocator::getFreePorts (int firstPort, int lastPort) {
+	auto it = ranges.find(make_pair(firstPort, lastPort));
+	if (it != ranges.end()) {
+		it->second.lastUse = ++useCount;
+		return it->second.freePorts;
+	}
+
+	pruneRanges();
+
+	// First use of the range: the ports never released come first in random order, then the released ones.
+	vector<int> ports;
+	vector<FreePort> releasedPorts;
+	for (int port = firstPort; port <= lastPort; port += 2) {
+		auto releaseIt = releaseTimes.find(port);
+		if (releaseIt == releaseTimes.end())
+			ports.push_back(port);
+		else
+			releasedPorts.push_back({ port, releaseIt->second });
+	}
+	for (size_t i = ports.size(); i > 1; i--)
+		swap(ports[i - 1], ports[ortp_random() % i]);
+	sort(releasedPorts.begin(), releasedPorts.end(), [](const FreePort &a, const FreePort &b) {
+		return a.releaseTime < b.releaseTime;
+	});
+
+	Range &range = ranges[make_pair(firstPort, lastPort)];
+	range.lastUse = ++useCount;
+	for (int port : ports)
+		range.freePorts.push_back({ port, 0 });
+	range.freePorts.insert(range.freePorts.end(), releasedPorts.begin(), releasedPorts.end());
+	return range.freePorts;
+}
+
+// Drops the least recently used range when a new one is about to be added, e.g. after the port range of a
+// stream type changed. Its queue is rebuilt from the release times if it is used again.
+void RtpPortAllocator::pruneRanges () {
+	if (ranges.size() < maxRanges)
+		return;
+
+	auto oldest = min_element(ranges.begin(), ranges.end(), [](
+		const pair<const pair<int, int>, Range> &a,
+		const pair<const pair<int, int>, Range> &b
+	) {
+		return a.second.lastUse < b.second.lastUse;
+	});
+	lInfo() << "Drop unused RTP port range [" << oldest->first.first << ", " << oldest->first.second + 1 << "]";
+	ranges.erase(oldest);
+}
+
+void RtpPortAllocator::compact (FreePortQueue &freePorts) {
+	freePorts.erase(remove_if(freePorts.begin(), freePorts.end(), [this](const FreePort &freePort) {
+		return !isValid(freePort);
+	}), freePorts.end());
+}
+
+bool RtpPortAllocator::isFree (int port) const {
+	return port > 0 && port < maxPort && !usedPorts.test(static_cast<size_t>(port)) &&
+		!usedPorts.test(static_cast<size_t>(port + 1));
+}
+
+bool RtpPortAllocator::isValid (const FreePort &freePort) const {
+	if (!isFree(freePort.port))
+		return false;
+	auto it = releaseTimes.find(freePort.port);
+	return it == releaseTimes.end() ? freePort.releaseTime == 0 : it->second == freePort.releaseTime;
+}
+
+void RtpPortAllocator::take (int port) {
+	usedPorts.set(static_cast<size_t>(port));
+	usedPorts.set(static_cast<size_t>(port + 1));
+	releaseTimes.erase(port);
+}
+
+LINPHONE_END_NAMESPACE
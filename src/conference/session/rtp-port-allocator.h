@@ -0,0 +1,93 @@
+/*
+ * rtp-port-allocator.h
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _L_RTP_PORT_ALLOCATOR_H_
+#define _L_RTP_PORT_ALLOCATOR_H_
+
+#include <bitset>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+// Keeps track of the ports used by the media streams of the calls of a core, in a bitmap. A port is allocated with
+// the next one, used by RTCP. Each range keeps its free ports in a queue, in random order first and then in release
+// order, so that the least recently released port is handed out in O(1). A port released less than reuseDelay
+// milliseconds ago is not handed out, so that late packets of a call do not reach the next one. Only the most
+// recently used ranges are kept, the queues of the others are dropped.
+class RtpPortAllocator {
+public:
+	RtpPortAllocator () = default;
+
+	// Takes port, or the first free port after it, stepping by 2. Returns -1 if none is free.
+	int allocateFixed (int port);
+	// Takes the least recently released free port between minPort and maxPort. Returns -1 if none is free or if
+	// all the free ones were released less than reuseDelay milliseconds ago.
+	int allocateInRange (int minPort, int maxPort, unsigned int reuseDelay);
+	void release (int port);
+
+	bool isUsed (int port) const;
+	size_t getRangeCount () const;
+
+private:
+	static const int maxPort = 65535;
+	// Number of ports tried from a fixed one, when the previous ones are used by other calls.
+	static const int maxFixedPortTries = 50;
+	// Audio, video and text ranges, with room for the previous ones after a configuration change.
+	static const size_t maxRanges = 8;
+
+	struct FreePort {
+		int port;
+		// 0 if the port was never released.
+		uint64_t releaseTime;
+	};
+
+	// Entries of a queue whose port was taken, or released again since, are skipped when they are popped.
+	typedef std::deque<FreePort> FreePortQueue;
+
+	struct Range {
+		FreePortQueue freePorts;
+		// Value of useCount when a port was last allocated from the range.
+		uint64_t lastUse;
+	};
+
+	FreePortQueue &getFreePorts (int firstPort, int lastPort);
+	void pruneRanges ();
+	void compact (FreePortQueue &freePorts);
+	bool isFree (int port) const;
+	bool isValid (const FreePort &freePort) const;
+	void take (int port);
+
+	std::bitset<maxPort + 1> usedPorts;
+	std::unordered_map<int, uint64_t> releaseTimes;
+	std::map<std::pair<int, int>, Range> ranges;
+	uint64_t useCount = 0;
+
+	L_DISABLE_COPY(RtpPortAllocator);
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_RTP_PORT_ALLOCATOR_H_
@@ -20,6 +20,8 @@
 #ifndef _L_CONTENT_P_H_
 #define _L_CONTENT_P_H_
 
+#include <memory>
+
 #include "content-disposition.h"
 #include "content-type.h"
 #include "content.h"
@@ -33,12 +35,17 @@ class Header;
 
 class ContentPrivate : public ClonableObjectPrivate {
 private:
-	std::vector<char> body;
+	// Shared between the copies of a content and never modified in place: setting a body always
+	// allocates a new buffer, so copying a content (or handing it to another one) does not copy the bytes.
+	std::shared_ptr<std::vector<char>> body;
 	ContentType contentType;
 	ContentDisposition contentDisposition;
 	std::string contentEncoding;
 	std::list<Header> headers;
 
+	const std::vector<char> &getBody () const;
+	void setBody (std::vector<char> &&newBody);
+
 	const std::list<std::pair<std::string, std::string>>::const_iterator findHeader (const std::string &headerName) const;
 
 	L_DECLARE_PUBLIC(Content);
@@ -17,6 +17,12 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
  */
 
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "linphone/utils/utils.h"
 
 #include "content-type.h"
@@ -31,10 +37,94 @@ LINPHONE_BEGIN_NAMESPACE
 
 // -----------------------------------------------------------------------------
 
+namespace {
+	// Parsed form shared by all the content types built from equivalent strings.
+	struct InternedContentType {
+		string type;
+		string subType;
+		string value;
+		list<HeaderParam> parameters;
+	};
+
+	// Multipart boundaries are unique to a message and never interned. Other values coming from the network may still be:
+	// stop interning new ones once the table is full, they are then parsed and compared as before.
+	constexpr size_t MaxInternedContentTypes = 256;
+
+	class ContentTypeTable {
+	public:
+		const InternedContentType *find (const string &contentType) {
+			lock_guard<mutex> lock(tableMutex);
+			auto it = byString.find(contentType);
+			return it == byString.end() ? nullptr : it->second;
+		}
+
+		const InternedContentType *intern (const string &contentType, const ContentType &parsed) {
+			if (hasBoundary(parsed))
+				return nullptr;
+
+			string key = getCanonicalKey(parsed);
+			lock_guard<mutex> lock(tableMutex);
+			auto it = byKey.find(key);
+			if (it == byKey.end()) {
+				if (byKey.size() >= MaxInternedContentTypes)
+					return nullptr;
+				unique_ptr<InternedContentType> interned(new InternedContentType);
+				interned->type = parsed.getType();
+				interned->subType = parsed.getSubType();
+				interned->value = parsed.getValue();
+				interned->parameters = parsed.getParameters();
+				it = byKey.emplace(move(key), move(interned)).first;
+			}
+			if (!contentType.empty() && (byString.size() < 2 * MaxInternedContentTypes))
+				byString[contentType] = it->second.get();
+			return it->second.get();
+		}
+
+		static ContentTypeTable &getInstance () {
+			// Never destroyed: static content types may be used until the very end of the program.
+			static ContentTypeTable *table = new ContentTypeTable;
+			return *table;
+		}
+
+	private:
+		static bool hasBoundary (const ContentType &contentType) {
+			for (const auto &param : contentType.getParameters()) {
+				if (Utils::stringToLower(param.getName()) == "boundary")
+					return true;
+			}
+			return false;
+		}
+
+		static string getKeyToken (const string &token) {
+			return to_string(token.size()) + ":" + token;
+		}
+
+		// Two content types are equal if and only if they have the same key, parameter names being unique.
+		static string getCanonicalKey (const ContentType &contentType) {
+			vector<string> parameters;
+			for (const auto &param : contentType.getParameters())
+				parameters.push_back(getKeyToken(param.getName()) + getKeyToken(param.getValue()));
+			sort(parameters.begin(), parameters.end());
+
+			string key = getKeyToken(contentType.getType()) + getKeyToken(contentType.getSubType());
+			for (const auto &param : parameters)
+				key += param;
+			return key;
+		}
+
+		mutex tableMutex;
+		unordered_map<string, const InternedContentType *> byString;
+		unordered_map<string, unique_ptr<InternedContentType>> byKey;
+	};
+}
+
+// -----------------------------------------------------------------------------
+
 class ContentTypePrivate : public HeaderPrivate {
 public:
 	string type;
 	string subType;
+	const InternedContentType *interned = nullptr;
 };
 
 // -----------------------------------------------------------------------------
@@ -56,6 +146,20 @@ const ContentType ContentType::Sdp("application/sdp");
 ContentType::ContentType (const string &contentType) : Header(*new ContentTypePrivate) {
 	L_D();
 
+	if (contentType.empty())
+		return;
+
+	ContentTypeTable &table = ContentTypeTable::getInstance();
+	const InternedContentType *interned = table.find(contentType);
+	if (interned) {
+		d->type = interned->type;
+		d->subType = interned->subType;
+		setValue(interned->value);
+		addParameters(interned->parameters);
+		d->interned = interned;
+		return;
+	}
+
 	size_t pos = contentType.find('/');
 	size_t posParam = contentType.find(";");
 	size_t end = contentType.length();
@@ -83,6 +187,8 @@ ContentType::ContentType (const string &contentType) : Header(*new ContentTypePr
 			params.erase(0, posParam + 1);
 		} while (posParam != std::string::npos);
 	}
+
+	d->interned = table.intern(contentType, *this);
 }
 
 ContentType::ContentType (const string &type, const string &subType) : Header(*new ContentTypePrivate) {
@@ -116,24 +222,40 @@ ContentType::ContentType (
 	addParameters(parameters);
 }
 
-ContentType::ContentType (const ContentType &other) : ContentType(other.getType(), other.getSubType(), other.getParameters()) {}
+ContentType::ContentType (const ContentType &other) : Header(*new ContentTypePrivate) {
+	*this = other;
+}
 
 ContentType &ContentType::operator= (const ContentType &other) {
+	L_D();
 	if (this != &other) {
-		setType(other.getType());
-		setSubType(other.getSubType());
+		// Already validated and lowercased, no need to go through the setters.
+		const ContentTypePrivate *dOther = other.getPrivate();
+		d->type = dOther->type;
+		d->subType = dOther->subType;
+		setValue(other.getValue());
 		cleanParameters();
 		addParameters(other.getParameters());
+		d->interned = dOther->interned;
 	}
 
 	return *this;
 }
 
 bool ContentType::weakEqual (const ContentType &other) const {
+	L_D();
+	const ContentTypePrivate *dOther = other.getPrivate();
+	if (d->interned && (d->interned == dOther->interned))
+		return true;
 	return (getType() == other.getType()) && (getSubType() == other.getSubType());
 }
 
 bool ContentType::operator== (const ContentType &other) const {
+	L_D();
+	const ContentTypePrivate *dOther = other.getPrivate();
+	if (d->interned && dOther->interned)
+		return d->interned == dOther->interned;
+
 	if (!weakEqual(other))
 		return false;
 	if (getParameters().size() != other.getParameters().size())
@@ -192,6 +314,11 @@ bool ContentType::isValid () const {
 	return !d->type.empty() && !d->subType.empty();
 }
 
+void ContentType::onModified () {
+	L_D();
+	d->interned = nullptr;
+}
+
 bool ContentType::isMultipart() const {
 	return getType() == "multipart";
 }
@@ -76,6 +76,8 @@ public:
 	static const ContentType Sdp;
 
 private:
+	void onModified () override;
+
 	L_DECLARE_PRIVATE(ContentType);
 };
 
@@ -35,6 +35,19 @@ LINPHONE_BEGIN_NAMESPACE
 
 // =============================================================================
 
+const vector<char> &ContentPrivate::getBody () const {
+	return body ? *body : Utils::getEmptyConstRefObject<vector<char>>();
+}
+
+void ContentPrivate::setBody (vector<char> &&newBody) {
+	if (newBody.empty())
+		body = nullptr;
+	else
+		body = make_shared<vector<char>>(move(newBody));
+}
+
+// =============================================================================
+
 Content::Content () : ClonableObject(*new ContentPrivate) {}
 
 Content::Content (const Content &other) : ClonableObject(*new ContentPrivate), AppDataContainer(other) {
@@ -58,8 +71,10 @@ Content::~Content () {
 	/*
 	 * Fills the body with zeros before releasing since it may contain
 	 * private data like cipher keys or decoded messages.
+	 * Only the last content referencing the body does it.
 	 */
-	d->body.assign(d->body.size(), 0);
+	if (d->body && (d->body.use_count() == 1))
+		d->body->assign(d->body->size(), 0);
 }
 
 Content &Content::operator= (const Content &other) {
@@ -84,8 +99,9 @@ Content &Content::operator= (Content &&other) {
 
 bool Content::operator== (const Content &other) const {
 	L_D();
+	const ContentPrivate *dOther = other.getPrivate();
 	return d->contentType == other.getContentType() &&
-		d->body == other.getBody() &&
+		(d->body == dOther->body || d->getBody() == dOther->getBody()) &&
 		d->contentDisposition == other.getContentDisposition() &&
 		d->contentEncoding == other.getContentEncoding() &&
 		d->headers == other.getHeaders();
@@ -93,7 +109,7 @@ bool Content::operator== (const Content &other) const {
 
 void Content::copy(const Content &other) {
 	L_D();
-	d->body = other.getBody();
+	d->body = other.getPrivate()->body;
 	d->contentType = other.getContentType();
 	d->contentDisposition = other.getContentDisposition();
 	d->contentEncoding = other.getContentEncoding();
@@ -132,49 +148,56 @@ void Content::setContentEncoding (const string &contentEncoding) {
 
 const vector<char> &Content::getBody () const {
 	L_D();
-	return d->body;
+	return d->getBody();
 }
 
 string Content::getBodyAsString () const {
 	L_D();
-	return Utils::utf8ToLocale(string(d->body.begin(), d->body.end()));
+	const vector<char> &body = d->getBody();
+	return Utils::utf8ToLocale(string(body.begin(), body.end()));
 }
 
 string Content::getBodyAsUtf8String () const {
 	L_D();
-	return string(d->body.begin(), d->body.end());
+	const vector<char> &body = d->getBody();
+	return string(body.begin(), body.end());
 }
 
 void Content::setBody (const vector<char> &body) {
 	L_D();
-	d->body = body;
+	d->setBody(vector<char>(body));
 }
 
 void Content::setBody (vector<char> &&body) {
 	L_D();
-	d->body = move(body);
+	d->setBody(move(body));
 }
 
 void Content::setBody (const string &body) {
 	L_D();
 	string toUtf8 = Utils::localeToUtf8(body);
-	d->body = vector<char>(toUtf8.cbegin(), toUtf8.cend());
+	d->setBody(vector<char>(toUtf8.cbegin(), toUtf8.cend()));
 }
 
 void Content::setBody (const void *buffer, size_t size) {
 	L_D();
 	const char *start = static_cast<const char *>(buffer);
-	d->body = vector<char>(start, start + size);
+	d->setBody(vector<char>(start, start + size));
 }
 
 void Content::setBodyFromUtf8 (const string &body) {
 	L_D();
-	d->body = vector<char>(body.cbegin(), body.cend());
+	d->setBody(vector<char>(body.cbegin(), body.cend()));
+}
+
+void Content::shareBody (const Content &other) {
+	L_D();
+	d->body = other.getPrivate()->body;
 }
 
 size_t Content::getSize () const {
 	L_D();
-	return d->body.size();
+	return d->getBody().size();
 }
 
 bool Content::isEmpty () const {
@@ -183,7 +206,7 @@ bool Content::isEmpty () const {
 
 bool Content::isValid () const {
 	L_D();
-	return d->contentType.isValid() || (d->contentType.isEmpty() && d->body.empty());
+	return d->contentType.isValid() || (d->contentType.isEmpty() && d->getBody().empty());
 }
 
 bool Content::isFile () const {
@@ -74,6 +74,9 @@ public:
 	void setBody (const void *buffer, size_t size);
 	void setBodyFromUtf8 (const std::string &body);
 
+	// Use the body of another content without copying it.
+	void shareBody (const Content &other);
+
 	size_t getSize () const;
 
 	bool isValid () const;
@@ -35,6 +35,7 @@ class FileContentPrivate : public ContentPrivate {
 public:
 	string fileName;
 	string filePath;
+	string thumbnailFilePath;
 	size_t fileSize = 0;
 };
 
@@ -47,6 +48,7 @@ FileContent::FileContent (const FileContent &other) : Content(*new FileContentPr
 	Content::copy(other);
 	d->fileName = other.getFileName();
 	d->filePath = other.getFilePath();
+	d->thumbnailFilePath = other.getThumbnailFilePath();
 	d->fileSize = other.getFileSize();
 }
 
@@ -55,6 +57,7 @@ FileContent::FileContent (FileContent &&other) : Content(*new FileContentPrivate
 	Content::copy(other);
 	d->fileName = move(other.getPrivate()->fileName);
 	d->filePath = move(other.getPrivate()->filePath);
+	d->thumbnailFilePath = move(other.getPrivate()->thumbnailFilePath);
 	d->fileSize = move(other.getPrivate()->fileSize);
 }
 
@@ -63,6 +66,7 @@ FileContent &FileContent::operator= (const FileContent &other) {
 	Content::operator=(other);
 	d->fileName = other.getFileName();
 	d->filePath = other.getFilePath();
+	d->thumbnailFilePath = other.getThumbnailFilePath();
 	d->fileSize = other.getFileSize();
 	return *this;
 }
@@ -72,6 +76,7 @@ FileContent &FileContent::operator= (FileContent &&other) {
 	Content::operator=(move(other));
 	d->fileName = move(other.getPrivate()->fileName);
 	d->filePath = move(other.getPrivate()->filePath);
+	d->thumbnailFilePath = move(other.getPrivate()->thumbnailFilePath);
 	d->fileSize = move(other.getPrivate()->fileSize);
 	return *this;
 }
@@ -81,6 +86,7 @@ bool FileContent::operator== (const FileContent &other) const {
 	return Content::operator==(other) &&
 		d->fileName == other.getFileName() &&
 		d->filePath == other.getFilePath() &&
+		d->thumbnailFilePath == other.getThumbnailFilePath() &&
 		d->fileSize == other.getFileSize();
 }
 
@@ -114,6 +120,16 @@ const string &FileContent::getFilePath () const {
 	return d->filePath;
 }
 
+void FileContent::setThumbnailFilePath (const string &path) {
+	L_D();
+	d->thumbnailFilePath = path;
+}
+
+const string &FileContent::getThumbnailFilePath () const {
+	L_D();
+	return d->thumbnailFilePath;
+}
+
 bool FileContent::isFile () const {
 	return true;
 }
@@ -52,6 +52,10 @@ public:
 	void setFilePath (const std::string &path);
 	const std::string &getFilePath () const;
 
+	// Optional smaller version of the file, uploaded along with it so that receivers can show it first.
+	void setThumbnailFilePath (const std::string &path);
+	const std::string &getThumbnailFilePath () const;
+
 	bool isFile () const override;
 	bool isFileTransfer () const override;
 
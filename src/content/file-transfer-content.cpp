@@ -35,6 +35,7 @@ class FileTransferContentPrivate : public ContentPrivate {
 public:
 	string fileName;
 	string fileUrl;
+	string thumbnailUrl;
 	string filePath;
 	FileContent *fileContent = nullptr;
 	size_t fileSize = 0;
@@ -52,6 +53,7 @@ FileTransferContent::FileTransferContent (const FileTransferContent &other) : Co
 	Content::copy(other);
 	d->fileName = other.getFileName();
 	d->fileUrl = other.getFileUrl();
+	d->thumbnailUrl = other.getThumbnailUrl();
 	d->filePath = other.getFilePath();
 	d->fileContent = other.getFileContent();
 	d->fileSize = other.getFileSize();
@@ -63,6 +65,7 @@ FileTransferContent::FileTransferContent (FileTransferContent &&other) : Content
 	Content::copy(other);
 	d->fileName = move(other.getPrivate()->fileName);
 	d->fileUrl = move(other.getPrivate()->fileUrl);
+	d->thumbnailUrl = move(other.getPrivate()->thumbnailUrl);
 	d->filePath = move(other.getPrivate()->filePath);
 	d->fileContent = move(other.getPrivate()->fileContent);
 	d->fileSize = move(other.getPrivate()->fileSize);
@@ -75,6 +78,7 @@ FileTransferContent &FileTransferContent::operator= (const FileTransferContent &
 		Content::operator=(other);
 		d->fileName = other.getFileName();
 		d->fileUrl = other.getFileUrl();
+		d->thumbnailUrl = other.getThumbnailUrl();
 		d->filePath = other.getFilePath();
 		d->fileContent = other.getFileContent();
 		d->fileSize = other.getFileSize();
@@ -89,6 +93,7 @@ FileTransferContent &FileTransferContent::operator= (FileTransferContent &&other
 	Content::operator=(move(other));
 	d->fileName = move(other.getPrivate()->fileName);
 	d->fileUrl = move(other.getPrivate()->fileUrl);
+	d->thumbnailUrl = move(other.getPrivate()->thumbnailUrl);
 	d->filePath = move(other.getPrivate()->filePath);
 	d->fileContent = move(other.getPrivate()->fileContent);
 	d->fileSize = move(other.getPrivate()->fileSize);
@@ -102,6 +107,7 @@ bool FileTransferContent::operator== (const FileTransferContent &other) const {
 	return Content::operator==(other) &&
 		d->fileName == other.getFileName() &&
 		d->fileUrl == other.getFileUrl() &&
+		d->thumbnailUrl == other.getThumbnailUrl() &&
 		d->filePath == other.getFilePath() &&
 		d->fileSize == other.getFileSize();
 }
@@ -126,6 +132,16 @@ const string &FileTransferContent::getFileUrl () const {
 	return d->fileUrl;
 }
 
+void FileTransferContent::setThumbnailUrl (const string &url) {
+	L_D();
+	d->thumbnailUrl = url;
+}
+
+const string &FileTransferContent::getThumbnailUrl () const {
+	L_D();
+	return d->thumbnailUrl;
+}
+
 void FileTransferContent::setFilePath (const string &path) {
 	L_D();
 	d->filePath = path;
@@ -52,6 +52,9 @@ public:
 	void setFileUrl (const std::string &url);
 	const std::string &getFileUrl () const;
 
+	void setThumbnailUrl (const std::string &url);
+	const std::string &getThumbnailUrl () const;
+
 	void setFilePath (const std::string &path);
 	const std::string &getFilePath () const;
 
@@ -102,6 +102,7 @@ string Header::getName () const {
 void Header::setValue (const string &value) {
 	L_D();
 	d->value = value;
+	onModified();
 }
 
 string Header::getValue () const {
@@ -112,6 +113,7 @@ string Header::getValue () const {
 void Header::cleanParameters () {
 	L_D();
 	d->parameters.clear();
+	onModified();
 }
 
 const list<HeaderParam> &Header::getParameters () const {
@@ -127,6 +129,7 @@ void Header::addParameter (const HeaderParam &param) {
 	L_D();
 	removeParameter(param);
 	d->parameters.push_back(param);
+	onModified();
 }
 
 void Header::addParameters(const list<HeaderParam> &params) {
@@ -139,8 +142,10 @@ void Header::addParameters(const list<HeaderParam> &params) {
 void Header::removeParameter (const string &paramName) {
 	L_D();
 	auto it = findParameter(paramName);
-	if (it != d->parameters.cend())
+	if (it != d->parameters.cend()) {
 		d->parameters.remove(*it);
+		onModified();
+	}
 }
 
 void Header::removeParameter (const HeaderParam &param) {
@@ -70,6 +70,9 @@ public:
 protected:
 	explicit Header (HeaderPrivate &p);
 
+	// Called whenever the value or the parameters are changed.
+	virtual void onModified () {}
+
 private:
 	L_DECLARE_PRIVATE(Header);
 };
@@ -0,0 +1,138 @@
+/*
+ * multipart-builder.cpp
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <cstring>
+
+#include "linphone/utils/utils.h"
+
+#include "content-type.h"
+#include "header/header.h"
+#include "header/header-param.h"
+#include "multipart-builder.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+namespace {
+	constexpr const char CrLf[] = "\r\n";
+	constexpr const char Dashes[] = "--";
+	constexpr const char HeaderSeparator[] = ": ";
+	constexpr const char ContentTypeHeader[] = "Content-Type: ";
+	constexpr const char ContentLengthHeader[] = "Content-Length: ";
+
+	// Same layout as belle-sip's marshalling of a generic header: "Name: value;param=value".
+	string headerToString (const Header &header) {
+		string str = header.getName() + HeaderSeparator + header.getValue();
+		for (const auto &param : header.getParameters())
+			str += param.asString();
+		return str;
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+MultipartBuilder::MultipartBuilder (const string &boundary) : boundary(boundary) {}
+
+const string &MultipartBuilder::getBoundary () const {
+	return boundary;
+}
+
+void MultipartBuilder::reserve (size_t size) {
+	buffer.reserve(size);
+}
+
+size_t MultipartBuilder::getSize () const {
+	return buffer.size();
+}
+
+void MultipartBuilder::addPart (const ContentType &contentType, const char *body, size_t size, const list<Header> &headers) {
+	// Delimiter of the previous part is shared with the opening delimiter of this one.
+	if (nbParts > 0)
+		append(CrLf);
+	append(Dashes);
+	append(boundary);
+	append(CrLf);
+
+	for (const auto &header : headers) {
+		append(headerToString(header));
+		append(CrLf);
+	}
+	append(ContentTypeHeader);
+	append(contentType.asString());
+	append(CrLf);
+	append(ContentLengthHeader);
+	append(Utils::toString(size));
+	append(CrLf);
+	append(CrLf);
+
+	append(body, size);
+	nbParts++;
+}
+
+void MultipartBuilder::addPart (const ContentType &contentType, const string &body, const list<Header> &headers) {
+	addPart(contentType, body.c_str(), body.size(), headers);
+}
+
+Content MultipartBuilder::finish () {
+	if (nbParts > 0)
+		append(CrLf);
+	append(Dashes);
+	append(boundary);
+	append(Dashes);
+	append(CrLf);
+
+	ContentType contentType(ContentType::Multipart);
+	contentType.addParameter("boundary", boundary);
+
+	Content content;
+	content.setContentType(contentType);
+	content.setBody(move(buffer));
+
+	buffer = vector<char>();
+	nbParts = 0;
+	return content;
+}
+
+size_t MultipartBuilder::getPartOverhead (const ContentType &contentType, size_t size, const list<Header> &headers) const {
+	size_t overhead = strlen(CrLf) + strlen(Dashes) + boundary.size() + strlen(CrLf);
+	for (const auto &header : headers)
+		overhead += headerToString(header).size() + strlen(CrLf);
+	overhead += strlen(ContentTypeHeader) + contentType.asString().size() + strlen(CrLf);
+	overhead += strlen(ContentLengthHeader) + Utils::toString(size).size() + 2 * strlen(CrLf);
+	return overhead;
+}
+
+// -----------------------------------------------------------------------------
+
+void MultipartBuilder::append (const char *str) {
+	append(str, strlen(str));
+}
+
+void MultipartBuilder::append (const string &str) {
+	buffer.insert(buffer.end(), str.cbegin(), str.cend());
+}
+
+void MultipartBuilder::append (const char *data, size_t size) {
+	buffer.insert(buffer.end(), data, data + size);
+}
+
+LINPHONE_END_NAMESPACE
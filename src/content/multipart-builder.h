@@ -0,0 +1,84 @@
+/*
+ * multipart-builder.h
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _L_MULTIPART_BUILDER_H_
+#define _L_MULTIPART_BUILDER_H_
+
+#include <list>
+#include <string>
+#include <vector>
+
+#include "content-manager.h"
+#include "content.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+class ContentType;
+class Header;
+
+// Writes a multipart body part by part into a single buffer, without creating
+// intermediate Content or body handler objects like ContentManager::contentListToMultipart.
+// Parts are laid out as belle-sip does: additional headers, Content-Type then Content-Length.
+class MultipartBuilder {
+public:
+	explicit MultipartBuilder (const std::string &boundary = MultipartBoundary);
+
+	const std::string &getBoundary () const;
+
+	void reserve (size_t size);
+	size_t getSize () const;
+
+	void addPart (
+		const ContentType &contentType,
+		const char *body,
+		size_t size,
+		const std::list<Header> &headers = std::list<Header>()
+	);
+	void addPart (
+		const ContentType &contentType,
+		const std::string &body,
+		const std::list<Header> &headers = std::list<Header>()
+	);
+
+	// Closes the multipart body and moves it into a multipart/mixed content.
+	// The builder is empty afterwards.
+	Content finish ();
+
+	// Number of bytes added around a part body (delimiter and headers), to reserve the buffer.
+	size_t getPartOverhead (
+		const ContentType &contentType,
+		size_t size,
+		const std::list<Header> &headers = std::list<Header>()
+	) const;
+
+private:
+	void append (const char *str);
+	void append (const std::string &str);
+	void append (const char *data, size_t size);
+
+	std::string boundary;
+	std::vector<char> buffer;
+	int nbParts = 0;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_MULTIPART_BUILDER_H_
@@ -22,8 +22,10 @@
 
 #include "core-p.h"
 #include "call/call-p.h"
+#include "chat/chat-message/file-transfer-scheduler.h"
 #include "conference/session/call-session-p.h"
 #include "logger/logger.h"
+#include "utils/metrics.h"
 
 // TODO: Remove me later.
 #include "c-wrapper/c-wrapper.h"
@@ -45,6 +47,10 @@ int CorePrivate::addCall (const shared_ptr<Call> &call) {
 	if (!hasCalls())
 		notifySoundcardUsage(true);
 	calls.push_back(call);
+	Metrics::get().callsTotal.increment();
+	Metrics::get().callsActive.increment();
+	if (call->getPrivate()->hasPendingWork())
+		setCallPendingWork(call, true);
 	linphone_core_notify_call_created(q->getCCore(), L_GET_C_BACK_PTR(call));
 	return 0;
 }
@@ -84,12 +90,26 @@ bool CorePrivate::isAlreadyInCallWithAddress (const Address &addr) const {
 	return false;
 }
 
-void CorePrivate::iterateCalls (time_t currentRealTime, bool oneSecondElapsed) const {
-	// Make a copy of the list af calls because it may be altered during calls to the Call::iterate method
-	list<shared_ptr<Call>> savedCalls(calls);
-	for (const auto &call : savedCalls) {
-		call->getPrivate()->iterate(currentRealTime, oneSecondElapsed);
+void CorePrivate::iterateCalls (time_t currentRealTime, bool oneSecondElapsed) {
+	// Calls with no pending work (an established audio call, a ringing one) may be iterated at a lower rate:
+	// their streams have little to report meanwhile, and every call is iterated when a second elapsed.
+	// In between, only the busy calls are visited.
+	uint64_t currentTime = ms_get_cur_time_ms();
+	list<shared_ptr<Call>> savedCalls;
+	if (
+		oneSecondElapsed || idleCallIterationInterval <= 0 ||
+		currentTime - lastIdleCallsIterationTime >= static_cast<uint64_t>(idleCallIterationInterval)
+	) {
+		lastIdleCallsIterationTime = currentTime;
+		// Make a copy of the list af calls because it may be altered during calls to the Call::iterate method
+		savedCalls = calls;
+	} else {
+		for (Call *call : busyCalls)
+			savedCalls.push_back(call->getSharedFromThis());
 	}
+
+	for (const auto &call : savedCalls)
+		call->getPrivate()->iterate(currentRealTime, oneSecondElapsed);
 }
 
 void CorePrivate::notifySoundcardUsage (bool used) {
@@ -107,9 +127,25 @@ int CorePrivate::removeCall (const shared_ptr<Call> &call) {
 		return -1;
 	}
 	calls.erase(iter);
+	Metrics::get().callsActive.decrement();
+	setCallPendingWork(call, false);
+	if (fileTransferScheduler)
+		fileTransferScheduler->callRemoved();
 	return 0;
 }
 
+void CorePrivate::setCallPendingWork (const shared_ptr<Call> &call, bool pendingWork) {
+	if (!pendingWork) {
+		if (busyCalls.erase(call.get()))
+			Metrics::get().callsBusy.decrement();
+		return;
+	}
+
+	// A session may report its work before its call is added, the call is checked again when it is.
+	if (find(calls.begin(), calls.end(), call) != calls.end() && busyCalls.insert(call.get()).second)
+		Metrics::get().callsBusy.increment();
+}
+
 void CorePrivate::unsetVideoWindowId (bool preview, void *id) {
 #ifdef VIDEO_ENABLED
 	for (const auto &call : calls) {
@@ -20,6 +20,8 @@
 #ifndef _L_CORE_P_H_
 #define _L_CORE_P_H_
 
+#include <unordered_set>
+
 #include "chat/chat-room/abstract-chat-room.h"
 #include "core.h"
 #include "db/main-db.h"
@@ -31,8 +33,11 @@
 LINPHONE_BEGIN_NAMESPACE
 
 class CoreListener;
+class FileTransferScheduler;
 class LocalConferenceListEventHandler;
+class OutgoingMessageScheduler;
 class RemoteConferenceListEventHandler;
+class RtpPortAllocator;
 
 class CorePrivate : public ObjectPrivate {
 public:
@@ -52,9 +57,10 @@ public:
 	bool hasCalls () const { return !calls.empty(); }
 	bool inviteReplacesABrokenCall (SalCallOp *op);
 	bool isAlreadyInCallWithAddress (const Address &addr) const;
-	void iterateCalls (time_t currentRealTime, bool oneSecondElapsed) const;
+	void iterateCalls (time_t currentRealTime, bool oneSecondElapsed);
 	void notifySoundcardUsage (bool used);
 	int removeCall (const std::shared_ptr<Call> &call);
+	void setCallPendingWork (const std::shared_ptr<Call> &call, bool pendingWork);
 	void setCurrentCall (const std::shared_ptr<Call> &call) { currentCall = call; }
 	void unsetVideoWindowId (bool preview, void *id);
 
@@ -72,13 +78,22 @@ public:
 	std::unique_ptr<MainDb> mainDb;
 	std::unique_ptr<RemoteConferenceListEventHandler> remoteListEventHandler;
 	std::unique_ptr<LocalConferenceListEventHandler> localListEventHandler;
+	std::unique_ptr<OutgoingMessageScheduler> outgoingMessageScheduler;
+	std::unique_ptr<FileTransferScheduler> fileTransferScheduler;
+	std::unique_ptr<RtpPortAllocator> rtpPortAllocator;
 
 private:
 	bool isInBackground = false;
 
+	// Read at startup from [misc] idle_call_iteration_interval, in milliseconds. 0 iterates every call each time.
+	int idleCallIterationInterval = 0;
+	uint64_t lastIdleCallsIterationTime = 0;
+
 	std::list<CoreListener *> listeners;
 
 	std::list<std::shared_ptr<Call>> calls;
+	// Calls with pending work, kept up to date by their sessions. The others wait for idleCallIterationInterval.
+	std::unordered_set<Call *> busyCalls;
 	std::shared_ptr<Call> currentCall;
 
 	std::list<std::shared_ptr<AbstractChatRoom>> chatRooms;
@@ -22,13 +22,17 @@
 
 #include "address/address-p.h"
 #include "call/call.h"
+#include "chat/chat-message/file-transfer-scheduler.h"
+#include "chat/chat-message/outgoing-message-scheduler.h"
 #include "chat/chat-room/chat-room.h"
 #include "conference/handlers/local-conference-list-event-handler.h"
 #include "conference/handlers/remote-conference-list-event-handler.h"
+#include "conference/session/rtp-port-allocator.h"
 #include "core/core-listener.h"
 #include "core/core-p.h"
 #include "logger/logger.h"
 #include "paths/paths.h"
+#include "utils/metrics.h"
 
 // TODO: Remove me later.
 #include "c-wrapper/c-wrapper.h"
@@ -47,6 +51,12 @@ void CorePrivate::init () {
 	mainDb.reset(new MainDb(q->getSharedFromThis()));
 	remoteListEventHandler = makeUnique<RemoteConferenceListEventHandler>(q->getSharedFromThis());
 	localListEventHandler = makeUnique<LocalConferenceListEventHandler>(q->getSharedFromThis());
+	outgoingMessageScheduler = makeUnique<OutgoingMessageScheduler>(q->getSharedFromThis());
+	fileTransferScheduler = makeUnique<FileTransferScheduler>(q->getSharedFromThis());
+	rtpPortAllocator = makeUnique<RtpPortAllocator>();
+	idleCallIterationInterval = lp_config_get_int(
+		linphone_core_get_config(L_GET_C_BACK_PTR(q)), "misc", "idle_call_iteration_interval", 0
+	);
 
 	AbstractDb::Backend backend;
 	string uri = L_C_TO_STRING(lp_config_get_string(linphone_core_get_config(L_GET_C_BACK_PTR(q)), "storage", "uri", nullptr));
@@ -82,6 +92,14 @@ void CorePrivate::uninit () {
 		ms_usleep(10000);
 	}
 
+	if (outgoingMessageScheduler)
+		outgoingMessageScheduler->clear();
+	outgoingMessageScheduler = nullptr;
+	if (fileTransferScheduler)
+		fileTransferScheduler->clear();
+	fileTransferScheduler = nullptr;
+	rtpPortAllocator = nullptr;
+
 	chatRooms.clear();
 	chatRoomsById.clear();
 	noCreatedClientGroupChatRooms.clear();
@@ -107,6 +125,11 @@ void CorePrivate::notifyNetworkReachable (bool sipNetworkReachable, bool mediaNe
 }
 
 void CorePrivate::notifyRegistrationStateChanged (LinphoneProxyConfig *cfg, LinphoneRegistrationState state, const string &message) {
+	if (state == LinphoneRegistrationOk)
+		Metrics::get().registrationsSucceeded.increment();
+	else if (state == LinphoneRegistrationFailed)
+		Metrics::get().registrationsFailed.increment();
+
 	auto listenersCopy = listeners; // Allow removable of a listener in its own call
 	for (const auto &listener : listenersCopy)
 		listener->onRegistrationStateChanged(cfg, state, message);
@@ -20,8 +20,11 @@
 #ifndef _L_DB_TRANSACTION_H_
 #define _L_DB_TRANSACTION_H_
 
+#include <chrono>
+
 #include "db/main-db-p.h"
 #include "logger/logger.h"
+#include "utils/metrics.h"
 
 // =============================================================================
 
@@ -91,6 +94,23 @@ public:
 	>::type;
 
 	DbTransaction (DbTransactionInfo &info, Function &&function) : mFunction(std::move(function)) {
+		const auto start = std::chrono::steady_clock::now();
+		if (!run(info))
+			Metrics::get().dbTransactionErrors.increment();
+		Metrics::get().dbTransactionDuration.observe(
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()
+		);
+	}
+
+	DbTransaction (DbTransaction &&DbTransaction) : mFunction(std::move(DbTransaction.mFunction)) {}
+
+	operator ReturnType () const {
+		return mResult;
+	}
+
+private:
+	// Returns false if the transaction could not be executed.
+	bool run (DbTransactionInfo &info) {
 		MainDb *mainDb = info.mainDb;
 		const char *name = info.name;
 		soci::session *session = mainDb->getPrivate()->dbSession.getBackendSession();
@@ -98,6 +118,7 @@ public:
 		try {
 			SmartTransaction tr(session, name);
 			mResult = exec<InternalReturnType>(tr);
+			return true;
 		} catch (const soci::soci_error &e) {
 			lWarning() << "Catched exception in MainDb::" << name << "(" << e.what() << ").";
 			soci::soci_error::error_category category = e.get_error_category();
@@ -108,25 +129,20 @@ public:
 				try {
 					SmartTransaction tr(session, name);
 					mResult = exec<InternalReturnType>(tr);
+					return true;
 				} catch (const std::exception &e) {
 					lError() << "Unable to execute query after reconnect in MainDb::" << name << "(" << e.what() << ").";
 				}
-				return;
+				return false;
 			}
 			lError() << "Unhandled [" << getErrorCategoryAsString(category) << "] exception in MainDb::" <<
 				name << ": `" << e.what() << "`.";
 		} catch (const std::exception &e) {
 			lError() << "Unhandled generic exception in MainDb::" << name << ": `" << e.what() << "`.";
 		}
+		return false;
 	}
 
-	DbTransaction (DbTransaction &&DbTransaction) : mFunction(std::move(DbTransaction.mFunction)) {}
-
-	operator ReturnType () const {
-		return mResult;
-	}
-
-private:
 	// Exec function with no return type.
 	template<typename T>
 	typename std::enable_if<std::is_same<T, void>::value, bool>::type exec (SmartTransaction &tr) const {
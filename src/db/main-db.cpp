@@ -18,6 +18,7 @@
  */
 
 #include <ctime>
+#include <unordered_set>
 
 #include "linphone/utils/algorithm.h"
 #include "linphone/utils/static-string.h"
@@ -48,7 +49,7 @@ using namespace std;
 LINPHONE_BEGIN_NAMESPACE
 
 namespace {
-	constexpr unsigned int ModuleVersionEvents = makeVersion(1, 0, 5);
+	constexpr unsigned int ModuleVersionEvents = makeVersion(1, 0, 6);
 	constexpr unsigned int ModuleVersionFriends = makeVersion(1, 0, 0);
 	constexpr unsigned int ModuleVersionLegacyFriendsImport = makeVersion(1, 0, 0);
 	constexpr unsigned int ModuleVersionLegacyHistoryImport = makeVersion(1, 0, 0);
@@ -270,9 +271,10 @@ void MainDbPrivate::insertContent (long long chatMessageId, const Content &conte
 		const string &name = fileContent.getFileName();
 		const size_t &size = fileContent.getFileSize();
 		const string &path = fileContent.getFilePath();
-		*session << "INSERT INTO chat_message_file_content (chat_message_content_id, name, size, path) VALUES"
-			" (:chatMessageContentId, :name, :size, :path)",
-			soci::use(chatMessageContentId), soci::use(name), soci::use(size), soci::use(path);
+		const string &thumbnailPath = fileContent.getThumbnailFilePath();
+		*session << "INSERT INTO chat_message_file_content (chat_message_content_id, name, size, path, thumbnail_path) VALUES"
+			" (:chatMessageContentId, :name, :size, :path, :thumbnailPath)",
+			soci::use(chatMessageContentId), soci::use(name), soci::use(size), soci::use(path), soci::use(thumbnailPath);
 	}
 
 	for (const auto &appData : content.getAppDataMap())
@@ -1120,6 +1122,8 @@ void MainDbPrivate::updateSchema () {
 
 		*session << queryDisplay;
 	}
+	if (version < makeVersion(1, 0, 6))
+		*session << "ALTER TABLE chat_message_file_content ADD COLUMN thumbnail_path VARCHAR(512) NOT NULL DEFAULT ''";
 }
 
 // -----------------------------------------------------------------------------
@@ -2061,6 +2065,66 @@ list<shared_ptr<ChatMessage>> MainDb::getUnreadChatMessages (const ChatRoomId &c
 	};
 }
 
+// Returns the unread messages that cannot be handled by the set-based update of markChatMessagesAsRead:
+// the ones loaded in memory, whose state must be changed, and, if requested, the ones which are still
+// waiting for a display notification. The others are never loaded.
+list<shared_ptr<ChatMessage>> MainDb::getChatMessagesToMarkAsRead (
+	const ChatRoomId &chatRoomId,
+	bool withDisplayNotification
+) const {
+	// Ids of the unread messages of the chat room, used to find the ones living in memory.
+	static const string unreadQuery = "SELECT event_id FROM conference_chat_message_event"
+		"  WHERE event_id IN ("
+		"    SELECT event_id FROM conference_event WHERE chat_room_id = :chatRoomId"
+		"  ) AND direction = " + Utils::toString(int(ChatMessage::Direction::Incoming)) +
+		"  AND state <> " + Utils::toString(int(ChatMessage::State::Displayed));
+	static const string displayNotificationQuery = Statements::get(Statements::SelectConferenceEvents) +
+		string(" AND direction = ") + Utils::toString(int(ChatMessage::Direction::Incoming)) +
+		" AND state <> " + Utils::toString(int(ChatMessage::State::Displayed)) +
+		" AND display_notification_required = 1";
+
+	DurationLogger durationLogger(
+		"Get chat messages to mark as read: (peer=" + chatRoomId.getPeerAddress().asString() +
+		", local=" + chatRoomId.getLocalAddress().asString() + ")."
+	);
+
+	return L_DB_TRANSACTION {
+		L_D();
+
+		list<shared_ptr<ChatMessage>> chatMessages;
+		unordered_set<const ChatMessage *> foundChatMessages;
+		soci::session *session = d->dbSession.getBackendSession();
+		long long dbChatRoomId = d->selectChatRoomId(chatRoomId);
+
+		soci::rowset<soci::row> unreadRows = (session->prepare << unreadQuery, soci::use(dbChatRoomId));
+		for (const auto &row : unreadRows) {
+			shared_ptr<ChatMessage> chatMessage = d->getChatMessageFromCache(d->dbSession.resolveId(row, 0));
+			if (chatMessage && foundChatMessages.insert(chatMessage.get()).second)
+				chatMessages.push_back(chatMessage);
+		}
+
+		if (!withDisplayNotification)
+			return chatMessages;
+
+		shared_ptr<AbstractChatRoom> chatRoom = d->findChatRoom(chatRoomId);
+		if (!chatRoom)
+			return chatMessages;
+
+		soci::rowset<soci::row> rows = (session->prepare << displayNotificationQuery, soci::use(dbChatRoomId));
+		for (const auto &row : rows) {
+			shared_ptr<EventLog> event = d->selectGenericConferenceEvent(chatRoom, row);
+			if (!event)
+				continue;
+
+			shared_ptr<ChatMessage> chatMessage = static_pointer_cast<ConferenceChatMessageEvent>(event)->getChatMessage();
+			if (foundChatMessages.insert(chatMessage.get()).second)
+				chatMessages.push_back(chatMessage);
+		}
+
+		return chatMessages;
+	};
+}
+
 list<MainDb::ParticipantState> MainDb::getChatMessageParticipantsByImdnState (
 	const shared_ptr<EventLog> &eventLog,
 	ChatMessage::State state
@@ -2374,15 +2438,17 @@ void MainDb::loadChatMessageContents (const shared_ptr<ChatMessage> &chatMessage
 				string name;
 				int size;
 				string path;
+				string thumbnailPath;
 
-				*session << "SELECT name, size, path FROM chat_message_file_content"
+				*session << "SELECT name, size, path, thumbnail_path FROM chat_message_file_content"
 					" WHERE chat_message_content_id = :contentId",
-					soci::into(name), soci::into(size), soci::into(path), soci::use(contentId);
+					soci::into(name), soci::into(size), soci::into(path), soci::into(thumbnailPath), soci::use(contentId);
 
 				FileContent *fileContent = new FileContent();
 				fileContent->setFileName(name);
 				fileContent->setFileSize(size_t(size));
 				fileContent->setFilePath(path);
+				fileContent->setThumbnailFilePath(thumbnailPath);
 
 				content = fileContent;
 			} else
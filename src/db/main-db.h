@@ -102,6 +102,10 @@ public:
 
 	void markChatMessagesAsRead (const ChatRoomId &chatRoomId) const;
 	std::list<std::shared_ptr<ChatMessage>> getUnreadChatMessages (const ChatRoomId &chatRoomId) const;
+	std::list<std::shared_ptr<ChatMessage>> getChatMessagesToMarkAsRead (
+		const ChatRoomId &chatRoomId,
+		bool withDisplayNotification
+	) const;
 
 	std::list<ParticipantState> getChatMessageParticipantsByImdnState (
 		const std::shared_ptr<EventLog> &eventLog,
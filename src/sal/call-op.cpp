@@ -113,7 +113,7 @@ belle_sip_header_allow_t *SalCallOp::createAllow (bool enableUpdate) {
 }
 
 int SalCallOp::setCustomBody (belle_sip_message_t *msg, const Content &body) {
-	auto bodyBuffer = body.getBody();
+	const vector<char> &bodyBuffer = body.getBody();
 	size_t bodySize = bodyBuffer.size();
 	if (bodySize > SIP_MESSAGE_BODY_LIMIT) {
 		lError() << "Trying to add a body greater than " << (SIP_MESSAGE_BODY_LIMIT / 1024) << "kB to message [" << msg << "]";
@@ -670,7 +670,7 @@ void SalCallOp::callTerminated (belle_sip_server_transaction_t *serverTransactio
 	mState = State::Terminating;
 	setReasonErrorInfo(BELLE_SIP_MESSAGE(cancelRequest ? cancelRequest : serverRequest));
 	belle_sip_response_t *response = createResponseFromRequest(serverRequest, statusCode);
-	belle_sip_server_transaction_send_response(serverTransaction, response);
+	Sal::sendResponse(serverTransaction, response);
 	mRoot->mCallbacks.call_terminated(this, (mDir == Dir::Incoming) ? getFrom().c_str() : getTo().c_str());
 }
 
@@ -687,7 +687,7 @@ void SalCallOp::resetDescriptions () {
 
 void SalCallOp::unsupportedMethod (belle_sip_server_transaction_t *serverTransaction, belle_sip_request_t *request) {
 	auto response = belle_sip_response_create_from_request(request, 501);
-	belle_sip_server_transaction_send_response(serverTransaction, response);
+	Sal::sendResponse(serverTransaction, response);
 }
 
 bool SalCallOp::isAPendingIncomingInviteTransaction (belle_sip_transaction_t *transaction) {
@@ -766,16 +766,16 @@ void SalCallOp::processRequestEventCb (void *userCtx, const belle_sip_request_ev
 			if (method == "CANCEL") {
 				if (belle_sip_request_event_get_server_transaction(event)) {
 					// First answer 200 ok to cancel
-					belle_sip_server_transaction_send_response(serverTransaction, op->createResponseFromRequest(request, 200));
+					Sal::sendResponse(serverTransaction, op->createResponseFromRequest(request, 200));
 					// Terminate invite transaction
 					op->callTerminated(op->mPendingServerTransaction, 487, request);
 				} else {
 					// Call leg does not exist
-					belle_sip_server_transaction_send_response(serverTransaction, op->createResponseFromRequest(request, 481));
+					Sal::sendResponse(serverTransaction, op->createResponseFromRequest(request, 481));
 				}
 			} else if (method == "PRACK") {
 				response = op->createResponseFromRequest(request, 200);
-				belle_sip_server_transaction_send_response(serverTransaction, response);
+				Sal::sendResponse(serverTransaction, response);
 			} else if (method == "UPDATE") {
 				op->resetDescriptions();
 				if (op->processBodyForInvite(request) == SalReasonNone)
@@ -804,7 +804,7 @@ void SalCallOp::processRequestEventCb (void *userCtx, const belle_sip_request_ev
 					// Session timer case
 					// Session expire should be handled. To be done when real session timer (rfc4028) will be implemented.
 					response = op->createResponseFromRequest(request, 200);
-					belle_sip_server_transaction_send_response(serverTransaction, response);
+					Sal::sendResponse(serverTransaction, response);
 					belle_sip_object_unref(op->mPendingUpdateServerTransaction);
 					op->mPendingUpdateServerTransaction = nullptr;
 				} else {
@@ -841,23 +841,23 @@ void SalCallOp::processRequestEventCb (void *userCtx, const belle_sip_request_ev
 					}
 				}
 				response = op->createResponseFromRequest(request, 200);
-				belle_sip_server_transaction_send_response(serverTransaction, response);
+				Sal::sendResponse(serverTransaction, response);
 			} else if (method == "REFER") {
 				op->processRefer(event, serverTransaction);
 			} else if (method == "NOTIFY") {
 				op->processNotify(event, serverTransaction);
 			} else if (method == "OPTIONS") {
 				response = op->createResponseFromRequest(request, 200);
-				belle_sip_server_transaction_send_response(serverTransaction, response);
+				Sal::sendResponse(serverTransaction, response);
 			} else if (method == "CANCEL") {
 				auto lastTransaction = belle_sip_dialog_get_last_transaction(op->mDialog);
 				if (!lastTransaction || !isAPendingIncomingInviteTransaction(lastTransaction) ) {
 					// Call leg does not exist because 200ok already sent
-					belle_sip_server_transaction_send_response(serverTransaction, op->createResponseFromRequest(request, 481));
+					Sal::sendResponse(serverTransaction, op->createResponseFromRequest(request, 481));
 				} else {
 					// CANCEL on re-INVITE for which a 200ok has not been sent yet
-					belle_sip_server_transaction_send_response(serverTransaction, op->createResponseFromRequest(request, 200));
-					belle_sip_server_transaction_send_response(
+					Sal::sendResponse(serverTransaction, op->createResponseFromRequest(request, 200));
+					Sal::sendResponse(
 						BELLE_SIP_SERVER_TRANSACTION(lastTransaction),
 						op->createResponseFromRequest(belle_sip_transaction_get_request(BELLE_SIP_TRANSACTION(lastTransaction)), 487)
 					);
@@ -981,7 +981,7 @@ int SalCallOp::notifyRinging (bool earlyMedia) {
 		if (contact && (contactHeader = belle_sip_header_contact_create(contact)))
 			belle_sip_message_add_header(BELLE_SIP_MESSAGE(ringingResponse), BELLE_SIP_HEADER(contactHeader));
 	}
-	belle_sip_server_transaction_send_response(mPendingServerTransaction, ringingResponse);
+	Sal::sendResponse(mPendingServerTransaction, ringingResponse);
 	return 0;
 }
 
@@ -1019,7 +1019,7 @@ int SalCallOp::accept () {
 
 	addCustomHeaders(BELLE_SIP_MESSAGE(response));
 	handleOfferAnswerResponse(response);
-	belle_sip_server_transaction_send_response(transaction, response);
+	Sal::sendResponse(transaction, response);
 	if (mPendingUpdateServerTransaction) {
 		belle_sip_object_unref(mPendingUpdateServerTransaction);
 		mPendingUpdateServerTransaction = nullptr;
@@ -1055,7 +1055,7 @@ int SalCallOp::decline (SalReason reason, const string &redirectionUri) {
 	auto response = createResponseFromRequest(belle_sip_transaction_get_request(transaction), status);
 	if (contactHeader)
 		belle_sip_message_add_header(BELLE_SIP_MESSAGE(response), BELLE_SIP_HEADER(contactHeader));
-	belle_sip_server_transaction_send_response(BELLE_SIP_SERVER_TRANSACTION(transaction), response);
+	Sal::sendResponse(BELLE_SIP_SERVER_TRANSACTION(transaction), response);
 	return 0;
 }
 
@@ -1096,7 +1096,7 @@ int SalCallOp::declineWithErrorInfo (const SalErrorInfo *info, const SalAddress
 
 	if (contactHeader)
 		belle_sip_message_add_header(BELLE_SIP_MESSAGE(response), BELLE_SIP_HEADER(contactHeader));
-	belle_sip_server_transaction_send_response(BELLE_SIP_SERVER_TRANSACTION(transaction), response);
+	Sal::sendResponse(BELLE_SIP_SERVER_TRANSACTION(transaction), response);
 	return 0;
 }
 
@@ -1478,12 +1478,12 @@ void SalCallOp::processRefer (const belle_sip_request_event_t *event, belle_sip_
 		if (referredByHeader)
 			setReferredBy(referredByHeader);
 		auto response = createResponseFromRequest(request, 202);
-		belle_sip_server_transaction_send_response(serverTransaction, response);
+		Sal::sendResponse(serverTransaction, response);
 		mRoot->mCallbacks.call_refer_received(this, reinterpret_cast<SalAddress *>(BELLE_SIP_HEADER_ADDRESS(referToHeader)));
 	} else {
 		lWarning() << "Cannot do anything with the refer without destination";
 		auto response = createResponseFromRequest(request, 400);
-		belle_sip_server_transaction_send_response(serverTransaction, response);
+		Sal::sendResponse(serverTransaction, response);
 	}
 }
 
@@ -1514,13 +1514,13 @@ void SalCallOp::processNotify (const belle_sip_request_event_t *event, belle_sip
 				status = SalReferFailed;
 			belle_sip_object_unref(sipfrag);
 			auto response = createResponseFromRequest(request, 200);
-			belle_sip_server_transaction_send_response(serverTransaction, response);
+			Sal::sendResponse(serverTransaction, response);
 			mRoot->mCallbacks.notify_refer(this, status);
 		}
 	} else {
 		lError() << "Notify without sipfrag or not for 'refer' event package, rejecting";
 		auto response = createResponseFromRequest(request, 489);
-		belle_sip_server_transaction_send_response(serverTransaction, response);
+		Sal::sendResponse(serverTransaction, response);
 	}
 }
 
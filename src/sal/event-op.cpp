@@ -79,7 +79,7 @@ void SalSubscribeOp::handleNotify (belle_sip_request_t *request, const char *eve
 	ref();
 	mRoot->mCallbacks.notify(this, subscribeStatus, eventName, bodyHandler);
 	auto response = createResponseFromRequest(request, 200);
-	belle_sip_server_transaction_send_response(mPendingServerTransaction, response);
+	Sal::sendResponse(mPendingServerTransaction, response);
 	unref();
 }
 
@@ -97,7 +97,7 @@ void SalSubscribeOp::subscribeProcessRequestEventCb (void *userCtx, const belle_
 	if (!eventHeader) {
 		lWarning() << "No event header in incoming SUBSCRIBE";
 		auto response = op->createResponseFromRequest(request, 400);
-		belle_sip_server_transaction_send_response(serverTransaction, response);
+		Sal::sendResponse(serverTransaction, response);
 		if (!op->mDialog)
 			op->release();
 		return;
@@ -115,7 +115,7 @@ void SalSubscribeOp::subscribeProcessRequestEventCb (void *userCtx, const belle_
 			auto dialog = belle_sip_provider_create_dialog(op->mRoot->mProvider, BELLE_SIP_TRANSACTION(serverTransaction));
 			if (!dialog) {
 				auto response = op->createResponseFromRequest(request, 481);
-				belle_sip_server_transaction_send_response(serverTransaction, response);
+				Sal::sendResponse(serverTransaction, response);
 				op->release();
 				return;
 			}
@@ -148,11 +148,11 @@ void SalSubscribeOp::subscribeProcessRequestEventCb (void *userCtx, const belle_
 				// Either a refresh or an unsubscribe
 				if (expiresHeader && belle_sip_header_expires_get_expires(expiresHeader) > 0) {
 					auto response = op->createResponseFromRequest(request, 200);
-					belle_sip_server_transaction_send_response(serverTransaction, response);
+					Sal::sendResponse(serverTransaction, response);
 				} else if (expiresHeader) {
 					lInfo() << "Unsubscribe received from [" << op->getFrom() << "]";
 					auto response = op->createResponseFromRequest(request, 200);
-					belle_sip_server_transaction_send_response(serverTransaction, response);
+					Sal::sendResponse(serverTransaction, response);
 					op->mRoot->mCallbacks.incoming_subscribe_closed(op);
 				}
 			}
@@ -263,7 +263,7 @@ int SalSubscribeOp::accept () {
 	auto expiresHeader = belle_sip_message_get_header_by_type(request, belle_sip_header_expires_t);
 	auto response = createResponseFromRequest(request, 200);
 	belle_sip_message_add_header(BELLE_SIP_MESSAGE(response), BELLE_SIP_HEADER(expiresHeader));
-	belle_sip_server_transaction_send_response(mPendingServerTransaction, response);
+	Sal::sendResponse(mPendingServerTransaction, response);
 	return 0;
 }
 
@@ -272,7 +272,7 @@ int SalSubscribeOp::decline (SalReason reason) {
 		belle_sip_transaction_get_request(BELLE_SIP_TRANSACTION(mPendingServerTransaction)),
 		toSipCode(reason)
 	);
-	belle_sip_server_transaction_send_response(mPendingServerTransaction, response);
+	Sal::sendResponse(mPendingServerTransaction, response);
 	return 0;
 }
 
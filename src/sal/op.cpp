@@ -21,6 +21,7 @@
 
 #include "c-wrapper/internal/c-tools.h"
 #include "sal/op.h"
+#include "utils/metrics.h"
 #include "bellesip_sal/sal_impl.h"
 
 using namespace std;
@@ -290,6 +291,8 @@ int SalOp::sendRequestWithContact (belle_sip_request_t *request, bool addContact
 	}
 
 	int result = belle_sip_client_transaction_send_request_to(clientTransaction, nextHopUri);
+	if (result == 0)
+		Metrics::get().sipRequestsSent.increment();
 
 	// Update call id if not set yet for this op
 	if ((result == 0) && mCallId.empty()) {
@@ -997,7 +1000,7 @@ void SalOp::processIncomingMessage (const belle_sip_request_event_t *event) {
 		lError() << "Unsupported MESSAGE (no Content-Type)";
 		auto response = belle_sip_response_create_from_request(request, 500);
 		addMessageAccept(BELLE_SIP_MESSAGE(response));
-		belle_sip_server_transaction_send_response(serverTransaction, response);
+		Sal::sendResponse(serverTransaction, response);
 		release();
 	}
 }
@@ -1017,7 +1020,7 @@ int SalOp::replyMessage (SalReason reason) {
 		belle_sip_transaction_get_request(BELLE_SIP_TRANSACTION(mPendingServerTransaction)),
 		toSipCode(reason)
 	);
-	belle_sip_server_transaction_send_response(mPendingServerTransaction, response);
+	Sal::sendResponse(mPendingServerTransaction, response);
 	return 0;
 }
 
@@ -203,7 +203,7 @@ void SalPresenceOp::handleNotify (belle_sip_request_t *request, belle_sip_dialog
 		response = createResponseFromRequest(request, 488);
 	}
 	if (response)
-		belle_sip_server_transaction_send_response(mPendingServerTransaction, response);
+		Sal::sendResponse(mPendingServerTransaction, response);
 }
 
 void SalPresenceOp::presenceProcessRequestEventCb (void *userCtx, const belle_sip_request_event_t *event) {
@@ -224,7 +224,7 @@ void SalPresenceOp::presenceProcessRequestEventCb (void *userCtx, const belle_si
 	if (!eventHeader) {
 		lWarning() << "No event header in incoming SUBSCRIBE";
 		auto response = op->createResponseFromRequest(request, 400);
-		belle_sip_server_transaction_send_response(serverTransaction, response);
+		Sal::sendResponse(serverTransaction, response);
 		if (!op->mDialog)
 			op->release();
 		return;
@@ -239,7 +239,7 @@ void SalPresenceOp::presenceProcessRequestEventCb (void *userCtx, const belle_si
 			auto dialog = belle_sip_provider_create_dialog(op->mRoot->mProvider, BELLE_SIP_TRANSACTION(serverTransaction));
 			if (!dialog) {
 				auto response = op->createResponseFromRequest(request, 481);
-				belle_sip_server_transaction_send_response(serverTransaction, response);
+				Sal::sendResponse(serverTransaction, response);
 				op->release();
 				return;
 			}
@@ -275,7 +275,7 @@ void SalPresenceOp::presenceProcessRequestEventCb (void *userCtx, const belle_si
 				// If it is a refresh there is nothing to notify to the app. If it is an unSUBSCRIBE, then the dialog
 				// will be terminated shortly, and this will be notified to the app through the dialog_terminated callback.
 				auto response = op->createResponseFromRequest(request, 200);
-				belle_sip_server_transaction_send_response(serverTransaction, response);
+				Sal::sendResponse(serverTransaction, response);
 			}
 			break;
 		default:
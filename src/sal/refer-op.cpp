@@ -111,7 +111,7 @@ int SalReferOp::reply (SalReason reason) {
 		belle_sip_transaction_get_request(BELLE_SIP_TRANSACTION(mPendingServerTransaction)),
 		code
 	);
-	belle_sip_server_transaction_send_response(mPendingServerTransaction, response);
+	Sal::sendResponse(mPendingServerTransaction, response);
 	return 0;
 }
 
@@ -25,6 +25,7 @@
 #include "sal/refer-op.h"
 #include "sal/event-op.h"
 #include "sal/message-op.h"
+#include "utils/metrics.h"
 #include "bellesip_sal/sal_impl.h"
 #include "tester_utils.h"
 #include "private.h"
@@ -63,6 +64,7 @@ void Sal::processRequestEventCb (void *userCtx, const belle_sip_request_event_t
 	belle_sip_header_t *evh = nullptr;
 	auto request = belle_sip_request_event_get_request(event);
 	string method = belle_sip_request_get_method(request);
+	Metrics::get().sipRequestsReceived.increment();
 
 	auto dialog = belle_sip_request_event_get_dialog(event);
 	if (dialog) {
@@ -82,7 +84,7 @@ void Sal::processRequestEventCb (void *userCtx, const belle_sip_request_event_t
 		if (((method == "INVITE") || (method == "NOTIFY")) && belle_sip_header_to_get_tag(toHeader)) {
 			lWarning() << "Receiving " << method << " with to-tag but no know dialog here, rejecting";
 			auto response = belle_sip_response_create_from_request(request, 481);
-			belle_sip_provider_send_response(sal->mProvider, response);
+			sal->sendStatelessResponse(response);
 			return;
 		// By default (eg. when a to-tag is present), out of dialog ACK are automatically
 		// handled in lower layers (belle-sip) but in case it misses, it will be forwarded to us
@@ -108,24 +110,24 @@ void Sal::processRequestEventCb (void *userCtx, const belle_sip_request_event_t
 			op = new SalReferOp(sal);
 		} else if (method == "OPTIONS") {
 			auto response = belle_sip_response_create_from_request(request, 200);
-			belle_sip_provider_send_response(sal->mProvider, response);
+			sal->sendStatelessResponse(response);
 			return;
 		} else if (method == "INFO") { // INFO out of call dialogs are not allowed
 			auto response = belle_sip_response_create_from_request(request, 481);
-			belle_sip_provider_send_response(sal->mProvider, response);
+			sal->sendStatelessResponse(response);
 			return;
 		} else if (method == "BYE") { // Out of dialog BYE
 			auto response = belle_sip_response_create_from_request(request, 481);
-			belle_sip_provider_send_response(sal->mProvider, response);
+			sal->sendStatelessResponse(response);
 			return;
 		} else if (method == "CANCEL") { // Out of dialog CANCEL
 			auto response = belle_sip_response_create_from_request(request, 481);
-			belle_sip_provider_send_response(sal->mProvider, response);
+			sal->sendStatelessResponse(response);
 			return;
 		} else if (sal->mEnableTestFeatures && (method == "PUBLISH")) { // Out of dialog PUBLISH
 			auto response = belle_sip_response_create_from_request(request, 200);
 			belle_sip_message_add_header(BELLE_SIP_MESSAGE(response), belle_sip_header_create("SIP-Etag", "4441929FFFZQOA"));
-			belle_sip_provider_send_response(sal->mProvider, response);
+			sal->sendStatelessResponse(response);
 			return;
 		} else {
 			lError() << "Sal::processRequestEventCb(): not implemented yet for method [" << method << "]";
@@ -134,7 +136,7 @@ void Sal::processRequestEventCb (void *userCtx, const belle_sip_request_event_t
 				BELLE_SIP_MESSAGE(response),
 				BELLE_SIP_HEADER(belle_sip_header_allow_create("INVITE, CANCEL, ACK, BYE, SUBSCRIBE, NOTIFY, MESSAGE, OPTIONS, INFO"))
 			);
-			belle_sip_provider_send_response(sal->mProvider, response);
+			sal->sendStatelessResponse(response);
 			return;
 		}
 		op->mDir = SalOp::Dir::Incoming;
@@ -252,6 +254,7 @@ void Sal::processRequestEventCb (void *userCtx, const belle_sip_request_event_t
 void Sal::processResponseEventCb (void *userCtx, const belle_sip_response_event_t *event) {
 	auto response = belle_sip_response_event_get_response(event);
 	int responseCode = belle_sip_response_get_status_code(response);
+	Metrics::get().sipResponsesReceived.increment();
 
 	auto clientTransaction = belle_sip_response_event_get_client_transaction(event);
 	if (!clientTransaction) {
@@ -801,6 +804,18 @@ void Sal::cancelTimer(belle_sip_source_t *timer) {
 	belle_sip_main_loop_remove_source(ml, timer);
 }
 
+// -----------------------------------------------------------------------------
+
+void Sal::sendResponse (belle_sip_server_transaction_t *transaction, belle_sip_response_t *response) {
+	belle_sip_server_transaction_send_response(transaction, response);
+	Metrics::get().sipResponsesSent.increment();
+}
+
+void Sal::sendStatelessResponse (belle_sip_response_t *response) {
+	belle_sip_provider_send_response(mProvider, response);
+	Metrics::get().sipResponsesSent.increment();
+}
+
 belle_sip_response_t *Sal::createResponseFromRequest (belle_sip_request_t *request, int code) {
 	auto response = belle_sip_response_create_from_request(request, code);
 	belle_sip_message_add_header(BELLE_SIP_MESSAGE(response), BELLE_SIP_HEADER(mUserAgentHeader));
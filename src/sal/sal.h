@@ -249,6 +249,13 @@ public:
 	belle_sip_source_t *createTimer (belle_sip_source_func_t func, void *data, unsigned int timeoutValueMs, const std::string &timerName);
 	void cancelTimer (belle_sip_source_t *timer);
 
+	// ---------------------------------------------------------------------------
+	// Responses
+	// ---------------------------------------------------------------------------
+	// Every response is sent through these, so that it is counted in the metrics.
+	static void sendResponse (belle_sip_server_transaction_t *transaction, belle_sip_response_t *response);
+	void sendStatelessResponse (belle_sip_response_t *response);
+
 
 private:
 	struct SalUuid {
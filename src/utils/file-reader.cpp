@@ -0,0 +1,152 @@
+/*
+ * file-reader.cpp
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif // ifndef _WIN32
+
+#include "logger/logger.h"
+
+#include "file-reader.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+namespace {
+	constexpr size_t ReadAheadSize = 256 * 1024;
+	constexpr size_t ReadAheadAlignment = 4096;
+	constexpr size_t MappedWindowSize = 256 * 1024;
+}
+
+bool FileReader::open (const string &path, bool allowMapping) {
+	close();
+
+	#ifndef _WIN32
+		int fd = allowMapping ? ::open(path.c_str(), O_RDONLY) : -1;
+		if (fd >= 0) {
+			struct stat st;
+			if (fstat(fd, &st) == 0 && st.st_size > 0) {
+				void *data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+				if (data != MAP_FAILED) {
+					posix_madvise(data, static_cast<size_t>(st.st_size), POSIX_MADV_SEQUENTIAL);
+					mapping = static_cast<uint8_t *>(data);
+					size = static_cast<size_t>(st.st_size);
+				}
+			}
+			if (mapping) {
+				mappedFd = fd;
+				return true;
+			}
+			::close(fd);
+		}
+		if (allowMapping)
+			lInfo() << "Unable to map " << path << ", reading it instead";
+	#endif // ifndef _WIN32
+
+	file = bctbx_file_open(bctbx_vfs_get_default(), path.c_str(), "r");
+	if (!file) {
+		lError() << "Unable to open " << path;
+		return false;
+	}
+	int64_t fileSize = bctbx_file_size(file);
+	size = fileSize > 0 ? static_cast<size_t>(fileSize) : 0;
+	return true;
+}
+
+void FileReader::close () {
+	#ifndef _WIN32
+		if (mapping)
+			munmap(mapping, size);
+		if (mappedFd >= 0)
+			::close(mappedFd);
+	#endif // ifndef _WIN32
+	mapping = nullptr;
+	mappedFd = -1;
+	mappedWindowOffset = 0;
+	mappedWindowEnd = 0;
+
+	if (file) {
+		bctbx_file_close(file);
+		file = nullptr;
+	}
+	size = 0;
+	readAhead.clear();
+	readAheadOffset = 0;
+	readAheadSize = 0;
+}
+
+size_t FileReader::read (size_t offset, uint8_t *buffer, size_t count) {
+	if (offset >= size)
+		return 0;
+	count = min(count, size - offset);
+
+	#ifndef _WIN32
+		if (mapping) {
+			// Touching a page past the end of a file truncated since it was mapped raises SIGBUS, so the size is
+			// checked before copying from a new window rather than for each chunk. A truncation racing with the
+			// copy of the current window remains possible.
+			if (offset < mappedWindowOffset || offset + count > mappedWindowEnd) {
+				size_t windowOffset = offset - offset % MappedWindowSize;
+				size_t windowEnd = min(size, max(offset + count, windowOffset + MappedWindowSize));
+				struct stat st;
+				if (fstat(mappedFd, &st) != 0 || st.st_size < 0 || static_cast<size_t>(st.st_size) < windowEnd) {
+					lError() << "Mapped file truncated while being read";
+					return 0;
+				}
+				mappedWindowOffset = windowOffset;
+				mappedWindowEnd = windowEnd;
+			}
+			memcpy(buffer, mapping + offset, count);
+			return count;
+		}
+	#endif // ifndef _WIN32
+
+	size_t copied = 0;
+	while (copied < count) {
+		size_t position = offset + copied;
+		if ((position < readAheadOffset || position >= readAheadOffset + readAheadSize) && !fillReadAhead(position))
+			break;
+		size_t available = min(count - copied, readAheadOffset + readAheadSize - position);
+		memcpy(buffer + copied, readAhead.data() + (position - readAheadOffset), available);
+		copied += available;
+	}
+	return copied;
+}
+
+bool FileReader::fillReadAhead (size_t offset) {
+	if (!file)
+		return false;
+
+	readAhead.resize(ReadAheadSize);
+	readAheadOffset = offset - offset % ReadAheadAlignment;
+	ssize_t result = bctbx_file_read(file, readAhead.data(), ReadAheadSize, static_cast<off_t>(readAheadOffset));
+	readAheadSize = result > 0 ? static_cast<size_t>(result) : 0;
+	return readAheadOffset + readAheadSize > offset;
+}
+
+LINPHONE_END_NAMESPACE
@@ -0,0 +1,75 @@
+/*
+ * file-reader.h
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _L_FILE_READER_H_
+#define _L_FILE_READER_H_
+
+#include <string>
+#include <vector>
+
+#include <bctoolbox/vfs.h>
+
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+// Reads a file sequentially in chunks of any size. The file is memory-mapped when the platform allows it,
+// otherwise it is read ahead in large aligned blocks so that small chunks do not cost one read each.
+// A file truncated while it is read gives short reads: read() returns fewer bytes than available at open time.
+class FileReader {
+public:
+	FileReader () = default;
+	~FileReader () { close(); }
+
+	// Mapping may be disabled to always read through the read-ahead buffer.
+	bool open (const std::string &path, bool allowMapping = true);
+	void close ();
+
+	bool isOpen () const { return mapping || file; }
+	size_t getSize () const { return size; }
+
+	bool isMapped () const { return !!mapping; }
+
+	// Copies up to count bytes from offset into buffer and returns the number of bytes copied. It is less than
+	// min(count, getSize() - offset) only when the file could not be read, e.g. it was truncated meanwhile.
+	size_t read (size_t offset, uint8_t *buffer, size_t count);
+
+private:
+	bool fillReadAhead (size_t offset);
+
+	size_t size = 0;
+	uint8_t *mapping = nullptr;
+	// Kept open along with the mapping, to check the size of the file before touching its pages.
+	int mappedFd = -1;
+	// Part of the mapping known to be backed by the file, checked once for each window read.
+	size_t mappedWindowOffset = 0;
+	size_t mappedWindowEnd = 0;
+	bctbx_vfs_file_t *file = nullptr;
+	std::vector<uint8_t> readAhead;
+	size_t readAheadOffset = 0;
+	size_t readAheadSize = 0;
+
+	L_DISABLE_COPY(FileReader);
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_FILE_READER_H_
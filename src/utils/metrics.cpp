@@ -0,0 +1,95 @@
+/*
+ * metrics.cpp
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <locale>
+#include <sstream>
+
+#include "metrics.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+Metrics::Metric::Metric (Metrics &registry, const char *name, const char *help, const char *type) :
+	name(name), help(help), type(type) {
+	registry.metrics.push_back(this);
+}
+
+// -----------------------------------------------------------------------------
+
+void Metrics::Counter::print (ostream &stream) const {
+	stream << name << " " << get() << "\n";
+}
+
+void Metrics::Gauge::print (ostream &stream) const {
+	stream << name << " " << get() << "\n";
+}
+
+// -----------------------------------------------------------------------------
+
+Metrics::Histogram::Histogram (Metrics &registry, const char *name, const char *help, vector<double> bounds) :
+	Metric(registry, name, help, "histogram"), bounds(move(bounds)) {
+	buckets.reset(new atomic<uint64_t>[this->bounds.size() + 1]);
+	for (size_t i = 0; i <= this->bounds.size(); i++)
+		buckets[i].store(0, memory_order_relaxed);
+}
+
+void Metrics::Histogram::observe (double value) {
+	size_t index = static_cast<size_t>(lower_bound(bounds.begin(), bounds.end(), value) - bounds.begin());
+	buckets[index].fetch_add(1, memory_order_relaxed);
+
+	double current = sum.load(memory_order_relaxed);
+	while (!sum.compare_exchange_weak(current, current + value, memory_order_relaxed)) {}
+}
+
+void Metrics::Histogram::print (ostream &stream) const {
+	// Buckets are cumulative in the exposition format.
+	uint64_t count = 0;
+	for (size_t i = 0; i < bounds.size(); i++) {
+		count += buckets[i].load(memory_order_relaxed);
+		stream << name << "_bucket{le=\"" << bounds[i] << "\"} " << count << "\n";
+	}
+	count += buckets[bounds.size()].load(memory_order_relaxed);
+	stream << name << "_bucket{le=\"+Inf\"} " << count << "\n";
+	stream << name << "_sum " << sum.load(memory_order_relaxed) << "\n";
+	stream << name << "_count " << count << "\n";
+}
+
+// -----------------------------------------------------------------------------
+
+Metrics &Metrics::get () {
+	static Metrics instance;
+	return instance;
+}
+
+string Metrics::toPrometheusText () const {
+	ostringstream stream;
+	stream.imbue(locale::classic());
+	for (const Metric *metric : metrics) {
+		stream << "# HELP " << metric->name << " " << metric->help << "\n";
+		stream << "# TYPE " << metric->name << " " << metric->type << "\n";
+		metric->print(stream);
+	}
+	return stream.str();
+}
+
+LINPHONE_END_NAMESPACE
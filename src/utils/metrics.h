@@ -0,0 +1,155 @@
+/*
+ * metrics.h
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _L_METRICS_H_
+#define _L_METRICS_H_
+
+#include <atomic>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+// Process-wide counters, gauges and histograms, rendered in the Prometheus text exposition format.
+// Updates are relaxed atomic operations so that they can be done from any thread without locking.
+class Metrics {
+public:
+	class Metric {
+	public:
+		virtual ~Metric () = default;
+
+	protected:
+		Metric (Metrics &registry, const char *name, const char *help, const char *type);
+
+		const char *name;
+
+	private:
+		virtual void print (std::ostream &stream) const = 0;
+
+		const char *help;
+		const char *type;
+
+		friend class Metrics;
+	};
+
+	class Counter : public Metric {
+	public:
+		Counter (Metrics &registry, const char *name, const char *help) : Metric(registry, name, help, "counter") {}
+
+		void increment (uint64_t value = 1) { count.fetch_add(value, std::memory_order_relaxed); }
+		uint64_t get () const { return count.load(std::memory_order_relaxed); }
+
+	private:
+		void print (std::ostream &stream) const override;
+
+		std::atomic<uint64_t> count{ 0 };
+	};
+
+	class Gauge : public Metric {
+	public:
+		Gauge (Metrics &registry, const char *name, const char *help) : Metric(registry, name, help, "gauge") {}
+
+		void increment (int64_t delta = 1) { value.fetch_add(delta, std::memory_order_relaxed); }
+		void decrement (int64_t delta = 1) { value.fetch_sub(delta, std::memory_order_relaxed); }
+		int64_t get () const { return value.load(std::memory_order_relaxed); }
+
+	private:
+		void print (std::ostream &stream) const override;
+
+		std::atomic<int64_t> value{ 0 };
+	};
+
+	class Histogram : public Metric {
+	public:
+		// Bounds are the upper bounds of the buckets, in increasing order. A last bucket holds the values above them.
+		Histogram (Metrics &registry, const char *name, const char *help, std::vector<double> bounds);
+
+		void observe (double value);
+
+	private:
+		void print (std::ostream &stream) const override;
+
+		const std::vector<double> bounds;
+		std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+		std::atomic<double> sum{ 0 };
+	};
+
+	static Metrics &get ();
+
+	std::string toPrometheusText () const;
+
+private:
+	Metrics () = default;
+
+	// Filled by the constructors of the metrics below, it must be declared before them.
+	std::vector<const Metric *> metrics;
+
+public:
+	Counter callsTotal{ *this, "linphone_calls_total", "Calls created." };
+	Gauge callsActive{ *this, "linphone_calls_active", "Calls currently handled by the cores." };
+	Gauge callsBusy{ *this, "linphone_calls_busy", "Calls with pending work, iterated on each core iteration." };
+	Counter callIterations{ *this, "linphone_call_iterations_total", "Call iterations run by the cores." };
+	Counter registrationsSucceeded{ *this, "linphone_registrations_ok_total", "Successful registrations." };
+	Counter registrationsFailed{ *this, "linphone_registrations_failed_total", "Failed registrations." };
+	Counter sipRequestsSent{ *this, "linphone_sip_requests_sent_total", "SIP requests sent." };
+	Counter sipRequestsReceived{ *this, "linphone_sip_requests_received_total", "SIP requests received." };
+	Counter sipResponsesSent{ *this, "linphone_sip_responses_sent_total", "SIP responses sent." };
+	Counter sipResponsesReceived{ *this, "linphone_sip_responses_received_total", "SIP responses received." };
+	Counter sipBodiesEncoded{ *this, "linphone_sip_bodies_encoded_total", "SIP bodies sent with a content encoding." };
+	Counter sipBodiesEncodedBytes{
+		*this, "linphone_sip_bodies_encoded_bytes_total", "Size of the SIP bodies handed to the content encoder."
+	};
+	Counter sipBodiesUnencoded{
+		*this, "linphone_sip_bodies_unencoded_total", "SIP bodies sent as is, below sip/content_encoding_min_size."
+	};
+	Counter chatMessagesSent{ *this, "linphone_chat_messages_sent_total", "Chat messages delivered to the server." };
+	Counter chatMessagesReceived{ *this, "linphone_chat_messages_received_total", "Chat messages received." };
+	Counter chatMessagesFailed{ *this, "linphone_chat_messages_failed_total", "Chat messages that could not be sent." };
+	Counter fileTransfersStarted{ *this, "linphone_file_transfers_total", "HTTP file transfers started." };
+	Counter fileTransferConnections{
+		*this, "linphone_file_transfer_connections_total",
+		"Upper bound on the connections, and so on the TCP and TLS handshakes, opened for file transfers: "
+		"a new one is counted whenever more transfers run at once against a server than before."
+	};
+	Gauge presencePendingSubscriptions{
+		*this, "linphone_presence_pending_subscriptions",
+		"Incoming presence subscriptions waiting for the application to accept or deny them."
+	};
+	Histogram dbTransactionDuration{
+		*this, "linphone_db_transaction_duration_seconds", "Duration of the database transactions.",
+		{ 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1 }
+	};
+	Counter dbTransactionErrors{ *this, "linphone_db_transaction_errors_total", "Database transactions that failed." };
+	Histogram callQualityRating{
+		*this, "linphone_call_quality_rating", "Average quality rating of the audio streams, from 0 to 5.",
+		{ 1, 2, 3, 4, 5 }
+	};
+
+	L_DISABLE_COPY(Metrics);
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_METRICS_H_
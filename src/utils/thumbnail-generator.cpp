@@ -0,0 +1,225 @@
+/*
+ * thumbnail-generator.cpp
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <fstream>
+
+#include <mediastreamer2/msfactory.h>
+#include <mediastreamer2/msfilter.h>
+#include <mediastreamer2/msjpegwriter.h>
+#include <mediastreamer2/msticker.h>
+#include <mediastreamer2/msvideo.h>
+
+#include "core/core.h"
+#include "logger/logger.h"
+#include "private.h"
+
+#include "thumbnail-generator.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+namespace {
+	// The thumbnail fits in 320x240, or 240x320 for a portrait image.
+	constexpr int ThumbnailMaxLongSide = 320;
+	constexpr int ThumbnailMaxShortSide = 240;
+
+	// The static image source outputs its first frame right away, this only guards against a stuck graph.
+	constexpr unsigned int GenerationTimeout = 5000;
+}
+
+bool ThumbnailGenerator::start (
+	const shared_ptr<Core> &core,
+	const string &imagePath,
+	const string &thumbnailPath,
+	const Callback &callback
+) {
+#ifdef VIDEO_ENABLED
+	stop();
+
+	// The static image source silently falls back to a blank picture, so only well-formed JPEG images are accepted.
+	int width, height;
+	if (!getJpegSize(imagePath, width, height)) {
+		lWarning() << "Unable to generate a thumbnail of " << imagePath << ": not a JPEG image";
+		return false;
+	}
+
+	const bool landscape = width >= height;
+	const int maxWidth = landscape ? ThumbnailMaxLongSide : ThumbnailMaxShortSide;
+	const int maxHeight = landscape ? ThumbnailMaxShortSide : ThumbnailMaxLongSide;
+	if (width > maxWidth || height > maxHeight) {
+		const double scale = min(double(maxWidth) / width, double(maxHeight) / height);
+		width = int(width * scale);
+		height = int(height * scale);
+	}
+
+	// YUV 4:2:0 needs even dimensions.
+	MSVideoSize size;
+	size.width = width & ~1;
+	size.height = height & ~1;
+	if (size.width == 0 || size.height == 0)
+		return false;
+
+	MSFactory *factory = core->getCCore()->factory;
+	source = ms_factory_create_filter(factory, MS_STATIC_IMAGE_ID);
+	writer = ms_factory_create_filter(factory, MS_JPEG_WRITER_ID);
+	if (!source || !writer) {
+		lWarning() << "Unable to generate a thumbnail: static image or JPEG writer filter not available";
+		stop();
+		return false;
+	}
+
+	ms_filter_call_method(source, MS_FILTER_SET_VIDEO_SIZE, &size);
+	ms_filter_call_method(source, MS_STATIC_IMAGE_SET_IMAGE, (void *)imagePath.c_str());
+	ms_filter_link(source, 0, writer, 0);
+
+	// Not synchronous: the notification is dispatched from the event queue of the core, in the main loop.
+	ms_filter_add_notify_callback(writer, snapshotTaken, this, FALSE);
+	if (ms_filter_call_method(writer, MS_JPEG_WRITER_TAKE_SNAPSHOT, (void *)thumbnailPath.c_str()) != 0) {
+		lWarning() << "Unable to generate a thumbnail: cannot take snapshot to " << thumbnailPath;
+		stop();
+		return false;
+	}
+
+	ticker = ms_ticker_new();
+	ms_ticker_set_name(ticker, "Thumbnail generator");
+	ms_ticker_attach(ticker, source);
+
+	this->core = core;
+	this->callback = callback;
+	success = false;
+	startTimer(GenerationTimeout);
+	return true;
+#else
+	return false;
+#endif // ifdef VIDEO_ENABLED
+}
+
+void ThumbnailGenerator::stop () {
+	stopTimer();
+	callback = nullptr;
+
+	if (ticker) {
+		ms_ticker_detach(ticker, source);
+		ms_ticker_destroy(ticker);
+		ticker = nullptr;
+	}
+	if (source && writer)
+		ms_filter_unlink(source, 0, writer, 0);
+	if (source) {
+		ms_filter_destroy(source);
+		source = nullptr;
+	}
+	if (writer) {
+		ms_filter_destroy(writer);
+		writer = nullptr;
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+bool ThumbnailGenerator::getJpegSize (const string &path, int &width, int &height) {
+	ifstream stream(path, ios::binary);
+	if (stream.get() != 0xFF || stream.get() != 0xD8)
+		return false;
+
+	for (;;) {
+		if (stream.get() != 0xFF)
+			return false;
+
+		int marker;
+		do
+			marker = stream.get();
+		while (marker == 0xFF);
+
+		// Standalone markers have no length.
+		if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7))
+			continue;
+		// Start of scan or end of image before any frame header, or end of file.
+		if (marker == 0xDA || marker == 0xD9 || !stream)
+			return false;
+
+		int length = stream.get() << 8;
+		length |= stream.get();
+		if (!stream || length < 2)
+			return false;
+
+		// Start of frame markers, DHT (0xC4), JPG (0xC8) and DAC (0xCC) excepted.
+		if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+			stream.get(); // Sample precision.
+			height = stream.get() << 8;
+			height |= stream.get();
+			width = stream.get() << 8;
+			width |= stream.get();
+			return stream && width > 0 && height > 0;
+		}
+
+		stream.seekg(length - 2, ios::cur);
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+void ThumbnailGenerator::snapshotTaken (void *userData, MSFilter *, unsigned int id, void *) {
+#ifdef VIDEO_ENABLED
+	if (id != MS_JPEG_WRITER_SNAPSHOT_TAKEN)
+		return;
+
+	// The graph is not destroyed from the notification of one of its filters, but from the next main loop iteration.
+	ThumbnailGenerator *generator = static_cast<ThumbnailGenerator *>(userData);
+	generator->success = true;
+	generator->stopTimer();
+	generator->startTimer(0);
+#endif // ifdef VIDEO_ENABLED
+}
+
+int ThumbnailGenerator::timerExpired (void *data, unsigned int) {
+	ThumbnailGenerator *generator = static_cast<ThumbnailGenerator *>(data);
+	Callback callback = generator->callback;
+	bool success = generator->success;
+	if (!success)
+		lWarning() << "Thumbnail generation timed out";
+
+	generator->stop();
+	if (callback)
+		callback(success);
+	return BELLE_SIP_STOP;
+}
+
+void ThumbnailGenerator::startTimer (unsigned int timeout) {
+	shared_ptr<Core> core = this->core.lock();
+	if (core)
+		timer = core->getCCore()->sal->createTimer(timerExpired, this, timeout, "thumbnail generator");
+}
+
+void ThumbnailGenerator::stopTimer () {
+	if (!timer)
+		return;
+
+	shared_ptr<Core> core = this->core.lock();
+	if (core && core->getCCore()->sal)
+		core->getCCore()->sal->cancelTimer(timer);
+	belle_sip_object_unref(timer);
+	timer = nullptr;
+}
+
+LINPHONE_END_NAMESPACE
@@ -0,0 +1,84 @@
+/*
+ * thumbnail-generator.h
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#ifndef _L_THUMBNAIL_GENERATOR_H_
+#define _L_THUMBNAIL_GENERATOR_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <belle-sip/belle-sip.h>
+
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+struct _MSFilter;
+struct _MSTicker;
+
+LINPHONE_BEGIN_NAMESPACE
+
+class Core;
+
+// Writes a small JPEG copy of a JPEG image, using the mediastreamer2 static image source and JPEG writer filters.
+// The generation is asynchronous: the callback is called from the main loop once it is done, unless stop() is called
+// before. It is only available when video is enabled.
+class ThumbnailGenerator {
+public:
+	typedef std::function<void (bool success)> Callback;
+
+	ThumbnailGenerator () = default;
+	~ThumbnailGenerator () { stop(); }
+
+	bool start (
+		const std::shared_ptr<Core> &core,
+		const std::string &imagePath,
+		const std::string &thumbnailPath,
+		const Callback &callback
+	);
+	void stop ();
+
+	bool isRunning () const { return !!timer; }
+
+	// Reads the dimensions of a JPEG image from its start of frame marker.
+	static bool getJpegSize (const std::string &path, int &width, int &height);
+
+private:
+	static void snapshotTaken (void *userData, _MSFilter *filter, unsigned int id, void *arg);
+	static int timerExpired (void *data, unsigned int revents);
+
+	void startTimer (unsigned int timeout);
+	void stopTimer ();
+
+	std::weak_ptr<Core> core;
+	Callback callback;
+	bool success = false;
+
+	_MSFilter *source = nullptr;
+	_MSFilter *writer = nullptr;
+	_MSTicker *ticker = nullptr;
+	belle_sip_source_t *timer = nullptr;
+
+	L_DISABLE_COPY(ThumbnailGenerator);
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_THUMBNAIL_GENERATOR_H_
@@ -179,6 +179,24 @@ char *Utils::utf8ToChar (uint32_t ic) {
 	return result;
 }
 
+void Utils::appendUtf8 (string &str, uint32_t ic) {
+	if (ic < 0x80) {
+		str += static_cast<char>(ic);
+	} else if (ic < 0x800) {
+		str += static_cast<char>(0xC0 + ((ic >> 6) & 0x1F));
+		str += static_cast<char>(0x80 + (ic & 0x3F));
+	} else if (ic < 0x10000) {
+		str += static_cast<char>(0xE0 + ((ic >> 12) & 0xF));
+		str += static_cast<char>(0x80 + ((ic >> 6) & 0x3F));
+		str += static_cast<char>(0x80 + (ic & 0x3F));
+	} else if (ic < 0x110000) {
+		str += static_cast<char>(0xF0 + ((ic >> 18) & 0x7));
+		str += static_cast<char>(0x80 + ((ic >> 12) & 0x3F));
+		str += static_cast<char>(0x80 + ((ic >> 6) & 0x3F));
+		str += static_cast<char>(0x80 + (ic & 0x3F));
+	}
+}
+
 string Utils::trim (const string &str) {
 	auto itFront = find_if_not(str.begin(), str.end(), [] (int c) { return isspace(c); });
 	auto itBack = find_if_not(str.rbegin(), str.rend(), [] (int c) { return isspace(c); }).base();
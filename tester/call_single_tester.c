@@ -586,6 +586,155 @@ static void simple_call(void) {
 	simple_call_base(FALSE);
 }
 
+static void call_stats_history(void) {
+	LinphoneCoreManager* marie = linphone_core_manager_new( "marie_rc");
+	LinphoneCoreManager* pauline = linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	LinphoneCallStatsSample samples[3];
+	LinphoneCall *call;
+	size_t count;
+
+	lp_config_set_int(linphone_core_get_config(marie->lc), "rtp", "stats_history_size", 3);
+	lp_config_set_int(linphone_core_get_config(marie->lc), "rtp", "log_bandwidth_usage", 0);
+	if (!BC_ASSERT_TRUE(call(marie, pauline)))
+		goto end;
+
+	/* a sample per second, only the last ones are kept */
+	wait_for_until(marie->lc, pauline->lc, NULL, 0, 5000);
+	call = linphone_core_get_current_call(marie->lc);
+	BC_ASSERT_EQUAL((int)linphone_call_get_stats_history(call, LinphoneStreamTypeAudio, 0, NULL, 0), 3, int, "%d");
+	count = linphone_call_get_stats_history(call, LinphoneStreamTypeAudio, 0, samples, 3);
+	if (BC_ASSERT_EQUAL((int)count, 3, int, "%d")) {
+		BC_ASSERT_TRUE(samples[0].time <= samples[2].time);
+		BC_ASSERT_GREATER(samples[2].upload_bandwidth, 0.f, float, "%f");
+		BC_ASSERT_EQUAL((int)linphone_call_get_stats_history(call, LinphoneStreamTypeAudio, samples[2].time + 1, NULL, 0), 0, int, "%d");
+	}
+	/* out of range stream types have no history */
+	BC_ASSERT_EQUAL((int)linphone_call_get_stats_history(call, LinphoneStreamTypeUnknown, 0, samples, 3), 0, int, "%d");
+	BC_ASSERT_EQUAL((int)linphone_call_get_stats_history(call, (LinphoneStreamType)-1, 0, samples, 3), 0, int, "%d");
+	BC_ASSERT_EQUAL((int)linphone_call_get_stats_history(call, (LinphoneStreamType)42, 0, samples, 3), 0, int, "%d");
+	end_call(marie, pauline);
+
+end:
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+static void call_metrics(void) {
+	LinphoneCoreManager* marie = linphone_core_manager_new( "marie_rc");
+	LinphoneCoreManager* pauline = linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	long long calls = liblinphone_tester_get_metric("linphone_calls_total");
+	long long active_calls = liblinphone_tester_get_metric("linphone_calls_active");
+	long long requests = liblinphone_tester_get_metric("linphone_sip_requests_sent_total");
+	long long responses = liblinphone_tester_get_metric("linphone_sip_responses_sent_total");
+
+	BC_ASSERT_TRUE(calls >= 0);
+	BC_ASSERT_TRUE(liblinphone_tester_get_metric("linphone_presence_pending_subscriptions") >= 0);
+	if (!BC_ASSERT_TRUE(call(marie, pauline)))
+		goto end;
+
+	/* the call is counted once by each core */
+	BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_calls_total") - calls), 2, int, "%d");
+	BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_calls_active") - active_calls), 2, int, "%d");
+	BC_ASSERT_TRUE(liblinphone_tester_get_metric("linphone_sip_requests_sent_total") > requests);
+	/* at least the 180 Ringing and 200 OK of the INVITE received by pauline */
+	BC_ASSERT_TRUE(liblinphone_tester_get_metric("linphone_sip_responses_sent_total") >= responses + 2);
+	end_call(marie, pauline);
+	wait_for_until(marie->lc, pauline->lc, NULL, 0, 1000);
+	BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_calls_active") - active_calls), 0, int, "%d");
+
+end:
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+static void call_with_idle_iteration_interval(void) {
+	LinphoneCoreManager* marie = linphone_core_manager_create( "marie_rc");
+	LinphoneCoreManager* pauline = linphone_core_manager_create(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	LinphoneCall *call_marie;
+	LinphoneCall *call_pauline;
+	long long busy_calls = liblinphone_tester_get_metric("linphone_calls_busy");
+	long long iterations;
+
+	/* established calls are only iterated every second */
+	lp_config_set_int(linphone_core_get_config(marie->lc), "misc", "idle_call_iteration_interval", 1000);
+	lp_config_set_int(linphone_core_get_config(pauline->lc), "misc", "idle_call_iteration_interval", 1000);
+	linphone_core_manager_start(marie, TRUE);
+	linphone_core_manager_start(pauline, TRUE);
+	if (!BC_ASSERT_TRUE(call(marie, pauline)))
+		goto end;
+
+	/* an audio call has no pending work once its streams run */
+	call_marie = linphone_core_get_current_call(marie->lc);
+	call_pauline = linphone_core_get_current_call(pauline->lc);
+	BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_calls_busy") - busy_calls), 0, int, "%d");
+	iterations = liblinphone_tester_get_metric("linphone_call_iterations_total");
+	wait_for_until(marie->lc, pauline->lc, NULL, 0, 3000);
+	BC_ASSERT_LOWER((int)(liblinphone_tester_get_metric("linphone_call_iterations_total") - iterations), 20, int, "%d");
+	BC_ASSERT_GREATER(linphone_call_stats_get_download_bandwidth(linphone_call_get_audio_stats(call_marie)), 0.f, float, "%f");
+
+	/* the re-INVITEs make both calls busy until they are paused, then running again */
+	linphone_call_pause(call_pauline);
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallPausedByRemote, 1));
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneCallPaused, 1));
+	BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_calls_busy") - busy_calls), 0, int, "%d");
+	linphone_call_resume(call_pauline);
+	BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_calls_busy") - busy_calls), 1, int, "%d");
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneCallStreamsRunning, 2));
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallStreamsRunning, 2));
+	BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_calls_busy") - busy_calls), 0, int, "%d");
+	end_call(marie, pauline);
+
+end:
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+	BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_calls_busy") - busy_calls), 0, int, "%d");
+}
+
+static uint64_t time_core_iterations(LinphoneCore *lc, int count) {
+	uint64_t start = ms_get_cur_time_ms();
+	int i;
+	for (i = 0; i < count; i++)
+		linphone_core_iterate(lc);
+	return ms_get_cur_time_ms() - start;
+}
+
+/* Compares the cost of iterating a core with an idle call, with and without idle_call_iteration_interval */
+static void idle_call_iteration_benchmark(void) {
+	LinphoneCoreManager* marie;
+	LinphoneCoreManager* pauline;
+	const int count = 20000;
+	uint64_t marie_time;
+	uint64_t pauline_time;
+	long long iterations;
+
+	if (!liblinphone_tester_run_benchmarks) {
+		ms_message("Benchmark skipped, use --run-benchmarks to run it");
+		return;
+	}
+
+	marie = linphone_core_manager_create("marie_rc");
+	pauline = linphone_core_manager_create(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	lp_config_set_int(linphone_core_get_config(marie->lc), "misc", "idle_call_iteration_interval", 1000);
+	linphone_core_manager_start(marie, TRUE);
+	linphone_core_manager_start(pauline, TRUE);
+	if (!BC_ASSERT_TRUE(call(marie, pauline)))
+		goto end;
+
+	iterations = liblinphone_tester_get_metric("linphone_call_iterations_total");
+	marie_time = time_core_iterations(marie->lc, count);
+	ms_message("Idle call iteration benchmark: %d iterations with a 1 s interval in %llu ms, %lld call iterations",
+		count, (unsigned long long)marie_time, liblinphone_tester_get_metric("linphone_call_iterations_total") - iterations);
+	iterations = liblinphone_tester_get_metric("linphone_call_iterations_total");
+	pauline_time = time_core_iterations(pauline->lc, count);
+	ms_message("Idle call iteration benchmark: %d iterations without interval in %llu ms, %lld call iterations",
+		count, (unsigned long long)pauline_time, liblinphone_tester_get_metric("linphone_call_iterations_total") - iterations);
+	end_call(marie, pauline);
+
+end:
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
 /*This test is added to reproduce a crash when a call is failed synchronously*/
 static void  simple_call_with_no_sip_transport(void){
 	LinphoneCoreManager* marie;
@@ -6538,6 +6687,10 @@ test_t call_tests[] = {
 	TEST_NO_TAG("Cancelled ringing call", cancelled_ringing_call),
 	TEST_NO_TAG("Call busy when calling self", call_busy_when_calling_self),
 	TEST_NO_TAG("Simple call", simple_call),
+	TEST_NO_TAG("Call statistics history", call_stats_history),
+	TEST_NO_TAG("Call metrics", call_metrics),
+	TEST_NO_TAG("Call with idle iteration interval", call_with_idle_iteration_interval),
+	TEST_NO_TAG("Idle call iteration benchmark", idle_call_iteration_benchmark),
 	TEST_NO_TAG("Simple call with no SIP transport", simple_call_with_no_sip_transport),
 	TEST_NO_TAG("Simple call with UDP", simple_call_with_udp),
 	TEST_ONE_TAG("Call terminated automatically by linphone_core_destroy", automatic_call_termination, "LeaksMemory"),
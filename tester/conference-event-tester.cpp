@@ -16,17 +16,21 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <list>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "address/identity-address.h"
 #include "conference/conference-listener.h"
 #include "conference/handlers/local-conference-event-handler-p.h"
+#include "conference/handlers/local-conference-list-event-handler.h"
 #include "conference/handlers/remote-conference-event-handler-p.h"
 #include "conference/local-conference-p.h"
 #include "conference/local-conference.h"
 #include "conference/participant-p.h"
 #include "conference/remote-conference.h"
+#include "core/core-p.h"
 #include "liblinphone_tester.h"
 #include "linphone/core.h"
 #include "private.h"
@@ -546,7 +550,7 @@ void first_notify_parsing() {
 	size_t size = strlen(first_notify) + strlen(confUri);
 	char *notify = new char[size];
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 
 	snprintf(notify, size, first_notify, confUri);
 	tester->handler->notifyReceived(notify);
@@ -584,7 +588,7 @@ void first_notify_parsing_wrong_conf() {
 	size_t size = strlen(first_notify) + strlen(confUri);
 	char *notify = new char[size];
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	snprintf(notify, size, first_notify, confUri);
 	tester->handler->notifyReceived(notify);
 
@@ -616,7 +620,7 @@ void participant_added_parsing() {
 	size_t size2 = strlen(participant_added_notify) + strlen(confUri);
 	char *notify_added = new char[size2];
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	snprintf(notify, size, first_notify, confUri);
 	tester->handler->notifyReceived(notify);
 
@@ -662,7 +666,7 @@ void participant_not_added_parsing() {
 	size_t size2 = strlen(participant_not_added_notify) + strlen(confUri);
 	char *notify_not_added = new char[size2];
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	snprintf(notify, size, first_notify, confUri);
 	tester->handler->notifyReceived(notify);
 
@@ -705,7 +709,7 @@ void participant_deleted_parsing() {
 	size_t size2 = strlen(participant_deleted_notify) + strlen(confUri);
 	char *notify_deleted = new char[size2];
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	snprintf(notify, size, first_notify, confUri);
 	tester->handler->notifyReceived(notify);
 
@@ -748,7 +752,7 @@ void participant_admined_parsing() {
 	size_t size2 = strlen(participant_admined_notify) + strlen(confUri);
 	char *notify_admined = new char[size2];
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	snprintf(notify, size, first_notify, confUri);
 	tester->handler->notifyReceived(notify);
 
@@ -790,7 +794,7 @@ void participant_unadmined_parsing() {
 	size_t size2 = strlen(participant_unadmined_notify) + strlen(confUri);
 	char *notify_unadmined = new char[size2];
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	snprintf(notify, size, first_notify, confUri);
 	tester->handler->notifyReceived(notify);
 
@@ -848,7 +852,7 @@ void send_first_notify() {
 	const_cast<IdentityAddress &>(localConf->getConferenceAddress()) = addr;
 	string notify = localHandlerPrivate->createNotifyFullState();
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	tester->handler->notifyReceived(notify);
 
 	BC_ASSERT_STRING_EQUAL(tester->confSubject.c_str(), "A random test subject");
@@ -900,7 +904,7 @@ void send_added_notify() {
 	const_cast<IdentityAddress &>(localConf->getConferenceAddress()) = addr;
 	string notify = localHandlerPrivate->createNotifyFullState();
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	tester->handler->notifyReceived(notify);
 
 	BC_ASSERT_EQUAL(tester->participants.size(), 2, int, "%d");
@@ -959,7 +963,7 @@ void send_removed_notify() {
 	const_cast<IdentityAddress &>(localConf->getConferenceAddress()) = addr;
 	string notify = localHandlerPrivate->createNotifyFullState();
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	tester->handler->notifyReceived(notify);
 
 	BC_ASSERT_EQUAL(tester->participants.size(), 2, int, "%d");
@@ -1015,7 +1019,7 @@ void send_admined_notify() {
 	const_cast<IdentityAddress &>(localConf->getConferenceAddress()) = addr;
 	string notify = localHandlerPrivate->createNotifyFullState();
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	tester->handler->notifyReceived(notify);
 
 	BC_ASSERT_EQUAL(tester->participants.size(), 2, int, "%d");
@@ -1070,7 +1074,7 @@ void send_unadmined_notify() {
 	const_cast<IdentityAddress &>(localConf->getConferenceAddress()) = addr;
 	string notify = localHandlerPrivate->createNotifyFullState();
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	tester->handler->notifyReceived(notify);
 
 	BC_ASSERT_EQUAL(tester->participants.size(), 2, int, "%d");
@@ -1126,7 +1130,7 @@ void send_subject_changed_notify () {
 	const_cast<IdentityAddress &>(localConf->getConferenceAddress()) = addr;
 	string notify = localHandlerPrivate->createNotifyFullState();
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	tester->handler->notifyReceived(notify);
 
 	BC_ASSERT_STRING_EQUAL(tester->confSubject.c_str(), "A random test subject");
@@ -1188,7 +1192,7 @@ void send_device_added_notify() {
 	const_cast<IdentityAddress &>(localConf->getConferenceAddress()) = addr;
 	string notify = localHandlerPrivate->createNotifyFullState();
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	tester->handler->notifyReceived(notify);
 
 	BC_ASSERT_EQUAL(tester->participantDevices.size(), 2, int, "%d");
@@ -1248,7 +1252,7 @@ void send_device_removed_notify() {
 	const_cast<IdentityAddress &>(localConf->getConferenceAddress()) = addr;
 	string notify = localHandlerPrivate->createNotifyFullState();
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	tester->handler->notifyReceived(notify);
 
 	BC_ASSERT_EQUAL(tester->participantDevices.size(), 2, int, "%d");
@@ -1321,7 +1325,7 @@ void one_to_one_keyword () {
 	const_cast<IdentityAddress &>(localConf->getConferenceAddress()) = addr;
 	string notify = localHandlerPrivate->createNotifyFullState(-1, true);
 
-	const_cast<IdentityAddress &>(tester->handler->getChatRoomId().getPeerAddress()) = addr;
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
 	tester->handler->notifyReceived(notify);
 
 	BC_ASSERT_EQUAL(tester->participantDevices.size(), 1, int, "%d");
@@ -1335,6 +1339,211 @@ void one_to_one_keyword () {
 	linphone_core_manager_destroy(pauline);
 }
 
+void cached_full_state_notify () {
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	char *identityStr = linphone_address_as_string(pauline->identity);
+	Address addr(identityStr);
+	bctbx_free(identityStr);
+	shared_ptr<ConferenceEventTester> tester = make_shared<ConferenceEventTester>(marie->lc->cppPtr, addr);
+	shared_ptr<LocalConference> localConf = make_shared<LocalConference>(pauline->lc->cppPtr, addr, nullptr);
+	LinphoneAddress *cBobAddr = linphone_core_interpret_url(marie->lc, bobUri);
+	char *bobAddrStr = linphone_address_as_string(cBobAddr);
+	Address bobAddr(bobAddrStr);
+	bctbx_free(bobAddrStr);
+	linphone_address_unref(cBobAddr);
+	LinphoneAddress *cAliceAddr = linphone_core_interpret_url(marie->lc, aliceUri);
+	char *aliceAddrStr = linphone_address_as_string(cAliceAddr);
+	Address aliceAddr(aliceAddrStr);
+	bctbx_free(aliceAddrStr);
+	linphone_address_unref(cAliceAddr);
+	LinphoneAddress *cFrankAddr = linphone_core_interpret_url(marie->lc, frankUri);
+	char *frankAddrStr = linphone_address_as_string(cFrankAddr);
+	Address frankAddr(frankAddrStr);
+	bctbx_free(frankAddrStr);
+	linphone_address_unref(cFrankAddr);
+
+	CallSessionParams params;
+	localConf->addParticipant(bobAddr, &params, false);
+	localConf->addParticipant(aliceAddr, &params, false);
+	shared_ptr<Participant> alice = localConf->findParticipant(aliceAddr);
+	LocalConferenceEventHandlerPrivate *localHandlerPrivate = L_GET_PRIVATE(
+		L_ATTR_GET(L_GET_PRIVATE(localConf), eventHandler)
+	);
+	const_cast<IdentityAddress &>(localConf->getConferenceAddress()) = addr;
+
+	// Same conference version and state: the serialized body is reused.
+	string notify = localHandlerPrivate->getNotifyFullState();
+	BC_ASSERT_TRUE(notify == localHandlerPrivate->getNotifyFullState());
+
+	// A state change without a new version invalidates the cached body.
+	L_GET_PRIVATE(alice)->setAdmin(true);
+	string adminNotify = localHandlerPrivate->getNotifyFullState();
+	BC_ASSERT_TRUE(adminNotify != notify);
+
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
+	tester->handler->notifyReceived(adminNotify);
+	BC_ASSERT_EQUAL(tester->participants.size(), 2, int, "%d");
+	BC_ASSERT_TRUE(tester->participants.find(aliceAddr.asString())->second);
+
+	// A new version invalidates the cached body.
+	localConf->addParticipant(frankAddr, &params, false);
+	localHandlerPrivate->createNotifyParticipantAdded(frankAddr);
+	notify = localHandlerPrivate->getNotifyFullState();
+	BC_ASSERT_TRUE(notify != adminNotify);
+	BC_ASSERT_TRUE(notify == localHandlerPrivate->getNotifyFullState());
+
+	// Any change of the state bumps its revision, without a new version either.
+	unsigned int stateRevision = localConf->getStateRevision();
+	localConf->removeParticipant(localConf->findParticipant(frankAddr));
+	BC_ASSERT_TRUE(localConf->getStateRevision() != stateRevision);
+	BC_ASSERT_TRUE(localHandlerPrivate->getNotifyFullState() != notify);
+	localConf->addParticipant(frankAddr, &params, false);
+	BC_ASSERT_TRUE(localHandlerPrivate->getNotifyFullState() == notify);
+
+	// The conference address is part of the state.
+	stateRevision = localConf->getStateRevision();
+	L_GET_PRIVATE(localConf)->setConferenceAddress(IdentityAddress("sip:other-conference@sip.example.org"));
+	BC_ASSERT_TRUE(localConf->getStateRevision() != stateRevision);
+	string otherEntityNotify = localHandlerPrivate->getNotifyFullState();
+	BC_ASSERT_TRUE(otherEntityNotify != notify);
+	BC_ASSERT_TRUE(otherEntityNotify.find("other-conference@sip.example.org") != string::npos);
+
+	tester = nullptr;
+	localConf = nullptr;
+	alice = nullptr;
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+void missed_notifies_from_ring () {
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	char *identityStr = linphone_address_as_string(pauline->identity);
+	Address addr(identityStr);
+	bctbx_free(identityStr);
+	shared_ptr<ConferenceEventTester> tester = make_shared<ConferenceEventTester>(marie->lc->cppPtr, addr);
+	shared_ptr<LocalConference> localConf = make_shared<LocalConference>(pauline->lc->cppPtr, addr, nullptr);
+	LinphoneAddress *cBobAddr = linphone_core_interpret_url(marie->lc, bobUri);
+	char *bobAddrStr = linphone_address_as_string(cBobAddr);
+	Address bobAddr(bobAddrStr);
+	bctbx_free(bobAddrStr);
+	linphone_address_unref(cBobAddr);
+	LinphoneAddress *cAliceAddr = linphone_core_interpret_url(marie->lc, aliceUri);
+	char *aliceAddrStr = linphone_address_as_string(cAliceAddr);
+	Address aliceAddr(aliceAddrStr);
+	bctbx_free(aliceAddrStr);
+	linphone_address_unref(cAliceAddr);
+	LinphoneAddress *cFrankAddr = linphone_core_interpret_url(marie->lc, frankUri);
+	char *frankAddrStr = linphone_address_as_string(cFrankAddr);
+	Address frankAddr(frankAddrStr);
+	bctbx_free(frankAddrStr);
+	linphone_address_unref(cFrankAddr);
+
+	CallSessionParams params;
+	localConf->addParticipant(bobAddr, &params, false);
+	LocalConferenceEventHandlerPrivate *localHandlerPrivate = L_GET_PRIVATE(
+		L_ATTR_GET(L_GET_PRIVATE(localConf), eventHandler)
+	);
+	const_cast<IdentityAddress &>(localConf->getConferenceAddress()) = addr;
+	string notify = localHandlerPrivate->createNotifyFullState();
+	int knownNotifyId = static_cast<int>(localHandlerPrivate->getLastNotify());
+
+	tester->handler->setChatRoomId(ChatRoomId(addr, tester->handler->getChatRoomId().getLocalAddress()));
+	tester->handler->notifyReceived(notify);
+	BC_ASSERT_EQUAL(tester->participants.size(), 1, int, "%d");
+
+	// These events are not stored in the database, the missed notifies can only come from memory.
+	localConf->addParticipant(aliceAddr, &params, false);
+	localHandlerPrivate->createNotifyParticipantAdded(aliceAddr);
+	localHandlerPrivate->createNotifyParticipantAdminStatusChanged(aliceAddr, true);
+	localConf->addParticipant(frankAddr, &params, false);
+	localHandlerPrivate->createNotifyParticipantAdded(frankAddr);
+
+	notify = localHandlerPrivate->createNotifyMultipart(knownNotifyId);
+	BC_ASSERT_FALSE(notify.empty());
+	tester->handler->multipartNotifyReceived(notify);
+
+	BC_ASSERT_EQUAL(tester->participants.size(), 3, int, "%d");
+	BC_ASSERT_TRUE(tester->participants.find(aliceAddr.asString()) != tester->participants.end());
+	BC_ASSERT_TRUE(tester->participants.find(frankAddr.asString()) != tester->participants.end());
+	BC_ASSERT_TRUE(tester->participants.find(aliceAddr.asString())->second);
+	BC_ASSERT_TRUE(!tester->participants.find(frankAddr.asString())->second);
+
+	tester = nullptr;
+	localConf = nullptr;
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+void list_handlers_lookup_performance () {
+	const int nbConferences = 5000;
+	const int nbSubscriptions = 500;
+	LinphoneCoreManager *pauline = linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	LocalConferenceListEventHandler &listHandler = *L_GET_PRIVATE(pauline->lc->cppPtr)->localListEventHandler;
+
+	vector<shared_ptr<LocalConference>> conferences;
+	vector<ChatRoomId> chatRoomIds;
+	for (int i = 0; i < nbConferences; i++) {
+		IdentityAddress addr("sip:conference-" + to_string(i) + "@example.com");
+		ChatRoomId chatRoomId(addr, addr);
+		shared_ptr<LocalConference> localConf = make_shared<LocalConference>(pauline->lc->cppPtr, addr, nullptr);
+		LocalConferenceEventHandler *handler = (L_ATTR_GET(L_GET_PRIVATE(localConf), eventHandler)).get();
+		// Same order as a server group chat room: the chat room id is only known after the handler is added.
+		listHandler.addHandler(handler);
+		handler->setChatRoomId(chatRoomId);
+		conferences.push_back(localConf);
+		chatRoomIds.push_back(chatRoomId);
+	}
+
+	// A device subscribing to all its chat rooms at once: the resource list of its SUBSCRIBE.
+	string xmlBody = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<resource-lists xmlns=\"urn:ietf:params:xml:ns:resource-lists\"><list>\n";
+	for (int i = 0; i < nbSubscriptions; i++) {
+		const IdentityAddress &addr = chatRoomIds[static_cast<size_t>(i * (nbConferences / nbSubscriptions))].getPeerAddress();
+		xmlBody += "<entry uri=\"" + addr.asString() + ";Last-Notify=" + to_string(i) + "\"/>\n";
+	}
+	xmlBody += "<entry uri=\"sip:unknown-conference@example.com\"/>\n</list></resource-lists>\n";
+
+	uint64_t startTime = ms_get_cur_time_ms();
+	list<LocalConferenceListEventHandler::SubscribedHandler> subscribedHandlers = listHandler.findSubscribedHandlers(xmlBody);
+	uint64_t elapsedTime = ms_get_cur_time_ms() - startTime;
+	ms_message("%d conference handler lookups among %d conferences took %llu ms", nbSubscriptions, nbConferences, (unsigned long long)elapsedTime);
+	BC_ASSERT_EQUAL((int)subscribedHandlers.size(), nbSubscriptions, int, "%d");
+	int nbFound = 0;
+	for (const auto &subscribedHandler : subscribedHandlers) {
+		IdentityAddress addr(subscribedHandler.address);
+		if (subscribedHandler.handler->getChatRoomId() == ChatRoomId(addr, addr) && subscribedHandler.lastNotify == to_string(nbFound))
+			nbFound++;
+	}
+	BC_ASSERT_EQUAL(nbFound, nbSubscriptions, int, "%d");
+
+	// A handler is indexed again when its chat room id changes.
+	LocalConferenceEventHandler *handler = (L_ATTR_GET(L_GET_PRIVATE(conferences.front()), eventHandler)).get();
+	IdentityAddress newAddr("sip:conference-renamed@example.com");
+	handler->setChatRoomId(ChatRoomId(newAddr, newAddr));
+	BC_ASSERT_PTR_NULL(listHandler.findHandler(chatRoomIds.front()));
+	BC_ASSERT_PTR_EQUAL(listHandler.findHandler(ChatRoomId(newAddr, newAddr)), handler);
+	handler->setChatRoomId(chatRoomIds.front());
+	BC_ASSERT_PTR_EQUAL(listHandler.findHandler(chatRoomIds.front()), handler);
+
+	// Handlers sharing an id: the first registered one is found, the other one once it is removed.
+	LocalConferenceEventHandler *otherHandler = (L_ATTR_GET(L_GET_PRIVATE(conferences[1]), eventHandler)).get();
+	otherHandler->setChatRoomId(chatRoomIds.front());
+	BC_ASSERT_PTR_EQUAL(listHandler.findHandler(chatRoomIds.front()), handler);
+	BC_ASSERT_PTR_NULL(listHandler.findHandler(chatRoomIds[1]));
+	listHandler.removeHandler(handler);
+	BC_ASSERT_PTR_EQUAL(listHandler.findHandler(chatRoomIds.front()), otherHandler);
+
+	for (const auto &localConf : conferences)
+		listHandler.removeHandler((L_ATTR_GET(L_GET_PRIVATE(localConf), eventHandler)).get());
+	BC_ASSERT_PTR_NULL(listHandler.findHandler(chatRoomIds.front()));
+	BC_ASSERT_TRUE(listHandler.getHandlers().empty());
+
+	conferences.clear();
+	linphone_core_manager_destroy(pauline);
+}
+
 test_t conference_event_tests[] = {
 	TEST_NO_TAG("First notify parsing", first_notify_parsing),
 	TEST_NO_TAG("First notify parsing wrong conf", first_notify_parsing_wrong_conf),
@@ -1351,7 +1560,10 @@ test_t conference_event_tests[] = {
 	TEST_NO_TAG("Send subject changed notify", send_subject_changed_notify),
 	TEST_NO_TAG("Send device added notify", send_device_added_notify),
 	TEST_NO_TAG("Send device removed notify", send_device_removed_notify),
-	TEST_NO_TAG("one-to-one keyword", one_to_one_keyword)
+	TEST_NO_TAG("one-to-one keyword", one_to_one_keyword),
+	TEST_NO_TAG("Cached full state notify", cached_full_state_notify),
+	TEST_NO_TAG("Missed notifies from ring", missed_notifies_from_ring),
+	TEST_NO_TAG("List handlers lookup performance", list_handlers_lookup_performance)
 };
 
 test_suite_t conference_event_test_suite = {
@@ -16,15 +16,23 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include <algorithm>
+#include <cstring>
+#include <memory>
+#include <sstream>
 #include <string>
 
+#include "chat/notification/imdn.h"
 #include "content/content-manager.h"
 #include "content/content-type.h"
 #include "content/content.h"
 #include "content/header/header-param.h"
+#include "content/multipart-builder.h"
+#include "linphone/utils/utils.h"
 #include "liblinphone_tester.h"
 #include "tester_utils.h"
 #include "logger/logger.h"
+#include "xml/imdn.h"
+#include "xml/linphone-imdn.h"
 
 using namespace LinphonePrivate;
 using namespace std;
@@ -369,6 +377,56 @@ void list_to_multipart () {
 	BC_ASSERT_TRUE(originalStr == generatedStr);
 }
 
+static void multipart_builder (void) {
+	ContentType rlmiContentType = ContentType("application", "rlmi+xml");
+	rlmiContentType.addParameter("charset", "\"UTF-8\"");
+	ContentType contentType = ContentType("application", "pidf+xml");
+	contentType.addParameter("charset", "\"UTF-8\"");
+	Header header = Header("Content-Id", "toto");
+	header.addParameter("param1", "value1");
+	header.addParameter("param2", "");
+	header.addParameter("param3", "value3");
+
+	MultipartBuilder builder;
+	size_t size = builder.getPartOverhead(rlmiContentType, strlen(part1)) + strlen(part1)
+		+ builder.getPartOverhead(contentType, strlen(part2)) + strlen(part2)
+		+ builder.getPartOverhead(contentType, strlen(part3), { Header("Content-Encoding", "b64") }) + strlen(part3)
+		+ builder.getPartOverhead(contentType, strlen(part4), { header }) + strlen(part4);
+	builder.addPart(rlmiContentType, part1);
+	builder.addPart(contentType, part2);
+	builder.addPart(contentType, part3, { Header("Content-Encoding", "b64") });
+	builder.addPart(contentType, part4, { header });
+	BC_ASSERT_EQUAL(static_cast<int>(builder.getSize()), static_cast<int>(size), int, "%d");
+
+	// Must be byte for byte what belle-sip writes for the contents of list_to_multipart.
+	Content multipartContent = builder.finish();
+	BC_ASSERT_TRUE(multipartContent.getContentType().isMultipart());
+	BC_ASSERT_STRING_EQUAL(MultipartBoundary, multipartContent.getContentType().getParameter("boundary").getValue().c_str());
+	BC_ASSERT_EQUAL(static_cast<int>(builder.getSize()), 0, int, "%d");
+
+	const string delimiter = string("--") + MultipartBoundary + "\r\n";
+	const string rlmiHeaders = "Content-Type: application/rlmi+xml;charset=\"UTF-8\"\r\n";
+	const string pidfHeaders = "Content-Type: application/pidf+xml;charset=\"UTF-8\"\r\n";
+	string expectedStr = delimiter + rlmiHeaders
+		+ "Content-Length: " + Utils::toString(strlen(part1)) + "\r\n\r\n" + part1 + "\r\n"
+		+ delimiter + pidfHeaders
+		+ "Content-Length: " + Utils::toString(strlen(part2)) + "\r\n\r\n" + part2 + "\r\n"
+		+ delimiter + "Content-Encoding: b64\r\n" + pidfHeaders
+		+ "Content-Length: " + Utils::toString(strlen(part3)) + "\r\n\r\n" + part3 + "\r\n"
+		+ delimiter + "Content-Id: toto;param1=value1;param2;param3=value3\r\n" + pidfHeaders
+		+ "Content-Length: " + Utils::toString(strlen(part4)) + "\r\n\r\n" + part4 + "\r\n"
+		+ "--" + MultipartBoundary + "--\r\n";
+	BC_ASSERT_STRING_EQUAL(expectedStr.c_str(), multipartContent.getBodyAsString().c_str());
+
+	list<Content> contents = ContentManager::multipartToContentList(multipartContent);
+	BC_ASSERT_EQUAL(static_cast<int>(contents.size()), 4, int, "%d");
+	if (contents.size() == 4) {
+		BC_ASSERT_TRUE(contents.front().getContentType() == rlmiContentType);
+		BC_ASSERT_TRUE(contents.back().getHeader("Content-Id").getValue() == "toto");
+		BC_ASSERT_TRUE(contents.back().getHeader("Content-Id").getParameter("param3").getValue() == "value3");
+	}
+}
+
 static void content_type_parsing(void) {
 	string type = "message/external-body;access-type=URL;URL=\"https://www.linphone.org/img/linphone-open-source-voip-projectX2.png\"";
 	ContentType contentType = ContentType(type);
@@ -401,6 +459,47 @@ static void content_type_parsing(void) {
 	BC_ASSERT_TRUE(type == contentType.asString());
 }
 
+static void content_type_interning(void) {
+	BC_ASSERT_TRUE(ContentType("text/plain") == ContentType::PlainText);
+	BC_ASSERT_TRUE(ContentType(" Text/Plain ") == ContentType::PlainText);
+	BC_ASSERT_TRUE(ContentType("text/plain;charset=UTF-8") != ContentType::PlainText);
+	BC_ASSERT_TRUE(ContentType("text/plain;charset=UTF-8").weakEqual(ContentType::PlainText));
+
+	// Same parsed value, whatever the order of the parameters.
+	ContentType first("multipart/mixed;boundary=abc;charset=UTF-8");
+	ContentType second("multipart/mixed;charset=UTF-8;boundary=abc");
+	BC_ASSERT_TRUE(first == second);
+	BC_ASSERT_TRUE(first != ContentType("multipart/mixed;charset=UTF-8;boundary=abd"));
+
+	// Built again from the interning table.
+	ContentType again("multipart/mixed;boundary=abc;charset=UTF-8");
+	BC_ASSERT_TRUE(again == first);
+	BC_ASSERT_STRING_EQUAL(again.asString().c_str(), first.asString().c_str());
+	BC_ASSERT_STRING_EQUAL(again.getParameter("boundary").getValue().c_str(), "abc");
+
+	// A modified copy is no longer equal to its source.
+	ContentType copy(first);
+	BC_ASSERT_TRUE(copy == first);
+	copy.addParameter("boundary", "def");
+	BC_ASSERT_TRUE(copy != first);
+	BC_ASSERT_TRUE(copy == ContentType("multipart/mixed;boundary=def;charset=UTF-8"));
+	copy.removeParameter("charset");
+	BC_ASSERT_TRUE(copy == ContentType("multipart/mixed;boundary=def"));
+	copy.setSubType("related");
+	BC_ASSERT_TRUE(copy == ContentType("multipart/related;boundary=def"));
+
+	BC_ASSERT_FALSE(ContentType("invalid").isValid());
+	BC_ASSERT_TRUE(ContentType("invalid") == ContentType());
+
+	// Boundaries are not interned: more of them than the table can hold still compare by value.
+	for (int i = 0; i < 300; i++) {
+		string boundary = "multipart/related;boundary=" + to_string(i);
+		BC_ASSERT_TRUE(ContentType(boundary) == ContentType(boundary));
+		BC_ASSERT_TRUE(ContentType(boundary) != ContentType(boundary + "x"));
+	}
+	BC_ASSERT_TRUE(ContentType(" Application/Sdp ") == ContentType::Sdp);
+}
+
 static void content_header_parsing(void) {
 	string value = "toto;param1=value1;param2;param3=value3";
 	Header header = Header("Content-Id", value);
@@ -418,11 +517,160 @@ static void content_header_parsing(void) {
 	BC_ASSERT_STRING_EQUAL("", header.getParameter("access-type").getValue().c_str());
 }
 
+static void content_body_sharing(void) {
+	Content content;
+	content.setContentType(ContentType::PlainText);
+	content.setBodyFromUtf8("Hello world");
+
+	// Copies share the bytes of the body.
+	Content copy(content);
+	BC_ASSERT_TRUE(copy == content);
+	BC_ASSERT_PTR_EQUAL(copy.getBody().data(), content.getBody().data());
+
+	Content shared;
+	shared.shareBody(content);
+	BC_ASSERT_PTR_EQUAL(shared.getBody().data(), content.getBody().data());
+	BC_ASSERT_STRING_EQUAL(shared.getBodyAsUtf8String().c_str(), "Hello world");
+
+	// Setting a new body never alters the other contents.
+	copy.setBodyFromUtf8("Goodbye");
+	BC_ASSERT_STRING_EQUAL(copy.getBodyAsUtf8String().c_str(), "Goodbye");
+	BC_ASSERT_STRING_EQUAL(content.getBodyAsUtf8String().c_str(), "Hello world");
+	BC_ASSERT_FALSE(copy == content);
+
+	Content moved(move(shared));
+	BC_ASSERT_STRING_EQUAL(moved.getBodyAsUtf8String().c_str(), "Hello world");
+	BC_ASSERT_TRUE(shared.isEmpty());
+	BC_ASSERT_EQUAL((int)shared.getSize(), 0, int, "%d");
+
+	content.setBody(vector<char>());
+	BC_ASSERT_TRUE(content.isEmpty());
+	BC_ASSERT_STRING_EQUAL(moved.getBodyAsUtf8String().c_str(), "Hello world");
+}
+
+// Reference implementation of the IMDN body, as built before the hand written writer.
+static string create_imdn_xml_with_xsd (const string &id, time_t timestamp, Imdn::Type imdnType, LinphoneReason reason) {
+	char *datetime = linphone_timestamp_to_rfc3339_string(timestamp);
+	Xsd::Imdn::Imdn imdn(id, datetime);
+	ms_free(datetime);
+	bool needLinphoneImdnNamespace = false;
+	if (imdnType == Imdn::Type::Delivery) {
+		Xsd::Imdn::Status status;
+		if (reason == LinphoneReasonNone) {
+			auto delivered = Xsd::Imdn::Delivered();
+			status.setDelivered(delivered);
+		} else {
+			auto failed = Xsd::Imdn::Failed();
+			status.setFailed(failed);
+			Xsd::LinphoneImdn::ImdnReason imdnReason(linphone_reason_to_string(reason));
+			imdnReason.setCode(linphone_reason_to_error_code(reason));
+			status.setReason(imdnReason);
+			needLinphoneImdnNamespace = true;
+		}
+		Xsd::Imdn::DeliveryNotification deliveryNotification(status);
+		imdn.setDeliveryNotification(deliveryNotification);
+	} else if (imdnType == Imdn::Type::Display) {
+		Xsd::Imdn::Status1 status;
+		auto displayed = Xsd::Imdn::Displayed();
+		status.setDisplayed(displayed);
+		Xsd::Imdn::DisplayNotification displayNotification(status);
+		imdn.setDisplayNotification(displayNotification);
+	}
+
+	stringstream ss;
+	Xsd::XmlSchema::NamespaceInfomap map;
+	map[""].name = "urn:ietf:params:xml:ns:imdn";
+	if (needLinphoneImdnNamespace)
+		map["imdn"].name = "http://www.linphone.org/xsds/imdn.xsd";
+	Xsd::Imdn::serializeImdn(ss, imdn, map, "UTF-8", Xsd::XmlSchema::Flags::dont_pretty_print);
+	return ss.str();
+}
+
+static void check_imdn_parsing (const string &xml) {
+	Imdn::Notification notification;
+	BC_ASSERT_TRUE(Imdn::parseXml(xml, notification));
+
+	istringstream data(xml);
+	unique_ptr<Xsd::Imdn::Imdn> imdn(Xsd::Imdn::parseImdn(data, Xsd::XmlSchema::Flags::dont_validate));
+	if (!BC_ASSERT_PTR_NOT_NULL(imdn.get()))
+		return;
+	BC_ASSERT_STRING_EQUAL(notification.messageId.c_str(), imdn->getMessageId().c_str());
+	BC_ASSERT_STRING_EQUAL(notification.datetime.c_str(), imdn->getDatetime().c_str());
+	if (imdn->getDeliveryNotification().present()) {
+		BC_ASSERT_TRUE(notification.type == Imdn::Type::Delivery);
+		auto &status = imdn->getDeliveryNotification().get().getStatus();
+		BC_ASSERT_EQUAL(notification.status == Imdn::Status::Delivered, status.getDelivered().present(), bool, "%d");
+		BC_ASSERT_EQUAL(notification.status == Imdn::Status::Failed, status.getFailed().present(), bool, "%d");
+		BC_ASSERT_EQUAL(notification.status == Imdn::Status::Error, status.getError().present(), bool, "%d");
+	} else if (imdn->getDisplayNotification().present()) {
+		BC_ASSERT_TRUE(notification.type == Imdn::Type::Display);
+		auto &status = imdn->getDisplayNotification().get().getStatus();
+		BC_ASSERT_EQUAL(notification.status == Imdn::Status::Displayed, status.getDisplayed().present(), bool, "%d");
+	} else
+		BC_ASSERT_TRUE(notification.status == Imdn::Status::None);
+}
+
+static void imdn_codec (void) {
+	const string messageId = "0hJhXfn6T-aV0Ibj";
+	const time_t timestamp = 1528300000;
+
+	string delivered = Imdn::createXml(messageId, timestamp, Imdn::Type::Delivery, LinphoneReasonNone);
+	BC_ASSERT_STRING_EQUAL(
+		delivered.c_str(),
+		create_imdn_xml_with_xsd(messageId, timestamp, Imdn::Type::Delivery, LinphoneReasonNone).c_str()
+	);
+	string failed = Imdn::createXml(messageId, timestamp, Imdn::Type::Delivery, LinphoneReasonUnsupportedContent);
+	BC_ASSERT_STRING_EQUAL(
+		failed.c_str(),
+		create_imdn_xml_with_xsd(messageId, timestamp, Imdn::Type::Delivery, LinphoneReasonUnsupportedContent).c_str()
+	);
+	string displayed = Imdn::createXml(messageId, timestamp, Imdn::Type::Display, LinphoneReasonNone);
+	BC_ASSERT_STRING_EQUAL(
+		displayed.c_str(),
+		create_imdn_xml_with_xsd(messageId, timestamp, Imdn::Type::Display, LinphoneReasonNone).c_str()
+	);
+
+	check_imdn_parsing(delivered);
+	check_imdn_parsing(failed);
+	check_imdn_parsing(displayed);
+
+	// Prefixed elements, comments, pretty printing and escaped characters.
+	check_imdn_parsing(
+		"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<!-- Sent by another client -->\n"
+		"<ns:imdn xmlns:ns='urn:ietf:params:xml:ns:imdn'>\n"
+		"\t<ns:message-id>\n\t\tid&amp;1 \n\t</ns:message-id>\n"
+		"\t<ns:datetime>2018-06-06T15:46:40Z</ns:datetime>\n"
+		"\t<ns:delivery-notification>\n"
+		"\t\t<ns:status><ns:error /></ns:status>\n"
+		"\t</ns:delivery-notification>\n"
+		"</ns:imdn>\n"
+	);
+
+	// Outside of the supported subset, left to the xsd parser.
+	Imdn::Notification notification;
+	BC_ASSERT_FALSE(Imdn::parseXml(
+		"<imdn xmlns=\"urn:ietf:params:xml:ns:imdn\"><message-id><![CDATA[id]]></message-id>"
+		"<datetime>2018-06-06T15:46:40Z</datetime></imdn>",
+		notification
+	));
+	BC_ASSERT_FALSE(Imdn::parseXml(
+		"<imdn xmlns=\"urn:example\"><message-id>id</message-id><datetime>2018-06-06T15:46:40Z</datetime></imdn>",
+		notification
+	));
+	BC_ASSERT_FALSE(Imdn::parseXml(delivered.substr(0, delivered.size() - 3), notification));
+	BC_ASSERT_FALSE(Imdn::parseXml("", notification));
+}
+
 test_t contents_tests[] = {
 	TEST_NO_TAG("Multipart to list", multipart_to_list),
 	TEST_NO_TAG("List to multipart", list_to_multipart),
+	TEST_NO_TAG("Multipart builder", multipart_builder),
 	TEST_NO_TAG("Content type parsing", content_type_parsing),
-	TEST_NO_TAG("Content header parsing", content_header_parsing)
+	TEST_NO_TAG("Content type interning", content_type_interning),
+	TEST_NO_TAG("Content header parsing", content_header_parsing),
+	TEST_NO_TAG("Content body sharing", content_body_sharing),
+	TEST_NO_TAG("IMDN codec", imdn_codec)
 };
 
 test_suite_t contents_test_suite = {
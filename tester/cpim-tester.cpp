@@ -19,7 +19,9 @@
 #include "address/address.h"
 #include "chat/chat-message/chat-message.h"
 #include "chat/chat-room/basic-chat-room.h"
+#include "chat/chat-room/chat-room-p.h"
 #include "chat/cpim/cpim.h"
+#include "chat/notification/imdn.h"
 #include "content/content-type.h"
 #include "content/content.h"
 #include "core/core.h"
@@ -307,6 +309,120 @@ static void cpim_chat_message_modifier_with_multipart_body () {
 	cpim_chat_message_modifier_base(TRUE);
 }
 
+static int rejectIncomingMessagesCode = 0;
+
+static int reject_incoming_message_cb (LinphoneImEncryptionEngine *engine, LinphoneChatRoom *room, LinphoneChatMessage *msg) {
+	return rejectIncomingMessagesCode ? rejectIncomingMessagesCode : -1;
+}
+
+static bctbx_list_t *send_imdn_requesting_messages (LinphoneChatRoom *room, int count, bctbx_list_t *messages) {
+	for (int i = 0; i < count; i++) {
+		LinphoneChatMessage *msg = linphone_chat_room_create_message(room, "Tell me if you get my message");
+		linphone_chat_message_cbs_set_msg_state_changed(linphone_chat_message_get_callbacks(msg), liblinphone_tester_chat_message_msg_state_changed);
+		linphone_chat_message_send(msg);
+		messages = bctbx_list_append(messages, msg);
+	}
+	return messages;
+}
+
+enum class ImdnAggregationTest {
+	Count,
+	Delay,
+	SendFailure,
+	SendRetry
+};
+
+static void imdn_aggregation_base (ImdnAggregationTest test) {
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_new("pauline_tcp_rc");
+	linphone_im_notif_policy_enable_all(linphone_core_get_im_notif_policy(marie->lc));
+	linphone_im_notif_policy_enable_all(linphone_core_get_im_notif_policy(pauline->lc));
+
+	LinphoneImEncryptionEngine *pauline_imee = linphone_im_encryption_engine_new();
+	linphone_im_encryption_engine_cbs_set_process_incoming_message(
+		linphone_im_encryption_engine_get_callbacks(pauline_imee), reject_incoming_message_cb
+	);
+	linphone_core_set_im_encryption_engine(pauline->lc, pauline_imee);
+	rejectIncomingMessagesCode = 0;
+
+	char *paulineUri = linphone_address_as_string_uri_only(pauline->identity);
+	IdentityAddress paulineAddress(paulineUri);
+	bctbx_free(paulineUri);
+
+	// Notifications are only aggregated in chat rooms that handle CPIM.
+	shared_ptr<AbstractChatRoom> marieRoom = marie->lc->cppPtr->getOrCreateBasicChatRoom(paulineAddress);
+	marieRoom->allowCpim(true);
+	marieRoom->allowMultipart(true);
+	Imdn *imdnHandler = L_GET_PRIVATE(static_pointer_cast<ChatRoom>(marieRoom))->getImdnHandler();
+	Imdn::AggregationPolicy policy = imdnHandler->getAggregationPolicy();
+	policy.deliveredDelay = policy.displayedDelay = (test == ImdnAggregationTest::Delay) ? 2000 : 60000;
+	if (test != ImdnAggregationTest::Delay)
+		policy.maxCount = 2;
+	imdnHandler->setAggregationPolicy(policy);
+
+	LinphoneChatRoom *paulineRoom = linphone_core_get_chat_room(pauline->lc, marie->identity);
+	bctbx_list_t *messages = send_imdn_requesting_messages(paulineRoom, 1, nullptr);
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneMessageReceived, 1));
+	// Below the count and before the delay, nothing is sent.
+	BC_ASSERT_FALSE(wait_for_until(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDeliveredToUser, 1, 1000));
+
+	switch (test) {
+		case ImdnAggregationTest::Count:
+			messages = send_imdn_requesting_messages(paulineRoom, 1, messages);
+			BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDeliveredToUser, 2, 5000));
+			break;
+
+		case ImdnAggregationTest::Delay:
+			BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDeliveredToUser, 1, 5000));
+			break;
+
+		case ImdnAggregationTest::SendFailure:
+			// The aggregated IMDN is rejected by the recipient, its notifications are dropped and not sent again.
+			rejectIncomingMessagesCode = 488;
+			messages = send_imdn_requesting_messages(paulineRoom, 1, messages);
+			BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneMessageReceived, 2));
+			BC_ASSERT_FALSE(wait_for_until(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDeliveredToUser, 1, 2000));
+			rejectIncomingMessagesCode = 0;
+			messages = send_imdn_requesting_messages(paulineRoom, 2, messages);
+			BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDeliveredToUser, 2, 5000));
+			BC_ASSERT_FALSE(wait_for_until(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDeliveredToUser, 3, 2000));
+			break;
+
+		case ImdnAggregationTest::SendRetry:
+			// The aggregated IMDN fails for a transient reason, it is sent again on its own once the failure is gone.
+			rejectIncomingMessagesCode = 503;
+			messages = send_imdn_requesting_messages(paulineRoom, 1, messages);
+			BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneMessageReceived, 2));
+			BC_ASSERT_FALSE(wait_for_until(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDeliveredToUser, 1, 2000));
+			rejectIncomingMessagesCode = 0;
+			BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDeliveredToUser, 2, 10000));
+			break;
+	}
+
+	bctbx_list_free_with_data(messages, (bctbx_list_free_func)linphone_chat_message_unref);
+	marieRoom.reset();
+	linphone_im_encryption_engine_unref(pauline_imee);
+
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+static void imdn_aggregation_count () {
+	imdn_aggregation_base(ImdnAggregationTest::Count);
+}
+
+static void imdn_aggregation_delay () {
+	imdn_aggregation_base(ImdnAggregationTest::Delay);
+}
+
+static void imdn_aggregation_send_failure () {
+	imdn_aggregation_base(ImdnAggregationTest::SendFailure);
+}
+
+static void imdn_aggregation_send_retry () {
+	imdn_aggregation_base(ImdnAggregationTest::SendRetry);
+}
+
 test_t cpim_tests[] = {
 	TEST_NO_TAG("Parse minimal CPIM message", parse_minimal_message),
 	TEST_NO_TAG("Set generic header name", set_generic_header_name),
@@ -315,7 +431,11 @@ test_t cpim_tests[] = {
 	TEST_NO_TAG("Parse Message with generic header parameters", parse_message_with_generic_header_parameters),
 	TEST_NO_TAG("Build Message", build_message),
 	TEST_NO_TAG("CPIM chat message modifier", cpim_chat_message_modifier),
-	TEST_NO_TAG("CPIM chat message modifier with multipart body", cpim_chat_message_modifier_with_multipart_body)
+	TEST_NO_TAG("CPIM chat message modifier with multipart body", cpim_chat_message_modifier_with_multipart_body),
+	TEST_NO_TAG("IMDN aggregation count", imdn_aggregation_count),
+	TEST_NO_TAG("IMDN aggregation delay", imdn_aggregation_delay),
+	TEST_NO_TAG("IMDN aggregation send failure", imdn_aggregation_send_failure),
+	TEST_NO_TAG("IMDN aggregation send retry", imdn_aggregation_send_retry)
 };
 
 static int suite_begin(void) {
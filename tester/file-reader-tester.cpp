@@ -0,0 +1,165 @@
+/*
+ * file-reader-tester.cpp
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#ifndef _WIN32
+	#include <unistd.h>
+#endif // ifndef _WIN32
+
+#include "utils/file-reader.h"
+
+#include "liblinphone_tester.h"
+
+// =============================================================================
+
+using namespace std;
+
+using namespace LinphonePrivate;
+
+namespace {
+	// A bit more than two read-ahead blocks of 256 KiB, not a multiple of the 4 KiB alignment.
+	constexpr size_t FileSize = 2 * 256 * 1024 + 12345;
+}
+
+static vector<uint8_t> write_test_file (const char *path) {
+	vector<uint8_t> data(FileSize);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = static_cast<uint8_t>((i * 31) ^ (i >> 11));
+
+	FILE *file = fopen(path, "wb");
+	if (BC_ASSERT_PTR_NOT_NULL(file)) {
+		BC_ASSERT_EQUAL((unsigned long)fwrite(data.data(), 1, data.size(), file), (unsigned long)data.size(), unsigned long, "%lu");
+		fclose(file);
+	}
+	return data;
+}
+
+static void read_sequentially (bool allowMapping) {
+	char *path = bc_tester_file("file_reader.dump");
+	vector<uint8_t> data = write_test_file(path);
+
+	FileReader reader;
+	if (BC_ASSERT_TRUE(reader.open(path, allowMapping))) {
+		if (!allowMapping)
+			BC_ASSERT_FALSE(reader.isMapped());
+		BC_ASSERT_EQUAL((unsigned long)reader.getSize(), (unsigned long)FileSize, unsigned long, "%lu");
+
+		// Chunks of an odd size, so that some of them straddle two read-ahead blocks.
+		vector<uint8_t> buffer(FileSize);
+		size_t offset = 0;
+		while (offset < FileSize) {
+			size_t count = reader.read(offset, buffer.data() + offset, 4099);
+			if (count == 0) {
+				BC_FAIL("Short read");
+				break;
+			}
+			offset += count;
+		}
+		BC_ASSERT_EQUAL((unsigned long)offset, (unsigned long)FileSize, unsigned long, "%lu");
+		BC_ASSERT_TRUE(buffer == data);
+
+		// Past the end of the file.
+		BC_ASSERT_EQUAL((unsigned long)reader.read(FileSize, buffer.data(), 16), 0, unsigned long, "%lu");
+	}
+
+	reader.close();
+	remove(path);
+	bc_free(path);
+}
+
+static void read_mapped () {
+	read_sequentially(true);
+}
+
+static void read_ahead () {
+	read_sequentially(false);
+}
+
+static void read_ahead_random_access () {
+	char *path = bc_tester_file("file_reader.dump");
+	vector<uint8_t> data = write_test_file(path);
+
+	FileReader reader;
+	if (BC_ASSERT_TRUE(reader.open(path, false))) {
+		// Backward, across a block boundary, and a chunk larger than a block.
+		const size_t offsets[] = { 300000, 262140, 10, FileSize - 100 };
+		const size_t counts[] = { 5000, 8, 600000, 1000 };
+		vector<uint8_t> buffer(600000);
+		for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); i++) {
+			size_t expected = min(counts[i], FileSize - offsets[i]);
+			size_t count = reader.read(offsets[i], buffer.data(), counts[i]);
+			BC_ASSERT_EQUAL((unsigned long)count, (unsigned long)expected, unsigned long, "%lu");
+			BC_ASSERT_TRUE(equal(
+				buffer.begin(), buffer.begin() + static_cast<ptrdiff_t>(count), data.begin() + static_cast<ptrdiff_t>(offsets[i])
+			));
+		}
+	}
+
+	reader.close();
+	remove(path);
+	bc_free(path);
+}
+
+#ifndef _WIN32
+static void read_truncated (bool allowMapping) {
+	char *path = bc_tester_file("file_reader.dump");
+	write_test_file(path);
+
+	FileReader reader;
+	if (BC_ASSERT_TRUE(reader.open(path, allowMapping))) {
+		vector<uint8_t> buffer(4096);
+		BC_ASSERT_EQUAL((unsigned long)reader.read(0, buffer.data(), buffer.size()), 4096, unsigned long, "%lu");
+
+		// Reading past the new end of the file gives a short read, not a crash: a mapped file is checked again
+		// when the read moves to another window of 256 KiB.
+		BC_ASSERT_EQUAL(truncate(path, 512 * 1024), 0, int, "%d");
+		BC_ASSERT_EQUAL((unsigned long)reader.read(FileSize - 4096, buffer.data(), buffer.size()), 0, unsigned long, "%lu");
+	}
+
+	reader.close();
+	remove(path);
+	bc_free(path);
+}
+
+static void read_mapped_truncated () {
+	read_truncated(true);
+}
+
+static void read_ahead_truncated () {
+	read_truncated(false);
+}
+#endif // ifndef _WIN32
+
+test_t file_reader_tests[] = {
+	TEST_NO_TAG("Read mapped", read_mapped),
+	TEST_NO_TAG("Read ahead", read_ahead),
+	TEST_NO_TAG("Read ahead random access", read_ahead_random_access),
+#ifndef _WIN32
+	TEST_NO_TAG("Read mapped truncated", read_mapped_truncated),
+	TEST_NO_TAG("Read ahead truncated", read_ahead_truncated)
+#endif // ifndef _WIN32
+};
+
+test_suite_t file_reader_test_suite = {
+	"File reader", NULL, NULL, liblinphone_tester_before_each, liblinphone_tester_after_each,
+	sizeof(file_reader_tests) / sizeof(file_reader_tests[0]), file_reader_tests
+};
@@ -59,6 +59,7 @@ extern test_suite_t contents_test_suite;
 extern test_suite_t cpim_test_suite;
 extern test_suite_t dtmf_test_suite;
 extern test_suite_t event_test_suite;
+extern test_suite_t file_reader_test_suite;
 extern test_suite_t main_db_test_suite;
 extern test_suite_t flexisip_test_suite;
 extern test_suite_t group_chat_test_suite;
@@ -76,10 +77,12 @@ extern test_suite_t proxy_config_test_suite;
 extern test_suite_t quality_reporting_test_suite;
 extern test_suite_t register_test_suite;
 extern test_suite_t remote_provisioning_test_suite;
+extern test_suite_t rtp_port_allocator_test_suite;
 extern test_suite_t setup_test_suite;
 extern test_suite_t stun_test_suite;
 extern test_suite_t tunnel_test_suite;
 extern test_suite_t upnp_test_suite;
+extern test_suite_t utils_test_suite;
 extern test_suite_t video_test_suite;
 
 #ifdef VCARD_ENABLED
@@ -136,6 +139,7 @@ extern const char* test_route;
 extern const char* userhostsfile;
 extern bool_t liblinphone_tester_keep_uuid;
 extern bool_t liblinphone_tester_tls_support_disabled;
+extern bool_t liblinphone_tester_run_benchmarks;
 extern const MSAudioDiffParams audio_cmp_params;
 extern const char *liblinphone_tester_mire_id;
 extern const char *liblinphone_tester_static_image_id;
@@ -426,6 +430,21 @@ void call_base(LinphoneMediaEncryption mode, bool_t enable_video,bool_t enable_r
 bool_t call_with_caller_params(LinphoneCoreManager* caller_mgr,LinphoneCoreManager* callee_mgr, const LinphoneCallParams *params);
 bool_t pause_call_1(LinphoneCoreManager* mgr_1,LinphoneCall* call_1,LinphoneCoreManager* mgr_2,LinphoneCall* call_2);
 void compare_files(const char *path1, const char *path2);
+
+#ifndef _WIN32
+/* HTTP server on the loopback interface serving a single file, see local_http_server.c. */
+typedef struct _LocalHttpServer LocalHttpServer;
+LocalHttpServer *local_http_server_new(const char *file_path);
+char *local_http_server_get_url(const LocalHttpServer *server, const char *name);
+void local_http_server_ignore_ranges(LocalHttpServer *server, bool_t ignore);
+void local_http_server_pause_at(LocalHttpServer *server, size_t offset);
+void local_http_server_resume(LocalHttpServer *server);
+size_t local_http_server_get_size(const LocalHttpServer *server);
+int local_http_server_get_requests(LocalHttpServer *server);
+int local_http_server_get_partial_responses(LocalHttpServer *server);
+size_t local_http_server_get_last_range_start(LocalHttpServer *server);
+void local_http_server_destroy(LocalHttpServer *server);
+#endif
 void check_media_direction(LinphoneCoreManager* mgr, LinphoneCall *call, MSList* lcs,LinphoneMediaDirection audio_dir, LinphoneMediaDirection video_dir);
 void _call_with_ice_base(LinphoneCoreManager* pauline,LinphoneCoreManager* marie, bool_t caller_with_ice, bool_t callee_with_ice, bool_t random_ports, bool_t forced_relay);
 int check_nb_media_starts(LinphoneCoreManager *caller, LinphoneCoreManager *callee, unsigned int caller_nb_media_starts, unsigned int callee_nb_media_starts);
@@ -446,6 +465,8 @@ void liblinphone_tester_init(void(*ftester_printf)(int level, const char *fmt, v
 void liblinphone_tester_uninit(void);
 int liblinphone_tester_set_log_file(const char *filename);
 bool_t check_ice(LinphoneCoreManager* caller, LinphoneCoreManager* callee, LinphoneIceState state);
+/* value of a metric of linphone_core_get_metrics(), -1 if it is not found */
+long long liblinphone_tester_get_metric(const char *name);
 
 
 LinphoneConferenceServer* linphone_conference_server_new(const char *rc_file, bool_t do_registration);
@@ -0,0 +1,296 @@
+/*
+	liblinphone_tester - liblinphone test suite
+	Copyright (C) 2018  Belledonne Communications SARL
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 2 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Minimal HTTP/1.1 server on the loopback interface, serving a single file from memory. It answers GET requests with
+ * a strong entity tag and honors "Range: bytes=N-" requests validated by If-Range, so that download resumption can
+ * be tested without depending on the behavior of a public server.
+ */
+
+#ifndef _WIN32
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "liblinphone_tester.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#define LOCAL_HTTP_SERVER_ETAG "\"linphone-tester\""
+
+struct _LocalHttpServer {
+	ms_thread_t thread;
+	ms_mutex_t mutex;
+	int sock;
+	int port;
+	bool_t running;
+	bool_t ignore_ranges;
+	bool_t pause_pending;
+	bool_t paused;
+	size_t pause_offset;
+	char *data;
+	size_t size;
+	int requests;
+	int partial_responses;
+	size_t last_range_start;
+};
+
+static bool_t local_http_server_is_running(LocalHttpServer *server) {
+	bool_t running;
+	ms_mutex_lock(&server->mutex);
+	running = server->running;
+	ms_mutex_unlock(&server->mutex);
+	return running;
+}
+
+static int local_http_server_read_request(int fd, char *request, size_t size) {
+	size_t length = 0;
+	while (length < size - 1) {
+		ssize_t ret = recv(fd, request + length, size - 1 - length, 0);
+		if (ret <= 0)
+			return -1;
+		length += (size_t)ret;
+		request[length] = '\0';
+		if (strstr(request, "\r\n\r\n"))
+			return 0;
+	}
+	return -1;
+}
+
+static int local_http_server_send(int fd, const char *data, size_t size) {
+	while (size > 0) {
+		ssize_t ret = send(fd, data, size, MSG_NOSIGNAL);
+		if (ret <= 0)
+			return -1;
+		data += ret;
+		size -= (size_t)ret;
+	}
+	return 0;
+}
+
+static void local_http_server_serve(LocalHttpServer *server, int fd) {
+	char request[4096];
+	char header[512];
+	const char *range;
+	const char *if_range;
+	size_t start = 0;
+	size_t offset;
+	bool_t partial = FALSE;
+
+	if (local_http_server_read_request(fd, request, sizeof(request)) != 0)
+		return;
+
+	range = strstr(request, "\r\nRange: bytes=");
+	if_range = strstr(request, "\r\nIf-Range: ");
+	ms_mutex_lock(&server->mutex);
+	server->requests++;
+	if (range && !server->ignore_ranges
+		&& (!if_range || strncmp(if_range + strlen("\r\nIf-Range: "), LOCAL_HTTP_SERVER_ETAG, strlen(LOCAL_HTTP_SERVER_ETAG)) == 0)
+	) {
+		start = (size_t)strtoul(range + strlen("\r\nRange: bytes="), NULL, 10);
+		if (start < server->size) {
+			partial = TRUE;
+			server->partial_responses++;
+			server->last_range_start = start;
+		} else {
+			start = 0;
+		}
+	}
+	ms_mutex_unlock(&server->mutex);
+
+	if (partial) {
+		snprintf(header, sizeof(header),
+			"HTTP/1.1 206 Partial Content\r\nContent-Type: application/octet-stream\r\nContent-Length: %lu\r\n"
+			"Content-Range: bytes %lu-%lu/%lu\r\nETag: " LOCAL_HTTP_SERVER_ETAG "\r\nConnection: close\r\n\r\n",
+			(unsigned long)(server->size - start), (unsigned long)start, (unsigned long)(server->size - 1), (unsigned long)server->size
+		);
+	} else {
+		snprintf(header, sizeof(header),
+			"HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: %lu\r\n"
+			"Accept-Ranges: bytes\r\nETag: " LOCAL_HTTP_SERVER_ETAG "\r\nConnection: close\r\n\r\n",
+			(unsigned long)server->size
+		);
+	}
+	if (local_http_server_send(fd, header, strlen(header)) != 0)
+		return;
+
+	/* Send by chunks so that a pause takes effect at the requested offset. */
+	offset = start;
+	while (offset < server->size && local_http_server_is_running(server)) {
+		size_t chunk = server->size - offset < 16384 ? server->size - offset : 16384;
+		bool_t paused;
+
+		ms_mutex_lock(&server->mutex);
+		if (server->pause_pending && server->pause_offset > offset && server->pause_offset < offset + chunk)
+			chunk = server->pause_offset - offset;
+		else if (server->pause_pending && server->pause_offset == offset) {
+			server->pause_pending = FALSE;
+			server->paused = TRUE;
+		}
+		paused = server->paused;
+		ms_mutex_unlock(&server->mutex);
+
+		if (paused) {
+			ms_usleep(10000);
+			continue;
+		}
+		if (local_http_server_send(fd, server->data + offset, chunk) != 0)
+			return;
+		offset += chunk;
+	}
+}
+
+static void *local_http_server_thread(void *data) {
+	LocalHttpServer *server = (LocalHttpServer *)data;
+	while (local_http_server_is_running(server)) {
+		struct timeval timeout = { 0, 100000 };
+		fd_set fds;
+		int fd;
+
+		FD_ZERO(&fds);
+		FD_SET(server->sock, &fds);
+		if (select(server->sock + 1, &fds, NULL, NULL, &timeout) <= 0)
+			continue;
+		fd = accept(server->sock, NULL, NULL);
+		if (fd < 0)
+			continue;
+		local_http_server_serve(server, fd);
+		close(fd);
+	}
+	return NULL;
+}
+
+LocalHttpServer *local_http_server_new(const char *file_path) {
+	LocalHttpServer *server;
+	struct sockaddr_in addr;
+	socklen_t addr_len = sizeof(addr);
+	FILE *file = fopen(file_path, "rb");
+	long size;
+
+	if (!file) {
+		ms_error("local_http_server_new(): cannot open %s: %s", file_path, strerror(errno));
+		return NULL;
+	}
+	server = ms_new0(LocalHttpServer, 1);
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	server->size = size > 0 ? (size_t)size : 0;
+	server->data = ms_malloc(server->size + 1);
+	if (fread(server->data, 1, server->size, file) != server->size)
+		ms_error("local_http_server_new(): short read on %s", file_path);
+	fclose(file);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	server->sock = socket(AF_INET, SOCK_STREAM, 0);
+	if (server->sock < 0
+		|| bind(server->sock, (struct sockaddr *)&addr, sizeof(addr)) != 0
+		|| listen(server->sock, 5) != 0
+		|| getsockname(server->sock, (struct sockaddr *)&addr, &addr_len) != 0
+	) {
+		ms_error("local_http_server_new(): cannot listen on the loopback interface: %s", strerror(errno));
+		if (server->sock >= 0)
+			close(server->sock);
+		ms_free(server->data);
+		ms_free(server);
+		return NULL;
+	}
+	server->port = ntohs(addr.sin_port);
+
+	ms_mutex_init(&server->mutex, NULL);
+	server->running = TRUE;
+	ms_thread_create(&server->thread, NULL, local_http_server_thread, server);
+	return server;
+}
+
+char *local_http_server_get_url(const LocalHttpServer *server, const char *name) {
+	return ms_strdup_printf("http://127.0.0.1:%d/%s", server->port, name);
+}
+
+void local_http_server_ignore_ranges(LocalHttpServer *server, bool_t ignore) {
+	ms_mutex_lock(&server->mutex);
+	server->ignore_ranges = ignore;
+	ms_mutex_unlock(&server->mutex);
+}
+
+void local_http_server_pause_at(LocalHttpServer *server, size_t offset) {
+	ms_mutex_lock(&server->mutex);
+	server->pause_pending = TRUE;
+	server->pause_offset = offset;
+	ms_mutex_unlock(&server->mutex);
+}
+
+void local_http_server_resume(LocalHttpServer *server) {
+	ms_mutex_lock(&server->mutex);
+	server->paused = FALSE;
+	ms_mutex_unlock(&server->mutex);
+}
+
+size_t local_http_server_get_size(const LocalHttpServer *server) {
+	return server->size;
+}
+
+int local_http_server_get_requests(LocalHttpServer *server) {
+	int requests;
+	ms_mutex_lock(&server->mutex);
+	requests = server->requests;
+	ms_mutex_unlock(&server->mutex);
+	return requests;
+}
+
+int local_http_server_get_partial_responses(LocalHttpServer *server) {
+	int partial_responses;
+	ms_mutex_lock(&server->mutex);
+	partial_responses = server->partial_responses;
+	ms_mutex_unlock(&server->mutex);
+	return partial_responses;
+}
+
+size_t local_http_server_get_last_range_start(LocalHttpServer *server) {
+	size_t last_range_start;
+	ms_mutex_lock(&server->mutex);
+	last_range_start = server->last_range_start;
+	ms_mutex_unlock(&server->mutex);
+	return last_range_start;
+}
+
+void local_http_server_destroy(LocalHttpServer *server) {
+	ms_mutex_lock(&server->mutex);
+	server->running = FALSE;
+	server->paused = FALSE;
+	ms_mutex_unlock(&server->mutex);
+	ms_thread_join(server->thread, NULL);
+	ms_mutex_destroy(&server->mutex);
+	close(server->sock);
+	ms_free(server->data);
+	ms_free(server);
+}
+
+#endif /* _WIN32 */
@@ -667,6 +667,390 @@ static void transfer_message_download_cancelled(void) {
 	linphone_core_manager_destroy(pauline);
 }
 
+#if !defined(_WIN32) && defined(SQLITE_STORAGE_ENABLED)
+static void transfer_message_download_resumed_after_io_error_base(bool_t server_ignores_ranges) {
+	char *send_filepath = bc_tester_res("sounds/sintel_trailer_opus_h264.mkv");
+	char *receive_filepath = bc_tester_file("receive_file.dump");
+	LocalHttpServer *server = local_http_server_new(send_filepath);
+	LinphoneCoreManager* marie = linphone_core_manager_new( "marie_rc");
+	LinphoneCoreManager* pauline = linphone_core_manager_new( "pauline_tcp_rc");
+	belle_http_provider_t *provider = linphone_core_get_http_provider(marie->lc);
+	LinphoneChatRoom* chat_room = linphone_core_get_chat_room(pauline->lc, marie->identity);
+	LinphoneChatMessage* msg = linphone_chat_room_create_message(chat_room, NULL);
+	char *url;
+
+	if (!BC_ASSERT_PTR_NOT_NULL(server))
+		goto end;
+
+	remove(receive_filepath);
+	url = local_http_server_get_url(server, "sintel_trailer_opus_h264.mkv");
+	linphone_chat_message_set_external_body_url(msg, url);
+	ms_free(url);
+	linphone_chat_message_send(msg);
+
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneMessageReceivedWithFile, 1, 10000));
+	if (marie->stat.last_received_chat_message) {
+		LinphoneChatMessage *recv_msg = marie->stat.last_received_chat_message;
+		LinphoneChatMessageCbs *cbs = linphone_chat_message_get_callbacks(recv_msg);
+		LinphoneChatRoom *marie_room = linphone_chat_message_get_chat_room(recv_msg);
+		bctbx_list_t *history;
+		FILE *partial_file;
+		long partial_size = 0;
+
+		linphone_chat_message_cbs_set_msg_state_changed(cbs, liblinphone_tester_chat_message_msg_state_changed);
+		linphone_chat_message_cbs_set_file_transfer_progress_indication(cbs, file_transfer_progress_indication);
+		linphone_chat_message_set_file_transfer_filepath(recv_msg, receive_filepath);
+
+		/* the server stalls at the middle of the file, then the connection is dropped */
+		local_http_server_pause_at(server, local_http_server_get_size(server) / 2);
+		linphone_chat_message_download_file(recv_msg);
+		BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.progress_of_LinphoneFileTransfer, 50, 10000));
+		belle_http_provider_set_recv_error(provider, -1);
+		local_http_server_resume(server);
+		BC_ASSERT_TRUE(wait_for_until(marie->lc, pauline->lc, &marie->stat.number_of_LinphoneMessageFileTransferError, 1, 10000));
+		belle_http_provider_set_recv_error(provider, 0);
+		BC_ASSERT_EQUAL(marie->stat.number_of_LinphoneFileTransferDownloadSuccessful, 0, int, "%d");
+
+		partial_file = fopen(receive_filepath, "rb");
+		if (BC_ASSERT_PTR_NOT_NULL(partial_file)) {
+			fseek(partial_file, 0, SEEK_END);
+			partial_size = ftell(partial_file);
+			fclose(partial_file);
+		}
+		BC_ASSERT_GREATER(partial_size, 0, long, "%ld");
+		BC_ASSERT_LOWER((unsigned long)partial_size, (unsigned long)local_http_server_get_size(server), unsigned long, "%lu");
+
+		/* the resumption state is kept with the message: retry with the one stored in the history */
+		linphone_chat_message_unref(marie->stat.last_received_chat_message);
+		marie->stat.last_received_chat_message = NULL;
+		history = linphone_chat_room_get_history(marie_room, 1);
+		if (BC_ASSERT_EQUAL((int)bctbx_list_size(history), 1, int, "%d")) {
+			recv_msg = (LinphoneChatMessage *)bctbx_list_get_data(history);
+			cbs = linphone_chat_message_get_callbacks(recv_msg);
+			linphone_chat_message_cbs_set_msg_state_changed(cbs, liblinphone_tester_chat_message_msg_state_changed);
+			linphone_chat_message_cbs_set_file_transfer_progress_indication(cbs, file_transfer_progress_indication);
+			linphone_chat_message_set_file_transfer_filepath(recv_msg, receive_filepath);
+
+			local_http_server_ignore_ranges(server, server_ignores_ranges);
+			marie->stat.progress_of_LinphoneFileTransfer = 0;
+			linphone_chat_message_download_file(recv_msg);
+			if (BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneFileTransferDownloadSuccessful, 1, 10000))) {
+				/* on a full response, the partial file is truncated instead of being appended to */
+				compare_files(send_filepath, receive_filepath);
+			}
+			BC_ASSERT_EQUAL(local_http_server_get_requests(server), 2, int, "%d");
+			if (server_ignores_ranges) {
+				BC_ASSERT_EQUAL(local_http_server_get_partial_responses(server), 0, int, "%d");
+			} else {
+				BC_ASSERT_EQUAL(local_http_server_get_partial_responses(server), 1, int, "%d");
+				BC_ASSERT_EQUAL((unsigned long)local_http_server_get_last_range_start(server), (unsigned long)partial_size, unsigned long, "%lu");
+			}
+		}
+		bctbx_list_free_with_data(history, (bctbx_list_free_func)linphone_chat_message_unref);
+	}
+
+end:
+	linphone_chat_message_unref(msg);
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+	if (server)
+		local_http_server_destroy(server);
+	remove(receive_filepath);
+	bc_free(send_filepath);
+	bc_free(receive_filepath);
+}
+
+static void transfer_message_download_resumed_after_io_error(void) {
+	transfer_message_download_resumed_after_io_error_base(FALSE);
+}
+
+static void transfer_message_download_restarted_after_io_error(void) {
+	transfer_message_download_resumed_after_io_error_base(TRUE);
+}
+#endif
+
+static int file_transfer_running = 0;
+static int file_transfer_queued = 0;
+static int file_transfer_max_running = 0;
+static int file_transfer_max_queued = 0;
+
+static void file_transfer_queue_changed(LinphoneCore *lc, int running, int queued) {
+	file_transfer_running = running;
+	file_transfer_queued = queued;
+	if (running > file_transfer_max_running) file_transfer_max_running = running;
+	if (queued > file_transfer_max_queued) file_transfer_max_queued = queued;
+}
+
+static void file_transfer_2_messages_queued_base(const char *limit) {
+	if (transport_supported(LinphoneTransportTls)) {
+		LinphoneCoreManager* marie = linphone_core_manager_new( "marie_rc");
+		LinphoneCoreManager* pauline = linphone_core_manager_new( "pauline_tcp_rc");
+		LinphoneChatRoom* pauline_room;
+		LinphoneChatMessage* msg;
+		LinphoneChatMessage* msg2;
+		LinphoneCoreCbs *core_cbs = linphone_factory_create_core_cbs(linphone_factory_get());
+		long long transfers = liblinphone_tester_get_metric("linphone_file_transfers_total");
+		long long connections = liblinphone_tester_get_metric("linphone_file_transfer_connections_total");
+
+		file_transfer_max_running = file_transfer_max_queued = 0;
+		linphone_core_cbs_set_file_transfer_queue_changed(core_cbs, file_transfer_queue_changed);
+		linphone_core_add_callbacks(pauline->lc, core_cbs);
+		linphone_core_cbs_unref(core_cbs);
+		lp_config_set_int(linphone_core_get_config(pauline->lc), "misc", limit, 1);
+		linphone_core_set_file_transfer_server(pauline->lc,"https://www.linphone.org:444/lft.php");
+
+		/* the second upload waits for the first one to be over */
+		pauline_room = linphone_core_get_chat_room(pauline->lc, marie->identity);
+		msg = create_message_from_sintel_trailer(pauline_room);
+		msg2 = create_message_from_sintel_trailer(pauline_room);
+		linphone_chat_message_send(msg);
+		linphone_chat_message_send(msg2);
+		BC_ASSERT_EQUAL((int)linphone_chat_message_get_state(msg2), (int)LinphoneChatMessageStateInProgress, int, "%d");
+		BC_ASSERT_TRUE(wait_for_until(pauline->lc,marie->lc,&marie->stat.number_of_LinphoneMessageReceivedWithFile,2, 120000));
+		BC_ASSERT_EQUAL(file_transfer_max_running, 1, int, "%d");
+		BC_ASSERT_EQUAL(file_transfer_max_queued, 1, int, "%d");
+		/* the second upload to the server may reuse the connection of the first one */
+		BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_file_transfers_total") - transfers), 2, int, "%d");
+		BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_file_transfer_connections_total") - connections), 1, int, "%d");
+
+		linphone_chat_message_unref(msg);
+		linphone_chat_message_unref(msg2);
+		linphone_core_manager_destroy(pauline);
+		linphone_core_manager_destroy(marie);
+	}
+}
+
+static void file_transfer_2_messages_queued(void) {
+	file_transfer_2_messages_queued_base("max_concurrent_file_transfers");
+}
+
+static void file_transfer_2_messages_queued_per_host(void) {
+	/* both uploads go to the same file server */
+	file_transfer_2_messages_queued_base("max_concurrent_file_transfers_per_host");
+}
+
+static void transfer_message_with_thumbnail(void) {
+	if (transport_supported(LinphoneTransportTls)) {
+		LinphoneCoreManager* marie = linphone_core_manager_new( "marie_rc");
+		LinphoneCoreManager* pauline = linphone_core_manager_new( "pauline_tcp_rc");
+		LinphoneChatRoom* pauline_room;
+		LinphoneChatMessage* msg;
+		LinphoneContent* content;
+		char *send_filepath = bc_tester_res("sounds/sintel_trailer_opus_h264.mkv");
+		char *thumbnail_filepath = bc_tester_res("images/nowebcamCIF.jpg");
+
+		linphone_core_set_file_transfer_server(pauline->lc,"https://www.linphone.org:444/lft.php");
+		pauline_room = linphone_core_get_chat_room(pauline->lc, marie->identity);
+		content = linphone_core_create_content(pauline->lc);
+		linphone_content_set_type(content,"video");
+		linphone_content_set_subtype(content,"mkv");
+		linphone_content_set_name(content,"sintel_trailer_opus_h264.mkv");
+		linphone_content_set_file_path(content, send_filepath);
+		linphone_content_set_thumbnail_file_path(content, thumbnail_filepath);
+		BC_ASSERT_STRING_EQUAL(linphone_content_get_thumbnail_file_path(content), thumbnail_filepath);
+		msg = linphone_chat_room_create_file_transfer_message(pauline_room, content);
+		linphone_content_unref(content);
+		linphone_chat_message_cbs_set_msg_state_changed(linphone_chat_message_get_callbacks(msg), liblinphone_tester_chat_message_msg_state_changed);
+
+		/* the file transfer XML advertises the thumbnail uploaded after the file */
+		linphone_chat_message_send(msg);
+		BC_ASSERT_TRUE(wait_for_until(pauline->lc,marie->lc,&pauline->stat.number_of_LinphoneMessageFileTransferDone,1, 60000));
+		if (BC_ASSERT_TRUE(wait_for_until(pauline->lc,marie->lc,&marie->stat.number_of_LinphoneMessageReceivedWithFile,1, 60000))) {
+			const LinphoneContent *received = linphone_chat_message_get_file_transfer_information(marie->stat.last_received_chat_message);
+			if (BC_ASSERT_PTR_NOT_NULL(received)) {
+				BC_ASSERT_PTR_NOT_NULL(linphone_content_get_thumbnail_url(received));
+				BC_ASSERT_STRING_EQUAL(linphone_content_get_name(received), "sintel_trailer_opus_h264.mkv");
+			}
+		}
+
+		linphone_chat_message_unref(msg);
+		bc_free(send_filepath);
+		bc_free(thumbnail_filepath);
+		linphone_core_manager_destroy(pauline);
+		linphone_core_manager_destroy(marie);
+	}
+}
+
+#ifdef VIDEO_ENABLED
+static void transfer_message_with_generated_thumbnail(void) {
+	if (transport_supported(LinphoneTransportTls)) {
+		LinphoneCoreManager* marie = linphone_core_manager_new( "marie_rc");
+		LinphoneCoreManager* pauline = linphone_core_manager_new( "pauline_tcp_rc");
+		LinphoneChatRoom* pauline_room;
+		LinphoneChatMessage* msg;
+		LinphoneContent* content;
+		char *send_filepath = bc_tester_res("images/nowebcamVGA.jpg");
+
+		/* a JPEG image sent without thumbnail gets one made by the sender */
+		linphone_config_set_int(linphone_core_get_config(pauline->lc), "misc", "file_transfer_generate_thumbnails", 1);
+		linphone_core_set_file_transfer_server(pauline->lc,"https://www.linphone.org:444/lft.php");
+		pauline_room = linphone_core_get_chat_room(pauline->lc, marie->identity);
+		content = linphone_core_create_content(pauline->lc);
+		linphone_content_set_type(content,"image");
+		linphone_content_set_subtype(content,"jpeg");
+		linphone_content_set_name(content,"nowebcamVGA.jpg");
+		linphone_content_set_file_path(content, send_filepath);
+		msg = linphone_chat_room_create_file_transfer_message(pauline_room, content);
+		linphone_content_unref(content);
+		linphone_chat_message_cbs_set_msg_state_changed(linphone_chat_message_get_callbacks(msg), liblinphone_tester_chat_message_msg_state_changed);
+
+		linphone_chat_message_send(msg);
+		BC_ASSERT_TRUE(wait_for_until(pauline->lc,marie->lc,&pauline->stat.number_of_LinphoneMessageFileTransferDone,1, 60000));
+		if (BC_ASSERT_TRUE(wait_for_until(pauline->lc,marie->lc,&marie->stat.number_of_LinphoneMessageReceivedWithFile,1, 60000))) {
+			const LinphoneContent *received = linphone_chat_message_get_file_transfer_information(marie->stat.last_received_chat_message);
+			if (BC_ASSERT_PTR_NOT_NULL(received)) {
+				BC_ASSERT_PTR_NOT_NULL(linphone_content_get_thumbnail_url(received));
+				BC_ASSERT_STRING_EQUAL(linphone_content_get_name(received), "nowebcamVGA.jpg");
+			}
+		}
+
+		linphone_chat_message_unref(msg);
+		bc_free(send_filepath);
+		linphone_core_manager_destroy(pauline);
+		linphone_core_manager_destroy(marie);
+	}
+}
+#endif
+
+#ifdef SQLITE_STORAGE_ENABLED
+static void transfer_message_thumbnail_stored(void) {
+	LinphoneCoreManager* marie = linphone_core_manager_new( "marie_rc");
+	LinphoneCoreManager* pauline = linphone_core_manager_new( "pauline_tcp_rc");
+	LinphoneChatRoom* pauline_room;
+	LinphoneChatMessage* msg;
+	LinphoneContent* content;
+	bctbx_list_t *history;
+	char *send_filepath = bc_tester_res("sounds/sintel_trailer_opus_h264.mkv");
+	char *thumbnail_filepath = bc_tester_res("images/nowebcamCIF.jpg");
+
+	/* nothing listens there: the upload fails and the message keeps its file content */
+	linphone_core_set_file_transfer_server(pauline->lc, "http://127.0.0.1:1/lft.php");
+	pauline_room = linphone_core_get_chat_room(pauline->lc, marie->identity);
+	content = linphone_core_create_content(pauline->lc);
+	linphone_content_set_type(content,"video");
+	linphone_content_set_subtype(content,"mkv");
+	linphone_content_set_name(content,"sintel_trailer_opus_h264.mkv");
+	linphone_content_set_file_path(content, send_filepath);
+	linphone_content_set_thumbnail_file_path(content, thumbnail_filepath);
+	msg = linphone_chat_room_create_file_transfer_message(pauline_room, content);
+	linphone_content_unref(content);
+	linphone_chat_message_cbs_set_msg_state_changed(linphone_chat_message_get_callbacks(msg), liblinphone_tester_chat_message_msg_state_changed);
+
+	linphone_chat_message_send(msg);
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc,marie->lc,&pauline->stat.number_of_LinphoneMessageNotDelivered,1, 10000));
+	linphone_chat_message_unref(msg);
+
+	/* the thumbnail is still there once the message is loaded from the database */
+	history = linphone_chat_room_get_history(pauline_room, 1);
+	if (BC_ASSERT_EQUAL((int)bctbx_list_size(history), 1, int, "%d")) {
+		const LinphoneContent *stored = linphone_chat_message_get_file_transfer_information((LinphoneChatMessage *)bctbx_list_get_data(history));
+		if (BC_ASSERT_PTR_NOT_NULL(stored)) {
+			BC_ASSERT_STRING_EQUAL(linphone_content_get_file_path(stored), send_filepath);
+			BC_ASSERT_STRING_EQUAL(linphone_content_get_thumbnail_file_path(stored), thumbnail_filepath);
+		}
+	}
+	bctbx_list_free_with_data(history, (bctbx_list_free_func)linphone_chat_message_unref);
+
+	bc_free(send_filepath);
+	bc_free(thumbnail_filepath);
+	linphone_core_manager_destroy(pauline);
+	linphone_core_manager_destroy(marie);
+}
+#endif
+
+#ifndef _WIN32
+static LinphoneChatMessage *receive_message_with_external_body(LinphoneCoreManager *sender, LinphoneCoreManager *receiver, const char *url) {
+	LinphoneChatRoom *chat_room = linphone_core_get_chat_room(sender->lc, receiver->identity);
+	LinphoneChatMessage *msg = linphone_chat_room_create_message(chat_room, NULL);
+	LinphoneChatMessage *recv_msg = NULL;
+	int received = receiver->stat.number_of_LinphoneMessageReceivedWithFile;
+
+	linphone_chat_message_set_external_body_url(msg, url);
+	linphone_chat_message_send(msg);
+	linphone_chat_message_unref(msg);
+	if (BC_ASSERT_TRUE(wait_for_until(sender->lc, receiver->lc, &receiver->stat.number_of_LinphoneMessageReceivedWithFile, received + 1, 10000))) {
+		LinphoneChatMessageCbs *cbs;
+		recv_msg = linphone_chat_message_ref(receiver->stat.last_received_chat_message);
+		cbs = linphone_chat_message_get_callbacks(recv_msg);
+		linphone_chat_message_cbs_set_msg_state_changed(cbs, liblinphone_tester_chat_message_msg_state_changed);
+		linphone_chat_message_cbs_set_file_transfer_progress_indication(cbs, file_transfer_progress_indication);
+	}
+	return recv_msg;
+}
+
+static void file_transfer_queued_during_call(void) {
+	char *send_filepath = bc_tester_res("sounds/sintel_trailer_opus_h264.mkv");
+	char *receive_filepath = bc_tester_file("receive_file.dump");
+	char *receive_filepath2 = bc_tester_file("receive_file2.dump");
+	LocalHttpServer *server = local_http_server_new(send_filepath);
+	LinphoneCoreManager* marie = linphone_core_manager_new( "marie_rc");
+	LinphoneCoreManager* pauline = linphone_core_manager_new( "pauline_tcp_rc");
+	LinphoneCoreCbs *core_cbs = linphone_factory_create_core_cbs(linphone_factory_get());
+	LinphoneChatMessage *recv_msg = NULL;
+	LinphoneChatMessage *recv_msg2 = NULL;
+	char *url;
+
+	if (!BC_ASSERT_PTR_NOT_NULL(server))
+		goto end;
+
+	file_transfer_running = file_transfer_queued = 0;
+	file_transfer_max_running = file_transfer_max_queued = 0;
+	linphone_core_cbs_set_file_transfer_queue_changed(core_cbs, file_transfer_queue_changed);
+	linphone_core_add_callbacks(marie->lc, core_cbs);
+
+	url = local_http_server_get_url(server, "sintel_trailer_opus_h264.mkv");
+	recv_msg = receive_message_with_external_body(pauline, marie, url);
+	recv_msg2 = receive_message_with_external_body(pauline, marie, url);
+	ms_free(url);
+	if (!recv_msg || !recv_msg2)
+		goto end;
+
+	if (!BC_ASSERT_TRUE(call(marie, pauline)))
+		goto end;
+
+	/* by default a single transfer runs during a call: the first download stalls at the middle of the file,
+	 * the second one waits for a slot */
+	remove(receive_filepath);
+	remove(receive_filepath2);
+	local_http_server_pause_at(server, local_http_server_get_size(server) / 2);
+	linphone_chat_message_set_file_transfer_filepath(recv_msg, receive_filepath);
+	linphone_chat_message_download_file(recv_msg);
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.progress_of_LinphoneFileTransfer, 50, 10000));
+	linphone_chat_message_set_file_transfer_filepath(recv_msg2, receive_filepath2);
+	linphone_chat_message_download_file(recv_msg2);
+	BC_ASSERT_EQUAL(file_transfer_running, 1, int, "%d");
+	BC_ASSERT_EQUAL(file_transfer_queued, 1, int, "%d");
+
+	/* the end of the call lifts the limit right away, while the first download still runs */
+	end_call(marie, pauline);
+	BC_ASSERT_EQUAL(file_transfer_running, 2, int, "%d");
+	BC_ASSERT_EQUAL(file_transfer_queued, 0, int, "%d");
+
+	local_http_server_resume(server);
+	if (BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneFileTransferDownloadSuccessful, 2, 20000))) {
+		compare_files(send_filepath, receive_filepath);
+		compare_files(send_filepath, receive_filepath2);
+	}
+	BC_ASSERT_EQUAL(file_transfer_max_running, 2, int, "%d");
+
+end:
+	if (recv_msg)
+		linphone_chat_message_unref(recv_msg);
+	if (recv_msg2)
+		linphone_chat_message_unref(recv_msg2);
+	linphone_core_cbs_unref(core_cbs);
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+	if (server)
+		local_http_server_destroy(server);
+	remove(receive_filepath);
+	remove(receive_filepath2);
+	bc_free(send_filepath);
+	bc_free(receive_filepath);
+	bc_free(receive_filepath2);
+}
+#endif
+
 static void file_transfer_2_messages_simultaneously(void) {
 	if (transport_supported(LinphoneTransportTls)) {
 		LinphoneCoreManager* marie = linphone_core_manager_new( "marie_rc");
@@ -1017,8 +1401,165 @@ static void is_composing_notification(void) {
 static void is_composing_notification_with_lime(void) {
 	_is_composing_notification(TRUE);
 }
+
+static void is_composing_notification_coalescing(void) {
+	LinphoneChatRoom *pauline_chat_room;
+	int dummy = 0;
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_new("pauline_tcp_rc");
+	lp_config_set_int(linphone_core_get_config(pauline->lc), "sip", "composing_min_interval", 3000);
+	lp_config_set_int(linphone_core_get_config(pauline->lc), "sip", "composing_idle_timeout", 15);
+
+	pauline_chat_room = linphone_core_get_chat_room(pauline->lc, marie->identity);
+	linphone_core_get_chat_room(marie->lc, pauline->identity);
+	linphone_chat_room_compose(pauline_chat_room);
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneIsComposingActiveReceived, 1));
+
+	/* Composing again right after sending a message is deferred until the minimum interval has elapsed */
+	linphone_chat_room_send_message(pauline_chat_room, "Hello");
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneIsComposingIdleReceived, 1));
+	linphone_chat_room_compose(pauline_chat_room);
+	wait_for_until(pauline->lc, marie->lc, &dummy, 1, 1000);
+	BC_ASSERT_EQUAL(marie->stat.number_of_LinphoneIsComposingActiveReceived, 1, int, "%d");
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneIsComposingActiveReceived, 2, 5000));
+
+	/* Repeated compose calls while already composing do not generate any notification */
+	linphone_chat_room_compose(pauline_chat_room);
+	linphone_chat_room_compose(pauline_chat_room);
+	wait_for_until(pauline->lc, marie->lc, &dummy, 1, 4000);
+	BC_ASSERT_EQUAL(marie->stat.number_of_LinphoneIsComposingActiveReceived, 2, int, "%d");
+	BC_ASSERT_EQUAL(marie->stat.number_of_LinphoneIsComposingIdleReceived, 1, int, "%d");
+
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
 #endif
 
+static int outgoing_message_queue_congested = 0;
+static int outgoing_message_queue_decongested = 0;
+
+static void outgoing_message_queue_congestion_changed(LinphoneCore *lc, bool_t congested) {
+	if (congested) outgoing_message_queue_congested++;
+	else outgoing_message_queue_decongested++;
+}
+
+static void outgoing_message_pacing(void) {
+	int dummy = 0;
+	int i;
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_create("pauline_tcp_rc");
+	LinphoneChatRoom *pauline_chat_room;
+	LinphoneCoreCbs *cbs = linphone_factory_create_core_cbs(linphone_factory_get());
+
+	outgoing_message_queue_congested = outgoing_message_queue_decongested = 0;
+	linphone_core_cbs_set_outgoing_message_queue_congestion_changed(cbs, outgoing_message_queue_congestion_changed);
+	linphone_core_add_callbacks(pauline->lc, cbs);
+	linphone_core_cbs_unref(cbs);
+	/* The rates are read when the core starts */
+	lp_config_set_int(linphone_core_get_config(pauline->lc), "sip", "outgoing_message_rate_per_destination", 1);
+	lp_config_set_int(linphone_core_get_config(pauline->lc), "sip", "outgoing_message_congestion_threshold", 2);
+	linphone_core_manager_start(pauline, TRUE);
+	pauline_chat_room = linphone_core_get_chat_room(pauline->lc, marie->identity);
+
+	/* Only the first message goes out right away, the others are spread at one per second */
+	for (i = 0; i < 4; i++)
+		linphone_chat_room_send_message(pauline_chat_room, "Hello");
+	BC_ASSERT_EQUAL(outgoing_message_queue_congested, 1, int, "%d");
+	wait_for_until(pauline->lc, marie->lc, &dummy, 1, 500);
+	BC_ASSERT_EQUAL(marie->stat.number_of_LinphoneMessageReceived, 1, int, "%d");
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneMessageReceived, 4, 6000));
+	BC_ASSERT_EQUAL(outgoing_message_queue_congested, 1, int, "%d");
+	BC_ASSERT_EQUAL(outgoing_message_queue_decongested, 1, int, "%d");
+
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+static void outgoing_message_pacing_priority(void) {
+	int dummy = 0;
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_create("pauline_tcp_rc");
+	LinphoneChatRoom *marie_chat_room;
+	LinphoneChatRoom *pauline_chat_room;
+	LinphoneChatMessage *msg;
+
+	lp_config_set_int(linphone_core_get_config(pauline->lc), "sip", "outgoing_message_rate_per_destination", 1);
+	/* Hand the display notification to the scheduler right away */
+	lp_config_set_int(linphone_core_get_config(pauline->lc), "misc", "aggregate_imdn", 0);
+	linphone_core_manager_start(pauline, TRUE);
+	linphone_im_notif_policy_enable_all(linphone_core_get_im_notif_policy(marie->lc));
+	linphone_im_notif_policy_enable_all(linphone_core_get_im_notif_policy(pauline->lc));
+	marie_chat_room = linphone_core_get_chat_room(marie->lc, pauline->identity);
+	pauline_chat_room = linphone_core_get_chat_room(pauline->lc, marie->identity);
+
+	msg = linphone_chat_room_create_message(marie_chat_room, "Read me");
+	linphone_chat_message_cbs_set_msg_state_changed(linphone_chat_message_get_callbacks(msg), liblinphone_tester_chat_message_msg_state_changed);
+	linphone_chat_message_send(msg);
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageReceived, 1));
+	/* Let the destination bucket refill before the burst */
+	wait_for_until(pauline->lc, marie->lc, &dummy, 1, 1500);
+
+	/* The first message takes the token, the rest is queued in reverse priority order */
+	linphone_chat_room_send_message(pauline_chat_room, "Hello 1");
+	linphone_chat_room_compose(pauline_chat_room);
+	linphone_chat_room_mark_as_read(pauline_chat_room);
+	linphone_chat_room_send_message(pauline_chat_room, "Hello 2");
+
+	/* Message > Notification > IsComposing */
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneMessageReceived, 2, 5000));
+	BC_ASSERT_EQUAL(marie->stat.number_of_LinphoneMessageDisplayed, 0, int, "%d");
+	BC_ASSERT_EQUAL(marie->stat.number_of_LinphoneIsComposingActiveReceived, 0, int, "%d");
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneMessageDisplayed, 1, 5000));
+	BC_ASSERT_EQUAL(marie->stat.number_of_LinphoneIsComposingActiveReceived, 0, int, "%d");
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneIsComposingActiveReceived, 1, 5000));
+
+	linphone_chat_message_unref(msg);
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+static void imdn_content_encoding_base(int min_size, bool_t expect_encoded) {
+	LinphoneCoreManager *marie = linphone_core_manager_create("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_new("pauline_tcp_rc");
+	LinphoneChatRoom *pauline_chat_room;
+	LinphoneChatMessage *msg;
+	long long encoded = liblinphone_tester_get_metric("linphone_sip_bodies_encoded_total");
+	long long unencoded = liblinphone_tester_get_metric("linphone_sip_bodies_unencoded_total");
+
+	/* the IMDNs sent by marie are deflated unless they are smaller than the threshold */
+	lp_config_set_int(linphone_core_get_config(marie->lc), "sip", "content_encoding_min_size", min_size);
+	linphone_core_manager_start(marie, TRUE);
+	if (!linphone_core_content_encoding_supported(marie->lc, "deflate")) {
+		ms_warning("Deflate content encoding is not available, skipping test");
+		goto end;
+	}
+	linphone_im_notif_policy_enable_all(linphone_core_get_im_notif_policy(marie->lc));
+	linphone_im_notif_policy_enable_all(linphone_core_get_im_notif_policy(pauline->lc));
+	pauline_chat_room = linphone_core_get_chat_room(pauline->lc, marie->identity);
+	msg = linphone_chat_room_create_message(pauline_chat_room, "Tell me if you get my message");
+	linphone_chat_message_cbs_set_msg_state_changed(linphone_chat_message_get_callbacks(msg), liblinphone_tester_chat_message_msg_state_changed);
+	linphone_chat_message_send(msg);
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDeliveredToUser, 1));
+	linphone_chat_message_unref(msg);
+
+	if (expect_encoded) {
+		BC_ASSERT_GREATER((int)(liblinphone_tester_get_metric("linphone_sip_bodies_encoded_total") - encoded), 0, int, "%d");
+		BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_sip_bodies_unencoded_total") - unencoded), 0, int, "%d");
+	} else {
+		BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_sip_bodies_encoded_total") - encoded), 0, int, "%d");
+		BC_ASSERT_GREATER((int)(liblinphone_tester_get_metric("linphone_sip_bodies_unencoded_total") - unencoded), 0, int, "%d");
+	}
+
+end:
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+static void imdn_content_encoding_threshold(void) {
+	imdn_content_encoding_base(65536, FALSE);
+	imdn_content_encoding_base(0, TRUE);
+}
+
 static void _imdn_notifications(bool_t with_lime) {
 	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
 	LinphoneCoreManager *pauline = linphone_core_manager_new("pauline_tcp_rc");
@@ -2139,6 +2680,66 @@ static void real_time_text_message_accented_chars(void) {
 	linphone_core_manager_destroy(pauline);
 }
 
+static void real_time_text_message_receive_buffer(void) {
+	LinphoneChatRoom *pauline_chat_room;
+	LinphoneCoreManager* marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager* pauline = linphone_core_manager_new( "pauline_tcp_rc");
+	LinphoneCallParams *marie_params = NULL;
+	LinphoneCall *pauline_call, *marie_call;
+
+	marie_params = linphone_core_create_call_params(marie->lc, NULL);
+	linphone_call_params_enable_realtime_text(marie_params,TRUE);
+
+	BC_ASSERT_TRUE(call_with_caller_params(marie, pauline, marie_params));
+	pauline_call=linphone_core_get_current_call(pauline->lc);
+	marie_call=linphone_core_get_current_call(marie->lc);
+	if (pauline_call) {
+		pauline_chat_room = linphone_call_get_chat_room(pauline_call);
+		BC_ASSERT_PTR_NOT_NULL(pauline_chat_room);
+		if (pauline_chat_room) {
+			LinphoneChatMessage* rtt_message = linphone_chat_room_create_message(pauline_chat_room,NULL);
+			LinphoneChatRoom *marie_chat_room = linphone_call_get_chat_room(marie_call);
+			/* one to four bytes in UTF-8 */
+			const uint32_t message[6] = { 'a', 0xE9, 0x20AC, 0x1F600, 'b', 0x4E2D };
+			int i;
+
+			/* characters not read yet are kept while others are received */
+			for (i = 0; i < 3; i++)
+				linphone_chat_message_put_char(rtt_message, message[i]);
+			BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneIsComposingActiveReceived, 3, 5000));
+			BC_ASSERT_EQUAL(linphone_chat_room_get_char(marie_chat_room), message[0], unsigned long, "%lu");
+			BC_ASSERT_EQUAL(linphone_chat_room_get_char(marie_chat_room), message[1], unsigned long, "%lu");
+			linphone_chat_message_put_char(rtt_message, message[3]);
+			BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneIsComposingActiveReceived, 4, 5000));
+			BC_ASSERT_EQUAL(linphone_chat_room_get_char(marie_chat_room), message[2], unsigned long, "%lu");
+			BC_ASSERT_EQUAL(linphone_chat_room_get_char(marie_chat_room), message[3], unsigned long, "%lu");
+			BC_ASSERT_EQUAL(linphone_chat_room_get_char(marie_chat_room), 0, unsigned long, "%lu");
+
+			/* once all of them are read, the next ones come after them */
+			for (i = 4; i < 6; i++)
+				linphone_chat_message_put_char(rtt_message, message[i]);
+			BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneIsComposingActiveReceived, 6, 5000));
+			BC_ASSERT_EQUAL(linphone_chat_room_get_char(marie_chat_room), message[4], unsigned long, "%lu");
+			BC_ASSERT_EQUAL(linphone_chat_room_get_char(marie_chat_room), message[5], unsigned long, "%lu");
+
+			linphone_chat_message_send(rtt_message);
+			BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneMessageReceived, 1));
+			BC_ASSERT_PTR_NOT_NULL(marie->stat.last_received_chat_message);
+			if (marie->stat.last_received_chat_message) {
+				const char *text = linphone_chat_message_get_text(marie->stat.last_received_chat_message);
+				BC_ASSERT_PTR_NOT_NULL(text);
+				if (text)
+					BC_ASSERT_STRING_EQUAL(text, "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80" "b\xE4\xB8\xAD");
+			}
+			linphone_chat_message_unref(rtt_message);
+		}
+		end_call(marie, pauline);
+	}
+	linphone_call_params_unref(marie_params);
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
 static void real_time_text_message_different_text_codecs_payload_numbers_sender_side(void) {
 	real_time_text(FALSE, FALSE, TRUE, FALSE, FALSE, FALSE, FALSE);
 }
@@ -2193,6 +2794,77 @@ static void real_time_text_copy_paste(void) {
 	linphone_core_manager_destroy(pauline);
 }
 
+static void file_transfer_chunk_buffers(void) {
+	const size_t chunk_size = 64 * 1024;
+	uint8_t *chunk = ms_malloc(chunk_size + 1);
+	LinphoneBuffer *lb;
+
+	memset(chunk, 'a', chunk_size);
+	chunk[chunk_size] = '\0';
+
+	/* A borrowed chunk is a NUL terminated view of the data, given back without a copy... */
+	lb = _linphone_buffer_new_borrowing_data(chunk, chunk_size);
+	BC_ASSERT_PTR_EQUAL(linphone_buffer_get_content(lb), chunk);
+	BC_ASSERT_EQUAL((int)linphone_buffer_get_size(lb), (int)chunk_size, int, "%d");
+	BC_ASSERT_EQUAL((int)strlen(linphone_buffer_get_string_content(lb)), (int)chunk_size, int, "%d");
+	_linphone_buffer_release_borrowed_data(lb);
+	BC_ASSERT_EQUAL(chunk[0], 'a', char, "%c");
+
+	/* ...which gets its own copy when the application keeps it. */
+	lb = _linphone_buffer_new_borrowing_data(chunk, chunk_size);
+	linphone_buffer_ref(lb);
+	_linphone_buffer_release_borrowed_data(lb);
+	BC_ASSERT_TRUE(linphone_buffer_get_content(lb) != chunk);
+	memset(chunk, 'b', chunk_size);
+	BC_ASSERT_EQUAL(linphone_buffer_get_content(lb)[0], 'a', char, "%c");
+	BC_ASSERT_EQUAL((int)strlen(linphone_buffer_get_string_content(lb)), (int)chunk_size, int, "%d");
+	linphone_buffer_unref(lb);
+
+	ms_free(chunk);
+}
+
+static void file_transfer_chunk_buffers_benchmark(void) {
+	/* 256 MiB received in chunks of 64 KiB, handed to file_transfer_recv with and without a copy */
+	const size_t chunk_size = 64 * 1024;
+	const int nb_chunks = 4096;
+	uint8_t *chunk;
+	uint64_t start_time;
+	uint64_t copy_time;
+	uint64_t borrow_time;
+	size_t total = 0;
+	int i;
+
+	if (!liblinphone_tester_run_benchmarks) {
+		ms_message("Benchmark skipped, use --run-benchmarks to run it");
+		return;
+	}
+
+	chunk = ms_malloc(chunk_size + 1);
+	memset(chunk, 'a', chunk_size);
+	chunk[chunk_size] = '\0';
+
+	start_time = ms_get_cur_time_ms();
+	for (i = 0; i < nb_chunks; i++) {
+		LinphoneBuffer *lb = linphone_buffer_new_from_data(chunk, chunk_size);
+		total += linphone_buffer_get_size(lb);
+		linphone_buffer_unref(lb);
+	}
+	copy_time = ms_get_cur_time_ms() - start_time;
+
+	start_time = ms_get_cur_time_ms();
+	for (i = 0; i < nb_chunks; i++) {
+		LinphoneBuffer *lb = _linphone_buffer_new_borrowing_data(chunk, chunk_size);
+		total += linphone_buffer_get_size(lb);
+		_linphone_buffer_release_borrowed_data(lb);
+	}
+	borrow_time = ms_get_cur_time_ms() - start_time;
+	ms_message("File transfer chunk buffers benchmark: %d chunks of %u bytes in %llu ms with a copy, %llu ms borrowed",
+		nb_chunks, (unsigned int)chunk_size, (unsigned long long)copy_time, (unsigned long long)borrow_time);
+	BC_ASSERT_EQUAL((int)(total / chunk_size), 2 * nb_chunks, int, "%d");
+
+	ms_free(chunk);
+}
+
 void file_transfer_with_http_proxy(void) {
 	if (transport_supported(LinphoneTransportTls)) {
 		LinphoneCoreManager* marie = linphone_core_manager_new( "marie_rc");
@@ -2476,6 +3148,53 @@ void unread_message_count_callback(void) {
 	linphone_core_manager_destroy(pauline);
 }
 
+#ifdef SQLITE_STORAGE_ENABLED
+static void mark_as_read_loaded_and_unloaded_messages(void) {
+	LinphoneCoreManager* marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager* pauline = linphone_core_manager_new("pauline_tcp_rc");
+	LinphoneChatRoom *pauline_room = linphone_core_get_chat_room(pauline->lc, marie->identity);
+	LinphoneChatMessage *sent_messages[3];
+	int i;
+
+	linphone_im_notif_policy_enable_all(linphone_core_get_im_notif_policy(marie->lc));
+	linphone_im_notif_policy_enable_all(linphone_core_get_im_notif_policy(pauline->lc));
+
+	for (i = 0; i < 3; i++) {
+		sent_messages[i] = linphone_chat_room_create_message(pauline_room, "Read me");
+		linphone_chat_message_cbs_set_msg_state_changed(linphone_chat_message_get_callbacks(sent_messages[i]), liblinphone_tester_chat_message_msg_state_changed);
+		linphone_chat_message_send(sent_messages[i]);
+	}
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneMessageReceived, 3));
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDeliveredToUser, 3));
+
+	/* Only the last received message is still referenced, the two others are not loaded anymore. */
+	BC_ASSERT_PTR_NOT_NULL(marie->stat.last_received_chat_message);
+	if (marie->stat.last_received_chat_message != NULL) {
+		LinphoneChatMessage *in_memory_message = marie->stat.last_received_chat_message;
+		LinphoneChatRoom *marie_room = linphone_chat_message_get_chat_room(in_memory_message);
+		linphone_chat_message_cbs_set_msg_state_changed(linphone_chat_message_get_callbacks(in_memory_message), liblinphone_tester_chat_message_msg_state_changed);
+		BC_ASSERT_EQUAL(linphone_chat_room_get_unread_messages_count(marie_room), 3, int, "%d");
+
+		linphone_chat_room_mark_as_read(marie_room);
+		BC_ASSERT_EQUAL(linphone_chat_room_get_unread_messages_count(marie_room), 0, int, "%d");
+		BC_ASSERT_EQUAL(marie->stat.number_of_LinphoneMessageDisplayed, 1, int, "%d");
+		BC_ASSERT_EQUAL(linphone_chat_message_get_state(in_memory_message), LinphoneChatMessageStateDisplayed, int, "%d");
+
+		/* Every message gets its display notification, loaded or not. */
+		BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDisplayed, 3));
+
+		/* A second call has nothing left to notify. */
+		linphone_chat_room_mark_as_read(marie_room);
+		BC_ASSERT_FALSE(wait_for_until(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageDisplayed, 4, 1000));
+	}
+
+	for (i = 0; i < 3; i++)
+		linphone_chat_message_unref(sent_messages[i]);
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+#endif
+
 static void migration_from_messages_db (void) {
 	LinphoneCoreManager* marie = linphone_core_manager_new("marie_rc");
 	char *src_db = bc_tester_res("db/messages.db");
@@ -2513,17 +3232,40 @@ test_t message_tests[] = {
 	TEST_NO_TAG("Transfer message with download io error", transfer_message_with_download_io_error),
 	TEST_NO_TAG("Transfer message upload cancelled", transfer_message_upload_cancelled),
 	TEST_NO_TAG("Transfer message download cancelled", transfer_message_download_cancelled),
+#if !defined(_WIN32) && defined(SQLITE_STORAGE_ENABLED)
+	TEST_NO_TAG("Transfer message download resumed after io error", transfer_message_download_resumed_after_io_error),
+	TEST_NO_TAG("Transfer message download restarted after io error", transfer_message_download_restarted_after_io_error),
+#endif
 	TEST_NO_TAG("Transfer 2 messages simultaneously", file_transfer_2_messages_simultaneously),
+	TEST_NO_TAG("Transfer 2 messages queued", file_transfer_2_messages_queued),
+	TEST_NO_TAG("Transfer 2 messages queued per host", file_transfer_2_messages_queued_per_host),
+	TEST_NO_TAG("Transfer message with thumbnail", transfer_message_with_thumbnail),
+#ifndef _WIN32
+	TEST_NO_TAG("File transfer queued during call", file_transfer_queued_during_call),
+#endif
+#ifdef VIDEO_ENABLED
+	TEST_NO_TAG("Transfer message with generated thumbnail", transfer_message_with_generated_thumbnail),
+#endif
+#ifdef SQLITE_STORAGE_ENABLED
+	TEST_NO_TAG("Transfer message thumbnail stored", transfer_message_thumbnail_stored),
+#endif
+	TEST_NO_TAG("Transfer chunk buffers", file_transfer_chunk_buffers),
+	TEST_NO_TAG("Transfer chunk buffers benchmark", file_transfer_chunk_buffers_benchmark),
 	TEST_NO_TAG("Transfer using external body URL", file_transfer_using_external_body_url),
 	TEST_NO_TAG("Transfer using external body URL 2", file_transfer_using_external_body_url_2),
 	TEST_NO_TAG("Text message denied", text_message_denied),
 	TEST_NO_TAG("IsComposing notification", is_composing_notification),
 	TEST_NO_TAG("IMDN notifications", imdn_notifications),
+	TEST_NO_TAG("IMDN content encoding threshold", imdn_content_encoding_threshold),
 	TEST_NO_TAG("IM notification policy", im_notification_policy),
+	TEST_NO_TAG("Outgoing message pacing", outgoing_message_pacing),
+	TEST_NO_TAG("Outgoing message pacing priority", outgoing_message_pacing_priority),
 #ifdef SQLITE_STORAGE_ENABLED
 	TEST_NO_TAG("Unread message count", unread_message_count),
 	TEST_NO_TAG("Unread message count in callback", unread_message_count_callback),
+	TEST_NO_TAG("Mark as read loaded and unloaded messages", mark_as_read_loaded_and_unloaded_messages),
 	TEST_ONE_TAG("IsComposing notification lime", is_composing_notification_with_lime, "LIME"),
+	TEST_NO_TAG("IsComposing notification coalescing", is_composing_notification_coalescing),
 	TEST_ONE_TAG("IMDN notifications with lime", imdn_notifications_with_lime, "LIME"),
 	TEST_ONE_TAG("IM notification policy with lime", im_notification_policy_with_lime, "LIME"),
 	TEST_ONE_TAG("IM error delivery notification online", im_error_delivery_notification_online, "LIME"),
@@ -2557,6 +3299,7 @@ test_t message_tests[] = {
 	TEST_ONE_TAG("Real Time Text message compatibility crlf", real_time_text_message_compat_crlf, "RTT"),
 	TEST_ONE_TAG("Real Time Text message compatibility lf", real_time_text_message_compat_lf, "RTT"),
 	TEST_ONE_TAG("Real Time Text message with accented characters", real_time_text_message_accented_chars, "RTT"),
+	TEST_ONE_TAG("Real Time Text message receive buffer", real_time_text_message_receive_buffer, "RTT"),
 	TEST_ONE_TAG("Real Time Text offer answer with different payload numbers (sender side)", real_time_text_message_different_text_codecs_payload_numbers_sender_side, "RTT"),
 	TEST_ONE_TAG("Real Time Text offer answer with different payload numbers (receiver side)", real_time_text_message_different_text_codecs_payload_numbers_receiver_side, "RTT"),
 	TEST_ONE_TAG("Real Time Text copy paste", real_time_text_copy_paste, "RTT"),
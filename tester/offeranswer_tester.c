@@ -22,6 +22,7 @@
 #include "linphone/lpconfig.h"
 #include "liblinphone_tester.h"
 #include "tester_utils.h"
+#include "offeranswer.h"
 
 static int get_codec_position(const MSList *l, const char *mime_type, int rate){
 	const MSList *elem;
@@ -68,6 +69,15 @@ static void check_payload_type_numbers(LinphoneCall *call1, LinphoneCall *call2,
 	}
 }
 
+static int local_offer_codec_number(LinphoneCall *call, const char *mime_type) {
+	SalMediaDescription *md = _linphone_call_get_local_desc(call);
+	const MSList *elem;
+	for (elem = md->streams[_linphone_call_get_main_audio_stream_index(call)].payloads; elem != NULL; elem = elem->next) {
+		if (strcasecmp(((PayloadType *)elem->data)->mime_type, mime_type) == 0) return payload_type_get_number((PayloadType *)elem->data);
+	}
+	return -1;
+}
+
 static void simple_call_with_different_codec_mappings(void) {
 	LinphoneCoreManager* marie;
 	LinphoneCoreManager* pauline;
@@ -98,6 +108,16 @@ static void simple_call_with_different_codec_mappings(void) {
 		BC_ASSERT_TRUE(wait_for(pauline->lc,marie->lc,&marie->stat.number_of_LinphoneCallStreamsRunning,2));
 		/*payload type numbers shall remain the same*/
 		check_payload_type_numbers(linphone_core_get_current_call(marie->lc), pauline_call, 104);
+		BC_ASSERT_EQUAL(local_offer_codec_number(pauline_call, "PCMU"), 104, int, "%d");
+
+		/*and again in a second reinvite, whose offer may be reused from the first one*/
+		linphone_call_update(pauline_call,
+			params=linphone_core_create_call_params(pauline->lc, pauline_call));
+		linphone_call_params_unref(params);
+		BC_ASSERT_TRUE(wait_for(pauline->lc,marie->lc,&pauline->stat.number_of_LinphoneCallStreamsRunning,3));
+		BC_ASSERT_TRUE(wait_for(pauline->lc,marie->lc,&marie->stat.number_of_LinphoneCallStreamsRunning,3));
+		check_payload_type_numbers(linphone_core_get_current_call(marie->lc), pauline_call, 104);
+		BC_ASSERT_EQUAL(local_offer_codec_number(pauline_call, "PCMU"), 104, int, "%d");
 	}
 
 	end_call(marie,pauline);
@@ -105,6 +125,103 @@ static void simple_call_with_different_codec_mappings(void) {
 	linphone_core_manager_destroy(pauline);
 }
 
+static bool_t local_offer_has_codec(LinphoneCall *call, const char *mime_type) {
+	SalMediaDescription *md = _linphone_call_get_local_desc(call);
+	const MSList *elem;
+	for (elem = md->streams[_linphone_call_get_main_audio_stream_index(call)].payloads; elem != NULL; elem = elem->next) {
+		if (strcasecmp(((PayloadType *)elem->data)->mime_type, mime_type) == 0) return TRUE;
+	}
+	return FALSE;
+}
+
+static void update_from_marie_with_avpf(LinphoneCoreManager *marie, LinphoneCoreManager *pauline, LinphoneCall *marie_call, bool_t avpf, int count) {
+	LinphoneCallParams *params = linphone_core_create_call_params(marie->lc, marie_call);
+	linphone_call_params_enable_avpf(params, avpf);
+	linphone_call_update(marie_call, params);
+	linphone_call_params_unref(params);
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneCallStreamsRunning, count));
+	BC_ASSERT_TRUE(wait_for(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneCallStreamsRunning, count));
+}
+
+static void update_from_marie(LinphoneCoreManager *marie, LinphoneCoreManager *pauline, LinphoneCall *marie_call, int count) {
+	update_from_marie_with_avpf(marie, pauline, marie_call, linphone_call_params_avpf_enabled(linphone_call_get_params(marie_call)), count);
+}
+
+/* the payload types of a re-INVITE are reused from the previous offer unless the codecs configuration changed */
+static void codecs_change_between_reinvites(void) {
+	LinphoneCoreManager* marie = linphone_core_manager_new( "marie_rc");
+	LinphoneCoreManager* pauline = linphone_core_manager_new( "pauline_tcp_rc");
+	PayloadType *pcma = linphone_core_find_payload_type(marie->lc, "PCMA", 8000, 1);
+	LinphoneCall *marie_call;
+
+	if (!BC_ASSERT_PTR_NOT_NULL(pcma)) goto end;
+	linphone_core_enable_payload_type(marie->lc, pcma, TRUE);
+	if (!BC_ASSERT_TRUE(call(marie, pauline))) goto end;
+	marie_call = linphone_core_get_current_call(marie->lc);
+	BC_ASSERT_TRUE(local_offer_has_codec(marie_call, "PCMA"));
+
+	update_from_marie(marie, pauline, marie_call, 2);
+	BC_ASSERT_TRUE(local_offer_has_codec(marie_call, "PCMA"));
+
+	linphone_core_enable_payload_type(marie->lc, pcma, FALSE);
+	update_from_marie(marie, pauline, marie_call, 3);
+	BC_ASSERT_FALSE(local_offer_has_codec(marie_call, "PCMA"));
+
+	end_call(marie, pauline);
+end:
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+#ifdef VIDEO_ENABLED
+static int local_offer_video_avpf_features(LinphoneCall *call) {
+	SalMediaDescription *md = _linphone_call_get_local_desc(call);
+	const MSList *elem;
+	int features = 0;
+	for (elem = md->streams[_linphone_call_get_main_video_stream_index(call)].payloads; elem != NULL; elem = elem->next) {
+		features |= payload_type_get_avpf_params((PayloadType *)elem->data).features;
+	}
+	return features;
+}
+
+/* the RTCP feedback settings of an offer without AVPF must not leak into the next offers */
+static void avpf_disabled_and_reenabled_between_reinvites(void) {
+	LinphoneCoreManager* marie = linphone_core_manager_new( "marie_rc");
+	LinphoneCoreManager* pauline = linphone_core_manager_new( "pauline_tcp_rc");
+	LinphoneVideoPolicy policy;
+	LinphoneCall *marie_call;
+	int features;
+
+	if (!linphone_core_video_supported(marie->lc)) goto end;
+	linphone_proxy_config_enable_avpf(linphone_core_get_default_proxy_config(marie->lc), TRUE);
+	linphone_proxy_config_enable_avpf(linphone_core_get_default_proxy_config(pauline->lc), TRUE);
+	policy.automatically_accept = TRUE;
+	policy.automatically_initiate = TRUE;
+	linphone_core_enable_video_capture(marie->lc, TRUE);
+	linphone_core_enable_video_display(marie->lc, TRUE);
+	linphone_core_set_video_policy(marie->lc, &policy);
+	linphone_core_enable_video_capture(pauline->lc, TRUE);
+	linphone_core_enable_video_display(pauline->lc, TRUE);
+	linphone_core_set_video_policy(pauline->lc, &policy);
+
+	if (!BC_ASSERT_TRUE(call(marie, pauline))) goto end;
+	marie_call = linphone_core_get_current_call(marie->lc);
+	features = local_offer_video_avpf_features(marie_call);
+	BC_ASSERT_NOT_EQUAL(features, 0, int, "%d");
+
+	update_from_marie_with_avpf(marie, pauline, marie_call, FALSE, 2);
+	BC_ASSERT_EQUAL(local_offer_video_avpf_features(marie_call), 0, int, "%d");
+
+	update_from_marie_with_avpf(marie, pauline, marie_call, TRUE, 3);
+	BC_ASSERT_EQUAL(local_offer_video_avpf_features(marie_call), features, int, "%d");
+
+	end_call(marie, pauline);
+end:
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+#endif
+
 static void simple_call_with_fmtps(void){
 	LinphoneCoreManager* marie;
 	LinphoneCoreManager* pauline;
@@ -526,11 +643,204 @@ end:
 }
 #endif
 
+typedef struct _ExpectedPayload {
+	const PayloadType *pt;
+	int channels;
+	int number;
+} ExpectedPayload;
+
+static PayloadType *payload_match_pt_new(const char *mime_type, int rate, int channels, int number) {
+	PayloadType *pt = payload_type_new();
+	pt->type = PAYLOAD_AUDIO_CONTINUOUS;
+	pt->mime_type = ms_strdup(mime_type);
+	pt->clock_rate = rate;
+	pt->channels = channels;
+	payload_type_set_number(pt, number);
+	return pt;
+}
+
+static SalMediaDescription *payload_match_description_new(MSList *payloads) {
+	SalMediaDescription *md = sal_media_description_new();
+	md->nb_streams = 1;
+	md->streams[0].proto = SalProtoRtpAvp;
+	md->streams[0].type = SalAudio;
+	md->streams[0].dir = SalStreamSendRecv;
+	md->streams[0].rtp_port = 7078;
+	md->streams[0].payloads = payloads;
+	return md;
+}
+
+/*
+ * the matching done by offer/answer before payload types were indexed: first local payload type of the list with the
+ * same mime type, rate and channels, except for the codecs having their own offer/answer provider
+ */
+static const PayloadType *payload_match_reference(const MSList *local, const PayloadType *refpt, int *channels) {
+	const PayloadType *candidate = NULL;
+	for (; local != NULL; local = local->next) {
+		const PayloadType *pt = (const PayloadType *)local->data;
+		if (strcasecmp(refpt->mime_type, "opus") == 0) {
+			/* stereo matches the first opus of the list, legacy mono the last one, answered as mono */
+			if (strcasecmp(pt->mime_type, "opus") != 0) continue;
+			if (refpt->channels == 2) {
+				*channels = pt->channels;
+				return pt;
+			}
+			if (refpt->channels == 1) {
+				candidate = pt;
+				*channels = 1;
+			}
+		} else if (strcasecmp(refpt->mime_type, "G729A") == 0) {
+			/* the last G729 of the list with the same channels, whatever the rate */
+			if (strcasecmp(pt->mime_type, "G729") == 0 && pt->channels == refpt->channels) {
+				candidate = pt;
+				*channels = pt->channels;
+			}
+		} else if (strcasecmp(refpt->mime_type, "red") == 0) {
+			/* the first red of the list, whatever the rate and channels */
+			if (strcasecmp(pt->mime_type, "red") == 0) {
+				*channels = pt->channels;
+				return pt;
+			}
+		} else if (strcasecmp(pt->mime_type, refpt->mime_type) == 0 && pt->clock_rate == refpt->clock_rate && pt->channels == refpt->channels) {
+			*channels = pt->channels;
+			return pt;
+		}
+	}
+	return candidate;
+}
+
+static int payload_match_expected(const MSList *local, const MSList *remote, bool_t reading_response, bool_t one_matching_codec, ExpectedPayload *expected) {
+	int count = 0;
+	bool_t found_codec = FALSE;
+	const MSList *elem;
+	int i;
+
+	for (elem = remote; elem != NULL; elem = elem->next) {
+		const PayloadType *p2 = (const PayloadType *)elem->data;
+		int channels = 0;
+		const PayloadType *matched = payload_match_reference(local, p2, &channels);
+		if (!matched) continue;
+		if (one_matching_codec && strcasecmp(matched->mime_type, "telephone-event") != 0) {
+			if (found_codec) continue;
+			found_codec = TRUE;
+		}
+		expected[count].pt = matched;
+		expected[count].channels = channels;
+		expected[count++].number = payload_type_get_number(p2);
+		if (reading_response && payload_type_get_number(p2) != payload_type_get_number(matched)) {
+			expected[count].pt = matched;
+			expected[count].channels = channels;
+			expected[count++].number = payload_type_get_number(matched);
+		}
+	}
+	if (reading_response) {
+		for (elem = local; elem != NULL; elem = elem->next) {
+			const PayloadType *p1 = (const PayloadType *)elem->data;
+			bool_t found = FALSE;
+			for (i = 0; i < count && !found; i++)
+				found = (expected[i].number == payload_type_get_number(p1));
+			if (!found) {
+				expected[count].pt = p1;
+				expected[count].channels = p1->channels;
+				expected[count++].number = payload_type_get_number(p1);
+			}
+		}
+	}
+	return count;
+}
+
+static void check_payload_match(const MSList *result, const ExpectedPayload *expected, int expected_count) {
+	int i = 0;
+	BC_ASSERT_EQUAL((int)bctbx_list_size(result), expected_count, int, "%d");
+	for (; result != NULL && i < expected_count; result = result->next, i++) {
+		const PayloadType *pt = (const PayloadType *)result->data;
+		BC_ASSERT_STRING_EQUAL(pt->mime_type, expected[i].pt->mime_type);
+		BC_ASSERT_EQUAL(pt->clock_rate, expected[i].pt->clock_rate, int, "%d");
+		BC_ASSERT_EQUAL(pt->channels, expected[i].channels, int, "%d");
+		BC_ASSERT_EQUAL(payload_type_get_number(pt), expected[i].number, int, "%d");
+	}
+}
+
+/* offer/answer must match many payload types exactly as the plain list walk did */
+static void payload_matching_equivalence(void) {
+	static const int rates[] = { 8000, 16000, 48000 };
+	/* the factory of a core, so that the opus, G729A and red offer/answer providers are registered */
+	LinphoneCore *lc = linphone_factory_create_core_2(linphone_factory_get(), NULL, NULL, NULL, NULL, system_context);
+	MSFactory *factory = linphone_core_get_ms_factory(lc);
+	MSList *local_payloads = NULL;
+	MSList *remote_payloads = NULL;
+	SalMediaDescription *local, *remote, *result;
+	ExpectedPayload expected[256];
+	int expected_count;
+	char mime_type[32];
+	int i;
+
+	for (i = 0; i < 40; i++) {
+		snprintf(mime_type, sizeof(mime_type), "X-Codec%d", i % 13);
+		local_payloads = bctbx_list_append(local_payloads, payload_match_pt_new(mime_type, rates[i % 3], 1 + i % 2, 70 + i));
+	}
+	/* same keys as payload types above: only the first ones of the list can be matched */
+	local_payloads = bctbx_list_append(local_payloads, payload_match_pt_new("X-CODEC0", 8000, 1, 110));
+	local_payloads = bctbx_list_append(local_payloads, payload_match_pt_new("x-codec5", 16000, 2, 111));
+	local_payloads = bctbx_list_append(local_payloads, payload_match_pt_new("telephone-event", 8000, 1, 101));
+	/* payload types matched by the offer/answer providers */
+	local_payloads = bctbx_list_append(local_payloads, payload_match_pt_new("opus", 48000, 2, 112));
+	local_payloads = bctbx_list_append(local_payloads, payload_match_pt_new("opus", 48000, 1, 113));
+	local_payloads = bctbx_list_append(local_payloads, payload_match_pt_new("G729", 8000, 1, 18));
+	local_payloads = bctbx_list_append(local_payloads, payload_match_pt_new("G729", 8000, 2, 114));
+	local_payloads = bctbx_list_append(local_payloads, payload_match_pt_new("red", 1000, 1, 115));
+	local_payloads = bctbx_list_append(local_payloads, payload_match_pt_new("t140", 1000, 1, 116));
+	for (i = 0; i < 50; i++) {
+		/* lower case mime types, and some without any local counterpart */
+		snprintf(mime_type, sizeof(mime_type), "x-codec%d", (i * 7) % 17);
+		remote_payloads = bctbx_list_append(remote_payloads, payload_match_pt_new(mime_type, rates[(i * 5) % 3], 1 + (i / 3) % 2, 70 + (i * 3) % 45));
+	}
+	remote_payloads = bctbx_list_append(remote_payloads, payload_match_pt_new("opus", 48000, 1, 120));
+	remote_payloads = bctbx_list_append(remote_payloads, payload_match_pt_new("opus", 48000, 2, 121));
+	remote_payloads = bctbx_list_append(remote_payloads, payload_match_pt_new("G729A", 8000, 1, 122));
+	remote_payloads = bctbx_list_append(remote_payloads, payload_match_pt_new("red", 1000, 1, 123));
+	remote_payloads = bctbx_list_append(remote_payloads, payload_match_pt_new("t140", 1000, 1, 124));
+	remote_payloads = bctbx_list_append(remote_payloads, payload_match_pt_new("telephone-event", 8000, 1, 126));
+	local = payload_match_description_new(local_payloads);
+	remote = payload_match_description_new(remote_payloads);
+
+	/* answering an offer */
+	result = sal_media_description_new();
+	offer_answer_initiate_incoming(factory, local, remote, result, FALSE);
+	expected_count = payload_match_expected(local_payloads, remote_payloads, FALSE, FALSE, expected);
+	BC_ASSERT_GREATER(expected_count, 10, int, "%d");
+	check_payload_match(result->streams[0].payloads, expected, expected_count);
+	sal_media_description_unref(result);
+
+	result = sal_media_description_new();
+	offer_answer_initiate_incoming(factory, local, remote, result, TRUE);
+	expected_count = payload_match_expected(local_payloads, remote_payloads, FALSE, TRUE, expected);
+	BC_ASSERT_EQUAL(expected_count, 2, int, "%d");
+	check_payload_match(result->streams[0].payloads, expected, expected_count);
+	sal_media_description_unref(result);
+
+	/* reading an answer */
+	result = sal_media_description_new();
+	offer_answer_initiate_outgoing(factory, local, remote, result);
+	expected_count = payload_match_expected(local_payloads, remote_payloads, TRUE, FALSE, expected);
+	check_payload_match(result->streams[0].payloads, expected, expected_count);
+	sal_media_description_unref(result);
+
+	sal_media_description_unref(local);
+	sal_media_description_unref(remote);
+	linphone_core_unref(lc);
+}
+
 static test_t offeranswer_tests[] = {
 	TEST_NO_TAG("Start with no config", start_with_no_config),
 	TEST_NO_TAG("Call failed because of codecs", call_failed_because_of_codecs),
 	TEST_NO_TAG("Simple call with different codec mappings", simple_call_with_different_codec_mappings),
 	TEST_NO_TAG("Simple call with fmtps", simple_call_with_fmtps),
+	TEST_NO_TAG("Payload matching equivalence", payload_matching_equivalence),
+	TEST_NO_TAG("Codecs change between re-INVITEs", codecs_change_between_reinvites),
+#ifdef VIDEO_ENABLED
+	TEST_NO_TAG("AVPF disabled and re-enabled between re-INVITEs", avpf_disabled_and_reenabled_between_reinvites),
+#endif
 	TEST_NO_TAG("AVP to AVP call", avp_to_avp_call),
 	TEST_NO_TAG("AVP to AVPF call", avp_to_avpf_call),
 	TEST_NO_TAG("AVP to SAVP call", avp_to_savp_call),
@@ -224,6 +224,35 @@ static void simple_subscribe(void) {
 
 	linphone_core_manager_destroy(pauline);
 }
+static void new_subscription_requested_denied(LinphoneCore *lc, LinphoneFriend *lf, const char *url) {
+	get_stats(lc)->number_of_NewSubscriptionRequest++;
+	linphone_core_reject_subscriber(lc, lf);
+}
+
+static void subscribe_denied_not_pending(void) {
+	LinphoneCoreManager* marie = presence_linphone_core_manager_new("marie");
+	LinphoneCoreManager* pauline = presence_linphone_core_manager_new("pauline");
+	long long pending = liblinphone_tester_get_metric("linphone_presence_pending_subscriptions");
+	char *identity = linphone_address_as_string_uri_only(pauline->identity);
+	LinphoneFriend *lf = linphone_core_create_friend_with_address(marie->lc, identity);
+
+	linphone_core_cbs_set_new_subscription_requested(pauline->cbs, new_subscription_requested_denied);
+	linphone_friend_edit(lf);
+	linphone_friend_enable_subscribes(lf, TRUE);
+	linphone_friend_done(lf);
+	linphone_core_add_friend(marie->lc, lf);
+	linphone_friend_unref(lf);
+	ms_free(identity);
+
+	/* the denied subscriber stays in pauline's subscribers to reject its next requests, but is no longer pending */
+	BC_ASSERT_TRUE(wait_for(marie->lc, pauline->lc, &pauline->stat.number_of_NewSubscriptionRequest, 1));
+	BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_presence_pending_subscriptions") - pending), 0, int, "%d");
+
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+	BC_ASSERT_EQUAL((int)(liblinphone_tester_get_metric("linphone_presence_pending_subscriptions") - pending), 0, int, "%d");
+}
+
 static void simple_subscribe_with_early_notify(void) {
 
 	LinphoneCoreManager* marie = presence_linphone_core_manager_new("marie");
@@ -510,6 +539,7 @@ static void simple_subscribe_with_friend_from_rc(void) {
 test_t presence_tests[] = {
 	TEST_ONE_TAG("Simple Subscribe", simple_subscribe,"presence"),
 	TEST_ONE_TAG("Simple Subscribe with early NOTIFY", simple_subscribe_with_early_notify,"presence"),
+	TEST_ONE_TAG("Denied Subscribe not pending", subscribe_denied_not_pending, "presence"),
 	TEST_NO_TAG("Simple Subscribe with friend from rc", simple_subscribe_with_friend_from_rc),
 	/*TEST_ONE_TAG("Call with presence", call_with_presence, "LeaksMemory"),*/
 	TEST_NO_TAG("Unsubscribe while subscribing", unsubscribe_while_subscribing),
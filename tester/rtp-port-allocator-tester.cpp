@@ -0,0 +1,158 @@
+/*
+ * rtp-port-allocator-tester.cpp
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <set>
+
+#include "conference/session/media-session.h"
+#include "conference/session/rtp-port-allocator.h"
+#include "core/core-p.h"
+#include "private.h"
+
+#include "liblinphone_tester.h"
+#include "tester_utils.h"
+
+// =============================================================================
+
+using namespace std;
+
+using namespace LinphonePrivate;
+
+static void allocate_in_range () {
+	RtpPortAllocator allocator;
+	set<int> ports;
+
+	// 40000, 40002, 40004, 40006 and 40008: 40009 is the RTCP port of the last one.
+	for (int i = 0; i < 5; i++) {
+		int port = allocator.allocateInRange(40000, 40009, 0);
+		BC_ASSERT_TRUE(port >= 40000 && port <= 40008);
+		BC_ASSERT_EQUAL(port & 1, 0, int, "%d");
+		BC_ASSERT_TRUE(allocator.isUsed(port));
+		BC_ASSERT_TRUE(allocator.isUsed(port + 1));
+		ports.insert(port);
+	}
+	BC_ASSERT_EQUAL((int)ports.size(), 5, int, "%d");
+
+	// The range is exhausted until a port is released.
+	BC_ASSERT_EQUAL(allocator.allocateInRange(40000, 40009, 0), -1, int, "%d");
+	allocator.release(40004);
+	BC_ASSERT_FALSE(allocator.isUsed(40004));
+	BC_ASSERT_FALSE(allocator.isUsed(40005));
+	BC_ASSERT_EQUAL(allocator.allocateInRange(40000, 40009, 0), 40004, int, "%d");
+	BC_ASSERT_EQUAL(allocator.allocateInRange(40000, 40009, 0), -1, int, "%d");
+}
+
+static void allocate_fixed () {
+	RtpPortAllocator allocator;
+	BC_ASSERT_EQUAL(allocator.allocateFixed(40000), 40000, int, "%d");
+	BC_ASSERT_EQUAL(allocator.allocateFixed(40000), 40002, int, "%d");
+
+	// A fixed port taken in a range is skipped by the range.
+	BC_ASSERT_EQUAL(allocator.allocateInRange(40000, 40005, 0), 40004, int, "%d");
+	BC_ASSERT_EQUAL(allocator.allocateInRange(40000, 40005, 0), -1, int, "%d");
+
+	allocator.release(40002);
+	BC_ASSERT_EQUAL(allocator.allocateInRange(40000, 40005, 0), 40002, int, "%d");
+}
+
+static void port_reuse_delay () {
+	RtpPortAllocator allocator;
+	const unsigned int reuseDelay = 60000;
+
+	int first = allocator.allocateInRange(40000, 40005, reuseDelay);
+	int second = allocator.allocateInRange(40000, 40005, reuseDelay);
+	BC_ASSERT_NOT_EQUAL(first, -1, int, "%d");
+	BC_ASSERT_NOT_EQUAL(second, -1, int, "%d");
+
+	// The port never used is preferred to the one released just now...
+	allocator.release(first);
+	int third = allocator.allocateInRange(40000, 40005, reuseDelay);
+	BC_ASSERT_NOT_EQUAL(third, first, int, "%d");
+	BC_ASSERT_NOT_EQUAL(third, second, int, "%d");
+
+	// ...which is not reused before the end of its reuse delay.
+	BC_ASSERT_EQUAL(allocator.allocateInRange(40000, 40005, reuseDelay), -1, int, "%d");
+	BC_ASSERT_FALSE(allocator.isUsed(first));
+	BC_ASSERT_EQUAL(allocator.allocateInRange(40000, 40005, 0), first, int, "%d");
+
+	// The least recently released port comes first.
+	allocator.release(second);
+	allocator.release(third);
+	BC_ASSERT_EQUAL(allocator.allocateInRange(40000, 40005, 0), second, int, "%d");
+	BC_ASSERT_EQUAL(allocator.allocateInRange(40000, 40005, 0), third, int, "%d");
+}
+
+static void unused_ranges_pruned () {
+	RtpPortAllocator allocator;
+	int port = allocator.allocateInRange(40000, 40099, 0);
+	BC_ASSERT_NOT_EQUAL(port, -1, int, "%d");
+
+	// Successive range changes do not keep a queue per range.
+	for (int i = 1; i <= 20; i++) {
+		int rangePort = allocator.allocateInRange(40000 + 100 * i, 40099 + 100 * i, 0);
+		BC_ASSERT_NOT_EQUAL(rangePort, -1, int, "%d");
+		allocator.release(rangePort);
+		allocator.release(port);
+		port = allocator.allocateInRange(40000, 40099, 0);
+	}
+	BC_ASSERT_TRUE(allocator.getRangeCount() <= 8);
+
+	// A new range knows which ports were released from the others.
+	BC_ASSERT_EQUAL(allocator.allocateInRange(40100, 40101, 0), 40100, int, "%d");
+	BC_ASSERT_EQUAL(allocator.allocateInRange(40100, 40101, 0), -1, int, "%d");
+}
+
+static void release_with_session () {
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_new("pauline_tcp_rc");
+	const unique_ptr<RtpPortAllocator> &allocator = L_GET_PRIVATE(marie->lc->cppPtr)->rtpPortAllocator;
+
+	// A single port in the range: 41001 is its RTCP port, reused as soon as it is released.
+	linphone_core_set_audio_port_range(marie->lc, 41000, 41001);
+	lp_config_set_int(linphone_core_get_config(marie->lc), "rtp", "port_reuse_delay", 0);
+
+	// Released by the destructor of a session that never reached the Released state.
+	{
+		shared_ptr<MediaSession> session = make_shared<MediaSession>(marie->lc->cppPtr, nullptr, nullptr, nullptr);
+		BC_ASSERT_TRUE(allocator->isUsed(41000));
+	}
+	BC_ASSERT_FALSE(allocator->isUsed(41000));
+
+	// Released when the call is.
+	if (BC_ASSERT_TRUE(call(marie, pauline))) {
+		BC_ASSERT_TRUE(allocator->isUsed(41000));
+		end_call(marie, pauline);
+		BC_ASSERT_FALSE(allocator->isUsed(41000));
+	}
+
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+test_t rtp_port_allocator_tests[] = {
+	TEST_NO_TAG("Allocate in range", allocate_in_range),
+	TEST_NO_TAG("Allocate fixed", allocate_fixed),
+	TEST_NO_TAG("Port reuse delay", port_reuse_delay),
+	TEST_NO_TAG("Unused ranges pruned", unused_ranges_pruned),
+	TEST_NO_TAG("Release with session", release_with_session)
+};
+
+test_suite_t rtp_port_allocator_test_suite = {
+	"RTP port allocator", NULL, NULL, liblinphone_tester_before_each, liblinphone_tester_after_each,
+	sizeof(rtp_port_allocator_tests) / sizeof(rtp_port_allocator_tests[0]), rtp_port_allocator_tests
+};
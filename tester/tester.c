@@ -40,6 +40,7 @@ static bool_t liblinphone_tester_keep_record_files = FALSE;
 static bool_t liblinphone_tester_leak_detector_disabled = FALSE;
 bool_t liblinphone_tester_keep_uuid = FALSE;
 bool_t liblinphone_tester_tls_support_disabled = FALSE;
+bool_t liblinphone_tester_run_benchmarks = FALSE;
 int manager_count = 0;
 int leaked_objects_count = 0;
 const MSAudioDiffParams audio_cmp_params = {10,2000};
@@ -638,6 +639,9 @@ void liblinphone_tester_add_suites() {
 	bc_tester_add_suite(&clonable_object_test_suite);
 	bc_tester_add_suite(&main_db_test_suite);
 	bc_tester_add_suite(&property_container_test_suite);
+	bc_tester_add_suite(&rtp_port_allocator_test_suite);
+	bc_tester_add_suite(&file_reader_test_suite);
+	bc_tester_add_suite(&utils_test_suite);
 	#ifdef VIDEO_ENABLED
 		bc_tester_add_suite(&video_test_suite);
 	#endif // ifdef VIDEO_ENABLED
@@ -793,6 +797,16 @@ static void check_ice_from_rtp(LinphoneCall *c1, LinphoneCall *c2, LinphoneStrea
 	linphone_call_stats_unref(stats);
 }
 
+long long liblinphone_tester_get_metric(const char *name) {
+	char *metrics = linphone_core_get_metrics();
+	char *line = bctbx_strdup_printf("\n%s ", name);
+	char *found = strstr(metrics, line);
+	long long value = found ? atoll(found + strlen(line)) : -1;
+	bctbx_free(line);
+	ms_free(metrics);
+	return value;
+}
+
 bool_t check_ice(LinphoneCoreManager* caller, LinphoneCoreManager* callee, LinphoneIceState state) {
 	LinphoneCall *c1,*c2;
 	bool_t global_success = TRUE;
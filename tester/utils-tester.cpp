@@ -0,0 +1,66 @@
+/*
+ * utils-tester.cpp
+ * Copyright (C) 2010-2018 Belledonne Communications SARL
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include <cstring>
+#include <string>
+
+#include "linphone/utils/utils.h"
+
+#include "liblinphone_tester.h"
+
+// =============================================================================
+
+using namespace std;
+
+using namespace LinphonePrivate;
+
+static void append_utf8 () {
+	string str = "a";
+
+	// One to four bytes, appended to what is already there.
+	Utils::appendUtf8(str, 0xE9); // é
+	Utils::appendUtf8(str, 0x20AC); // €
+	Utils::appendUtf8(str, 0x1F600); // 😀
+	BC_ASSERT_STRING_EQUAL(str.c_str(), "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80");
+
+	// Not a code point.
+	Utils::appendUtf8(str, 0x110000);
+	BC_ASSERT_EQUAL(static_cast<int>(str.size()), 10, int, "%d");
+}
+
+static void append_utf8_as_utf8_to_char () {
+	const uint32_t codePoints[] = { 0x0, 0x7F, 0x80, 0x7FF, 0x800, 0xFFFF, 0x10000, 0x10FFFF };
+	for (uint32_t codePoint : codePoints) {
+		string str;
+		Utils::appendUtf8(str, codePoint);
+		char *expected = Utils::utf8ToChar(codePoint);
+		BC_ASSERT_TRUE(str == string(expected, codePoint == 0 ? 1 : strlen(expected)));
+		delete[] expected;
+	}
+}
+
+test_t utils_tests[] = {
+	TEST_NO_TAG("Append UTF-8", append_utf8),
+	TEST_NO_TAG("Append UTF-8 as UTF-8 to char", append_utf8_as_utf8_to_char)
+};
+
+test_suite_t utils_test_suite = {
+	"Utils", NULL, NULL, liblinphone_tester_before_each, liblinphone_tester_after_each,
+	sizeof(utils_tests) / sizeof(utils_tests[0]), utils_tests
+};